@@ -0,0 +1,65 @@
+#ifndef ATTACKS_HPP
+#define ATTACKS_HPP
+
+#include <cstdint>
+
+#include "Board.hpp"
+
+namespace Attacks
+{
+  // Pieces of the position as bitboards, bit 0 = a1 like the board, side 0 is white and 1 is black
+  struct Bitboards
+  {
+    Bitboards() = default;
+    explicit Bitboards(const Board::Board &board);
+    // Sides, occupancy and kings are filled in from the twelve piece bitboards
+    explicit Bitboards(const std::uint64_t (&pieces)[2][6]);
+
+    // Pawn, knight, bishop, rook, queen, king
+    std::uint64_t pieces[2][6] = {};
+    std::uint64_t sides[2] = {0, 0};
+    std::uint64_t occupancy = 0;
+    int kings[2] = {0, 0};
+  };
+
+  constexpr std::uint64_t whiteHalf = 0x00000000FFFFFFFFULL;
+  constexpr std::uint64_t blackHalf = 0xFFFFFFFF00000000ULL;
+
+  std::uint64_t getPawnAttacks(std::uint64_t pawns, int side);
+  std::uint64_t getKnightAttacks(int square);
+  std::uint64_t getKingAttacks(int square);
+
+  /**
+   * @brief Squares around the king of the given side and the three in front of those, where an attack on the king builds up
+   *
+   * @return std::uint64_t
+   */
+  std::uint64_t getKingZone(int square, int side);
+
+  // The king's file and its neighbours one and two ranks in front of it, where its own pawns shelter it
+  std::uint64_t getPawnShield(int square, int side);
+
+  // The same files up to four ranks in front of the king, where enemy pawns are storming it
+  std::uint64_t getPawnStorm(int square, int side);
+
+  /**
+   * @brief Sliding attacks stop at the first piece in each direction, that piece is attacked whatever its colour
+   *
+   * @return std::uint64_t
+   */
+  std::uint64_t getBishopAttacks(int square, std::uint64_t occupancy);
+  std::uint64_t getRookAttacks(int square, std::uint64_t occupancy);
+
+  inline int countBits(std::uint64_t bits)
+  {
+    return __builtin_popcountll(bits);
+  }
+
+  // Index of the lowest set bit, the bitboard must not be empty
+  inline int getFirstSquare(std::uint64_t bits)
+  {
+    return __builtin_ctzll(bits);
+  }
+} // namespace Attacks
+
+#endif // ATTACKS_HPP
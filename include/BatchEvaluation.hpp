@@ -0,0 +1,90 @@
+#ifndef BATCH_EVALUATION_HPP
+#define BATCH_EVALUATION_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Board.hpp"
+#include "Brain.hpp"
+
+namespace BatchEvaluation
+{
+  // A position stripped down to what the evaluation reads, bit 0 = a1 like the board, side 0 is white and 1 is black
+  struct PackedPosition
+  {
+    PackedPosition() = default;
+    explicit PackedPosition(const Board::Board &board);
+
+    // Pawn, knight, bishop, rook, queen, king
+    std::uint64_t pieces[2][6] = {};
+    bool isWhiteToMove = true;
+  };
+
+  // The same positions as a structure of arrays, every bitboard of all the positions lies next to each other so
+  // the kernels walk memory in order and the compiler can vectorize across positions
+  struct PositionBatch
+  {
+    explicit PositionBatch(const std::vector<PackedPosition> &positions);
+
+    std::size_t size() const;
+
+    std::vector<std::uint64_t> pieces[2][6];
+    std::vector<std::uint8_t> isWhiteToMove;
+  };
+
+  class BatchEvaluator
+  {
+  public:
+    /**
+     * @brief Starts threadCount - 1 workers, the thread calling evaluate is the last one
+     */
+    BatchEvaluator(std::size_t threadCount = getDefaultThreadCount());
+    ~BatchEvaluator();
+
+    BatchEvaluator(const BatchEvaluator &) = delete;
+    BatchEvaluator &operator=(const BatchEvaluator &) = delete;
+
+    /**
+     * @brief Evaluates every position with the given weights, from the side to move's point of view. Only the
+     * hand-written neuron terms are scored, the endgame entries and a loaded network Brain::evaluatePosition would use
+     * are left out
+     *
+     * @return std::vector<Score::Score> one score in centipawns per position
+     */
+    std::vector<Score::Score> evaluate(const PositionBatch &batch, const std::vector<Brain::EvaluationNode> &neurons);
+
+    std::size_t getThreadCount() const;
+
+    static std::size_t getDefaultThreadCount();
+
+    // Positions a thread takes at a time, small enough for the kernel scratch arrays to stay in the first level cache
+    constexpr static std::size_t chunkSize = 256;
+
+  private:
+    void runWorker();
+    void evaluateChunks();
+    void evaluateChunk(std::size_t begin, std::size_t end);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+    bool isStopping = false;
+    unsigned long long generation = 0;
+    std::size_t busyWorkers = 0;
+
+    // The batch being evaluated, only touched by the workers between workReady and workDone
+    const PositionBatch *batch = nullptr;
+    std::vector<Brain::EvaluationNode> neurons;
+    std::vector<Score::Weight> weights;
+    Score::Score *scores = nullptr;
+    std::atomic<std::size_t> nextChunk{0};
+  };
+} // namespace BatchEvaluation
+
+#endif // BATCH_EVALUATION_HPP
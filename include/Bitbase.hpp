@@ -0,0 +1,25 @@
+#ifndef BITBASE_HPP
+#define BITBASE_HPP
+
+#include <cstddef>
+
+namespace Bitbase
+{
+  /**
+   * @brief Generates the bitbase by retrograde iteration, only the first call does any work
+   */
+  void init();
+
+  /**
+   * @brief Exact result of king and pawn against king, the side with the pawn plays up the board like white. A probe
+   * before init generates the bitbase first
+   *
+   * @return true if the side with the pawn wins, false for a draw
+   */
+  bool probeKPK(int strongKing, int pawn, int weakKing, bool isStrongSideToMove);
+
+  // One bit per position with the pawn on files a to d, ranks 2 to 7
+  std::size_t getKPKSize();
+} // namespace Bitbase
+
+#endif // BITBASE_HPP
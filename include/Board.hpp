@@ -7,6 +7,8 @@
 #include <vector>
 #include <utility>
 #include <array>
+#include <cstddef>
+#include <cstdint>
 
 namespace Board
 {
@@ -22,6 +24,34 @@ namespace Board
     RESIGNATION
   };
 
+  // One piece put on a square or taken off it by a move, incremental evaluators replay these instead of the whole board
+  struct PieceChange
+  {
+    unsigned long long piece;
+    int square;
+    int sign;
+  };
+
+  // Everything makeMove changes that cannot be recomputed when the move is taken back
+  struct IrreversibleState
+  {
+    bool hasWhiteKingMoved;
+    bool hasBlackKingMoved;
+    bool hasWhiteRookAMoved;
+    bool hasWhiteRookHMoved;
+    bool hasBlackRookAMoved;
+    bool hasBlackRookHMoved;
+    int fiftyMoveRuleCounter;
+    GameState gameState;
+    unsigned long long hashKey;
+    unsigned long long pawnKey;
+    int middlegameScore[2];
+    int endgameScore[2];
+    int phase;
+    std::uint64_t materialKey;
+    std::size_t pieceChangeCount;
+  };
+
   class Board
   {
   public:
@@ -37,8 +67,22 @@ namespace Board
      */
     bool makeMove(const Move::Move &move);
 
+    /**
+     * @brief Finds the legal move going from one square to another, moves coming from outside (a user, the transposition table) only know the squares
+     *
+     * @return Move::Move, Move::Move(false) if there is no such move
+     */
+    Move::Move getValidMove(int from, int to, Move::PieceType promotionTo = Move::PieceType::QUEEN);
+
     void undoMove();
 
+    /**
+     * @brief Passes the turn to the opponent without moving a piece, used by the null move pruning in Brain
+     *
+     */
+    void makeNullMove();
+    void undoNullMove();
+
     /**
      * @brief Gets the all possible moves that can be made in the current state of the game
      *
@@ -106,6 +150,7 @@ namespace Board
 
     std::pair<bool, Move::Move> checkForPromotion(const Move::Move &move);
     std::pair<bool, Move::Move> checkForEnPassant(const Move::Move &move);
+    bool isRequestedPawn(const Move::Move &move, int from);
 
     inline bool isOnLeftBorder(int square);
     inline bool isOnRightBorder(int square);
@@ -151,9 +196,13 @@ namespace Board
     void setToDefault();
     void setFromFEN(const std::string& FEN);
 
-    // board[0] = a8
+    // board[0] = a1, board[63] = h8
     unsigned long long board[64] = {0};
 
+    // The same pieces one byte per square, kept up to date by updatePieceScore and the undo, the BoardScan kernels
+    // compare all of it in a few instructions where board would be walked square by square
+    alignas(32) std::uint8_t packedBoard[64] = {0};
+
     bool hasWhiteKingMoved = false;
     bool hasBlackKingMoved = false;
     bool hasWhiteRookAMoved = false;
@@ -174,6 +223,77 @@ namespace Board
     bool isWhiteTurn = true;
 
     std::vector<Move::Move> moveHistory;
+    std::vector<IrreversibleState> stateHistory;
+
+    // Piece changes of every move since the position was set up, the changes of move i start at
+    // stateHistory[i].pieceChangeCount
+    std::vector<PieceChange> pieceChanges;
+
+    IrreversibleState getIrreversibleState() const;
+    void restoreIrreversibleState();
+
+    // Zobrist key of the position, pieces, side to move, castling rights and the en passant file. updatePieceScore xors
+    // every piece that comes or goes, the undo takes the old key back
+    unsigned long long hashKey = 0;
+
+    /**
+     * @brief Computes the Zobrist key of the current position from scratch, for a new position and to check the
+     * incremental one
+     *
+     * @return unsigned long long
+     */
+    unsigned long long computeHashKey() const;
+
+    /**
+     * @brief The part of the key that is not the pieces: side to move, castling rights and the en passant file. makeMove
+     * xors the pieces in and out one at a time and swaps this part before and after the move
+     *
+     * @return unsigned long long
+     */
+    unsigned long long computeStateKey() const;
+
+    // Zobrist key of the pawns alone, the pawn structure evaluation is cached under it, kept up to date like hashKey
+    unsigned long long pawnKey = 0;
+    unsigned long long computePawnKey() const;
+
+    // Material and piece-square sums of each side (0 white, 1 black) in centipawns, makeMove only adds the difference of the
+    // pieces that moved and undoMove takes the old sums back
+    int middlegameScore[2] = {0, 0};
+    int endgameScore[2] = {0, 0};
+    int phase = 0;
+
+    // How many pieces of each kind are on the board, four bits apiece from the white pawns in the lowest bits to the
+    // black queens, kings left out. Positions with the same material share the key, the endgame table is indexed by it
+    std::uint64_t materialKey = 0;
+
+    static constexpr std::uint64_t getMaterialKeyStep(int side, int type)
+    {
+      return 1ULL << (4 * (5 * side + type));
+    }
+
+    /**
+     * @brief Pieces of one kind read from the material key, type 0 is a pawn and 4 a queen
+     *
+     * @return int
+     */
+    int getPieceCount(bool white, int type) const;
+
+    /**
+     * @brief Looks king and pawn against king up in the KPK bitbase
+     *
+     * @param result 1 when white wins, -1 when black wins and 0 for a draw
+     * @return false if the position is any other material
+     */
+    bool probeKPK(int &result) const;
+
+    /**
+     * @brief Material and piece-square score of one side in centipawns, tapered from the middlegame to the endgame tables as pieces come off
+     *
+     * @return int
+     */
+    int getTaperedScore(bool white) const;
+    void computePieceScores();
+    void updatePieceScore(unsigned long long piece, int square, int sign);
 
     static constexpr int NONE = 0;
     static constexpr int BLACK = 1;
@@ -0,0 +1,65 @@
+#ifndef BOARD_SCAN_HPP
+#define BOARD_SCAN_HPP
+
+#include <cstdint>
+
+namespace BoardScan
+{
+  // Kernels that look at all 64 squares of a byte-packed board at once, square 0 = a1 and every byte holds a piece
+  // with the bits of Board::Board, 0 for an empty square
+  enum class Kernel
+  {
+    SCALAR,
+    SSE2,
+    AVX2
+  };
+
+  // Pawn, knight, bishop, rook, queen, king of each side, bit 0 = a1, side 0 is white and 1 is black
+  struct PieceMasks
+  {
+    std::uint64_t pieces[2][6] = {};
+  };
+
+  /**
+   * @brief Squares holding exactly the given piece, colour included
+   *
+   * @return std::uint64_t
+   */
+  std::uint64_t getPieceMask(const std::uint8_t *squares, std::uint8_t piece);
+
+  std::uint64_t getOccupiedMask(const std::uint8_t *squares);
+
+  /**
+   * @brief All twelve piece masks from one pass, the board is loaded into registers once for every piece
+   *
+   * @return PieceMasks
+   */
+  PieceMasks getPieceMasks(const std::uint8_t *squares);
+
+  int countPieces(const std::uint8_t *squares, std::uint8_t piece);
+
+  /**
+   * @brief Adds up the table entries of the squares holding the given piece
+   *
+   * @return int
+   */
+  int sumPieceSquares(const std::uint8_t *squares, std::uint8_t piece, const std::int16_t *table);
+
+  /**
+   * @brief The fastest kernel the processor running the bot supports, picked on the first call
+   *
+   * @return Kernel
+   */
+  Kernel getKernel();
+
+  bool isSupported(Kernel kernel);
+
+  /**
+   * @brief Switches every scan to the given kernel, tests compare them with each other this way
+   *
+   * @return false if the processor does not support it, the kernel in use is kept then
+   */
+  bool setKernel(Kernel kernel);
+} // namespace BoardScan
+
+#endif // BOARD_SCAN_HPP
@@ -2,10 +2,35 @@
 #define BRAIN_HPP
 
 #include <string>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
 #include <fstream>
+#include <memory>
+#include <ostream>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "Attacks.hpp"
 #include "Board.hpp"
+#include "EvaluationCache.hpp"
+#include "MateSearch.hpp"
 #include "Move.hpp"
+#include "Network.hpp"
+#include "OpeningBook.hpp"
+#include "PawnStructure.hpp"
+#include "Score.hpp"
+#include "Syzygy.hpp"
+#include "Tablebase.hpp"
+#include "TimeManager.hpp"
+#include "TranspositionTable.hpp"
+
+namespace BatchEvaluation
+{
+  struct PackedPosition;
+  class BatchEvaluator;
+}
 
 namespace Brain
 {
@@ -15,6 +40,7 @@ namespace Brain
     SPACE,
     KING_SAFETY,
     PIECE_ACTIVITY,
+    PAWN_STRUCTURE,
   };
 
   struct EvaluationNode
@@ -32,41 +58,334 @@ namespace Brain
           return "KING_SAFETY";
         case EvaluationTypes::PIECE_ACTIVITY:
           return "ACTIVITY";
+        case EvaluationTypes::PAWN_STRUCTURE:
+          return "PAWN_STRUCTURE";
         default:
           return "mysterious shi";
       }
     }
   };
 
+  struct SearchOptions
+  {
+    int maxDepth = 4;
+
+    // Selective search, every technique can be switched off on its own for A/B comparisons
+    bool useNullMovePruning = true;
+    bool useLateMoveReductions = true;
+    bool useFutilityPruning = true;
+    bool useReverseFutilityPruning = true;
+    bool useLateMovePruning = true;
+    bool useRazoring = true;
+
+    // Zero window scouts on non-PV moves and a narrow window around the previous iteration's score at the root
+    bool usePrincipalVariationSearch = true;
+    bool useAspirationWindows = true;
+
+    bool useTranspositionTable = true;
+    bool useEvaluationCache = true;
+
+    // Positions whose material and pawns alone are this many centipawns outside the window skip king safety and piece activity
+    bool useLazyEvaluation = true;
+    Score::Score lazyEvaluationMargin = 200;
+
+    // Number of best lines reported, the first one is the move that gets played
+    int multiPv = 1;
+
+    // Book moves are played without a search whenever the opening book is open
+    bool useOpeningBook = true;
+    OpeningBook::Selection bookSelection = OpeningBook::Selection::WEIGHTED;
+
+    // Endgames covered by the tables are scored from them instead of being searched, the distance to mate tables first
+    // and then the Syzygy ones
+    bool useTablebase = true;
+
+    // Material the endgame table knows is scored by its own evaluator or scaled towards a draw, drawn king and pawn
+    // endings are cut off in the search by the KPK bitbase
+    bool useEndgames = true;
+
+    // A loaded network evaluates instead of the neurons, switching it off goes back to the hand-crafted evaluation
+    bool useNetwork = true;
+
+    // Every search first reads neurons.txt again if it changed, builds with the weights compiled in leave it alone
+#ifdef CHESSBOT_COMPILED_NEURONS
+    bool reloadNeurons = false;
+#else
+    bool reloadNeurons = true;
+#endif
+  };
+
+  struct SearchLine
+  {
+    Score::Score score = 0;
+    std::vector<Move::Move> principalVariation;
+  };
+
+  struct SearchStatistics
+  {
+    long long nodes = 0;
+    long long quiescenceNodes = 0;
+    int depth = 0;
+    int selectiveDepth = 0;
+    Score::Score score = 0;
+
+    // Aspiration window misses at the root and zero window scouts that had to be searched again
+    long long failHighs = 0;
+    long long failLows = 0;
+    long long reSearches = 0;
+
+    long long betaCutoffs = 0;
+    long long firstMoveBetaCutoffs = 0;
+
+    long long hashProbes = 0;
+    long long hashHits = 0;
+    long long hashCutoffs = 0;
+    int hashfull = 0;
+
+    long long tablebaseHits = 0;
+    long long bitbaseHits = 0;
+
+    long long pawnHashProbes = 0;
+    long long pawnHashHits = 0;
+
+    long long evaluationCacheProbes = 0;
+    long long evaluationCacheHits = 0;
+
+    // Evaluations inside the search that could have stopped after the cheap terms and the ones that did
+    long long lazyEvaluationProbes = 0;
+    long long lazyEvaluationExits = 0;
+
+    // One entry per completed iteration, times in milliseconds
+    std::vector<long long> iterationNodes;
+    std::vector<long long> iterationTimes;
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    long long getElapsedTime() const
+    {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    long long getNodesPerSecond() const
+    {
+      const long long elapsed = getElapsedTime();
+      return elapsed > 0 ? nodes * 1000 / elapsed : nodes * 1000;
+    }
+
+    // Nodes of the last iteration over the nodes of the one before it
+    double getEffectiveBranchingFactor() const
+    {
+      const size_t count = iterationNodes.size();
+      if (count < 2 || iterationNodes[count - 2] == 0)
+        return 0;
+      return static_cast<double>(iterationNodes[count - 1]) / iterationNodes[count - 2];
+    }
+
+    // Share of the cutoffs produced by the first move searched, a measure of move ordering quality
+    double getFirstMoveCutoffRate() const
+    {
+      return betaCutoffs > 0 ? static_cast<double>(firstMoveBetaCutoffs) / betaCutoffs : 0;
+    }
+
+    double getQuiescenceShare() const
+    {
+      return nodes > 0 ? static_cast<double>(quiescenceNodes) / nodes : 0;
+    }
+
+    double getHashHitRate() const
+    {
+      return hashProbes > 0 ? static_cast<double>(hashHits) / hashProbes : 0;
+    }
+
+    double getPawnHashHitRate() const
+    {
+      return pawnHashProbes > 0 ? static_cast<double>(pawnHashHits) / pawnHashProbes : 0;
+    }
+
+    double getEvaluationCacheHitRate() const
+    {
+      return evaluationCacheProbes > 0 ? static_cast<double>(evaluationCacheHits) / evaluationCacheProbes : 0;
+    }
+
+    double getLazyEvaluationRate() const
+    {
+      return lazyEvaluationProbes > 0 ? static_cast<double>(lazyEvaluationExits) / lazyEvaluationProbes : 0;
+    }
+  };
+
   class Brain
   {
   public:
     Brain();
     Brain(const std::string& FEN);
-    ~Brain() = default;
+    ~Brain();
 
-    double evaluatePosition();
+    /**
+     * @brief Static evaluation for the side the brain plays
+     *
+     * @return Score::Score in centipawns
+     */
+    Score::Score evaluatePosition();
+
+    /**
+     * @brief Evaluates many positions at once with the current weights, for labelling and tuning offline, the
+     * positions are laid out as a structure of arrays and spread over a pool of threads started on the first call.
+     * Only the hand-written neuron evaluation, without the endgame entries or the network
+     *
+     * @return std::vector<Score::Score> one score per position from its side to move's point of view
+     */
+    std::vector<Score::Score> evaluateBatch(const std::vector<BatchEvaluation::PackedPosition> &positions);
+
+    /**
+     * @brief Replaces the evaluation weights read from neurons.txt, scores cached under the old weights are not used again
+     */
+    void setNeurons(const std::vector<EvaluationNode> &neurons);
+    const std::vector<EvaluationNode> &getNeurons() const;
+
+    /**
+     * @brief Reads neurons.txt again when it was written since it was last read, a file that does not parse keeps
+     * the weights in use
+     *
+     * @return true if new weights were loaded
+     */
+    bool reloadNeuronsIfChanged();
     Move::Move findBestMove();
+    Move::Move findBestMove(const TimeManager::TimeControl &timeControl);
+    /**
+     * @brief Looks only for a forced mate of at most maxPlies half moves, much faster than findBestMove on deep mates
+     * because the attacker only tries checks and the proof number search goes after the narrowest lines first
+     *
+     * @return Move::Move first move of the shortest mate found, Move::Move(false) if there is none within maxPlies
+     */
+    Move::Move findMate(int maxPlies);
     bool makeRealMove(Move::Move move);
     bool makeTestMove(Move::Move move);
 
+    /**
+     * @brief Searches the position after the expected reply on a background thread while the opponent thinks,
+     * makeRealMove with that reply keeps the search going for findBestMove, any other move stops it
+     */
+    void startPondering();
+    void stopPondering();
+    bool isPondering() const;
+    Move::Move getPonderMove() const;
+
     Board::Board realBoard;
     Board::Board testBoard;
     bool isWhite = false;
 
+    SearchOptions searchOptions;
+    SearchStatistics searchStatistics;
+
+    // Best lines of the last completed iteration, ordered from the best
+    std::vector<SearchLine> searchLines;
+
+    // Every completed iteration prints an info line here when set, pondering stays silent
+    std::ostream *infoOutput = nullptr;
+    TimeManager::TimeManager timeManager;
+    TranspositionTable::TranspositionTable transpositionTable;
+    OpeningBook::OpeningBook openingBook;
+    Tablebase::Tablebase tablebase;
+    Syzygy::Syzygy syzygy;
+    MateSearch::MateSearch mateSearch;
+    Network::Network network;
+
+    // Each Brain searches on one thread at a time, so the pawn table is never shared between threads
+    PawnStructure::PawnStructure pawnStructure;
+    EvaluationCache::EvaluationCache evaluationCache;
+
   private:
     std::vector<EvaluationNode> readNeurons();
-    double evaluateNode(EvaluationNode node);
-    double evaluateSpace();
-    double evaluateKingSafety();
-    double evaluatePieceActivity();
-    int calculateMaterialDifference();
+    std::vector<EvaluationNode> getStartingNeurons();
+    Score::Score evaluateFor(bool white);
+    /**
+     * @brief Evaluation for the search, endgames the material key points to are scored or scaled by their own entry
+     *
+     * @return Score::Score
+     */
+    Score::Score evaluateFor(bool white, Score::Score alpha, Score::Score beta);
+    /**
+     * @brief The network or the neurons, stops after the cheap terms when they leave the window by more than the lazy
+     * evaluation margin, king safety and piece activity would not bring the score back into it
+     *
+     * @return Score::Score exact, or only the cheap terms when the score is far outside the window
+     */
+    Score::Score evaluateGeneral(bool white, Score::Score alpha, Score::Score beta);
+    Score::Score evaluateSide(bool white, bool cheapTerms);
+    constexpr static bool isCheap(EvaluationTypes type);
+    Score::Score evaluateNode(EvaluationTypes type, Score::Weight weight, bool white);
+    template <EvaluationTypes type>
+    Score::Score evaluateTerm(bool white);
+#ifdef CHESSBOT_COMPILED_NEURONS
+    /**
+     * @brief evaluateSide with the weights of neurons.txt known at compile time, one call per weighted term and
+     * nothing at all for the rest
+     */
+    template <bool cheapTerms, std::size_t... indices>
+    Score::Score evaluateCompiledSide(bool white, std::index_sequence<indices...>);
+    template <bool cheapTerms, std::size_t index>
+    void addCompiledTerm(bool white, Score::Score &result);
+#endif
+    Score::Score evaluateSpace(bool white);
+    Score::Score evaluateKingSafety(bool white);
+    Score::Score evaluatePieceActivity(bool white);
+    Score::Score calculateMaterialDifference(bool white);
 
-    constexpr static double optimalPieceActivity = 71.0;
-    constexpr static double optimalSpace = 24.0;
-    constexpr static double optimalKingSafety = 12.0;
+    Move::Move iterativeDeepening();
+    Score::Score searchLine(std::vector<Move::Move> &moves, int depth, Score::Score previousScore, const std::vector<Move::Move> &excludedMoves, Move::Move &bestMove);
+    Score::Score searchRoot(std::vector<Move::Move> &moves, int depth, Score::Score alpha, Score::Score beta, const std::vector<Move::Move> &excludedMoves, Move::Move &bestMove);
+    std::vector<Move::Move> getPrincipalVariation(const Move::Move &firstMove, int maxLength);
+    int getLineIndex(const Move::Move &move) const;
+    void printSearchInfo(const SearchLine &line, int lineNumber);
+    Score::Score search(int depth, Score::Score alpha, Score::Score beta, int ply, bool isNullMoveAllowed);
+    Score::Score quiescence(Score::Score alpha, Score::Score beta, int ply);
+    void orderMoves(std::vector<Move::Move> &moves, const Move::Move &hashMove = Move::Move(false));
+    bool isCapture(const Move::Move &move);
+    bool isPromotion(const Move::Move &move);
+    static bool isSameMove(const Move::Move &first, const Move::Move &second);
+    bool hasNonPawnMaterial(bool white);
+    static int getReduction(int depth, int moveNumber);
+    static Score::Score scoreToTranspositionTable(Score::Score score, int ply);
+    static Score::Score scoreFromTranspositionTable(Score::Score score, int ply);
+    static Score::Score scoreFromTablebase(const Tablebase::ProbeResult &result, int ply);
+    static Score::Score scoreFromSyzygy(Syzygy::Wdl wdl, int ply);
+
+    // Scores are whole centipawns, so the narrowest window is one centipawn wide
+    constexpr static Score::Score nullWindow = 1;
+    constexpr static int maxPly = 64;
+
+    // Aspiration windows start half a pawn wide and double on every miss until they give up and go infinite
+    constexpr static Score::Score aspirationWindow = 50;
+    constexpr static Score::Score maxAspirationWindow = 800;
+    constexpr static int aspirationDepth = 3;
+
+    // Margins are in centipawns, the unit of every term
+    constexpr static Score::Score futilityMargin = 150;
+    constexpr static Score::Score reverseFutilityMargin = 120;
+    constexpr static Score::Score razoringMargin = 300;
+    constexpr static int selectiveDepth = 3;
+    constexpr static int nullMoveVerificationDepth = 6;
+
+    std::thread ponderThread;
+    Move::Move ponderMove = Move::Move(false);
+    Move::Move ponderResult = Move::Move(false);
 
     std::vector<EvaluationNode> neurons;
+    // The weights of the neurons in fixed point, in the same order
+    std::vector<Score::Weight> neuronWeights;
+    std::uint64_t neuronsKey = 0;
+
+    // When neurons.txt was read, the hot reload compares it with the file's current time
+    std::filesystem::file_time_type neuronsWriteTime;
+#ifdef CHESSBOT_COMPILED_NEURONS
+    // Set while the weights in use are the ones compiled in, any others go through the runtime loop
+    bool usesCompiledNeurons = false;
+#endif
+
+    std::unique_ptr<BatchEvaluation::BatchEvaluator> batchEvaluator;
+
+    // Pieces of the position being evaluated, built once by evaluateFor for every term
+    Attacks::Bitboards evaluationBitboards;
     constexpr static char* neuronsSource = "neurons.txt";
   };
 } // namespace Brain
@@ -0,0 +1,52 @@
+#ifndef ENDGAME_HPP
+#define ENDGAME_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "Board.hpp"
+#include "Score.hpp"
+
+namespace Endgame
+{
+  // Scored for the side with the extra material, 0 white and 1 black
+  using EvaluationFunction = Score::Score (*)(const Board::Board &board, int strongSide);
+
+  // Out of fullScale, the general evaluation is multiplied by it
+  using ScaleFunction = int (*)(const Board::Board &board);
+
+  constexpr int fullScale = 64;
+
+  // Added to the score of a won endgame, it stays above every evaluation of a position that is only better
+  constexpr Score::Score knownWin = 1000;
+
+  // What is known about every position with one material key, either evaluate or scale is set
+  struct Entry
+  {
+    EvaluationFunction evaluate = nullptr;
+    ScaleFunction scale = nullptr;
+    int strongSide = 0;
+
+    // Neither side can ever mate, the game is drawn as soon as the material is on the board
+    bool isInsufficientMaterial = false;
+  };
+
+  /**
+   * @brief The material key of a signature in the notation of the tablebases, white before the v, e.g. KRPvKR
+   *
+   * @return std::uint64_t
+   */
+  std::uint64_t getMaterialKey(const std::string &signature);
+
+  /**
+   * @brief Looks the material key up, special material has its entry in a table and a lone king or opposite coloured
+   * bishops are recognised from the piece counts in the key
+   *
+   * @return const Entry* nullptr when the general evaluation knows best
+   */
+  const Entry *probe(std::uint64_t materialKey);
+
+  bool isInsufficientMaterial(std::uint64_t materialKey);
+} // namespace Endgame
+
+#endif // ENDGAME_HPP
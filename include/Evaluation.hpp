@@ -0,0 +1,37 @@
+#ifndef EVALUATION_HPP
+#define EVALUATION_HPP
+
+#include "Attacks.hpp"
+#include "Score.hpp"
+
+namespace Evaluation
+{
+  /**
+   * @brief Squares the knights, bishops, rooks and queens of the side attack, once in its own half and twice in the
+   * enemy's, squares of its own pieces not at all
+   *
+   * @return Score::Score in centipawns, a well developed army is worth about one pawn
+   */
+  Score::Score getPieceActivity(const Attacks::Bitboards &bitboards, int side);
+
+  /**
+   * @brief Enemy pieces hitting the king zone, pawns sheltering the king and enemy pawns storming it, faded out
+   * with the game phase
+   *
+   * @return Score::Score in centipawns, below zero when the king is in danger
+   */
+  Score::Score getKingSafety(const Attacks::Bitboards &bitboards, int side, int phase);
+
+  // Attacked squares of a well developed army
+  constexpr int optimalPieceActivity = 71;
+
+  // King safety in centipawns, attack units per square of the king zone hit by a pawn, knight, bishop, rook, queen or king
+  constexpr int kingAttackWeights[6] = {0, 2, 2, 3, 5, 0};
+  // Tenths of a centipawn per squared attack unit
+  constexpr int kingDangerPerUnit = 4;
+  constexpr int maxKingDanger = 500;
+  constexpr int pawnShieldBonus = 10;
+  constexpr int pawnStormPenalty = 5;
+} // namespace Evaluation
+
+#endif // EVALUATION_HPP
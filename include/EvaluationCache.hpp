@@ -0,0 +1,54 @@
+#ifndef EVALUATION_CACHE_HPP
+#define EVALUATION_CACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "Score.hpp"
+
+namespace EvaluationCache
+{
+  // The upper half of the key and the score share one word, it is read and written in one piece so another thread can
+  // never hand out half of its entry and the table needs no locks
+  struct Entry
+  {
+    std::atomic<std::uint64_t> data{0};
+  };
+
+  class EvaluationCache
+  {
+  public:
+    EvaluationCache(std::size_t sizeInKilobytes = defaultSizeInKilobytes);
+    ~EvaluationCache() = default;
+
+    /**
+     * @brief Rounds the table down to a power of two entries that fit in the given size, clears it
+     */
+    void resize(std::size_t sizeInKilobytes);
+    void clear();
+
+    /**
+     * @brief Safe to call from several threads at once
+     *
+     * @return true if the score of the key was found
+     */
+    bool probe(std::uint64_t key, Score::Score &score);
+    void store(std::uint64_t key, Score::Score score);
+
+    long long getProbes() const;
+    long long getHits() const;
+    void resetStatistics();
+
+    constexpr static std::size_t defaultSizeInKilobytes = 4096;
+
+  private:
+    std::unique_ptr<Entry[]> entries;
+    std::size_t mask = 0;
+    std::atomic<long long> probes{0};
+    std::atomic<long long> hits{0};
+  };
+} // namespace EvaluationCache
+
+#endif // EVALUATION_CACHE_HPP
@@ -0,0 +1,45 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace MappedFile
+{
+  // Read only view of a whole file, pages are loaded on first touch and shared with every process mapping the same file
+  class MappedFile
+  {
+  public:
+    MappedFile() = default;
+    MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    /**
+     * @brief Maps the file, any file mapped before is closed first
+     *
+     * @return true if the file exists and is not empty
+     */
+    bool open(const std::string &path);
+    void close();
+
+    bool isOpen() const;
+    const unsigned char *getData() const;
+    std::size_t getSize() const;
+
+  private:
+    const unsigned char *data = nullptr;
+    std::size_t size = 0;
+
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+  };
+} // namespace MappedFile
+
+#endif // MAPPED_FILE_HPP
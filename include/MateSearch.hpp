@@ -0,0 +1,67 @@
+#ifndef MATE_SEARCH_HPP
+#define MATE_SEARCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Board.hpp"
+#include "Move.hpp"
+
+namespace MateSearch
+{
+  // Proof and disproof numbers of a node for the side to move, the fewest leaves that still have to be solved to
+  // show that the side to move gets its way, or that it does not
+  struct Entry
+  {
+    unsigned long long key = 0;
+    std::uint32_t proof = 1;
+    std::uint32_t disproof = 1;
+    std::int16_t depth = -1;
+  };
+
+  class MateSearch
+  {
+  public:
+    MateSearch(std::size_t sizeInMegabytes = defaultSizeInMegabytes);
+    ~MateSearch() = default;
+
+    /**
+     * @brief Rounds the table down to a power of two entries that fit in the given size, clears it
+     */
+    void resize(std::size_t sizeInMegabytes);
+    void clear();
+
+    /**
+     * @brief Depth first proof number search for a mate by the side to move in at most maxPlies half moves,
+     * the attacker only plays checks and the defender every legal move
+     *
+     * @return true if the mate is forced, its first move is put in mateMove
+     */
+    bool solve(Board::Board &board, int maxPlies, Move::Move &mateMove);
+
+    long long getNodes() const;
+
+    // Unsolved after this many nodes counts as no mate found
+    long long nodeLimit = defaultNodeLimit;
+
+    constexpr static std::size_t defaultSizeInMegabytes = 16;
+    constexpr static long long defaultNodeLimit = 2000000;
+    constexpr static std::uint32_t infinity = 100000000;
+
+  private:
+    void searchNode(Board::Board &board, std::uint32_t proofThreshold, std::uint32_t disproofThreshold, int depth, bool isAttacker);
+    bool getTerminal(const Board::Board &board, int depth, bool isAttacker, Entry &entry) const;
+    Entry lookup(unsigned long long key, int depth, bool isAttacker) const;
+    void store(unsigned long long key, int depth, bool isAttacker, std::uint32_t proof, std::uint32_t disproof);
+    static unsigned long long getTableKey(unsigned long long key, int depth, bool isAttacker);
+
+    std::vector<Entry> entries;
+    std::size_t mask = 0;
+    long long nodes = 0;
+    int rootDepth = 0;
+    Move::Move rootMove = Move::Move(false);
+  };
+} // namespace MateSearch
+
+#endif // MATE_SEARCH_HPP
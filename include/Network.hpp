@@ -0,0 +1,119 @@
+#ifndef NETWORK_HPP
+#define NETWORK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Board.hpp"
+#include "BoardScan.hpp"
+#include "MappedFile.hpp"
+
+namespace Network
+{
+  // Sums of the feature weights of a position for both perspectives, white first
+  struct Accumulator
+  {
+    unsigned long long key = 0;
+    bool isValid = false;
+    std::vector<std::int16_t> values[2];
+  };
+
+  // Efficiently updatable network with HalfKP inputs: every piece except the kings, seen from each king
+  class Network
+  {
+  public:
+    Network() = default;
+    ~Network() = default;
+
+    /**
+     * @brief Maps a network file, the feature weights stay in the mapped file and the small layers are copied out
+     *
+     * @return true if the file is a valid network
+     */
+    bool load(const std::string &path);
+    void close();
+    bool isLoaded() const;
+
+    int getHalfDimensions() const;
+
+    /**
+     * @brief Evaluates the position for the side to move, the accumulators of the positions before it are reused
+     * and only the pieces that changed since are added or taken away
+     *
+     * @return int centipawns
+     */
+    int evaluate(const Board::Board &board);
+
+    /**
+     * @brief Index of a piece among the inputs of one perspective, black sees the board mirrored vertically
+     *
+     * @return int below featureCount
+     */
+    static int getFeatureIndex(int perspective, int kingSquare, unsigned long long piece, int square);
+
+    /**
+     * @brief Kernel of the layers, the fastest one the processor running the bot supports unless a test switched it
+     *
+     * @return BoardScan::Kernel
+     */
+    static BoardScan::Kernel getKernel();
+
+    /**
+     * @brief Switches every network to the given kernel
+     *
+     * @return false if the processor does not support it, the kernel in use is kept then
+     */
+    static bool setKernel(BoardScan::Kernel kernel);
+
+    constexpr static char magic[4] = {'C', 'B', 'N', 'N'};
+    constexpr static unsigned char version = 1;
+    constexpr static std::size_t headerSize = 16;
+
+    // 64 king squares times 10 pieces times 64 squares
+    constexpr static int featureCount = 64 * 10 * 64;
+
+    // Hidden layers run on 0 to 127 after every layer, the sums are shifted down by this many bits
+    constexpr static int weightShift = 6;
+    constexpr static int outputScale = 16;
+
+    // Positions further back than this are refreshed from scratch rather than replayed
+    constexpr static int maxReplayedMoves = 8;
+
+  private:
+    void refresh(const Board::Board &board, int perspective, std::int16_t *values) const;
+    void addFeature(std::int16_t *values, int feature) const;
+    void removeFeature(std::int16_t *values, int feature) const;
+    const Accumulator &update(const Board::Board &board);
+
+    MappedFile::MappedFile file;
+    bool isLoadedFlag = false;
+
+    int halfDimensions = 0;
+    int firstHidden = 0;
+    int secondHidden = 0;
+
+    // Inside the mapped file, featureCount rows of halfDimensions weights
+    const std::int16_t *featureWeights = nullptr;
+    std::vector<std::int16_t> featureBiases;
+
+    // The int8 weights are widened to int16 on load so every layer runs on the same multiply-add kernel
+    std::vector<std::int16_t> firstWeights;
+    std::vector<std::int32_t> firstBiases;
+    std::vector<std::int16_t> secondWeights;
+    std::vector<std::int32_t> secondBiases;
+    std::vector<std::int16_t> outputWeights;
+    std::int32_t outputBias = 0;
+
+    // One accumulator per ply of the board history
+    std::vector<Accumulator> accumulators;
+
+    // Layer outputs, kept between evaluations so that evaluating does not allocate
+    std::vector<std::int16_t> inputBuffer;
+    std::vector<std::int16_t> firstOutputBuffer;
+    std::vector<std::int16_t> secondOutputBuffer;
+  };
+} // namespace Network
+
+#endif // NETWORK_HPP
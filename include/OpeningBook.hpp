@@ -0,0 +1,86 @@
+#ifndef OPENING_BOOK_HPP
+#define OPENING_BOOK_HPP
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Board.hpp"
+#include "MappedFile.hpp"
+#include "Move.hpp"
+
+namespace OpeningBook
+{
+  enum class Selection
+  {
+    // Random move, the chance of each move is proportional to its weight
+    WEIGHTED,
+    // Always the move with the highest weight
+    BEST
+  };
+
+  // One 16 byte record of a Polyglot .bin file, all fields are big endian on disk
+  struct BookEntry
+  {
+    std::uint64_t key;
+    std::uint16_t move;
+    std::uint16_t weight;
+    std::uint32_t learn;
+  };
+
+  class OpeningBook
+  {
+  public:
+    OpeningBook() = default;
+    ~OpeningBook() = default;
+
+    /**
+     * @brief Maps a Polyglot book, nothing is read until a position is looked up
+     *
+     * @return true if the file could be mapped and holds whole entries
+     */
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const;
+
+    /**
+     * @brief Binary searches the sorted entries for the position, O(log n) without touching the rest of the file
+     *
+     * @return std::vector<BookEntry> entries of the position, empty when it is not in the book
+     */
+    std::vector<BookEntry> getEntries(std::uint64_t key) const;
+
+    /**
+     * @brief Picks a book move for the position
+     *
+     * @return Move::Move legal move from the book, Move::Move(false) when the book has nothing
+     */
+    Move::Move probe(Board::Board &board, Selection selection = Selection::WEIGHTED);
+
+    /**
+     * @brief Key of the position in the Polyglot layout, 768 piece-square keys, castling, en passant file (only when the capture is possible) and side to move
+     *
+     * @return std::uint64_t
+     */
+    static std::uint64_t getKey(const Board::Board &board);
+
+    /**
+     * @brief Turns a Polyglot move into a legal move of the position, castling is stored as the king taking its own rook
+     *
+     * @return Move::Move, Move::Move(false) if the move is not legal here
+     */
+    static Move::Move decodeMove(Board::Board &board, std::uint16_t move);
+
+    constexpr static std::size_t entrySize = 16;
+
+  private:
+    BookEntry readEntry(std::size_t index) const;
+
+    MappedFile::MappedFile file;
+    std::size_t entryCount = 0;
+    std::mt19937 generator{std::random_device{}()};
+  };
+} // namespace OpeningBook
+
+#endif // OPENING_BOOK_HPP
@@ -0,0 +1,80 @@
+#ifndef PAWN_STRUCTURE_HPP
+#define PAWN_STRUCTURE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Board.hpp"
+#include "Score.hpp"
+
+namespace PawnStructure
+{
+  // Everything the evaluation needs to know about the pawns, index 0 is white and 1 is black, bit 0 = a1 like the board
+  struct Entry
+  {
+    unsigned long long key = 0;
+    bool isValid = false;
+
+    std::uint64_t pawns[2] = {0, 0};
+    std::uint64_t attacks[2] = {0, 0};
+    // Every square the pawns could attack while they advance, the enemy pieces there can never be chased away by a pawn
+    std::uint64_t attackSpans[2] = {0, 0};
+    std::uint64_t passedPawns[2] = {0, 0};
+
+    // Passed, isolated, doubled and backward pawns in centipawns
+    Score::Score score[2] = {0, 0};
+    // Sum of the ranks the pawns have advanced, counted from their own side
+    int advancement[2] = {0, 0};
+  };
+
+  class PawnStructure
+  {
+  public:
+    PawnStructure(std::size_t sizeInKilobytes = defaultSizeInKilobytes);
+    ~PawnStructure() = default;
+
+    void resize(std::size_t sizeInKilobytes);
+    void clear();
+
+    /**
+     * @brief Pawn structure of the position, evaluated only when its pawn key is not in the table yet
+     *
+     * @return const Entry& valid until the next probe
+     */
+    const Entry &probe(const Board::Board &board);
+
+    /**
+     * @brief Evaluates the pawn structure of the position from scratch
+     *
+     * @return Entry
+     */
+    static Entry evaluate(const Board::Board &board);
+
+    /**
+     * @brief Evaluates the pawn structure of two pawn bitboards, the entry is left without a key
+     *
+     * @return Entry
+     */
+    static Entry evaluate(std::uint64_t whitePawns, std::uint64_t blackPawns);
+
+    long long getProbes() const;
+    long long getHits() const;
+    void resetStatistics();
+
+    constexpr static std::size_t defaultSizeInKilobytes = 1024;
+
+    constexpr static Score::Score passedPawnBonus[8] = {0, 5, 10, 20, 35, 60, 100, 0};
+    constexpr static Score::Score isolatedPawnPenalty = 15;
+    constexpr static Score::Score doubledPawnPenalty = 10;
+    constexpr static Score::Score backwardPawnPenalty = 10;
+
+  private:
+    std::vector<Entry> entries;
+    std::size_t mask = 0;
+    long long probes = 0;
+    long long hits = 0;
+  };
+} // namespace PawnStructure
+
+#endif // PAWN_STRUCTURE_HPP
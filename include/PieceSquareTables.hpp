@@ -0,0 +1,137 @@
+#ifndef PIECE_SQUARE_TABLES_HPP
+#define PIECE_SQUARE_TABLES_HPP
+
+namespace PieceSquareTables
+{
+  // Pawn, knight, bishop, rook, queen, king in centipawns, the king is never traded so it is worth nothing
+  constexpr int middlegameValues[6] = {100, 300, 300, 500, 900, 0};
+  constexpr int endgameValues[6] = {110, 290, 310, 520, 940, 0};
+
+  // Knights and bishops count one, rooks two and queens four, all of them on the board make 24, no pieces at all is the endgame
+  constexpr int phaseWeights[6] = {0, 1, 1, 2, 4, 0};
+  constexpr int maxPhase = 24;
+
+  // Blends the middlegame and endgame sums by the phase, extra pieces from promotions count as a full middlegame
+  inline int taper(int middlegame, int endgame, int phase)
+  {
+    const int middlegamePhase = phase < maxPhase ? phase : maxPhase;
+    return (middlegame * middlegamePhase + endgame * (maxPhase - middlegamePhase)) / maxPhase;
+  }
+
+  // Tables are seen from white, a1 first, black looks its square up mirrored vertically
+  constexpr int middlegameTables[6][64] = {
+      // Pawn
+      {0, 0, 0, 0, 0, 0, 0, 0,
+       5, 10, 10, -20, -20, 10, 10, 5,
+       5, -5, -10, 0, 0, -10, -5, 5,
+       0, 0, 0, 20, 20, 0, 0, 0,
+       5, 5, 10, 25, 25, 10, 5, 5,
+       10, 10, 20, 30, 30, 20, 10, 10,
+       50, 50, 50, 50, 50, 50, 50, 50,
+       0, 0, 0, 0, 0, 0, 0, 0},
+      // Knight
+      {-50, -40, -30, -30, -30, -30, -40, -50,
+       -40, -20, 0, 5, 5, 0, -20, -40,
+       -30, 5, 10, 15, 15, 10, 5, -30,
+       -30, 0, 15, 20, 20, 15, 0, -30,
+       -30, 5, 15, 20, 20, 15, 5, -30,
+       -30, 0, 10, 15, 15, 10, 0, -30,
+       -40, -20, 0, 0, 0, 0, -20, -40,
+       -50, -40, -30, -30, -30, -30, -40, -50},
+      // Bishop
+      {-20, -10, -10, -10, -10, -10, -10, -20,
+       -10, 5, 0, 0, 0, 0, 5, -10,
+       -10, 10, 10, 10, 10, 10, 10, -10,
+       -10, 0, 10, 10, 10, 10, 0, -10,
+       -10, 5, 5, 10, 10, 5, 5, -10,
+       -10, 0, 5, 10, 10, 5, 0, -10,
+       -10, 0, 0, 0, 0, 0, 0, -10,
+       -20, -10, -10, -10, -10, -10, -10, -20},
+      // Rook
+      {0, 0, 0, 5, 5, 0, 0, 0,
+       -5, 0, 0, 0, 0, 0, 0, -5,
+       -5, 0, 0, 0, 0, 0, 0, -5,
+       -5, 0, 0, 0, 0, 0, 0, -5,
+       -5, 0, 0, 0, 0, 0, 0, -5,
+       -5, 0, 0, 0, 0, 0, 0, -5,
+       5, 10, 10, 10, 10, 10, 10, 5,
+       0, 0, 0, 0, 0, 0, 0, 0},
+      // Queen
+      {-20, -10, -10, -5, -5, -10, -10, -20,
+       -10, 0, 5, 0, 0, 0, 0, -10,
+       -10, 5, 5, 5, 5, 5, 0, -10,
+       0, 0, 5, 5, 5, 5, 0, -5,
+       -5, 0, 5, 5, 5, 5, 0, -5,
+       -10, 0, 5, 5, 5, 5, 0, -10,
+       -10, 0, 0, 0, 0, 0, 0, -10,
+       -20, -10, -10, -5, -5, -10, -10, -20},
+      // King, tucked away behind its pawns
+      {20, 30, 10, 0, 0, 10, 30, 20,
+       20, 20, 0, 0, 0, 0, 20, 20,
+       -10, -20, -20, -20, -20, -20, -20, -10,
+       -20, -30, -30, -40, -40, -30, -30, -20,
+       -30, -40, -40, -50, -50, -40, -40, -30,
+       -30, -40, -40, -50, -50, -40, -40, -30,
+       -30, -40, -40, -50, -50, -40, -40, -30,
+       -30, -40, -40, -50, -50, -40, -40, -30},
+  };
+
+  constexpr int endgameTables[6][64] = {
+      // Pawn, the closer to promotion the better
+      {0, 0, 0, 0, 0, 0, 0, 0,
+       5, 5, 5, 5, 5, 5, 5, 5,
+       10, 10, 10, 10, 10, 10, 10, 10,
+       20, 20, 20, 20, 20, 20, 20, 20,
+       35, 35, 35, 35, 35, 35, 35, 35,
+       60, 60, 60, 60, 60, 60, 60, 60,
+       90, 90, 90, 90, 90, 90, 90, 90,
+       0, 0, 0, 0, 0, 0, 0, 0},
+      // Knight
+      {-50, -40, -30, -30, -30, -30, -40, -50,
+       -40, -20, 0, 0, 0, 0, -20, -40,
+       -30, 0, 10, 15, 15, 10, 0, -30,
+       -30, 5, 15, 20, 20, 15, 5, -30,
+       -30, 0, 15, 20, 20, 15, 0, -30,
+       -30, 5, 10, 15, 15, 10, 5, -30,
+       -40, -20, 0, 5, 5, 0, -20, -40,
+       -50, -40, -30, -30, -30, -30, -40, -50},
+      // Bishop
+      {-20, -10, -10, -10, -10, -10, -10, -20,
+       -10, 0, 0, 0, 0, 0, 0, -10,
+       -10, 0, 5, 10, 10, 5, 0, -10,
+       -10, 5, 10, 10, 10, 10, 5, -10,
+       -10, 5, 10, 10, 10, 10, 5, -10,
+       -10, 0, 5, 10, 10, 5, 0, -10,
+       -10, 0, 0, 0, 0, 0, 0, -10,
+       -20, -10, -10, -10, -10, -10, -10, -20},
+      // Rook
+      {0, 0, 0, 0, 0, 0, 0, 0,
+       0, 0, 0, 0, 0, 0, 0, 0,
+       0, 0, 0, 0, 0, 0, 0, 0,
+       0, 0, 0, 0, 0, 0, 0, 0,
+       0, 0, 0, 0, 0, 0, 0, 0,
+       0, 0, 0, 0, 0, 0, 0, 0,
+       10, 10, 10, 10, 10, 10, 10, 10,
+       0, 0, 0, 0, 0, 0, 0, 0},
+      // Queen
+      {-20, -10, -10, -5, -5, -10, -10, -20,
+       -10, 0, 0, 0, 0, 0, 0, -10,
+       -10, 0, 5, 5, 5, 5, 0, -10,
+       -5, 0, 5, 10, 10, 5, 0, -5,
+       -5, 0, 5, 10, 10, 5, 0, -5,
+       -10, 0, 5, 5, 5, 5, 0, -10,
+       -10, 0, 0, 0, 0, 0, 0, -10,
+       -20, -10, -10, -5, -5, -10, -10, -20},
+      // King, walks to the centre once the queens are gone
+      {-50, -30, -30, -30, -30, -30, -30, -50,
+       -30, -30, 0, 0, 0, 0, -30, -30,
+       -30, -10, 20, 30, 30, 20, -10, -30,
+       -30, -10, 30, 40, 40, 30, -10, -30,
+       -30, -10, 30, 40, 40, 30, -10, -30,
+       -30, -10, 20, 30, 30, 20, -10, -30,
+       -30, -20, -10, 0, 0, -10, -20, -30,
+       -50, -40, -30, -20, -20, -30, -40, -50},
+  };
+} // namespace PieceSquareTables
+
+#endif // PIECE_SQUARE_TABLES_HPP
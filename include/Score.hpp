@@ -0,0 +1,90 @@
+#ifndef SCORE_HPP
+#define SCORE_HPP
+
+#include <cstdint>
+#include <limits>
+
+namespace Score
+{
+  // Centipawns from one side's point of view, integers compare fast and add up the same on every build
+  using Score = std::int32_t;
+
+  constexpr Score draw = 0;
+
+  // A mate in n plies from the root scores mate - n, so the shortest mate is the best score
+  constexpr Score mate = 32000;
+  // Every score beyond the bound is a mate, the distances from the tablebases fit in between
+  constexpr Score mateBound = mate - 1000;
+  // A win the Syzygy tables know without its distance, below every mate so a mate the search sees is still preferred
+  constexpr Score tablebaseWin = mateBound - 1000;
+  // Above every score the search returns and still within 16 bits
+  constexpr Score infinite = 32500;
+
+  constexpr Score mateIn(int ply)
+  {
+    return mate - ply;
+  }
+
+  constexpr Score matedIn(int ply)
+  {
+    return -mate + ply;
+  }
+
+  constexpr bool isMate(Score score)
+  {
+    return score >= mateBound || score <= -mateBound;
+  }
+
+  // Halves are rounded away from zero, so a score and its negation round to negated centipawns
+  constexpr Score fromPawns(double pawns)
+  {
+    return static_cast<Score>(pawns >= 0 ? pawns * 100 + 0.5 : pawns * 100 - 0.5);
+  }
+
+  constexpr double toPawns(Score score)
+  {
+    return score / 100.0;
+  }
+
+  // Term weights in fixed point, weightOne is a weight of 1.0
+  using Weight = std::int32_t;
+  constexpr int weightShift = 16;
+  constexpr Weight weightOne = 1 << weightShift;
+
+  constexpr Weight toWeight(double value)
+  {
+    return static_cast<Weight>(value >= 0 ? value * weightOne + 0.5 : value * weightOne - 0.5);
+  }
+
+  /**
+   * @brief A term in centipawns times a weight, rounded to the nearest centipawn the same way for both signs so a
+   * position and its mirror image get negated scores
+   *
+   * @return Score
+   */
+  constexpr Score applyWeight(Score term, Weight weight)
+  {
+    const std::int64_t product = static_cast<std::int64_t>(term) * weight;
+    const std::int64_t half = weightOne / 2;
+    return static_cast<Score>(product >= 0 ? (product + half) >> weightShift : -((half - product) >> weightShift));
+  }
+
+  /**
+   * @brief Squeezes a score into the 16 bits of a transposition table entry, every score of the search fits as is
+   *
+   * @return std::int16_t
+   */
+  constexpr std::int16_t pack(Score score)
+  {
+    constexpr Score lowest = std::numeric_limits<std::int16_t>::min();
+    constexpr Score highest = std::numeric_limits<std::int16_t>::max();
+    return static_cast<std::int16_t>(score < lowest ? lowest : score > highest ? highest : score);
+  }
+
+  constexpr Score unpack(std::int16_t packed)
+  {
+    return packed;
+  }
+} // namespace Score
+
+#endif // SCORE_HPP
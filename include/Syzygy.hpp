@@ -0,0 +1,179 @@
+#ifndef SYZYGY_HPP
+#define SYZYGY_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Board.hpp"
+#include "MappedFile.hpp"
+#include "Tablebase.hpp"
+
+namespace Syzygy
+{
+  // Result for the side to move. A cursed win is a win the fifty move rule turns into a draw, a blessed loss the same
+  // from the other side
+  enum class Wdl
+  {
+    LOSS = -2,
+    BLESSED_LOSS = -1,
+    DRAW = 0,
+    CURSED_WIN = 1,
+    WIN = 2
+  };
+
+  // Probes the Syzygy tables: .rtbw files hold win, draw or loss, .rtbz files the half moves to the next capture or pawn
+  // move (DTZ). Both are compressed and only mapped by the first probe of their material
+  class Syzygy
+  {
+  public:
+    Syzygy() = default;
+    ~Syzygy() = default;
+
+    /**
+     * @brief Looks for tables in the directory, the name of a file is its material with the stronger side first, e.g. KRPvKR
+     *
+     * @return true if at least one WDL table was found
+     */
+    bool setPath(const std::string &directory);
+    void close();
+
+    bool isAvailable() const;
+    int getMaxPieces() const;
+
+    /**
+     * @brief Win, draw or loss with a fresh fifty move count. The tables may hold any value where a capture decides the
+     * game, so the captures are played and probed as well. Positions with castling rights are not answered
+     *
+     * @return true if every table needed was found
+     */
+    bool probeWdl(Board::Board &board, Wdl &result);
+
+    /**
+     * @brief Half moves to the next capture or pawn move that keeps the result, or to the mate. Positive when the side to
+     * move wins, negative when it loses, 0 for a draw. Cursed wins and blessed losses come out over 100
+     *
+     * @return true if every table needed was found
+     */
+    bool probeDtz(Board::Board &board, int &result);
+
+    /**
+     * @brief Ranks every move by its DTZ and the fifty move counter of the board and keeps the best ranked ones, a win
+     * the fifty move rule would take away ranks below a real one
+     *
+     * @return true if every move could be probed, moves is then ordered from the shortest DTZ, a loss from the longest
+     */
+    bool probeRoot(Board::Board &board, std::vector<Move::Move> &moves, Wdl &result);
+
+    /**
+     * @brief Where the table of the material stores the position: the side to move, the file of the leading pawn and the
+     * index. The table is mapped if it was not yet
+     *
+     * @return false without a table, or for a DTZ table that only stores the other side to move
+     */
+    bool getIndex(const std::vector<Tablebase::TablePiece> &pieces, bool isWhiteToMove, bool isDtz, int &side, int &file,
+                  std::uint64_t &index);
+
+    constexpr static char wdlExtension[] = ".rtbw";
+    constexpr static char dtzExtension[] = ".rtbz";
+    constexpr static std::uint8_t wdlMagic[] = {0x71, 0xe8, 0x23, 0x5d};
+    constexpr static std::uint8_t dtzMagic[] = {0xd7, 0x66, 0x0c, 0xa5};
+    constexpr static int maxPieces = 7;
+
+    // Flags of each side of a table
+    constexpr static std::uint8_t sideToMoveFlag = 1;
+    constexpr static std::uint8_t mappedFlag = 2;
+    constexpr static std::uint8_t winPliesFlag = 4;
+    constexpr static std::uint8_t lossPliesFlag = 8;
+    constexpr static std::uint8_t wideFlag = 16;
+    constexpr static std::uint8_t singleValueFlag = 128;
+
+  private:
+    enum class ProbeState
+    {
+      FAIL,
+      OK,
+      // A DTZ table stores one side to move only, the other one has to be probed one move deeper
+      CHANGE_SIDE,
+      // The best move captures or moves a pawn, the DTZ tables hold no value for such positions
+      ZEROING_BEST_MOVE
+    };
+
+    // One side of a table for one file of the leading pawn: how its pieces are grouped into the index and where the
+    // compressed values are
+    struct PairsData
+    {
+      std::uint8_t flags = 0;
+      std::size_t blockSize = 0;
+      std::size_t span = 0;
+      std::size_t blockCount = 0;
+      int maxSymbolLength = 0;
+      int minSymbolLength = 0;
+      const unsigned char *lowestSymbols = nullptr;
+      const unsigned char *tree = nullptr;
+      const unsigned char *sparseIndex = nullptr;
+      std::size_t sparseIndexSize = 0;
+      const unsigned char *blockLengths = nullptr;
+      std::size_t blockLengthCount = 0;
+      const unsigned char *data = nullptr;
+      std::vector<std::uint64_t> base;
+      std::vector<std::uint8_t> symbolLengths;
+
+      // File codes of the pieces in the order of the index, pieces of one group share a factor of the index
+      int pieces[maxPieces] = {0};
+      int groupLengths[maxPieces + 1] = {0};
+      std::uint64_t groupFactors[maxPieces + 1] = {0};
+
+      // DTZ tables map the stored values through a table for each result
+      std::uint16_t mapIndex[4] = {0};
+    };
+
+    struct Table
+    {
+      std::string path;
+      MappedFile::MappedFile file;
+      bool isLoaded = false;
+      bool isBroken = false;
+
+      // The material of the name, the first side of it plays white
+      int pieceCount = 0;
+      bool hasPawns = false;
+      bool hasUniquePieces = false;
+      bool isSymmetric = false;
+
+      // Pawns of the side whose pawns lead the index and of the other side
+      int pawnCount[2] = {0, 0};
+
+      // [side to move][file of the leading pawn]
+      PairsData sides[2][4];
+      const unsigned char *map = nullptr;
+    };
+
+    Table *getTable(const std::string &signature, bool isDtz, bool &isSwapped);
+    bool load(Table &table, bool isDtz);
+
+    static bool setGroups(const Table &table, PairsData &pairs, const int order[2], int file);
+    static bool setSizes(PairsData &pairs, const unsigned char *data, std::size_t size, std::size_t &offset);
+    static int decompress(const PairsData &pairs, std::uint64_t index, const unsigned char *end);
+    static int mapScore(const Table &table, int file, int value, int wdl);
+
+    ProbeState findIndex(const std::vector<Tablebase::TablePiece> &pieces, bool isWhiteToMove, bool isDtz, Table *&table,
+                         int &side, int &file, std::uint64_t &index);
+    ProbeState probeTable(const std::vector<Tablebase::TablePiece> &pieces, bool isWhiteToMove, bool isDtz, int wdl, int &value);
+
+    /**
+     * @brief Result of the position with its captures played out, with isZeroingChecked the pawn moves as well since
+     * the DTZ tables do not store positions whose best move is one of them
+     *
+     * @return int result from -2 for a loss to 2 for a win
+     */
+    int search(Board::Board &board, bool isZeroingChecked, ProbeState &state);
+
+    std::unordered_map<std::string, Table> wdlTables;
+    std::unordered_map<std::string, Table> dtzTables;
+    int largestTable = 0;
+  };
+} // namespace Syzygy
+
+#endif // SYZYGY_HPP
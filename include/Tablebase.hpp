@@ -0,0 +1,134 @@
+#ifndef TABLEBASE_HPP
+#define TABLEBASE_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Board.hpp"
+#include "MappedFile.hpp"
+
+namespace Tablebase
+{
+  enum class Wdl
+  {
+    LOSS = -1,
+    DRAW = 0,
+    WIN = 1
+  };
+
+  // Result for the side to move, the distance counts half moves until mate with best play from both sides
+  struct ProbeResult
+  {
+    Wdl wdl = Wdl::DRAW;
+    int distance = 0;
+  };
+
+  // A position brought into the layout of the tables, the stronger side plays white with its king on files a to d
+  struct TablePosition
+  {
+    // Pieces of each side from the king down, e.g. KQvK or KRPvKR
+    std::string signature;
+
+    // Squares in the order of the signature
+    std::vector<int> squares;
+    bool isStrongSideToMove = true;
+  };
+
+  // A piece as the tables see it, on the square of the real board
+  struct TablePiece
+  {
+    // One of KQRBNP
+    char letter;
+    bool isWhite;
+    int square;
+  };
+
+  class Tablebase
+  {
+  public:
+    Tablebase() = default;
+    ~Tablebase() = default;
+
+    /**
+     * @brief Looks for tables in the directory, a table is only mapped by the first probe of its material
+     *
+     * @return true if at least one table was found
+     */
+    bool setPath(const std::string &directory);
+    void close();
+
+    bool isAvailable() const;
+    int getMaxPieces() const;
+
+    /**
+     * @brief Looks the position up, positions with castling rights, a possible en passant capture or a result
+     * the fifty move rule could take away are not answered
+     *
+     * @return true if the result is exact
+     */
+    bool probe(const Board::Board &board, ProbeResult &result);
+
+    /**
+     * @brief Probes the positions after every legal move and keeps only the moves that hold the best result
+     *
+     * @return true if every move could be probed, moves is then ordered from the fastest win or the slowest loss
+     */
+    bool probeRoot(Board::Board &board, std::vector<Move::Move> &moves, ProbeResult &result);
+
+    /**
+     * @brief Builds the signature and the squares of the position as the table of its material stores it
+     *
+     * @return false for positions with too many pieces for any table
+     */
+    static bool getTablePosition(const Board::Board &board, TablePosition &position);
+    /**
+     * @brief The same from a list of pieces, the generator builds the positions after captures and promotions this way
+     * without a board
+     *
+     * @return false without exactly one king on each side
+     */
+    static bool getTablePosition(const std::vector<TablePiece> &pieces, bool isWhiteToMove, TablePosition &position);
+
+    /**
+     * @brief Index of the entry of the position in its table
+     *
+     * @return std::size_t
+     */
+    static std::size_t getIndex(const TablePosition &position);
+    static std::size_t getEntryCount(int pieceCount);
+
+    static std::int16_t encodeValue(const ProbeResult &result);
+    static ProbeResult decodeValue(std::int16_t value);
+
+    // File layout: magic, version, piece count, two reserved bytes and one little endian 16 bit value per position
+    constexpr static char magic[] = "CBTB";
+    constexpr static std::uint8_t version = 1;
+    constexpr static std::size_t headerSize = 8;
+    constexpr static char extension[] = ".cbtb";
+
+    // Unreachable positions, e.g. the side not to move in check
+    constexpr static std::int16_t illegalValue = INT16_MIN;
+    constexpr static int maxPieces = 4;
+
+    // A result is only exact if the mate comes before fifty moves by each side are played
+    constexpr static int fiftyMoveLimit = 100;
+
+  private:
+    struct Table
+    {
+      std::string path;
+      MappedFile::MappedFile file;
+      bool isLoaded = false;
+      bool isBroken = false;
+    };
+
+    const Table *getTable(const std::string &signature);
+
+    std::unordered_map<std::string, Table> tables;
+    int largestTable = 0;
+  };
+} // namespace Tablebase
+
+#endif // TABLEBASE_HPP
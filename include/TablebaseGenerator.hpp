@@ -0,0 +1,89 @@
+#ifndef TABLEBASE_GENERATOR_HPP
+#define TABLEBASE_GENERATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Tablebase.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace TablebaseGenerator
+{
+  struct GeneratorOptions
+  {
+    // Tables are written here and the tables of captures and promotions are read back from here
+    std::string directory = "tablebases";
+
+    std::size_t threadCount = WorkStealingPool::WorkStealingPool::getDefaultThreadCount();
+
+    // Tables already in the directory are kept unless this is set
+    bool overwrite = false;
+
+    // Every finished table prints a line here when set
+    std::ostream *progressOutput = nullptr;
+  };
+
+  // Builds distance to mate tables in the format Tablebase probes, by retrograde analysis: mates are found first, then
+  // every pass takes the positions decided one half move earlier back by one move until nothing changes. Captures and
+  // promotions lead into smaller tables, those are generated first and memory mapped while the table is built
+  class TablebaseGenerator
+  {
+  public:
+    TablebaseGenerator(const GeneratorOptions &options = GeneratorOptions());
+    ~TablebaseGenerator() = default;
+
+    /**
+     * @brief Writes the table of the signature, e.g. KRvKP, with the tables it depends on before it
+     *
+     * @return std::string path of the table
+     */
+    std::string generate(const std::string &signature);
+
+    /**
+     * @brief Writes every table with three up to maxPieces pieces
+     *
+     * @return std::size_t number of tables generated, kept tables are not counted
+     */
+    std::size_t generateAll(int maxPieces = Tablebase::Tablebase::maxPieces);
+
+    /**
+     * @brief The values of every position of the table, in the order of Tablebase::getIndex, the tables its captures
+     * and promotions lead to have to be in the directory already
+     *
+     * @return std::vector<std::int16_t>
+     */
+    std::vector<std::int16_t> generateTable(const std::string &signature);
+
+    /**
+     * @brief Every signature with the number of pieces, the ones without pawns first so promotions find their tables
+     *
+     * @return std::vector<std::string>
+     */
+    static std::vector<std::string> getSignatures(int pieceCount);
+
+    /**
+     * @brief Signatures a capture or a promotion leads to, the bare kings left out
+     *
+     * @return std::vector<std::string>
+     */
+    static std::vector<std::string> getChildSignatures(const std::string &signature);
+
+    static void writeTable(const std::string &path, int pieceCount, const std::vector<std::int16_t> &values);
+
+  private:
+    std::string getPath(const std::string &signature) const;
+
+    GeneratorOptions options;
+    WorkStealingPool::WorkStealingPool pool;
+  };
+
+  /**
+   * @brief Command line of the generator, a directory followed by --pieces, --threads, --overwrite or single signatures
+   */
+  void run(const std::vector<std::string> &arguments);
+} // namespace TablebaseGenerator
+
+#endif // TABLEBASE_GENERATOR_HPP
@@ -0,0 +1,113 @@
+#ifndef TEXEL_TUNER_HPP
+#define TEXEL_TUNER_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "BatchEvaluation.hpp"
+#include "Brain.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace TexelTuner
+{
+  struct TexelOptions
+  {
+    int epochs = 200;
+
+    // Adam steps, the weights are around 1 so a hundredth moves them noticeably within a few dozen epochs
+    double learningRate = 0.01;
+
+    // Positions per gradient task, small enough that every thread gets many of them
+    std::size_t chunkSize = 16384;
+
+    std::size_t threadCount = WorkStealingPool::WorkStealingPool::getDefaultThreadCount();
+
+    // Every epoch prints its error here when set
+    std::ostream *progressOutput = nullptr;
+  };
+
+  // Fits the neurons to game results: the evaluation is a weighted sum of its terms, so every term is evaluated once
+  // per position when it is loaded and an epoch only multiplies those numbers with the weights
+  class TexelTuner
+  {
+  public:
+    TexelTuner(const TexelOptions &options = TexelOptions());
+    ~TexelTuner() = default;
+
+    /**
+     * @brief Reads an EPD file, the result is taken from a c9 "1-0" style opcode or a [1.0] style label, lines without
+     * a result or with a broken position are skipped
+     *
+     * @return std::size_t number of positions added
+     */
+    std::size_t loadEpd(const std::string &path);
+
+    /**
+     * @brief Parses one EPD line
+     *
+     * @return true if the line has a position and a result, result is 1 for a white win, 0.5 for a draw and 0 for a loss
+     */
+    static bool parseEpdLine(const std::string &line, BatchEvaluation::PackedPosition &position, double &result);
+
+    /**
+     * @brief Evaluates every term of the positions and keeps only those numbers and the results
+     */
+    void addPositions(const std::vector<BatchEvaluation::PackedPosition> &positions, const std::vector<double> &results);
+
+    std::size_t getPositionCount() const;
+
+    /**
+     * @brief Value of one term for a position from white's point of view, what evaluatePosition multiplies with the
+     * term's weight
+     */
+    double getFeature(std::size_t position, Brain::EvaluationTypes type) const;
+
+    /**
+     * @brief Mean squared difference between the results and the win probability the weights predict
+     */
+    double computeError(const std::vector<Brain::EvaluationNode> &neurons, double scaling) const;
+
+    /**
+     * @brief Error and its derivative by every weight, summed over the chunks on every thread
+     *
+     * @return std::vector<double> one derivative per node, in the order of neurons
+     */
+    std::vector<double> computeGradient(const std::vector<Brain::EvaluationNode> &neurons, double scaling, double &error) const;
+
+    /**
+     * @brief Scaling of the sigmoid that fits the current weights best, found once before tuning so the weights do
+     * not all drift together to make up for a wrong one
+     */
+    double findScaling(const std::vector<Brain::EvaluationNode> &neurons) const;
+
+    /**
+     * @brief Runs options.epochs steps of Adam from the given weights
+     *
+     * @return std::vector<Brain::EvaluationNode> the tuned weights, same terms in the same order
+     */
+    std::vector<Brain::EvaluationNode> tune(const std::vector<Brain::EvaluationNode> &neurons, double scaling);
+
+    /**
+     * @brief Win probability for a score in pawns from white's point of view
+     */
+    static double getWinProbability(double score, double scaling);
+
+    // Every term of the evaluation, in the order the features of a position are stored
+    constexpr static int termCount = 5;
+
+  private:
+    static int getTermIndex(Brain::EvaluationTypes type);
+
+    TexelOptions options;
+    mutable WorkStealingPool::WorkStealingPool pool;
+    BatchEvaluation::BatchEvaluator batchEvaluator;
+
+    // termCount features per position one after another, floats keep millions of positions in a few hundred megabytes
+    std::vector<float> features;
+    std::vector<float> results;
+  };
+} // namespace TexelTuner
+
+#endif // TEXEL_TUNER_HPP
@@ -0,0 +1,120 @@
+#ifndef TIME_MANAGER_HPP
+#define TIME_MANAGER_HPP
+
+#include <atomic>
+#include <chrono>
+
+namespace TimeManager
+{
+  // All times are in milliseconds, zero means "not given"
+  struct TimeControl
+  {
+    long long remainingTime = 0;
+    long long increment = 0;
+    int movesToGo = 0;
+    long long moveTime = 0;
+
+    // Searches stop after this many nodes, unlike a clock it gives the same moves on any machine and under any load
+    long long nodes = 0;
+
+    bool isTimed() const { return remainingTime > 0 || moveTime > 0; }
+  };
+
+  class TimeManager
+  {
+  public:
+    TimeManager() = default;
+    ~TimeManager() = default;
+
+    /**
+     * @brief Starts the clock and computes the deadlines for the move about to be searched
+     */
+    void start(const TimeControl &timeControl);
+
+    /**
+     * @brief Starts a search on the opponent's time, it runs until ponderHit or stop
+     */
+    void startPondering();
+
+    /**
+     * @brief The opponent played the expected move, the pondering search goes on with deadlines and the node budget
+     * counted from now. Without either it goes on up to maxDepth, an iteration past it is stopped
+     */
+    void ponderHit(const TimeControl &timeControl, int maxDepth);
+
+    /**
+     * @brief Stops every search that is running, used when the search has to end right now
+     */
+    void stop();
+
+    /**
+     * @brief Polls the clock once every pollInterval nodes, true when the hard deadline has passed
+     */
+    bool shouldStop(long long nodes);
+
+    /**
+     * @brief Called before every iteration of the search with its depth
+     */
+    void startIteration(int depth);
+
+    /**
+     * @brief Called after every completed iteration, a changing best move or a dropping score buys more time
+     */
+    void updateIteration(bool hasBestMoveChanged, double scoreDrop);
+
+    /**
+     * @brief True when there is enough of the soft budget left for another iteration to finish
+     */
+    bool canStartIteration() const;
+
+    long long getElapsedTime() const;
+    long long getSoftDeadline() const;
+    long long getHardDeadline() const;
+    bool isActive() const;
+    bool isPondering() const;
+
+    // Nodes between two looks at the clock, the search runs ~10 nodes per millisecond so this is well under the move overhead
+    constexpr static long long pollInterval = 256;
+
+  private:
+    std::chrono::steady_clock::time_point startTime;
+    long long softDeadline = 0;
+    long long hardDeadline = 0;
+    long long maxNodes = 0;
+    long long nextPoll = 0;
+
+    // Depth limit of an untimed ponder hit, 0 for none, and the iteration the searching thread is on
+    int maxDepth = 0;
+    int iterationDepth = 0;
+
+    // Nodes searched when the ponder hit came, -1 until the searching thread has seen it
+    long long hitNodes = 0;
+    double softScale = 1.0;
+    int bestMoveStability = 0;
+    bool isTimed = false;
+
+    // Written by the thread waiting for the opponent, read by the searching one. ponderHit writes the clock and the
+    // limits above before it clears isPonderSearch, the searching thread only reads them once it has seen it cleared
+    std::atomic<bool> isStopped{false};
+    std::atomic<bool> isPonderSearch{false};
+
+    void computeDeadlines(const TimeControl &timeControl);
+
+    // Time lost between the decision and the move reaching the clock
+    constexpr static long long moveOverhead = 50;
+    // Games without moves-to-go are assumed to last this many more moves
+    constexpr static int defaultMovesToGo = 30;
+    constexpr static int maxMovesToGo = 50;
+    constexpr static double maxOptimumMultiplier = 3.0;
+    constexpr static double maxRemainingShare = 0.5;
+
+    constexpr static double unstableBestMoveScale = 1.5;
+    constexpr static double stableBestMoveScale = 0.6;
+    constexpr static int stableIterations = 3;
+    constexpr static double scoreDropScale = 1.3;
+    constexpr static double scoreDropMargin = 0.3;
+    constexpr static double maxSoftScale = 2.5;
+  };
+} // namespace TimeManager
+
+#endif // TIME_MANAGER_HPP
@@ -0,0 +1,71 @@
+#ifndef TRANSPOSITION_TABLE_HPP
+#define TRANSPOSITION_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Move.hpp"
+#include "Score.hpp"
+
+namespace TranspositionTable
+{
+  enum class Bound : std::uint8_t
+  {
+    NONE,
+    EXACT,
+    LOWER,
+    UPPER
+  };
+
+  struct Entry
+  {
+    unsigned long long key = 0;
+    // Score::pack of the score, with the small depth the entry fits in 16 bytes
+    std::int16_t score = 0;
+    std::int8_t depth = -1;
+    Bound bound = Bound::NONE;
+    // Only the squares of the best move are kept, Board::getValidMove turns them back into a move
+    std::int8_t from = -1;
+    std::int8_t to = -1;
+    std::uint8_t promotionTo = Move::PieceType::NONE;
+    std::uint8_t generation = 0;
+  };
+
+  class TranspositionTable
+  {
+  public:
+    TranspositionTable(std::size_t sizeInMegabytes = defaultSizeInMegabytes);
+    ~TranspositionTable() = default;
+
+    /**
+     * @brief Rounds the table down to a power of two entries that fit in the given size, clears it
+     */
+    void resize(std::size_t sizeInMegabytes);
+    void clear();
+
+    /**
+     * @brief Marks the start of a new search, entries from older searches are the first to be replaced
+     */
+    void newSearch();
+
+    bool probe(unsigned long long key, Entry &entry) const;
+    void store(unsigned long long key, Score::Score score, int depth, Bound bound, const Move::Move &bestMove);
+
+    std::size_t getSize() const;
+
+    /**
+     * @brief Permille of the table filled by the current search, estimated from the first thousand entries
+     */
+    int getHashfull() const;
+
+    constexpr static std::size_t defaultSizeInMegabytes = 16;
+
+  private:
+    std::vector<Entry> entries;
+    std::size_t mask = 0;
+    std::uint8_t generation = 0;
+  };
+} // namespace TranspositionTable
+
+#endif // TRANSPOSITION_TABLE_HPP
@@ -0,0 +1,127 @@
+#ifndef TUNER_HPP
+#define TUNER_HPP
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Brain.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace Tuner
+{
+  enum class GameResult
+  {
+    WHITE_WINS,
+    BLACK_WINS,
+    DRAW
+  };
+
+  struct TunerOptions
+  {
+    int populationSize = 16;
+    int generations = 100;
+
+    // The best ones are carried over unchanged, every other place is a child of two of the best half
+    int eliteCount = 4;
+
+    // Every weight of a child moves by a normal step of this size times the weight, at least by the absolute step
+    double mutationScale = 0.15;
+    double minimumMutation = 0.05;
+
+    // Each individual plays every opening with both colours against the weights it has to beat
+    int openingCount = 4;
+    long long nodesPerMove = 2000;
+    int maxPlies = 200;
+
+    std::size_t threadCount = WorkStealingPool::WorkStealingPool::getDefaultThreadCount();
+    unsigned int seed = 1;
+
+    // Rewritten after every generation, a run started again with the same file picks up where it stopped
+    std::string checkpointPath = "tuner_checkpoint.txt";
+
+    // The best weights so far in the neurons.txt format, neurons.txt itself is only replaced by hand
+    std::string outputPath = "tuned_neurons.txt";
+  };
+
+  struct Individual
+  {
+    std::vector<Brain::EvaluationNode> neurons;
+
+    // Points per game against the reference, 0.5 is as good as it
+    double fitness = 0;
+  };
+
+  struct Population
+  {
+    int generation = 0;
+    std::vector<Individual> individuals;
+
+    // Fitness of the best individual of the last generation played
+    double bestFitness = 0;
+
+    // The weights every individual is matched against, the best of the previous generation
+    std::vector<Brain::EvaluationNode> reference;
+  };
+
+  // Evolves the weights of neurons.txt through fixed-node mini-matches played on every core
+  class Tuner
+  {
+  public:
+    Tuner(const TunerOptions &options);
+    ~Tuner() = default;
+
+    /**
+     * @brief Continues from the checkpoint if there is one, else starts from the given weights, and evolves until
+     * options.generations are done, checkpointing after every generation
+     *
+     * @return Individual the best weights found
+     */
+    Individual run(const std::vector<Brain::EvaluationNode> &startingNeurons);
+
+    /**
+     * @brief Plays one generation: every individual's match, then selection, crossover and mutation, the random
+     * numbers are seeded from the generation so a resumed run breeds the same children
+     */
+    void runGeneration(Population &population);
+
+    /**
+     * @brief Plays the match of every individual against the reference in parallel and sets their fitness
+     */
+    void evaluatePopulation(Population &population);
+
+    /**
+     * @brief One game at a fixed number of nodes per move, threefold repetition and the ply limit are draws
+     */
+    GameResult playGame(const std::vector<Brain::EvaluationNode> &white, const std::vector<Brain::EvaluationNode> &black, const std::string &fen) const;
+
+    Population createPopulation(const std::vector<Brain::EvaluationNode> &startingNeurons);
+    std::vector<Brain::EvaluationNode> mutate(const std::vector<Brain::EvaluationNode> &neurons);
+    std::vector<Brain::EvaluationNode> crossover(const std::vector<Brain::EvaluationNode> &first, const std::vector<Brain::EvaluationNode> &second);
+
+    static bool saveCheckpoint(const std::string &path, const Population &population);
+    static bool loadCheckpoint(const std::string &path, Population &population);
+    static bool saveNeurons(const std::string &path, const std::vector<Brain::EvaluationNode> &neurons);
+    static bool loadNeurons(const std::string &path, std::vector<Brain::EvaluationNode> &neurons);
+
+    const TunerOptions &getOptions() const;
+    long long getGamesPlayed() const;
+
+    // Balanced positions out of common openings, the matches start from the first openingCount of them
+    static const std::vector<std::string> openings;
+
+  private:
+    TunerOptions options;
+    WorkStealingPool::WorkStealingPool pool;
+    std::mt19937 random;
+    long long gamesPlayed = 0;
+  };
+
+  /**
+   * @brief Entry point of the tuner executable, options are given as --name value pairs
+   */
+  void run(const std::vector<std::string> &arguments);
+} // namespace Tuner
+
+#endif // TUNER_HPP
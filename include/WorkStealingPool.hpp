@@ -0,0 +1,80 @@
+#ifndef WORK_STEALING_POOL_HPP
+#define WORK_STEALING_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WorkStealingPool
+{
+  // Every thread owns a queue, it takes its newest task first and steals the oldest task of another queue when its own
+  // runs dry, so tasks of very different lengths (games that end after 30 or after 200 moves) still keep every core busy
+  class WorkStealingPool
+  {
+  public:
+    /**
+     * @brief Starts threadCount - 1 workers, the thread calling wait is the last one
+     */
+    WorkStealingPool(std::size_t threadCount = getDefaultThreadCount());
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    /**
+     * @brief Queues a task, the queues are filled in turn and the task can start right away on any idle worker
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Runs tasks on the calling thread until every submitted task has finished, the first exception thrown by
+     * a task is thrown again from here
+     */
+    void wait();
+
+    std::size_t getThreadCount() const;
+    long long getStolenTaskCount() const;
+
+    static std::size_t getDefaultThreadCount();
+
+  private:
+    struct Queue
+    {
+      std::mutex mutex;
+      std::deque<std::function<void()>> tasks;
+    };
+
+    /**
+     * @brief Runs one task, from the thread's own queue if it has any and stolen from the others otherwise
+     *
+     * @return true if a task was run
+     */
+    bool runTask(std::size_t queueIndex);
+    bool takeTask(std::size_t queueIndex, bool isOwnQueue, std::function<void()> &task);
+    void runWorker(std::size_t queueIndex);
+
+    // Queue 0 belongs to the thread calling wait, the workers have the others
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+    bool isStopping = false;
+    std::size_t queuedTasks = 0;
+    std::size_t unfinishedTasks = 0;
+    std::exception_ptr firstError;
+
+    std::atomic<std::size_t> nextQueue{0};
+    std::atomic<long long> stolenTasks{0};
+  };
+} // namespace WorkStealingPool
+
+#endif // WORK_STEALING_POOL_HPP
@@ -0,0 +1,177 @@
+#include "Attacks.hpp"
+
+#include <array>
+#include <cstdlib>
+
+#include "BoardScan.hpp"
+
+namespace {
+  constexpr std::uint64_t fileA = 0x0101010101010101ULL;
+  constexpr std::uint64_t fileH = fileA << 7;
+
+  // North, east, south, west, north east, south east, south west, north west
+  constexpr int rankSteps[8] = {1, 0, -1, 0, 1, -1, -1, 1};
+  constexpr int fileSteps[8] = {0, 1, 0, -1, 1, 1, -1, -1};
+
+  struct Tables {
+    std::array<std::uint64_t, 64> knight{};
+    std::array<std::uint64_t, 64> king{};
+    // Every square from the square to the edge in one direction
+    std::array<std::array<std::uint64_t, 64>, 8> rays{};
+    // Indexed by side first, white looks up the board and black down
+    std::array<std::array<std::uint64_t, 64>, 2> kingZone{};
+    std::array<std::array<std::uint64_t, 64>, 2> pawnShield{};
+    std::array<std::array<std::uint64_t, 64>, 2> pawnStorm{};
+  };
+
+  // The king's file and its neighbours from the first to the last rank in front of the king, counted from its side
+  std::uint64_t getFilesInFront(int square, int side, int firstRank, int lastRank) {
+    const int direction = side == 0 ? 1 : -1;
+    std::uint64_t squares = 0;
+    for (int distance = firstRank; distance <= lastRank; distance++) {
+      const int rank = square / 8 + direction * distance;
+      for (int file = square % 8 - 1; file <= square % 8 + 1; file++) {
+        if (rank >= 0 && rank < 8 && file >= 0 && file < 8)
+          squares |= 1ULL << (rank * 8 + file);
+      }
+    }
+    return squares;
+  }
+
+  std::uint64_t getStepTargets(int square, const int (*steps)[2], int count) {
+    std::uint64_t targets = 0;
+    for (int i = 0; i < count; i++) {
+      const int rank = square / 8 + steps[i][0];
+      const int file = square % 8 + steps[i][1];
+      if (rank >= 0 && rank < 8 && file >= 0 && file < 8)
+        targets |= 1ULL << (rank * 8 + file);
+    }
+    return targets;
+  }
+
+  Tables buildTables() {
+    static const int knightSteps[8][2] = {{2, 1}, {2, -1}, {-2, 1}, {-2, -1}, {1, 2}, {1, -2}, {-1, 2}, {-1, -2}};
+    static const int kingSteps[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+
+    Tables tables;
+    for (int square = 0; square < 64; square++) {
+      tables.knight[square] = getStepTargets(square, knightSteps, 8);
+      tables.king[square] = getStepTargets(square, kingSteps, 8);
+
+      for (int side = 0; side < 2; side++) {
+        const std::uint64_t around = tables.king[square] | (1ULL << square);
+        tables.kingZone[side][square] = around | (side == 0 ? around << 8 : around >> 8);
+        tables.pawnShield[side][square] = getFilesInFront(square, side, 1, 2);
+        tables.pawnStorm[side][square] = getFilesInFront(square, side, 1, 4);
+      }
+
+      for (int direction = 0; direction < 8; direction++) {
+        std::uint64_t ray = 0;
+        int rank = square / 8 + rankSteps[direction];
+        int file = square % 8 + fileSteps[direction];
+        while (rank >= 0 && rank < 8 && file >= 0 && file < 8) {
+          ray |= 1ULL << (rank * 8 + file);
+          rank += rankSteps[direction];
+          file += fileSteps[direction];
+        }
+        tables.rays[direction][square] = ray;
+      }
+    }
+    return tables;
+  }
+
+  const Tables tables = buildTables();
+
+  // The ray up to and including the first blocker, rays going up the board find it with the lowest bit, the others with the highest
+  std::uint64_t getRayAttacks(int square, std::uint64_t occupancy, int direction) {
+    const std::uint64_t ray = tables.rays[direction][square];
+    const std::uint64_t blockers = ray & occupancy;
+    if (blockers == 0)
+      return ray;
+
+    const bool isUpwards = direction == 0 || direction == 1 || direction == 4 || direction == 7;
+    const int blocker = isUpwards ? __builtin_ctzll(blockers) : 63 - __builtin_clzll(blockers);
+    return ray & ~tables.rays[direction][blocker];
+  }
+}
+
+namespace Attacks
+{
+  Bitboards::Bitboards(const Board::Board &board)
+  {
+    const BoardScan::PieceMasks masks = BoardScan::getPieceMasks(board.packedBoard);
+    for (int side = 0; side < 2; side++)
+    {
+      for (int type = 0; type < 6; type++)
+      {
+        this->pieces[side][type] = masks.pieces[side][type];
+        this->sides[side] |= masks.pieces[side][type];
+      }
+    }
+
+    this->occupancy = this->sides[0] | this->sides[1];
+    this->kings[0] = board.currentWhiteKingPosition;
+    this->kings[1] = board.currentBlackKingPosition;
+  }
+
+  Bitboards::Bitboards(const std::uint64_t (&pieces)[2][6])
+  {
+    for (int side = 0; side < 2; side++)
+    {
+      for (int type = 0; type < 6; type++)
+      {
+        this->pieces[side][type] = pieces[side][type];
+        this->sides[side] |= pieces[side][type];
+      }
+
+      // A position without a king only shows up in tests, it is put on a1
+      this->kings[side] = pieces[side][5] != 0 ? getFirstSquare(pieces[side][5]) : 0;
+    }
+
+    this->occupancy = this->sides[0] | this->sides[1];
+  }
+
+  std::uint64_t getPawnAttacks(std::uint64_t pawns, int side)
+  {
+    if (side == 0)
+      return ((pawns & ~fileA) << 7) | ((pawns & ~fileH) << 9);
+    return ((pawns & ~fileA) >> 9) | ((pawns & ~fileH) >> 7);
+  }
+
+  std::uint64_t getKnightAttacks(int square)
+  {
+    return tables.knight[square];
+  }
+
+  std::uint64_t getKingAttacks(int square)
+  {
+    return tables.king[square];
+  }
+
+  std::uint64_t getKingZone(int square, int side)
+  {
+    return tables.kingZone[side][square];
+  }
+
+  std::uint64_t getPawnShield(int square, int side)
+  {
+    return tables.pawnShield[side][square];
+  }
+
+  std::uint64_t getPawnStorm(int square, int side)
+  {
+    return tables.pawnStorm[side][square];
+  }
+
+  std::uint64_t getBishopAttacks(int square, std::uint64_t occupancy)
+  {
+    return getRayAttacks(square, occupancy, 4) | getRayAttacks(square, occupancy, 5) |
+           getRayAttacks(square, occupancy, 6) | getRayAttacks(square, occupancy, 7);
+  }
+
+  std::uint64_t getRookAttacks(int square, std::uint64_t occupancy)
+  {
+    return getRayAttacks(square, occupancy, 0) | getRayAttacks(square, occupancy, 1) |
+           getRayAttacks(square, occupancy, 2) | getRayAttacks(square, occupancy, 3);
+  }
+} // namespace Attacks
@@ -0,0 +1,249 @@
+#include "BatchEvaluation.hpp"
+
+#include <algorithm>
+
+#include "Attacks.hpp"
+#include "Evaluation.hpp"
+#include "PawnStructure.hpp"
+#include "PieceSquareTables.hpp"
+
+namespace BatchEvaluation
+{
+  PackedPosition::PackedPosition(const Board::Board &board)
+  {
+    const Attacks::Bitboards bitboards(board);
+
+    for (int side = 0; side < 2; side++)
+    {
+      for (int type = 0; type < 6; type++)
+        this->pieces[side][type] = bitboards.pieces[side][type];
+    }
+
+    this->isWhiteToMove = board.isWhiteTurn;
+  }
+
+  PositionBatch::PositionBatch(const std::vector<PackedPosition> &positions)
+  {
+    for (int side = 0; side < 2; side++)
+    {
+      for (int type = 0; type < 6; type++)
+      {
+        this->pieces[side][type].reserve(positions.size());
+        for (const auto &position : positions)
+          this->pieces[side][type].push_back(position.pieces[side][type]);
+      }
+    }
+
+    this->isWhiteToMove.reserve(positions.size());
+    for (const auto &position : positions)
+      this->isWhiteToMove.push_back(position.isWhiteToMove ? 1 : 0);
+  }
+
+  std::size_t PositionBatch::size() const
+  {
+    return this->isWhiteToMove.size();
+  }
+
+  BatchEvaluator::BatchEvaluator(std::size_t threadCount)
+  {
+    for (std::size_t i = 1; i < threadCount; i++)
+      this->workers.emplace_back([this]()
+                                 { runWorker(); });
+  }
+
+  BatchEvaluator::~BatchEvaluator()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->isStopping = true;
+    }
+    this->workReady.notify_all();
+
+    for (auto &worker : this->workers)
+      worker.join();
+  }
+
+  std::size_t BatchEvaluator::getThreadCount() const
+  {
+    return this->workers.size() + 1;
+  }
+
+  std::size_t BatchEvaluator::getDefaultThreadCount()
+  {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  std::vector<Score::Score> BatchEvaluator::evaluate(const PositionBatch &batch, const std::vector<Brain::EvaluationNode> &neurons)
+  {
+    std::vector<Score::Score> scores(batch.size());
+    if (scores.empty())
+      return scores;
+
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->batch = &batch;
+      this->neurons = neurons;
+      this->weights.clear();
+      for (const auto &node : neurons)
+        this->weights.push_back(Score::toWeight(node.value));
+      this->scores = scores.data();
+      this->nextChunk = 0;
+      this->busyWorkers = this->workers.size();
+      this->generation++;
+    }
+    this->workReady.notify_all();
+
+    // The calling thread takes chunks like any worker and then waits for the ones still running
+    evaluateChunks();
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->workDone.wait(lock, [this]()
+                        { return this->busyWorkers == 0; });
+    this->batch = nullptr;
+    this->scores = nullptr;
+
+    return scores;
+  }
+
+  void BatchEvaluator::runWorker()
+  {
+    unsigned long long seenGeneration = 0;
+
+    while (true)
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->workReady.wait(lock, [&]()
+                           { return this->isStopping || this->generation != seenGeneration; });
+      if (this->isStopping)
+        return;
+
+      seenGeneration = this->generation;
+      lock.unlock();
+
+      evaluateChunks();
+
+      lock.lock();
+      if (--this->busyWorkers == 0)
+        this->workDone.notify_one();
+    }
+  }
+
+  void BatchEvaluator::evaluateChunks()
+  {
+    const std::size_t size = this->batch->size();
+
+    while (true)
+    {
+      const std::size_t begin = this->nextChunk.fetch_add(1) * chunkSize;
+      if (begin >= size)
+        return;
+
+      evaluateChunk(begin, std::min(begin + chunkSize, size));
+    }
+  }
+
+  void BatchEvaluator::evaluateChunk(std::size_t begin, std::size_t end)
+  {
+    const PositionBatch &batch = *this->batch;
+    const std::size_t count = end - begin;
+
+    int phase[chunkSize] = {};
+    int middlegame[2][chunkSize] = {};
+    int endgame[2][chunkSize] = {};
+
+    // Material and phase only count pieces, one bitboard across all the positions at a time
+    for (int side = 0; side < 2; side++)
+    {
+      for (int type = 0; type < 6; type++)
+      {
+        const std::uint64_t *pieces = batch.pieces[side][type].data() + begin;
+        const int phaseWeight = PieceSquareTables::phaseWeights[type];
+        const int middlegameValue = PieceSquareTables::middlegameValues[type];
+        const int endgameValue = PieceSquareTables::endgameValues[type];
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+          const int pieceCount = Attacks::countBits(pieces[i]);
+          phase[i] += pieceCount * phaseWeight;
+          middlegame[side][i] += pieceCount * middlegameValue;
+          endgame[side][i] += pieceCount * endgameValue;
+        }
+      }
+    }
+
+    // Piece-square tables need every square, black looks its square up mirrored like on the board
+    for (int side = 0; side < 2; side++)
+    {
+      const int mirror = side == 0 ? 0 : 56;
+
+      for (int type = 0; type < 6; type++)
+      {
+        const std::uint64_t *pieces = batch.pieces[side][type].data() + begin;
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+          for (std::uint64_t bits = pieces[i]; bits != 0; bits &= bits - 1)
+          {
+            const int square = Attacks::getFirstSquare(bits) ^ mirror;
+            middlegame[side][i] += PieceSquareTables::middlegameTables[type][square];
+            endgame[side][i] += PieceSquareTables::endgameTables[type][square];
+          }
+        }
+      }
+    }
+
+    // The pawn terms share one pawn evaluation, it is skipped when neither of them is weighted
+    bool usesPawns = false;
+    for (const auto &node : this->neurons)
+      usesPawns |= node.type == Brain::EvaluationTypes::SPACE || node.type == Brain::EvaluationTypes::PAWN_STRUCTURE;
+
+    // Pawn structure, king safety and activity look at the whole position
+    for (std::size_t i = 0; i < count; i++)
+    {
+      std::uint64_t pieces[2][6];
+      for (int side = 0; side < 2; side++)
+      {
+        for (int type = 0; type < 6; type++)
+          pieces[side][type] = batch.pieces[side][type][begin + i];
+      }
+
+      const Attacks::Bitboards bitboards(pieces);
+      const PawnStructure::Entry pawns = usesPawns ? PawnStructure::PawnStructure::evaluate(pieces[0][0], pieces[1][0]) : PawnStructure::Entry();
+
+      // Each side's term is weighted and rounded on its own like Brain::evaluateSide does, so the scores match exactly
+      Score::Score whiteScore = 0;
+      for (std::size_t node = 0; node < this->neurons.size(); node++)
+      {
+        Score::Score terms[2] = {0, 0};
+
+        for (int side = 0; side < 2; side++)
+        {
+          switch (this->neurons[node].type)
+          {
+          case Brain::EvaluationTypes::MATERIAL:
+            terms[side] = PieceSquareTables::taper(middlegame[side][i], endgame[side][i], phase[i]);
+            break;
+          case Brain::EvaluationTypes::SPACE:
+            terms[side] = pawns.advancement[side] * 100;
+            break;
+          case Brain::EvaluationTypes::KING_SAFETY:
+            terms[side] = Evaluation::getKingSafety(bitboards, side, phase[i]);
+            break;
+          case Brain::EvaluationTypes::PIECE_ACTIVITY:
+            terms[side] = Evaluation::getPieceActivity(bitboards, side);
+            break;
+          case Brain::EvaluationTypes::PAWN_STRUCTURE:
+            terms[side] = pawns.score[side];
+            break;
+          default:
+            break;
+          }
+        }
+
+        whiteScore += Score::applyWeight(terms[0], this->weights[node]) - Score::applyWeight(terms[1], this->weights[node]);
+      }
+
+      this->scores[begin + i] = batch.isWhiteToMove[begin + i] ? whiteScore : -whiteScore;
+    }
+  }
+} // namespace BatchEvaluation
@@ -0,0 +1,159 @@
+#include "Bitbase.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "Attacks.hpp"
+
+namespace {
+  // Bits so the results of all moves can be or-ed together, an invalid position adds nothing
+  enum Result : std::uint8_t
+  {
+    INVALID = 0,
+    UNKNOWN = 1,
+    DRAW = 2,
+    WIN = 4
+  };
+
+  // Both kings, the side to move, pawn files a to d and ranks 2 to 7
+  constexpr std::size_t positionCount = 64 * 64 * 2 * 4 * 6;
+
+  std::size_t getIndex(int strongKing, int weakKing, bool isStrongSideToMove, int pawn) {
+    return static_cast<std::size_t>(strongKing | weakKing << 6 | (isStrongSideToMove ? 0 : 1) << 12 | (pawn % 8) << 13 |
+                                    (6 - pawn / 8) << 15);
+  }
+
+  int getDistance(int first, int second) {
+    return std::max(std::abs(first % 8 - second % 8), std::abs(first / 8 - second / 8));
+  }
+
+  struct Position
+  {
+    int strongKing;
+    int weakKing;
+    bool isStrongSideToMove;
+    int pawn;
+  };
+
+  Position getPosition(std::size_t index) {
+    return {static_cast<int>(index & 63), static_cast<int>((index >> 6) & 63), ((index >> 12) & 1) == 0,
+            static_cast<int>((6 - (index >> 15)) * 8 + ((index >> 13) & 3))};
+  }
+
+  // Illegal positions, promotions that cannot be stopped and pawns that are lost or stalemates at once
+  Result classifyAtOnce(const Position &position) {
+    const std::uint64_t pawnAttacks = Attacks::getPawnAttacks(1ULL << position.pawn, 0);
+    const std::uint64_t strongKingAttacks = Attacks::getKingAttacks(position.strongKing);
+    const std::uint64_t weakKingAttacks = Attacks::getKingAttacks(position.weakKing);
+
+    if (position.strongKing == position.weakKing || position.strongKing == position.pawn || position.weakKing == position.pawn ||
+        getDistance(position.strongKing, position.weakKing) <= 1 ||
+        (position.isStrongSideToMove && (pawnAttacks & (1ULL << position.weakKing))))
+      return INVALID;
+
+    if (position.isStrongSideToMove)
+    {
+      const int promotionSquare = position.pawn + 8;
+      if (position.pawn / 8 == 6 && position.strongKing != promotionSquare && position.weakKing != promotionSquare &&
+          (getDistance(position.weakKing, promotionSquare) > 1 || getDistance(position.strongKing, promotionSquare) == 1))
+        return WIN;
+
+      return UNKNOWN;
+    }
+
+    const std::uint64_t weakMoves = weakKingAttacks & ~(strongKingAttacks | pawnAttacks);
+    if (weakMoves == 0 || (weakMoves & (1ULL << position.pawn)))
+      return DRAW;
+
+    return UNKNOWN;
+  }
+
+  // The strong side needs one move that wins, the weak side one that draws
+  Result classifyFromMoves(const Position &position, const std::vector<std::uint8_t> &results) {
+    std::uint8_t reached = INVALID;
+
+    if (position.isStrongSideToMove)
+    {
+      for (std::uint64_t moves = Attacks::getKingAttacks(position.strongKing); moves != 0; moves &= moves - 1)
+        reached |= results[getIndex(Attacks::getFirstSquare(moves), position.weakKing, false, position.pawn)];
+
+      // Promotions were settled at once, a promoted pawn that is taken is a draw
+      const int push = position.pawn + 8;
+      if (position.pawn / 8 < 6)
+        reached |= results[getIndex(position.strongKing, position.weakKing, false, push)];
+      if (position.pawn / 8 == 1 && push != position.strongKing && push != position.weakKing)
+        reached |= results[getIndex(position.strongKing, position.weakKing, false, push + 8)];
+
+      return reached & WIN ? WIN : reached & UNKNOWN ? UNKNOWN : DRAW;
+    }
+
+    for (std::uint64_t moves = Attacks::getKingAttacks(position.weakKing); moves != 0; moves &= moves - 1)
+      reached |= results[getIndex(position.strongKing, Attacks::getFirstSquare(moves), true, position.pawn)];
+
+    return reached & DRAW ? DRAW : reached & UNKNOWN ? UNKNOWN : WIN;
+  }
+
+  // Retrograde iteration, every pass settles the positions one move further from a known result. The passes update
+  // in place, a result found early in a pass is already used later in the same pass
+  std::vector<std::uint64_t> generateKPK() {
+    std::vector<std::uint8_t> results(positionCount);
+    for (std::size_t index = 0; index < positionCount; index++)
+      results[index] = classifyAtOnce(getPosition(index));
+
+    for (bool changed = true; changed;)
+    {
+      changed = false;
+      for (std::size_t index = 0; index < positionCount; index++)
+      {
+        if (results[index] != UNKNOWN)
+          continue;
+
+        results[index] = classifyFromMoves(getPosition(index), results);
+        changed |= results[index] != UNKNOWN;
+      }
+    }
+
+    // Whatever neither side could force is a draw
+    std::vector<std::uint64_t> bits(positionCount / 64, 0);
+    for (std::size_t index = 0; index < positionCount; index++)
+    {
+      if (results[index] == WIN)
+        bits[index / 64] |= 1ULL << (index % 64);
+    }
+    return bits;
+  }
+
+  const std::vector<std::uint64_t> &getKPK() {
+    static const std::vector<std::uint64_t> bits = generateKPK();
+    return bits;
+  }
+}
+
+namespace Bitbase
+{
+  void init()
+  {
+    getKPK();
+  }
+
+  bool probeKPK(int strongKing, int pawn, int weakKing, bool isStrongSideToMove)
+  {
+    // The table only has pawns on files a to d, the other half of the board is its mirror image
+    if (pawn % 8 > 3)
+    {
+      strongKing ^= 7;
+      pawn ^= 7;
+      weakKing ^= 7;
+    }
+
+    const std::size_t index = getIndex(strongKing, weakKing, isStrongSideToMove, pawn);
+    return (getKPK()[index / 64] >> (index % 64)) & 1;
+  }
+
+  std::size_t getKPKSize()
+  {
+    return getKPK().size() * sizeof(std::uint64_t);
+  }
+} // namespace Bitbase
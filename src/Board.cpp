@@ -1,7 +1,13 @@
 #include "Board.hpp"
+#include "Attacks.hpp"
+#include "Bitbase.hpp"
+#include "BoardScan.hpp"
+#include "Endgame.hpp"
+#include "PieceSquareTables.hpp"
 
 #include <algorithm>
 #include <array>
+#include <cstdlib>
 #include <iostream>
 #include <iostream>
 #include <unordered_map>
@@ -31,6 +37,75 @@ namespace {
 
     return sections;
   }
+
+  struct ZobristKeys {
+    unsigned long long pieces[12][64];
+    unsigned long long castling[4];
+    unsigned long long enPassant[8];
+    unsigned long long side;
+  };
+
+  // Fixed seed, keys have to be the same in every run so stored positions stay comparable
+  ZobristKeys buildZobristKeys() {
+    ZobristKeys keys{};
+    unsigned long long state = 0x9E3779B97F4A7C15ULL;
+
+    auto next = [&state]() {
+      // splitmix64
+      unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      return z ^ (z >> 31);
+    };
+
+    for (auto &piece : keys.pieces) {
+      for (auto &square : piece) {
+        square = next();
+      }
+    }
+    for (auto &key : keys.castling) {
+      key = next();
+    }
+    for (auto &key : keys.enPassant) {
+      key = next();
+    }
+    keys.side = next();
+
+    return keys;
+  }
+
+  const ZobristKeys zobristKeys = buildZobristKeys();
+
+  // PAWN = 2 ... KING = 64 become 0 ... 5, black pieces follow the white ones
+  int getZobristPieceIndex(unsigned long long piece) {
+    int type = 0;
+    for (unsigned long long bit = piece >> 2; bit != 0; bit >>= 1) {
+      ++type;
+    }
+    return type + (piece & Board::Board::BLACK ? 6 : 0);
+  }
+
+  // Value plus piece-square entry of every piece on every square, black mirrored, as 16 bit rows for the scan kernels
+  struct PieceScoreTables {
+    alignas(32) std::int16_t middlegame[2][6][64];
+    alignas(32) std::int16_t endgame[2][6][64];
+  };
+
+  PieceScoreTables buildPieceScoreTables() {
+    PieceScoreTables tables;
+    for (int side = 0; side < 2; side++) {
+      for (int type = 0; type < 6; type++) {
+        for (int square = 0; square < 64; square++) {
+          const int tableSquare = side ? square ^ 56 : square;
+          tables.middlegame[side][type][square] = static_cast<std::int16_t>(PieceSquareTables::middlegameValues[type] + PieceSquareTables::middlegameTables[type][tableSquare]);
+          tables.endgame[side][type][square] = static_cast<std::int16_t>(PieceSquareTables::endgameValues[type] + PieceSquareTables::endgameTables[type][tableSquare]);
+        }
+      }
+    }
+    return tables;
+  }
+
+  const PieceScoreTables pieceScoreTables = buildPieceScoreTables();
 }
 
 namespace Board
@@ -46,11 +121,11 @@ namespace Board
 
     for (int i = 0; i < 8; i++)
     {
-      board[i] = Board::BLACK | pieceSet[i];
-      board[i + 56] = pieceSet[i];
+      board[i] = pieceSet[i];
+      board[i + 56] = Board::BLACK | pieceSet[i];
 
-      board[i + 8] = Board::BLACK | Board::PAWN;
-      board[i + 48] = Board::PAWN;
+      board[i + 8] = Board::PAWN;
+      board[i + 48] = Board::BLACK | Board::PAWN;
 
       pieceSets.first.push_back(pieceSet[i]);
       pieceSets.second.push_back(pieceSet[i]);
@@ -61,6 +136,10 @@ namespace Board
 
     currentWhiteKingPosition = 4;
     currentBlackKingPosition = 60;
+
+    computePieceScores();
+    hashKey = computeHashKey();
+    pawnKey = computePawnKey();
   }
 
   void Board::setFromFEN(const std::string& FEN) {
@@ -101,6 +180,11 @@ namespace Board
       board[i] = Board::NONE;
     }
 
+    moveHistory.clear();
+    stateHistory.clear();
+    gameState = GameState::IN_PROGRESS;
+    fiftyMoveRuleCounter = 0;
+
     // STEP 1: LOAD IN BOARD STATE
     size_t column = 0;
     size_t row = 0;
@@ -114,7 +198,16 @@ namespace Board
         column += (symbol - '0');
       }
       else if(translationTable.find(symbol) != translationTable.end()) {
-        board[column + (row * 8)] = translationTable.at(symbol);
+        // FEN starts at the 8th rank, while the board is indexed from a1
+        const int square = column + ((7 - row) * 8);
+        board[square] = translationTable.at(symbol);
+
+        if(symbol == 'K') {
+          currentWhiteKingPosition = square;
+        }
+        else if(symbol == 'k') {
+          currentBlackKingPosition = square;
+        }
         ++column;
       } else {
         std::cout << symbol << std::endl;
@@ -134,6 +227,13 @@ namespace Board
     }
 
     // STEP 3: Castling rights
+    this->hasWhiteKingMoved = true;
+    this->hasBlackKingMoved = true;
+    this->hasWhiteRookAMoved = true;
+    this->hasWhiteRookHMoved = true;
+    this->hasBlackRookAMoved = true;
+    this->hasBlackRookHMoved = true;
+
     if(castlingRights.find("K") != std::string::npos) {
       this->hasWhiteKingMoved = false;
       this->hasWhiteRookHMoved = false;
@@ -152,22 +252,37 @@ namespace Board
     }
 
     // STEP 4: En Passant
+    // TBD
+
     // STEP 5: Fifty move rule
+    if(!fiftyMoveRuleCount.empty()) {
+      try {
+        this->fiftyMoveRuleCounter = std::stoi(fiftyMoveRuleCount);
+      } catch (const std::exception &) {
+        throw "Illegal FEN symbol in halfmove clock part";
+      }
+    }
+
     // STEP 6: Move count
     // TBD
+
+    computePieceScores();
+    hashKey = computeHashKey();
+    pawnKey = computePawnKey();
   }
 
   bool Board::makeMove(const Move::Move &move)
   {
-    // List all possible moves for debug
-    std::vector<Move::Move> moves = getAllValidMoves();
-    std::cout << "Possible moves: " << moves.size() << std::endl;
-    for (const auto &m : moves) {
-      std::cout << m.toString() << std::endl;
-    }
     if (gameState == GameState::CHECKMATE || gameState == GameState::STALEMATE || gameState == GameState::RESIGNATION || gameState == GameState::THREEFOLD_REPETITION || gameState == GameState::FIFTY_MOVE_RULE || gameState == GameState::INSUFFICIENT_MATERIAL)
       return false;
 
+    // A move given only by its squares gets the rest from the legal move list
+    if (move.pieceType == Move::PieceType::NONE && checkIfFitsInBoard(move.from))
+    {
+      const Move::Move resolvedMove = getValidMove(move.from, move.to, move.promotionTo == Move::PieceType::NONE ? Move::PieceType::QUEEN : move.promotionTo);
+      return resolvedMove.isValid && makeMove(resolvedMove);
+    }
+
     Move::Move checkedMove = isValidMove(move);
 
     if (!checkedMove.isValid) {
@@ -175,36 +290,178 @@ namespace Board
     }
     bool isValidMove;
 
+    const IrreversibleState previousState = getIrreversibleState();
+    const unsigned long long previousStateKey = computeStateKey();
+    const unsigned long long movingPiece = board[checkedMove.from];
+
     if (std::find(checkedMove.moveTypes.begin(), checkedMove.moveTypes.end(), Move::MoveTypes::SHORT_CASTLE) != checkedMove.moveTypes.end())
     {
-      return makeShortCastle();
+      isValidMove = makeShortCastle();
     }
     else if (std::find(checkedMove.moveTypes.begin(), checkedMove.moveTypes.end(), Move::MoveTypes::LONG_CASTLE) != checkedMove.moveTypes.end())
     {
-      return makeLongCastle();
+      isValidMove = makeLongCastle();
     }
     else
     {
-      if (std::find(checkedMove.moveTypes.begin(), checkedMove.moveTypes.end(), Move::MoveTypes::CAPTURE) != checkedMove.moveTypes.end())
+      // Not every validated move carries the CAPTURE type (e.g. bishops), so look at the target square instead
+      if (board[checkedMove.to] != Board::NONE)
       {
         checkedMove.capturedPiece = board[checkedMove.to];
-        fiftyMoveRuleCounter = 0;
       }
       isValidMove = makeRegularMove(checkedMove);
     }
+
+    // Half moves since the last capture or pawn move, the same count as the FEN halfmove clock
     fiftyMoveRuleCounter++;
+    if (checkedMove.capturedPiece != -1 || checkedMove.pieceType == Move::PieceType::PAWN)
+    {
+      fiftyMoveRuleCounter = 0;
+    }
+
     if (!isValidMove)
     {
-      fiftyMoveRuleCounter--;
+      fiftyMoveRuleCounter = previousState.fiftyMoveRuleCounter;
       return false;
     }
 
+    // Only the pieces that moved change the material and piece-square sums and the keys
+    const int movingColor = isWhiteTurn ? 0 : Board::BLACK;
+    const int firstRankSquare = isWhiteTurn ? 0 : 56;
+    if (std::find(checkedMove.moveTypes.begin(), checkedMove.moveTypes.end(), Move::MoveTypes::SHORT_CASTLE) != checkedMove.moveTypes.end())
+    {
+      updatePieceScore(Board::KING | movingColor, firstRankSquare + 4, -1);
+      updatePieceScore(Board::KING | movingColor, firstRankSquare + 6, 1);
+      updatePieceScore(Board::ROOK | movingColor, firstRankSquare + 7, -1);
+      updatePieceScore(Board::ROOK | movingColor, firstRankSquare + 5, 1);
+    }
+    else if (std::find(checkedMove.moveTypes.begin(), checkedMove.moveTypes.end(), Move::MoveTypes::LONG_CASTLE) != checkedMove.moveTypes.end())
+    {
+      updatePieceScore(Board::KING | movingColor, firstRankSquare + 4, -1);
+      updatePieceScore(Board::KING | movingColor, firstRankSquare + 2, 1);
+      updatePieceScore(Board::ROOK | movingColor, firstRankSquare + 0, -1);
+      updatePieceScore(Board::ROOK | movingColor, firstRankSquare + 3, 1);
+    }
+    else
+    {
+      updatePieceScore(movingPiece, checkedMove.from, -1);
+      updatePieceScore(board[checkedMove.to], checkedMove.to, 1);
+
+      if (checkedMove.capturedPiece != -1)
+        updatePieceScore(checkedMove.capturedPiece, checkedMove.to, -1);
+
+      if (std::find(checkedMove.moveTypes.begin(), checkedMove.moveTypes.end(), Move::MoveTypes::EN_PASSANT) != checkedMove.moveTypes.end())
+        updatePieceScore(Board::PAWN | (Board::BLACK - movingColor), isWhiteTurn ? checkedMove.to + Board::DOWN : checkedMove.to + Board::UP, -1);
+    }
+
+    stateHistory.push_back(previousState);
     moveHistory.push_back(checkedMove);
     isWhiteTurn = !isWhiteTurn;
+    hashKey ^= previousStateKey ^ computeStateKey();
+
     setGameState();
     return true;
   }
 
+  Move::Move Board::getValidMove(int from, int to, Move::PieceType promotionTo)
+  {
+    for (const auto &move : getAllValidMoves())
+    {
+      if (move.from != from || move.to != to)
+        continue;
+
+      if (move.promotionTo != Move::PieceType::NONE && move.promotionTo != promotionTo)
+        continue;
+
+      return move;
+    }
+
+    return Move::Move(false);
+  }
+
+  void Board::makeNullMove()
+  {
+    stateHistory.push_back(getIrreversibleState());
+    const unsigned long long previousStateKey = computeStateKey();
+
+    // An empty entry keeps en passant from being offered against the move before the null move
+    Move::Move nullMove(false);
+    moveHistory.push_back(nullMove);
+
+    isWhiteTurn = !isWhiteTurn;
+    gameState = GameState::IN_PROGRESS;
+    hashKey ^= previousStateKey ^ computeStateKey();
+  }
+
+  void Board::undoNullMove()
+  {
+    if (moveHistory.size() == 0 || moveHistory.back().pieceType != Move::PieceType::NONE)
+      return;
+
+    moveHistory.pop_back();
+    restoreIrreversibleState();
+    isWhiteTurn = !isWhiteTurn;
+  }
+
+  IrreversibleState Board::getIrreversibleState() const
+  {
+    IrreversibleState state;
+    state.hasWhiteKingMoved = hasWhiteKingMoved;
+    state.hasBlackKingMoved = hasBlackKingMoved;
+    state.hasWhiteRookAMoved = hasWhiteRookAMoved;
+    state.hasWhiteRookHMoved = hasWhiteRookHMoved;
+    state.hasBlackRookAMoved = hasBlackRookAMoved;
+    state.hasBlackRookHMoved = hasBlackRookHMoved;
+    state.fiftyMoveRuleCounter = fiftyMoveRuleCounter;
+    state.gameState = gameState;
+    state.hashKey = hashKey;
+    state.pawnKey = pawnKey;
+    state.middlegameScore[0] = middlegameScore[0];
+    state.middlegameScore[1] = middlegameScore[1];
+    state.endgameScore[0] = endgameScore[0];
+    state.endgameScore[1] = endgameScore[1];
+    state.phase = phase;
+    state.materialKey = materialKey;
+    state.pieceChangeCount = pieceChanges.size();
+    return state;
+  }
+
+  void Board::restoreIrreversibleState()
+  {
+    if (stateHistory.size() == 0)
+      return;
+
+    const IrreversibleState &state = stateHistory.back();
+    hasWhiteKingMoved = state.hasWhiteKingMoved;
+    hasBlackKingMoved = state.hasBlackKingMoved;
+    hasWhiteRookAMoved = state.hasWhiteRookAMoved;
+    hasWhiteRookHMoved = state.hasWhiteRookHMoved;
+    hasBlackRookAMoved = state.hasBlackRookAMoved;
+    hasBlackRookHMoved = state.hasBlackRookHMoved;
+    fiftyMoveRuleCounter = state.fiftyMoveRuleCounter;
+    gameState = state.gameState;
+    hashKey = state.hashKey;
+    pawnKey = state.pawnKey;
+    middlegameScore[0] = state.middlegameScore[0];
+    middlegameScore[1] = state.middlegameScore[1];
+    endgameScore[0] = state.endgameScore[0];
+    endgameScore[1] = state.endgameScore[1];
+    phase = state.phase;
+    materialKey = state.materialKey;
+
+    // The packed board goes back by replaying the piece changes of the move backwards
+    for (std::size_t i = pieceChanges.size(); i > state.pieceChangeCount; i--)
+    {
+      const PieceChange &change = pieceChanges[i - 1];
+      if (change.sign < 0)
+        packedBoard[change.square] = static_cast<std::uint8_t>(change.piece);
+      else if (packedBoard[change.square] == change.piece)
+        packedBoard[change.square] = Board::NONE;
+    }
+    pieceChanges.resize(state.pieceChangeCount);
+    stateHistory.pop_back();
+  }
+
   std::vector<Move::Move> Board::getAllValidMoves()
   {
     std::vector<Move::Move> moves = {};
@@ -231,75 +488,71 @@ namespace Board
   {
     std::vector<Move::Move> moves = {};
 
-    for (int i = 0; i < 64; i++)
+    for (std::uint64_t pawns = BoardScan::getPieceMask(packedBoard, Board::PAWN | !isWhiteTurn); pawns != 0; pawns &= pawns - 1)
     {
+      const int i = Attacks::getFirstSquare(pawns);
+
       if (isWhiteTurn)
       {
-        if (board[i] == Board::PAWN)
+        Move::Move movesList[] = {
+            Move::Move(i, i + 8, Move::PieceType::PAWN, {}),
+            Move::Move(i, i + 16, Move::PieceType::PAWN, {}),
+            Move::Move(i, i + 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE}),
+            Move::Move(i, i + 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE}),
+            Move::Move(i, i + 8, Move::PieceType::PAWN, {Move::MoveTypes::PROMOTION}, Move::PieceType::QUEEN),
+            Move::Move(i, i + 8, Move::PieceType::PAWN, {Move::MoveTypes::PROMOTION}, Move::PieceType::KNIGHT),
+            Move::Move(i, i + 8, Move::PieceType::PAWN, {Move::MoveTypes::PROMOTION}, Move::PieceType::BISHOP),
+            Move::Move(i, i + 8, Move::PieceType::PAWN, {Move::MoveTypes::PROMOTION}, Move::PieceType::ROOK),
+            Move::Move(i, i + 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::QUEEN),
+            Move::Move(i, i + 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::KNIGHT),
+            Move::Move(i, i + 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::BISHOP),
+            Move::Move(i, i + 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::ROOK),
+            Move::Move(i, i + 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::QUEEN),
+            Move::Move(i, i + 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::KNIGHT),
+            Move::Move(i, i + 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::BISHOP),
+            Move::Move(i, i + 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::ROOK),
+        };
+
+        for (const auto &move : movesList)
         {
-          Move::Move movesList[] = {
-              Move::Move(i, i + 8, Move::PieceType::PAWN, {}),
-              Move::Move(i, i + 16, Move::PieceType::PAWN, {}),
-              Move::Move(i, i + 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE}),
-              Move::Move(i, i + 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE}),
-              Move::Move(i, i + 8, Move::PieceType::PAWN, {Move::MoveTypes::PROMOTION}, Move::PieceType::QUEEN),
-              Move::Move(i, i + 8, Move::PieceType::PAWN, {Move::MoveTypes::PROMOTION}, Move::PieceType::KNIGHT),
-              Move::Move(i, i + 8, Move::PieceType::PAWN, {Move::MoveTypes::PROMOTION}, Move::PieceType::BISHOP),
-              Move::Move(i, i + 8, Move::PieceType::PAWN, {Move::MoveTypes::PROMOTION}, Move::PieceType::ROOK),
-              Move::Move(i, i + 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::QUEEN),
-              Move::Move(i, i + 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::KNIGHT),
-              Move::Move(i, i + 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::BISHOP),
-              Move::Move(i, i + 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::ROOK),
-              Move::Move(i, i + 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::QUEEN),
-              Move::Move(i, i + 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::KNIGHT),
-              Move::Move(i, i + 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::BISHOP),
-              Move::Move(i, i + 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::ROOK),
-          };
-
-          for (const auto &move : movesList)
+          Move::Move checkedMove = isValidMove(move);
+          if (checkedMove.isValid)
           {
-            Move::Move checkedMove = isValidMove(move);
-            if (checkedMove.isValid)
-            {
-              if (doesMoveCauseCheck(checkedMove))
-                continue;
-              moves.push_back(checkedMove);
-            }
+            if (doesMoveCauseCheck(checkedMove))
+              continue;
+            moves.push_back(checkedMove);
           }
         }
       }
       else
       {
-        if (board[i] == (Board::PAWN | Board::BLACK))
+        Move::Move movesList[] = {
+            Move::Move(i, i - 8, Move::PieceType::PAWN, {}),
+            Move::Move(i, i - 16, Move::PieceType::PAWN, {}),
+            Move::Move(i, i - 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE}),
+            Move::Move(i, i - 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE}),
+            Move::Move(i, i - 8, Move::PieceType::PAWN, {Move::MoveTypes::PROMOTION}, Move::PieceType::QUEEN),
+            Move::Move(i, i - 8, Move::PieceType::PAWN, {Move::MoveTypes::PROMOTION}, Move::PieceType::KNIGHT),
+            Move::Move(i, i - 8, Move::PieceType::PAWN, {Move::MoveTypes::PROMOTION}, Move::PieceType::BISHOP),
+            Move::Move(i, i - 8, Move::PieceType::PAWN, {Move::MoveTypes::PROMOTION}, Move::PieceType::ROOK),
+            Move::Move(i, i - 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::QUEEN),
+            Move::Move(i, i - 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::KNIGHT),
+            Move::Move(i, i - 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::BISHOP),
+            Move::Move(i, i - 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::ROOK),
+            Move::Move(i, i - 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::QUEEN),
+            Move::Move(i, i - 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::KNIGHT),
+            Move::Move(i, i - 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::BISHOP),
+            Move::Move(i, i - 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::ROOK),
+        };
+
+        for (const auto &move : movesList)
         {
-          Move::Move movesList[] = {
-              Move::Move(i, i - 8, Move::PieceType::PAWN, {}),
-              Move::Move(i, i - 16, Move::PieceType::PAWN, {}),
-              Move::Move(i, i - 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE}),
-              Move::Move(i, i - 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE}),
-              Move::Move(i, i - 8, Move::PieceType::PAWN, {Move::MoveTypes::PROMOTION}, Move::PieceType::QUEEN),
-              Move::Move(i, i - 8, Move::PieceType::PAWN, {Move::MoveTypes::PROMOTION}, Move::PieceType::KNIGHT),
-              Move::Move(i, i - 8, Move::PieceType::PAWN, {Move::MoveTypes::PROMOTION}, Move::PieceType::BISHOP),
-              Move::Move(i, i - 8, Move::PieceType::PAWN, {Move::MoveTypes::PROMOTION}, Move::PieceType::ROOK),
-              Move::Move(i, i - 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::QUEEN),
-              Move::Move(i, i - 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::KNIGHT),
-              Move::Move(i, i - 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::BISHOP),
-              Move::Move(i, i - 7, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::ROOK),
-              Move::Move(i, i - 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::QUEEN),
-              Move::Move(i, i - 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::KNIGHT),
-              Move::Move(i, i - 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::BISHOP),
-              Move::Move(i, i - 9, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION}, Move::PieceType::ROOK),
-          };
-
-          for (const auto &move : movesList)
+          Move::Move checkedMove = isValidMove(move);
+          if (checkedMove.isValid)
           {
-            Move::Move checkedMove = isValidMove(move);
-            if (checkedMove.isValid)
-            {
-              if (doesMoveCauseCheck(checkedMove))
-                continue;
-              moves.push_back(checkedMove);
-            }
+            if (doesMoveCauseCheck(checkedMove))
+              continue;
+            moves.push_back(checkedMove);
           }
         }
       }
@@ -316,19 +569,17 @@ namespace Board
     const int knightOffsets[] = {17, 15, 10, 6, -17, -15, -10, -6};
     const int targetPiece = isWhiteTurn ? Board::KNIGHT : (Board::KNIGHT | Board::BLACK);
     
-    for (int i = 0; i < 64; i++)
+    for (std::uint64_t knights = BoardScan::getPieceMask(packedBoard, targetPiece); knights != 0; knights &= knights - 1)
     {
-        if (board[i] == targetPiece)
+        const int i = Attacks::getFirstSquare(knights);
+        for (int offset : knightOffsets)
         {
-            for (int offset : knightOffsets)
+            Move::Move candidateMove(i, i + offset, Move::PieceType::KNIGHT, {});
+            Move::Move checkedMove = isValidMove(candidateMove);
+            
+            if (checkedMove.isValid && !doesMoveCauseCheck(checkedMove))
             {
-                Move::Move candidateMove(i, i + offset, Move::PieceType::KNIGHT, {});
-                Move::Move checkedMove = isValidMove(candidateMove);
-                
-                if (checkedMove.isValid && !doesMoveCauseCheck(checkedMove))
-                {
-                    moves.push_back(checkedMove);
-                }
+                moves.push_back(checkedMove);
             }
         }
     }
@@ -339,18 +590,16 @@ namespace Board
   std::vector<Move::Move> Board::getAllBishopMoves()
   {
     std::vector<Move::Move> moves;
-    for (int i = 0; i < 64; i++)
+    for (std::uint64_t bishops = BoardScan::getPieceMask(packedBoard, Board::BISHOP | !isWhiteTurn); bishops != 0; bishops &= bishops - 1)
     {
-      if (board[i] == (Board::BISHOP | !isWhiteTurn))
+      const int i = Attacks::getFirstSquare(bishops);
+      std::vector<std::pair<int, bool>> fromList = getDiagonalMoves(i);
+      for (auto [to, isCapture] : fromList)
       {
-        std::vector<std::pair<int, bool>> fromList = getDiagonalMoves(i);
-        for (auto [to, isCapture] : fromList)
-        {
-          Move::Move pushedMove = Move::Move(i, to, Move::PieceType::BISHOP, (isCapture ? std::vector<Move::MoveTypes>{Move::MoveTypes::CAPTURE} : std::vector<Move::MoveTypes>{}));
-          if (doesMoveCauseCheck(pushedMove))
-            continue;
-          moves.push_back(pushedMove);
-        }
+        Move::Move pushedMove = Move::Move(i, to, Move::PieceType::BISHOP, (isCapture ? std::vector<Move::MoveTypes>{Move::MoveTypes::CAPTURE} : std::vector<Move::MoveTypes>{}));
+        if (doesMoveCauseCheck(pushedMove))
+          continue;
+        moves.push_back(pushedMove);
       }
     }
     return moves;
@@ -359,18 +608,16 @@ namespace Board
   std::vector<Move::Move> Board::getAllRookMoves()
   {
     std::vector<Move::Move> moves;
-    for (int i = 0; i < 64; i++)
+    for (std::uint64_t rooks = BoardScan::getPieceMask(packedBoard, Board::ROOK | !isWhiteTurn); rooks != 0; rooks &= rooks - 1)
     {
-      if (board[i] == (Board::ROOK | !isWhiteTurn))
+      const int i = Attacks::getFirstSquare(rooks);
+      std::vector<std::pair<int, bool>> fromList = getVerticalAndHorizontalMoves(i);
+      for (auto [to, isCapture] : fromList)
       {
-        std::vector<std::pair<int, bool>> fromList = getVerticalAndHorizontalMoves(i);
-        for (auto [to, isCapture] : fromList)
-        {
-          Move::Move pushedMove = Move::Move(i, to, Move::PieceType::ROOK, (isCapture ? std::vector<Move::MoveTypes>{Move::MoveTypes::CAPTURE} : std::vector<Move::MoveTypes>{}));
-          if (doesMoveCauseCheck(pushedMove))
-            continue;
-          moves.push_back(pushedMove);
-        }
+        Move::Move pushedMove = Move::Move(i, to, Move::PieceType::ROOK, (isCapture ? std::vector<Move::MoveTypes>{Move::MoveTypes::CAPTURE} : std::vector<Move::MoveTypes>{}));
+        if (doesMoveCauseCheck(pushedMove))
+          continue;
+        moves.push_back(pushedMove);
       }
     }
     return moves;
@@ -379,27 +626,25 @@ namespace Board
   std::vector<Move::Move> Board::getAllQueenMoves()
   {
     std::vector<Move::Move> moves;
-    for (int i = 0; i < 64; i++)
+    for (std::uint64_t queens = BoardScan::getPieceMask(packedBoard, Board::QUEEN | !isWhiteTurn); queens != 0; queens &= queens - 1)
     {
-      if (board[i] == (Board::QUEEN | !isWhiteTurn))
-      {
-        std::vector<std::pair<int, bool>> fromList = getDiagonalMoves(i);
+      const int i = Attacks::getFirstSquare(queens);
+      std::vector<std::pair<int, bool>> fromList = getDiagonalMoves(i);
 
-        for (auto [to, isCapture] : fromList)
-        {
-          Move::Move pushedMove = Move::Move(i, to, Move::PieceType::QUEEN, (isCapture ? std::vector<Move::MoveTypes>{Move::MoveTypes::CAPTURE} : std::vector<Move::MoveTypes>{}));
-          if (doesMoveCauseCheck(pushedMove))
-            continue;
-          moves.push_back(pushedMove);
-        }
-        fromList = getVerticalAndHorizontalMoves(i);
-        for (auto [to, isCapture] : fromList)
-        {
-          Move::Move pushedMove = Move::Move(i, to, Move::PieceType::QUEEN, (isCapture ? std::vector<Move::MoveTypes>{Move::MoveTypes::CAPTURE} : std::vector<Move::MoveTypes>{}));
-          if (doesMoveCauseCheck(pushedMove))
-            continue;
-          moves.push_back(pushedMove);
-        }
+      for (auto [to, isCapture] : fromList)
+      {
+        Move::Move pushedMove = Move::Move(i, to, Move::PieceType::QUEEN, (isCapture ? std::vector<Move::MoveTypes>{Move::MoveTypes::CAPTURE} : std::vector<Move::MoveTypes>{}));
+        if (doesMoveCauseCheck(pushedMove))
+          continue;
+        moves.push_back(pushedMove);
+      }
+      fromList = getVerticalAndHorizontalMoves(i);
+      for (auto [to, isCapture] : fromList)
+      {
+        Move::Move pushedMove = Move::Move(i, to, Move::PieceType::QUEEN, (isCapture ? std::vector<Move::MoveTypes>{Move::MoveTypes::CAPTURE} : std::vector<Move::MoveTypes>{}));
+        if (doesMoveCauseCheck(pushedMove))
+          continue;
+        moves.push_back(pushedMove);
       }
     }
     return moves;
@@ -412,17 +657,17 @@ namespace Board
     if (checkShortCastle())
     {
       if (isWhiteTurn)
-        moves.push_back(Move::Move(60, 62, Move::PieceType::KING, {Move::MoveTypes::SHORT_CASTLE}));
-      else
         moves.push_back(Move::Move(4, 6, Move::PieceType::KING, {Move::MoveTypes::SHORT_CASTLE}));
+      else
+        moves.push_back(Move::Move(60, 62, Move::PieceType::KING, {Move::MoveTypes::SHORT_CASTLE}));
     }
 
     if (checkLongCastle())
     {
       if (isWhiteTurn)
-        moves.push_back(Move::Move(60, 58, Move::PieceType::KING, {Move::MoveTypes::LONG_CASTLE}));
-      else
         moves.push_back(Move::Move(4, 2, Move::PieceType::KING, {Move::MoveTypes::LONG_CASTLE}));
+      else
+        moves.push_back(Move::Move(60, 58, Move::PieceType::KING, {Move::MoveTypes::LONG_CASTLE}));
     }
 
     int possibleMoves[] = {Board::UP, Board::DOWN, Board::LEFT, Board::RIGHT, Board::UP_LEFT, Board::UP_RIGHT, Board::DOWN_LEFT, Board::DOWN_RIGHT};
@@ -443,34 +688,44 @@ namespace Board
         continue;
       }
 
+      Move::Move pushedMove(true);
+
       if (isWhiteTurn)
       {
         if (board[currentWhiteKingPosition + possibleMoves[i]] == Board::NONE)
         {
-          moves.push_back(Move::Move(currentWhiteKingPosition, currentWhiteKingPosition + possibleMoves[i], Move::PieceType::KING, {}));
+          pushedMove = Move::Move(currentWhiteKingPosition, currentWhiteKingPosition + possibleMoves[i], Move::PieceType::KING, {});
+        }
+        else if ((board[currentWhiteKingPosition + possibleMoves[i]] & Board::BLACK))
+        {
+          pushedMove = Move::Move(currentWhiteKingPosition, currentWhiteKingPosition + possibleMoves[i], Move::PieceType::KING, {Move::MoveTypes::CAPTURE});
         }
         else
         {
-          if ((board[currentWhiteKingPosition + possibleMoves[i]] & Board::BLACK))
-          {
-            moves.push_back(Move::Move(currentWhiteKingPosition, currentWhiteKingPosition + possibleMoves[i], Move::PieceType::KING, {Move::MoveTypes::CAPTURE}));
-          }
+          continue;
         }
       }
       else
       {
         if (board[currentBlackKingPosition + possibleMoves[i]] == Board::NONE)
         {
-          moves.push_back(Move::Move(currentBlackKingPosition, currentBlackKingPosition + possibleMoves[i], Move::PieceType::KING, {}));
+          pushedMove = Move::Move(currentBlackKingPosition, currentBlackKingPosition + possibleMoves[i], Move::PieceType::KING, {});
+        }
+        else if (!(board[currentBlackKingPosition + possibleMoves[i]] & Board::BLACK))
+        {
+          pushedMove = Move::Move(currentBlackKingPosition, currentBlackKingPosition + possibleMoves[i], Move::PieceType::KING, {Move::MoveTypes::CAPTURE});
         }
         else
         {
-          if ((board[currentBlackKingPosition + possibleMoves[i]] & !Board::BLACK))
-          {
-            moves.push_back(Move::Move(currentBlackKingPosition, currentBlackKingPosition + possibleMoves[i], Move::PieceType::KING, {Move::MoveTypes::CAPTURE}));
-          }
+          continue;
         }
       }
+
+      // The king itself blocks sliding attacks along the line it is escaping on, so check with the king moved
+      if (doesMoveCauseCheck(pushedMove))
+        continue;
+
+      moves.push_back(pushedMove);
     }
 
     return moves;
@@ -492,6 +747,12 @@ namespace Board
 
   Move::Move Board::isValidMove(const Move::Move &move)
   {
+    const bool isCastle = std::find(move.moveTypes.begin(), move.moveTypes.end(), Move::MoveTypes::SHORT_CASTLE) != move.moveTypes.end() ||
+                          std::find(move.moveTypes.begin(), move.moveTypes.end(), Move::MoveTypes::LONG_CASTLE) != move.moveTypes.end();
+
+    if (!isCastle && !checkIfFitsInBoard(move.to))
+      return Move::Move(false);
+
     std::vector<Move::Move> checkedMoves;
     switch (move.pieceType)
     {
@@ -562,11 +823,11 @@ namespace Board
         if (((targetSquare >= 7 && board[targetSquare + Board::DOWN_RIGHT] != Board::PAWN) && (targetSquare >= 9 && board[targetSquare + Board::DOWN_LEFT] != Board::PAWN)))
           return {};
 
-        if (targetSquare >= 7 && board[targetSquare + Board::DOWN_RIGHT] == Board::PAWN && !isOnRightBorder(targetSquare))
+        if (targetSquare >= 7 && board[targetSquare + Board::DOWN_RIGHT] == Board::PAWN && !isOnRightBorder(targetSquare) && isRequestedPawn(move, targetSquare + Board::DOWN_RIGHT))
         {
           return {Move::Move(targetSquare + Board::DOWN_RIGHT, targetSquare, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE})};
         }
-        else if (targetSquare >= 9 && board[targetSquare + Board::DOWN_LEFT] == Board::PAWN && !isOnLeftBorder(targetSquare))
+        else if (targetSquare >= 9 && board[targetSquare + Board::DOWN_LEFT] == Board::PAWN && !isOnLeftBorder(targetSquare) && isRequestedPawn(move, targetSquare + Board::DOWN_LEFT))
         {
           return {Move::Move(targetSquare + Board::DOWN_LEFT, targetSquare, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE})};
         }
@@ -581,11 +842,11 @@ namespace Board
         if (((targetSquare <= 56 && board[targetSquare + Board::UP_LEFT] != (Board::BLACK | Board::PAWN)) && (targetSquare <= 54 && board[targetSquare + Board::UP_RIGHT] != (Board::BLACK | Board::PAWN))))
           return {};
 
-        if (targetSquare <= 56 && board[targetSquare + Board::UP_LEFT] == (Board::BLACK | Board::PAWN) && !isOnLeftBorder(targetSquare))
+        if (targetSquare <= 56 && board[targetSquare + Board::UP_LEFT] == (Board::BLACK | Board::PAWN) && !isOnLeftBorder(targetSquare) && isRequestedPawn(move, targetSquare + Board::UP_LEFT))
         {
           return {Move::Move(targetSquare + Board::UP_LEFT, targetSquare, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE})};
         }
-        else if (targetSquare <= 54 && board[targetSquare + Board::UP_RIGHT] == (Board::BLACK | Board::PAWN) && !isOnRightBorder(targetSquare))
+        else if (targetSquare <= 54 && board[targetSquare + Board::UP_RIGHT] == (Board::BLACK | Board::PAWN) && !isOnRightBorder(targetSquare) && isRequestedPawn(move, targetSquare + Board::UP_RIGHT))
         {
           return {Move::Move(targetSquare + Board::UP_RIGHT, targetSquare, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE})};
         }
@@ -603,18 +864,18 @@ namespace Board
         // Check for a move two squares forward
         if (targetSquare >= 24 && targetSquare <= 31)
         {
-          if (board[targetSquare + Board::DOWN] == Board::PAWN)
+          if (board[targetSquare + Board::DOWN] == Board::PAWN && isRequestedPawn(move, targetSquare + Board::DOWN))
           {
             return {Move::Move(targetSquare + Board::DOWN, targetSquare, Move::PieceType::PAWN, {})};
           }
-          else if ((board[targetSquare + (Board::DOWN * 2)] == Board::PAWN && board[targetSquare + (Board::DOWN)] == Board::NONE))
+          else if ((board[targetSquare + (Board::DOWN * 2)] == Board::PAWN && board[targetSquare + (Board::DOWN)] == Board::NONE && isRequestedPawn(move, targetSquare + (Board::DOWN * 2))))
           {
             return {Move::Move(targetSquare + (Board::DOWN * 2), targetSquare, Move::PieceType::PAWN, {})};
           }
         }
         else
         {
-          if (board[targetSquare + Board::DOWN] == Board::PAWN)
+          if (board[targetSquare + Board::DOWN] == Board::PAWN && isRequestedPawn(move, targetSquare + Board::DOWN))
           {
             return {Move::Move(targetSquare + Board::DOWN, targetSquare, Move::PieceType::PAWN, {})};
           }
@@ -625,18 +886,18 @@ namespace Board
         // Check for a move two squares forward
         if (targetSquare >= 32 && targetSquare <= 39)
         {
-          if (board[targetSquare + Board::UP] == 3)
+          if (board[targetSquare + Board::UP] == 3 && isRequestedPawn(move, targetSquare + Board::UP))
           {
             return {Move::Move(targetSquare + Board::UP, targetSquare, Move::PieceType::PAWN, {})};
           }
-          else if ((board[targetSquare + (Board::UP * 2)] == 3 && board[targetSquare + Board::UP] == 0))
+          else if ((board[targetSquare + (Board::UP * 2)] == 3 && board[targetSquare + Board::UP] == 0 && isRequestedPawn(move, targetSquare + (Board::UP * 2))))
           {
             return {Move::Move(targetSquare + (Board::UP * 2), targetSquare, Move::PieceType::PAWN, {})};
           }
         }
         else
         {
-          if (board[targetSquare + Board::UP] == 3)
+          if (board[targetSquare + Board::UP] == 3 && isRequestedPawn(move, targetSquare + Board::UP))
             return {Move::Move(targetSquare + Board::UP, targetSquare, Move::PieceType::PAWN, {})};
         }
       }
@@ -715,13 +976,15 @@ namespace Board
     bool isCapture = std::find(move.moveTypes.begin(), move.moveTypes.end(), Move::MoveTypes::CAPTURE) != move.moveTypes.end();
 
     // TODO: FIX MULTIPLE POSSIBLE MOVES
-    int from = checkDiagonal(move.to, Move::PieceType::BISHOP, isCapture)[0];
+    std::vector<int> fromList = checkDiagonal(move.to, Move::PieceType::BISHOP, isCapture);
 
-    if (from == -1)
+    if (fromList.size() == 0)
     {
       return {};
     }
 
+    int from = move.from == -1 ? fromList[0] : move.from;
+
     if (isCapture)
     {
       if (isWhiteTurn)
@@ -930,6 +1193,9 @@ namespace Board
   {
     if (std::find(move.moveTypes.begin(), move.moveTypes.end(), Move::MoveTypes::SHORT_CASTLE) != move.moveTypes.end())
     {
+      if (!checkShortCastle())
+        return {};
+
       if (isWhiteTurn)
       {
         if (hasWhiteKingMoved || hasWhiteRookHMoved)
@@ -944,7 +1210,7 @@ namespace Board
         {
           return {};
         }
-        return {Move::Move(60, 62, Move::PieceType::KING, {Move::MoveTypes::SHORT_CASTLE})};
+        return {Move::Move(4, 6, Move::PieceType::KING, {Move::MoveTypes::SHORT_CASTLE})};
       }
       else
       {
@@ -960,12 +1226,15 @@ namespace Board
         {
           return {};
         }
-        return {Move::Move(4, 6, Move::PieceType::KING, {Move::MoveTypes::SHORT_CASTLE})};
+        return {Move::Move(60, 62, Move::PieceType::KING, {Move::MoveTypes::SHORT_CASTLE})};
       }
     }
 
     if (std::find(move.moveTypes.begin(), move.moveTypes.end(), Move::MoveTypes::LONG_CASTLE) != move.moveTypes.end())
     {
+      if (!checkLongCastle())
+        return {};
+
       if (isWhiteTurn)
       {
         if (hasWhiteKingMoved || hasWhiteRookAMoved)
@@ -980,7 +1249,7 @@ namespace Board
         {
           return {};
         }
-        return {Move::Move(60, 58, Move::PieceType::KING, {Move::MoveTypes::LONG_CASTLE})};
+        return {Move::Move(4, 2, Move::PieceType::KING, {Move::MoveTypes::LONG_CASTLE})};
       }
       else
       {
@@ -996,7 +1265,7 @@ namespace Board
         {
           return {};
         }
-        return {Move::Move(4, 2, Move::PieceType::KING, {Move::MoveTypes::LONG_CASTLE})};
+        return {Move::Move(60, 58, Move::PieceType::KING, {Move::MoveTypes::LONG_CASTLE})};
       }
     }
 
@@ -1081,11 +1350,15 @@ namespace Board
     {
       if (std::find(move.moveTypes.begin(), move.moveTypes.end(), Move::MoveTypes::PROMOTION) != move.moveTypes.end() || targetSquare >= 56 || targetSquare <= 7)
       {
+        // A capture needs an enemy piece on the target square
+        if (board[targetSquare] == Board::NONE || ((board[targetSquare] & Board::BLACK) != 0) != isWhiteTurn)
+          return {true, Move::Move(false)};
+
         if (isWhiteTurn)
         {
           if (targetSquare >= 56)
           {
-            if (move.promotionTo == -1)
+            if (move.promotionTo == Move::PieceType::NONE)
             {
               return {true, Move::Move(false)};
             }
@@ -1093,11 +1366,11 @@ namespace Board
             {
               Move::Move result = Move::Move(true);
 
-              if (targetSquare >= 7 && board[targetSquare + Board::DOWN_RIGHT] == Board::PAWN && !isOnRightBorder(targetSquare))
+              if (targetSquare >= 7 && board[targetSquare + Board::DOWN_RIGHT] == Board::PAWN && !isOnRightBorder(targetSquare) && isRequestedPawn(move, targetSquare + Board::DOWN_RIGHT))
               {
                 result = Move::Move(targetSquare + Board::DOWN_RIGHT, targetSquare, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION});
               }
-              else if (targetSquare >= 9 && board[targetSquare + Board::DOWN_LEFT] == Board::PAWN && !isOnLeftBorder(targetSquare))
+              else if (targetSquare >= 9 && board[targetSquare + Board::DOWN_LEFT] == Board::PAWN && !isOnLeftBorder(targetSquare) && isRequestedPawn(move, targetSquare + Board::DOWN_LEFT))
               {
                 result = Move::Move(targetSquare + Board::DOWN_LEFT, targetSquare, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION});
               }
@@ -1119,7 +1392,7 @@ namespace Board
         {
           if (targetSquare <= 7)
           {
-            if (move.promotionTo == -1)
+            if (move.promotionTo == Move::PieceType::NONE)
             {
               return {true, Move::Move(false)};
             }
@@ -1127,11 +1400,11 @@ namespace Board
             {
               Move::Move result = Move::Move(true);
 
-              if (targetSquare <= 56 && board[targetSquare + Board::UP_LEFT] == (Board::BLACK | Board::PAWN) && !isOnLeftBorder(targetSquare))
+              if (targetSquare <= 56 && board[targetSquare + Board::UP_LEFT] == (Board::BLACK | Board::PAWN) && !isOnLeftBorder(targetSquare) && isRequestedPawn(move, targetSquare + Board::UP_LEFT))
               {
                 result = Move::Move(targetSquare + Board::UP_LEFT, targetSquare, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION});
               }
-              else if (targetSquare <= 54 && board[targetSquare + Board::UP_RIGHT] == (Board::BLACK | Board::PAWN) && !isOnRightBorder(targetSquare))
+              else if (targetSquare <= 54 && board[targetSquare + Board::UP_RIGHT] == (Board::BLACK | Board::PAWN) && !isOnRightBorder(targetSquare) && isRequestedPawn(move, targetSquare + Board::UP_RIGHT))
               {
                 result = Move::Move(targetSquare + Board::UP_RIGHT, targetSquare, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::PROMOTION});
               }
@@ -1158,9 +1431,9 @@ namespace Board
         // Checkk for promotion
         if (std::find(move.moveTypes.begin(), move.moveTypes.end(), Move::MoveTypes::PROMOTION) != move.moveTypes.end() || targetSquare >= 56)
         {
-          if (targetSquare >= 56)
+          if (targetSquare >= 56 && board[targetSquare] == Board::NONE)
           {
-            if (move.promotionTo == -1)
+            if (move.promotionTo == Move::PieceType::NONE)
             {
               return {true, Move::Move(false)};
             }
@@ -1185,9 +1458,9 @@ namespace Board
         // Check for promotion
         if (std::find(move.moveTypes.begin(), move.moveTypes.end(), Move::MoveTypes::PROMOTION) != move.moveTypes.end() || targetSquare <= 7)
         {
-          if (targetSquare <= 7)
+          if (targetSquare <= 7 && board[targetSquare] == Board::NONE)
           {
-            if (move.promotionTo == -1)
+            if (move.promotionTo == Move::PieceType::NONE)
             {
               return {true, Move::Move(false)};
             }
@@ -1225,22 +1498,22 @@ namespace Board
 
     if (isWhiteTurn)
     {
-      if (lastMove.pieceType == Move::PieceType::PAWN && lastMove.to == targetSquare + Board::DOWN && lastMove.from == targetSquare + Board::UP && board[lastMove.to + Board::LEFT] == Board::PAWN && !isOnLeftBorder(targetSquare))
+      if (lastMove.pieceType == Move::PieceType::PAWN && lastMove.to == targetSquare + Board::DOWN && lastMove.from == targetSquare + Board::UP && board[lastMove.to + Board::LEFT] == Board::PAWN && !isOnLeftBorder(targetSquare) && isRequestedPawn(move, lastMove.to + Board::LEFT))
       {
         return {true, Move::Move(targetSquare + Board::DOWN_LEFT, targetSquare, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::EN_PASSANT})};
       }
-      else if (lastMove.pieceType == Move::PieceType::PAWN && lastMove.to == targetSquare + Board::DOWN && lastMove.from == targetSquare + Board::UP && board[lastMove.to + Board::RIGHT] == Board::PAWN && !isOnRightBorder(targetSquare))
+      else if (lastMove.pieceType == Move::PieceType::PAWN && lastMove.to == targetSquare + Board::DOWN && lastMove.from == targetSquare + Board::UP && board[lastMove.to + Board::RIGHT] == Board::PAWN && !isOnRightBorder(targetSquare) && isRequestedPawn(move, lastMove.to + Board::RIGHT))
       {
         return {true, Move::Move(targetSquare + Board::DOWN_RIGHT, targetSquare, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::EN_PASSANT})};
       }
     }
     else
     {
-      if (lastMove.pieceType == Move::PieceType::PAWN && lastMove.to == targetSquare + Board::UP && lastMove.from == targetSquare + Board::DOWN && board[lastMove.to + Board::LEFT] == (Board::PAWN | Board::BLACK) && !isOnLeftBorder(targetSquare))
+      if (lastMove.pieceType == Move::PieceType::PAWN && lastMove.to == targetSquare + Board::UP && lastMove.from == targetSquare + Board::DOWN && board[lastMove.to + Board::LEFT] == (Board::PAWN | Board::BLACK) && !isOnLeftBorder(targetSquare) && isRequestedPawn(move, lastMove.to + Board::LEFT))
       {
         return {true, Move::Move(targetSquare + Board::UP_LEFT, targetSquare, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::EN_PASSANT})};
       }
-      else if (lastMove.pieceType == Move::PieceType::PAWN && lastMove.to == targetSquare + Board::UP && lastMove.from == targetSquare + Board::DOWN && board[lastMove.to + Board::RIGHT] == (Board::PAWN | Board::BLACK) && !isOnRightBorder(targetSquare))
+      else if (lastMove.pieceType == Move::PieceType::PAWN && lastMove.to == targetSquare + Board::UP && lastMove.from == targetSquare + Board::DOWN && board[lastMove.to + Board::RIGHT] == (Board::PAWN | Board::BLACK) && !isOnRightBorder(targetSquare) && isRequestedPawn(move, lastMove.to + Board::RIGHT))
       {
         return {true, Move::Move(targetSquare + Board::UP_RIGHT, targetSquare, Move::PieceType::PAWN, {Move::MoveTypes::CAPTURE, Move::MoveTypes::EN_PASSANT})};
       }
@@ -1249,6 +1522,15 @@ namespace Board
     return {false, Move::Move(false)};
   }
 
+  bool Board::isRequestedPawn(const Move::Move &move, int from)
+  {
+    // Generated moves name the exact square, notation like "exd5" only names the file
+    if (move.disambiguationFile != -1)
+      return from % 8 == move.disambiguationFile;
+
+    return move.from == -1 || move.from == from;
+  }
+
   inline bool Board::isOnRightBorder(int square)
   {
     return square % 8 == 7;
@@ -1344,9 +1626,9 @@ namespace Board
           break;
         if (board[i] != Board::NONE)
         {
-          if ((isWhiteTurn && (board[i] & !Board::BLACK)) || (!isWhiteTurn && (board[i] & Board::BLACK)))
+          if ((isWhiteTurn && !(board[i] & Board::BLACK)) || (!isWhiteTurn && (board[i] & Board::BLACK)))
             break;
-          else if ((isWhiteTurn && (board[i] & Board::BLACK)) || (!isWhiteTurn && (board[i] & !Board::BLACK)))
+          else if ((isWhiteTurn && (board[i] & Board::BLACK)) || (!isWhiteTurn && !(board[i] & Board::BLACK)))
           {
             results.push_back({i, true});
             break;
@@ -1381,9 +1663,9 @@ namespace Board
           break;
         if (board[i] != Board::NONE)
         {
-          if ((isWhiteTurn && (board[i] & !Board::BLACK)) || (!isWhiteTurn && (board[i] & Board::BLACK)))
+          if ((isWhiteTurn && !(board[i] & Board::BLACK)) || (!isWhiteTurn && (board[i] & Board::BLACK)))
             break;
-          else if ((isWhiteTurn && (board[i] & Board::BLACK)) || (!isWhiteTurn && (board[i] & !Board::BLACK)))
+          else if ((isWhiteTurn && (board[i] & Board::BLACK)) || (!isWhiteTurn && !(board[i] & Board::BLACK)))
           {
             results.push_back({i, true});
             break;
@@ -1410,7 +1692,8 @@ namespace Board
     for (int offset : offsets)
     {
       int target = square + offset;
-      if (target >= 0 && target < 64 && square >= 0 && square < 64 && board[target] == (Board::KNIGHT | (reverseColor ? isWhiteTurn : !isWhiteTurn)))
+      if (target >= 0 && target < 64 && square >= 0 && square < 64 && abs(target % 8 - square % 8) <= 2 &&
+          board[target] == (Board::KNIGHT | (reverseColor ? isWhiteTurn : !isWhiteTurn)))
       {
         results.push_back(target);
       }
@@ -1440,7 +1723,7 @@ namespace Board
     {
       int target = square + offset;
 
-      if (!checkIfFitsInBoard(target))
+      if (!checkIfFitsInBoard(target) || checkIfCrossesBorder(square, target))
         continue;
 
       if ((isWhiteTurn && target == currentBlackKingPosition) ||
@@ -1454,22 +1737,22 @@ namespace Board
   {
     if (isWhiteTurn)
     {
-      if (square >= 0 && square < 64 && board[square + Board::UP_LEFT] == (Board::PAWN | (Board::BLACK)) && !isOnLeftBorder(square))
+      if (square + Board::UP_LEFT < 64 && square >= 0 && board[square + Board::UP_LEFT] == (Board::PAWN | (Board::BLACK)) && !isOnLeftBorder(square))
       {
         return square + Board::UP_LEFT;
       }
-      else if (square >= 0 && square < 64 && board[square + Board::UP_RIGHT] == (Board::PAWN | (Board::BLACK)) && !isOnRightBorder(square))
+      else if (square + Board::UP_RIGHT < 64 && square >= 0 && board[square + Board::UP_RIGHT] == (Board::PAWN | (Board::BLACK)) && !isOnRightBorder(square))
       {
         return square + Board::UP_RIGHT;
       }
     }
     else
     {
-      if (square >= 0 && square < 64 && board[square + Board::DOWN_LEFT] == (Board::PAWN) && !isOnLeftBorder(square))
+      if (square + Board::DOWN_LEFT >= 0 && square < 64 && board[square + Board::DOWN_LEFT] == (Board::PAWN) && !isOnLeftBorder(square))
       {
         return square + Board::DOWN_LEFT;
       }
-      else if (square >= 0 && square < 64 && board[square + Board::DOWN_RIGHT] == (Board::PAWN) && !isOnRightBorder(square))
+      else if (square + Board::DOWN_RIGHT >= 0 && square < 64 && board[square + Board::DOWN_RIGHT] == (Board::PAWN) && !isOnRightBorder(square))
       {
         return square + Board::DOWN_RIGHT;
       }
@@ -1501,11 +1784,11 @@ namespace Board
     {
       return knight[0];
     }
-    // int king = checkIfControledByEnemyKing(square);
-    // if (king != -1)
-    // {
-    //   return king;
-    // }
+    int king = checkIfControledByEnemyKing(square);
+    if (king != -1)
+    {
+      return king;
+    }
     int pawn = checkIfControledByEnemyPawn(square);
     if (pawn != -1)
     {
@@ -1516,6 +1799,10 @@ namespace Board
 
   bool Board::checkShortCastle()
   {
+    // Castling out of check is not allowed
+    if (isCheck())
+      return false;
+
     if (isWhiteTurn)
     {
       if (hasWhiteKingMoved || hasWhiteRookHMoved)
@@ -1572,12 +1859,14 @@ namespace Board
       hasBlackRookHMoved = true;
       currentBlackKingPosition = 62;
     }
-    isWhiteTurn = !isWhiteTurn;
     return true;
   }
 
   bool Board::checkLongCastle()
   {
+    if (isCheck())
+      return false;
+
     if (isWhiteTurn)
     {
       if (hasWhiteKingMoved || hasWhiteRookAMoved)
@@ -1636,7 +1925,6 @@ namespace Board
       hasBlackRookAMoved = true;
       currentBlackKingPosition = 58;
     }
-    isWhiteTurn = !isWhiteTurn;
     return true;
   }
 
@@ -1691,6 +1979,16 @@ namespace Board
       }
     }
 
+    // A rook leaving its corner, or being captured there, loses the castling right
+    if (move.from == 0 || move.to == 0)
+      hasWhiteRookAMoved = true;
+    if (move.from == 7 || move.to == 7)
+      hasWhiteRookHMoved = true;
+    if (move.from == 56 || move.to == 56)
+      hasBlackRookAMoved = true;
+    if (move.from == 63 || move.to == 63)
+      hasBlackRookHMoved = true;
+
     return true;
   }
 
@@ -1748,9 +2046,11 @@ bool Board::checkIfCrossesBorder(int square1, int square2)
 
   void Board::setGameState()
   {
-    if (isCheckmate())
+    const bool hasNoMoves = getAllValidMoves().size() == 0;
+
+    if (hasNoMoves && isCheck())
       gameState = GameState::CHECKMATE;
-    else if (isStalemate())
+    else if (hasNoMoves)
       gameState = GameState::STALEMATE;
     else if (isFiftyMoveRule())
       gameState = GameState::FIFTY_MOVE_RULE;
@@ -1788,58 +2088,13 @@ bool Board::checkIfCrossesBorder(int square1, int square2)
 
   bool Board::isFiftyMoveRule()
   {
-    return fiftyMoveRuleCounter >= 50;
+    // Fifty moves by each side
+    return fiftyMoveRuleCounter >= 100;
   }
 
   bool Board::isInsufficientMaterial()
   {
-    int whitePieces = 0;
-    int blackPieces = 0;
-
-    for (int i = 0; i < 64; i++)
-    {
-      if (board[i] != Board::NONE)
-      {
-        if (board[i] == Board::PAWN || board[i] == (Board::PAWN | Board::BLACK))
-        {
-          return false;
-        }
-        else if (board[i] == Board::ROOK || board[i] == (Board::ROOK | Board::BLACK))
-        {
-          return false;
-        }
-        else if (board[i] == Board::QUEEN || board[i] == (Board::QUEEN | Board::BLACK))
-        {
-          return false;
-        }
-        else if (board[i] == Board::KNIGHT || board[i] == (Board::KNIGHT | Board::BLACK))
-        {
-          if (whitePieces > 1 || blackPieces > 1)
-          {
-            return false;
-          }
-          else
-          {
-            whitePieces++;
-            blackPieces++;
-          }
-        }
-        else if (board[i] == Board::BISHOP || board[i] == (Board::BISHOP | Board::BLACK))
-        {
-          if (whitePieces > 1 || blackPieces > 1)
-          {
-            return false;
-          }
-          else
-          {
-            whitePieces++;
-            blackPieces++;
-          }
-        }
-      }
-    }
-
-    return true;
+    return Endgame::isInsufficientMaterial(materialKey);
   }
 
   std::string Board::getStringOfGameState() const
@@ -1877,8 +2132,8 @@ bool Board::checkIfCrossesBorder(int square1, int square2)
 
   bool Board::isOnEnemySide(int square, bool isWhite)
   {
-    if ((isWhite && square >= 32) ||
-        (!isWhite && square <= 31))
+    if ((isWhite && square <= 31) ||
+        (!isWhite && square >= 32))
       return false;
     else
       return true;
@@ -1889,121 +2144,211 @@ bool Board::checkIfCrossesBorder(int square1, int square2)
     return square[0] - 'a' + (square[1] - '1') * 8;
   }
 
-  // TODO: Check validity
   void Board::undoMove()
   {
-    if (moveHistory.size() == 0)
+    if (moveHistory.size() == 0 || moveHistory.back().pieceType == Move::PieceType::NONE)
     {
-    std::cout << "PUSTE" << "\n";
       return;
     }
 
     Move::Move lastMove = moveHistory.back();
-    std::cout << "COFAM RUCH: " << lastMove.toString() << "\n";
+    const bool movedWhite = !isWhiteTurn;
+    const int movedColor = movedWhite ? 0 : Board::BLACK;
+    const int firstRankSquare = movedWhite ? 0 : 56;
 
-    if (lastMove.pieceType == Move::PieceType::KING)
+    if (std::find(lastMove.moveTypes.begin(), lastMove.moveTypes.end(), Move::MoveTypes::SHORT_CASTLE) != lastMove.moveTypes.end())
     {
-      if (isWhiteTurn)
+      board[firstRankSquare + 4] = Board::KING | movedColor;
+      board[firstRankSquare + 5] = Board::NONE;
+      board[firstRankSquare + 6] = Board::NONE;
+      board[firstRankSquare + 7] = Board::ROOK | movedColor;
+    }
+    else if (std::find(lastMove.moveTypes.begin(), lastMove.moveTypes.end(), Move::MoveTypes::LONG_CASTLE) != lastMove.moveTypes.end())
+    {
+      board[firstRankSquare + 4] = Board::KING | movedColor;
+      board[firstRankSquare + 3] = Board::NONE;
+      board[firstRankSquare + 2] = Board::NONE;
+      board[firstRankSquare + 0] = Board::ROOK | movedColor;
+    }
+    else
+    {
+      // Promotions are stored with the pawn as the moved piece, so this also takes the promoted piece back
+      board[lastMove.from] = lastMove.pieceType | movedColor;
+
+      if (lastMove.capturedPiece != -1)
       {
-        hasWhiteKingMoved = false;
-        currentWhiteKingPosition = lastMove.from;
+        board[lastMove.to] = lastMove.capturedPiece;
       }
       else
       {
-        hasBlackKingMoved = false;
-        currentBlackKingPosition = lastMove.from;
+        board[lastMove.to] = Board::NONE;
       }
-    }
-    else if (lastMove.pieceType == Move::PieceType::ROOK)
-    {
-      if (isWhiteTurn)
+
+      if (std::find(lastMove.moveTypes.begin(), lastMove.moveTypes.end(), Move::MoveTypes::EN_PASSANT) != lastMove.moveTypes.end())
       {
-        if (lastMove.from == 0)
-        {
-          hasWhiteRookAMoved = false;
-        }
-        else if (lastMove.from == 7)
-        {
-          hasWhiteRookHMoved = false;
-        }
+        board[movedWhite ? lastMove.to + Board::DOWN : lastMove.to + Board::UP] = Board::PAWN | (movedWhite ? Board::BLACK : 0);
       }
+    }
+
+    if (lastMove.pieceType == Move::PieceType::KING)
+    {
+      if (movedWhite)
+        currentWhiteKingPosition = lastMove.from;
       else
+        currentBlackKingPosition = lastMove.from;
+    }
+
+    restoreIrreversibleState();
+    isWhiteTurn = movedWhite;
+
+    moveHistory.pop_back();
+  }
+
+  unsigned long long Board::computeHashKey() const
+  {
+    unsigned long long key = 0;
+
+    const BoardScan::PieceMasks masks = BoardScan::getPieceMasks(packedBoard);
+    for (int side = 0; side < 2; side++)
+    {
+      for (int type = 0; type < 6; type++)
       {
-        if (lastMove.from == 56)
-        {
-          hasBlackRookAMoved = false;
-        }
-        else if (lastMove.from == 63)
-        {
-          hasBlackRookHMoved = false;
-        }
+        for (std::uint64_t pieces = masks.pieces[side][type]; pieces != 0; pieces &= pieces - 1)
+          key ^= zobristKeys.pieces[6 * side + type][Attacks::getFirstSquare(pieces)];
       }
     }
 
-    if (lastMove.pieceType == Move::PieceType::PAWN)
-    {
-      Move::Move a(false);
-      a.to = lastMove.from;
-      
-      Move::Move b(false);
-      b.to = lastMove.to;
-
-      // std::cout << "ANALIZA PIONA / Z: " << a.toString() << " / DO : " << b.toString()  << std::endl;
-      // CHECK FOR INITIAL DOUBLE JUMP
-      // if(
-      //   isWhiteTurn && lastMove.from == lastMove.to + 2 * Board::DOWN ||
-      //   !isWhiteTurn && lastMove.from == lastMove.to + 2 * Board::UP ||
-      //   ) {
-
-      //   }
-      // if (std::find(lastMove.moveTypes.begin(), lastMove.moveTypes.end(), Move::MoveTypes::EN_PASSANT) != lastMove.moveTypes.end())
-      // {
-      //   std::cout << "PIONEK RUSZYL SIE Z: " << lastMove.from << " DO :"
-      //   // CHECK IF PREVIOUS MOVE WAS A DOUBLE MOVE
-      //   if(lastMove.from == lastMove.to - 16 || lastMove.from == lastMove.to + 16) {
-      //     if (isWhiteTurn)
-      //     {
-      //       board[lastMove.to + Board::DOWN * 2] = Board::PAWN | Board::COLOR;
-      //     }
-      //     else
-      //     {
-      //       board[lastMove.to + Board::UP * 2] = Board::PAWN;
-      //     }
-      //   }
-      //   else {
-      //     if (isWhiteTurn)
-      //     {
-      //       board[lastMove.to + Board::DOWN] = Board::PAWN | Board::COLOR;
-      //     }
-      //     else
-      //     {
-      //       board[lastMove.to + Board::UP] = Board::PAWN;
-      //     }
-      //   }
-
-      //   // TODO: ADD EN PASSANT
-      // }
-    }
-
-    if (std::find(lastMove.moveTypes.begin(), lastMove.moveTypes.end(), Move::MoveTypes::PROMOTION) != lastMove.moveTypes.end())
-    {
-      board[lastMove.from] = Board::PAWN | (isWhiteTurn ? 0 : Board::BLACK);
+    return key ^ computeStateKey();
+  }
+
+  unsigned long long Board::computeStateKey() const
+  {
+    unsigned long long key = 0;
+
+    if (!isWhiteTurn)
+      key ^= zobristKeys.side;
+
+    if (!hasWhiteKingMoved && !hasWhiteRookHMoved)
+      key ^= zobristKeys.castling[0];
+    if (!hasWhiteKingMoved && !hasWhiteRookAMoved)
+      key ^= zobristKeys.castling[1];
+    if (!hasBlackKingMoved && !hasBlackRookHMoved)
+      key ^= zobristKeys.castling[2];
+    if (!hasBlackKingMoved && !hasBlackRookAMoved)
+      key ^= zobristKeys.castling[3];
+
+    // En passant is only possible right after a double pawn push
+    if (moveHistory.size() > 0)
+    {
+      const Move::Move &lastMove = moveHistory.back();
+      if (lastMove.pieceType == Move::PieceType::PAWN && std::abs(lastMove.to - lastMove.from) == 16)
+        key ^= zobristKeys.enPassant[lastMove.to % 8];
     }
-    else
+
+    return key;
+  }
+
+  void Board::computePieceScores()
+  {
+    for (int square = 0; square < 64; square++)
+      packedBoard[square] = static_cast<std::uint8_t>(board[square]);
+
+    middlegameScore[0] = middlegameScore[1] = 0;
+    endgameScore[0] = endgameScore[1] = 0;
+    phase = 0;
+    materialKey = 0;
+
+    for (int side = 0; side < 2; side++)
     {
-      board[lastMove.from] = lastMove.pieceType | (isWhiteTurn ? 0 : Board::BLACK);
+      for (int type = 0; type < 6; type++)
+      {
+        const std::uint8_t piece = static_cast<std::uint8_t>((Board::PAWN << type) | side);
+        const int count = BoardScan::countPieces(packedBoard, piece);
+        middlegameScore[side] += BoardScan::sumPieceSquares(packedBoard, piece, pieceScoreTables.middlegame[side][type]);
+        endgameScore[side] += BoardScan::sumPieceSquares(packedBoard, piece, pieceScoreTables.endgame[side][type]);
+        phase += count * PieceSquareTables::phaseWeights[type];
+
+        if (type != 5)
+          materialKey += count * getMaterialKeyStep(side, type);
+      }
     }
 
+    // A fresh position has no moves to replay
+    pieceChanges.clear();
+  }
+
+  void Board::updatePieceScore(unsigned long long piece, int square, int sign)
+  {
+    // PAWN = 2 ... KING = 64 become 0 ... 5
+    const int type = getZobristPieceIndex(piece & ~Board::BLACK);
+    const int side = piece & Board::BLACK;
+    const int tableSquare = side ? square ^ 56 : square;
+
+    middlegameScore[side] += sign * (PieceSquareTables::middlegameValues[type] + PieceSquareTables::middlegameTables[type][tableSquare]);
+    endgameScore[side] += sign * (PieceSquareTables::endgameValues[type] + PieceSquareTables::endgameTables[type][tableSquare]);
+    phase += sign * PieceSquareTables::phaseWeights[type];
+
+    // Kings never come off, they have no place in the key
+    if (type != 5)
+      materialKey = sign > 0 ? materialKey + getMaterialKeyStep(side, type) : materialKey - getMaterialKeyStep(side, type);
+
+    // Adding and taking away a piece are the same xor
+    const unsigned long long pieceKey = zobristKeys.pieces[6 * side + type][square];
+    hashKey ^= pieceKey;
+    if (type == 0)
+      pawnKey ^= pieceKey;
+
+    // A capture puts the moving piece on the square before the captured one comes off, that leaves the square alone
+    if (sign > 0)
+      packedBoard[square] = static_cast<std::uint8_t>(piece);
+    else if (packedBoard[square] == piece)
+      packedBoard[square] = Board::NONE;
+
+    pieceChanges.push_back({piece, square, sign});
+  }
+
+  int Board::getPieceCount(bool white, int type) const
+  {
+    return static_cast<int>((materialKey >> (4 * (5 * (white ? 0 : 1) + type))) & 15);
+  }
+
+  bool Board::probeKPK(int &result) const
+  {
+    const bool isWhitePawn = materialKey == getMaterialKeyStep(0, 0);
+    if (!isWhitePawn && materialKey != getMaterialKeyStep(1, 0))
+      return false;
+
+    // The bitbase plays the pawn up the board, a black pawn is seen from the other side
+    const int strongSide = isWhitePawn ? 0 : 1;
+    const int flip = isWhitePawn ? 0 : 56;
+    const int pawn = Attacks::getFirstSquare(BoardScan::getPieceMask(packedBoard, Board::PAWN | strongSide)) ^ flip;
+    if (pawn < 8 || pawn >= 56)
+      return false;
+
+    const int strongKing = (isWhitePawn ? currentWhiteKingPosition : currentBlackKingPosition) ^ flip;
+    const int weakKing = (isWhitePawn ? currentBlackKingPosition : currentWhiteKingPosition) ^ flip;
+
+    const bool isWin = Bitbase::probeKPK(strongKing, pawn, weakKing, isWhiteTurn == isWhitePawn);
+    result = !isWin ? 0 : isWhitePawn ? 1 : -1;
+    return true;
+  }
 
-    if(lastMove.capturedPiece != -1) {
-      board[lastMove.to] = lastMove.capturedPiece | (!isWhiteTurn);
-    } else {
-      board[lastMove.to] = Board::NONE;
+  int Board::getTaperedScore(bool white) const
+  {
+    const int side = white ? 0 : 1;
+    return PieceSquareTables::taper(middlegameScore[side], endgameScore[side], phase);
+  }
+
+  unsigned long long Board::computePawnKey() const
+  {
+    unsigned long long key = 0;
+
+    for (int side = 0; side < 2; side++)
+    {
+      for (std::uint64_t pawns = BoardScan::getPieceMask(packedBoard, Board::PAWN | side); pawns != 0; pawns &= pawns - 1)
+        key ^= zobristKeys.pieces[6 * side][Attacks::getFirstSquare(pawns)];
     }
-    // std::cout << "Dochodzinmy do konca : " << lastMove.capturedPiece << "\n";
-    board[lastMove.from] = lastMove.pieceType | isWhiteTurn;
-    isWhiteTurn = !isWhiteTurn;
 
-    moveHistory.pop_back();
+    return key;
   }
 }
@@ -0,0 +1,250 @@
+#include "BoardScan.hpp"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CHESSBOT_SCAN_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+  struct Kernels {
+    BoardScan::Kernel kernel;
+    std::uint64_t (*getPieceMask)(const std::uint8_t *squares, std::uint8_t piece);
+    std::uint64_t (*getOccupiedMask)(const std::uint8_t *squares);
+    BoardScan::PieceMasks (*getPieceMasks)(const std::uint8_t *squares);
+    int (*sumPieceSquares)(const std::uint8_t *squares, std::uint8_t piece, const std::int16_t *table);
+  };
+
+  // PAWN = 2 ... KING = 64 of Board::Board, the lowest bit is black
+  std::uint8_t getPieceCode(int side, int type) {
+    return static_cast<std::uint8_t>((2 << type) | side);
+  }
+
+  std::uint64_t getPieceMaskScalar(const std::uint8_t *squares, std::uint8_t piece) {
+    std::uint64_t mask = 0;
+    for (int square = 0; square < 64; square++)
+      mask |= static_cast<std::uint64_t>(squares[square] == piece) << square;
+    return mask;
+  }
+
+  std::uint64_t getOccupiedMaskScalar(const std::uint8_t *squares) {
+    std::uint64_t mask = 0;
+    for (int square = 0; square < 64; square++)
+      mask |= static_cast<std::uint64_t>(squares[square] != 0) << square;
+    return mask;
+  }
+
+  BoardScan::PieceMasks getPieceMasksScalar(const std::uint8_t *squares) {
+    BoardScan::PieceMasks masks;
+    for (int square = 0; square < 64; square++) {
+      const int piece = squares[square];
+      if (piece != 0)
+        masks.pieces[piece & 1][__builtin_ctz(piece & ~1) - 1] |= 1ULL << square;
+    }
+    return masks;
+  }
+
+  int sumPieceSquaresScalar(const std::uint8_t *squares, std::uint8_t piece, const std::int16_t *table) {
+    int sum = 0;
+    for (int square = 0; square < 64; square++) {
+      if (squares[square] == piece)
+        sum += table[square];
+    }
+    return sum;
+  }
+
+#ifdef CHESSBOT_SCAN_X86
+  // SSE2: the board is four registers of 16 squares
+
+  __attribute__((target("sse2"))) std::uint64_t getMaskSse2(const __m128i (&rows)[4], __m128i code) {
+    std::uint64_t mask = 0;
+    for (int row = 0; row < 4; row++) {
+      const unsigned int bits = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(rows[row], code)));
+      mask |= static_cast<std::uint64_t>(bits) << (16 * row);
+    }
+    return mask;
+  }
+
+  __attribute__((target("sse2"))) void loadRowsSse2(const std::uint8_t *squares, __m128i (&rows)[4]) {
+    for (int row = 0; row < 4; row++)
+      rows[row] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(squares + 16 * row));
+  }
+
+  __attribute__((target("sse2"))) std::uint64_t getPieceMaskSse2(const std::uint8_t *squares, std::uint8_t piece) {
+    __m128i rows[4];
+    loadRowsSse2(squares, rows);
+    return getMaskSse2(rows, _mm_set1_epi8(static_cast<char>(piece)));
+  }
+
+  __attribute__((target("sse2"))) std::uint64_t getOccupiedMaskSse2(const std::uint8_t *squares) {
+    __m128i rows[4];
+    loadRowsSse2(squares, rows);
+    return ~getMaskSse2(rows, _mm_setzero_si128());
+  }
+
+  __attribute__((target("sse2"))) BoardScan::PieceMasks getPieceMasksSse2(const std::uint8_t *squares) {
+    __m128i rows[4];
+    loadRowsSse2(squares, rows);
+
+    BoardScan::PieceMasks masks;
+    for (int side = 0; side < 2; side++) {
+      for (int type = 0; type < 6; type++)
+        masks.pieces[side][type] = getMaskSse2(rows, _mm_set1_epi8(static_cast<char>(getPieceCode(side, type))));
+    }
+    return masks;
+  }
+
+  // The byte compare gives 0 or -1 per square, interleaving it with itself widens that to a 16 bit mask over the
+  // table entries of the same squares
+  __attribute__((target("sse2"))) int sumPieceSquaresSse2(const std::uint8_t *squares, std::uint8_t piece, const std::int16_t *table) {
+    const __m128i code = _mm_set1_epi8(static_cast<char>(piece));
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+
+    for (int square = 0; square < 64; square += 16) {
+      const __m128i matches = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(squares + square)), code);
+      const __m128i low = _mm_and_si128(_mm_unpacklo_epi8(matches, matches), _mm_loadu_si128(reinterpret_cast<const __m128i *>(table + square)));
+      const __m128i high = _mm_and_si128(_mm_unpackhi_epi8(matches, matches), _mm_loadu_si128(reinterpret_cast<const __m128i *>(table + square + 8)));
+      sum = _mm_add_epi32(sum, _mm_madd_epi16(low, ones));
+      sum = _mm_add_epi32(sum, _mm_madd_epi16(high, ones));
+    }
+
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+  }
+
+  // AVX2: the board is two registers of 32 squares
+
+  __attribute__((target("avx2"))) std::uint64_t getMaskAvx2(__m256i low, __m256i high, __m256i code) {
+    const unsigned int lowBits = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, code)));
+    const unsigned int highBits = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, code)));
+    return static_cast<std::uint64_t>(lowBits) | static_cast<std::uint64_t>(highBits) << 32;
+  }
+
+  __attribute__((target("avx2"))) std::uint64_t getPieceMaskAvx2(const std::uint8_t *squares, std::uint8_t piece) {
+    return getMaskAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(squares)),
+                       _mm256_loadu_si256(reinterpret_cast<const __m256i *>(squares + 32)),
+                       _mm256_set1_epi8(static_cast<char>(piece)));
+  }
+
+  __attribute__((target("avx2"))) std::uint64_t getOccupiedMaskAvx2(const std::uint8_t *squares) {
+    return ~getMaskAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(squares)),
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(squares + 32)), _mm256_setzero_si256());
+  }
+
+  __attribute__((target("avx2"))) BoardScan::PieceMasks getPieceMasksAvx2(const std::uint8_t *squares) {
+    const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(squares));
+    const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(squares + 32));
+
+    BoardScan::PieceMasks masks;
+    for (int side = 0; side < 2; side++) {
+      for (int type = 0; type < 6; type++)
+        masks.pieces[side][type] = getMaskAvx2(low, high, _mm256_set1_epi8(static_cast<char>(getPieceCode(side, type))));
+    }
+    return masks;
+  }
+
+  // Unpacking works within 128 bit lanes on AVX2, so each half of the compare is sign extended to 16 squares instead
+  __attribute__((target("avx2"))) int sumPieceSquaresAvx2(const std::uint8_t *squares, std::uint8_t piece, const std::int16_t *table) {
+    const __m256i code = _mm256_set1_epi8(static_cast<char>(piece));
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+
+    for (int square = 0; square < 64; square += 32) {
+      const __m256i matches = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(squares + square)), code);
+      const __m256i low = _mm256_and_si256(_mm256_cvtepi8_epi16(_mm256_castsi256_si128(matches)),
+                                           _mm256_loadu_si256(reinterpret_cast<const __m256i *>(table + square)));
+      const __m256i high = _mm256_and_si256(_mm256_cvtepi8_epi16(_mm256_extracti128_si256(matches, 1)),
+                                            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(table + square + 16)));
+      sum = _mm256_add_epi32(sum, _mm256_madd_epi16(low, ones));
+      sum = _mm256_add_epi32(sum, _mm256_madd_epi16(high, ones));
+    }
+
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    return _mm_cvtsi128_si32(half);
+  }
+#endif
+
+  Kernels getKernels(BoardScan::Kernel kernel) {
+    switch (kernel) {
+#ifdef CHESSBOT_SCAN_X86
+    case BoardScan::Kernel::AVX2:
+      return {kernel, getPieceMaskAvx2, getOccupiedMaskAvx2, getPieceMasksAvx2, sumPieceSquaresAvx2};
+    case BoardScan::Kernel::SSE2:
+      return {kernel, getPieceMaskSse2, getOccupiedMaskSse2, getPieceMasksSse2, sumPieceSquaresSse2};
+#endif
+    default:
+      return {BoardScan::Kernel::SCALAR, getPieceMaskScalar, getOccupiedMaskScalar, getPieceMasksScalar, sumPieceSquaresScalar};
+    }
+  }
+
+  Kernels &getCurrentKernels() {
+    static Kernels kernels = getKernels(BoardScan::isSupported(BoardScan::Kernel::AVX2)   ? BoardScan::Kernel::AVX2
+                                        : BoardScan::isSupported(BoardScan::Kernel::SSE2) ? BoardScan::Kernel::SSE2
+                                                                                          : BoardScan::Kernel::SCALAR);
+    return kernels;
+  }
+}
+
+namespace BoardScan
+{
+  std::uint64_t getPieceMask(const std::uint8_t *squares, std::uint8_t piece)
+  {
+    return getCurrentKernels().getPieceMask(squares, piece);
+  }
+
+  std::uint64_t getOccupiedMask(const std::uint8_t *squares)
+  {
+    return getCurrentKernels().getOccupiedMask(squares);
+  }
+
+  PieceMasks getPieceMasks(const std::uint8_t *squares)
+  {
+    return getCurrentKernels().getPieceMasks(squares);
+  }
+
+  int countPieces(const std::uint8_t *squares, std::uint8_t piece)
+  {
+    return __builtin_popcountll(getPieceMask(squares, piece));
+  }
+
+  int sumPieceSquares(const std::uint8_t *squares, std::uint8_t piece, const std::int16_t *table)
+  {
+    return getCurrentKernels().sumPieceSquares(squares, piece, table);
+  }
+
+  Kernel getKernel()
+  {
+    return getCurrentKernels().kernel;
+  }
+
+  bool isSupported(Kernel kernel)
+  {
+    switch (kernel)
+    {
+    case Kernel::SCALAR:
+      return true;
+#ifdef CHESSBOT_SCAN_X86
+    case Kernel::SSE2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("sse2");
+    case Kernel::AVX2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+    }
+  }
+
+  bool setKernel(Kernel kernel)
+  {
+    if (!isSupported(kernel))
+      return false;
+
+    getCurrentKernels() = getKernels(kernel);
+    return true;
+  }
+} // namespace BoardScan
@@ -1,20 +1,66 @@
 #include "Brain.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include "BatchEvaluation.hpp"
+#include "Bitbase.hpp"
+#include "Endgame.hpp"
+#include "Evaluation.hpp"
 #include "Menu.hpp"
 
+#ifdef CHESSBOT_COMPILED_NEURONS
+#include "CompiledNeurons.hpp"
+#endif
+
+namespace {
+  constexpr int reductionTableSize = 64;
+
+  // Late move reductions grow with the logarithm of both the depth and the move number
+  std::array<std::array<int, reductionTableSize>, reductionTableSize> buildReductionTable() {
+    std::array<std::array<int, reductionTableSize>, reductionTableSize> table{};
+
+    for (int depth = 1; depth < reductionTableSize; ++depth) {
+      for (int moveNumber = 1; moveNumber < reductionTableSize; ++moveNumber) {
+        table[depth][moveNumber] = static_cast<int>(0.75 + std::log(depth) * std::log(moveNumber) / 2.25);
+      }
+    }
+
+    return table;
+  }
+
+  std::uint64_t mixBits(std::uint64_t value) {
+    // splitmix64 finalizer
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+  }
+}
+
 namespace Brain
 {
   Brain::Brain()
   {
-    this->neurons = readNeurons();
+    setNeurons(getStartingNeurons());
+
+    // Generated up front, not by the first probe in the middle of a timed search
+    Bitbase::init();
   }
 
   Brain::Brain(const std::string& FEN) {
-    this->neurons = readNeurons();
+    setNeurons(getStartingNeurons());
+    Bitbase::init();
     this->realBoard.setFromFEN(FEN);
     this->testBoard.setFromFEN(FEN);
   }
 
+  Brain::~Brain()
+  {
+    stopPondering();
+  }
+
   bool Brain::makeRealMove(Move::Move move)
   {
     // auto moves = realBoard.getAllValidMoves();
@@ -26,21 +72,73 @@ namespace Brain
     // }
 
     // this->testBoard.makeMove(move);
-    std::cout << "QUEEN MOVES: " << std::endl;
-    for (auto &move : realBoard.getAllQueenMoves())
-      {
-      std::cout << move.toString() << " " << move.to << std::endl;
-    }
+
+    // On a ponder hit the pondering search already stands on the new position, so the test board is left to it
+    const bool isPonderHit = isPondering() && move.from == ponderMove.from && move.to == ponderMove.to &&
+                             (move.promotionTo == ponderMove.promotionTo ||
+                              (move.promotionTo == Move::PieceType::NONE && ponderMove.promotionTo == Move::PieceType::QUEEN));
+
+    if (!isPonderHit)
+      stopPondering();
 
     bool success = this->realBoard.makeMove(move);
 
-    if(success) {
+    if(success && !isPonderHit) {
       this->testBoard = this->realBoard;
     }
 
     return success;
   }
 
+  void Brain::startPondering()
+  {
+    stopPondering();
+
+    // The expected reply is the best move the last search found for the opponent
+    TranspositionTable::Entry entry;
+    if (!this->transpositionTable.probe(this->realBoard.hashKey, entry) || entry.from < 0)
+      return;
+
+    const Move::Move expectedReply = this->realBoard.getValidMove(entry.from, entry.to, static_cast<Move::PieceType>(entry.promotionTo));
+
+    this->testBoard = this->realBoard;
+    if (!expectedReply.isValid || !this->testBoard.makeMove(expectedReply))
+    {
+      this->testBoard = this->realBoard;
+      return;
+    }
+
+    this->ponderMove = expectedReply;
+    this->searchStatistics = SearchStatistics();
+    this->pawnStructure.resetStatistics();
+    this->evaluationCache.resetStatistics();
+    this->transpositionTable.newSearch();
+    this->timeManager.startPondering();
+
+    this->ponderThread = std::thread([this]()
+                                     { this->ponderResult = iterativeDeepening(); });
+  }
+
+  void Brain::stopPondering()
+  {
+    if (!this->ponderThread.joinable())
+      return;
+
+    this->timeManager.stop();
+    this->ponderThread.join();
+    this->testBoard = this->realBoard;
+  }
+
+  bool Brain::isPondering() const
+  {
+    return this->ponderThread.joinable();
+  }
+
+  Move::Move Brain::getPonderMove() const
+  {
+    return this->ponderMove;
+  }
+
   bool Brain::makeTestMove(Move::Move move)
   {
     // auto moves = realBoard.getAllValidMoves();
@@ -55,357 +153,1011 @@ namespace Brain
     return this->testBoard.makeMove(move);
   }
 
-  double Brain::evaluatePosition()
+  Score::Score Brain::evaluatePosition()
+  {
+    return evaluateFor(isWhite);
+  }
+
+  std::vector<Score::Score> Brain::evaluateBatch(const std::vector<BatchEvaluation::PackedPosition> &positions)
+  {
+    if (!this->batchEvaluator)
+      this->batchEvaluator = std::make_unique<BatchEvaluation::BatchEvaluator>();
+
+    return this->batchEvaluator->evaluate(BatchEvaluation::PositionBatch(positions), this->neurons);
+  }
+
+  Score::Score Brain::evaluateFor(bool white)
+  {
+    return evaluateFor(white, -Score::infinite, Score::infinite);
+  }
+
+  Score::Score Brain::evaluateFor(bool white, Score::Score alpha, Score::Score beta)
   {
-    double result = 0;
+    const Endgame::Entry *endgame = searchOptions.useEndgames ? Endgame::probe(this->testBoard.materialKey) : nullptr;
+    if (endgame == nullptr)
+      return evaluateGeneral(white, alpha, beta);
 
-    for (auto &node : neurons)
+    if (endgame->evaluate != nullptr)
     {
-      result += evaluateNode(node);
+      const Score::Score score = endgame->evaluate(this->testBoard, endgame->strongSide);
+      return white == (endgame->strongSide == 0) ? score : -score;
     }
 
+    // A lazy exit on the unscaled terms says nothing about the scaled score
+    return evaluateGeneral(white, -Score::infinite, Score::infinite) * endgame->scale(this->testBoard) / Endgame::fullScale;
+  }
+
+  Score::Score Brain::evaluateGeneral(bool white, Score::Score alpha, Score::Score beta)
+  {
+    // The network scores for the side to move, in centipawns like the neurons
+    if (searchOptions.useNetwork && network.isLoaded())
+    {
+      const Score::Score score = network.evaluate(this->testBoard);
+      return white == this->testBoard.isWhiteTurn ? score : -score;
+    }
+
+    // Cached from white's point of view, black gets the same score negated
+    const std::uint64_t key = this->testBoard.hashKey ^ this->neuronsKey;
+    Score::Score whiteScore;
+
+    if (!searchOptions.useEvaluationCache || !evaluationCache.probe(key, whiteScore))
+    {
+      const Score::Score cheapScore = evaluateSide(true, true) - evaluateSide(false, true);
+
+      // Only a partial score, it is not cached
+      if (searchOptions.useLazyEvaluation && beta - alpha < 2 * Score::infinite)
+      {
+        const Score::Score score = white ? cheapScore : -cheapScore;
+        searchStatistics.lazyEvaluationProbes++;
+
+        if (score - searchOptions.lazyEvaluationMargin >= beta || score + searchOptions.lazyEvaluationMargin <= alpha)
+        {
+          searchStatistics.lazyEvaluationExits++;
+          return score;
+        }
+      }
+
+      // Both sides read their attack sets from the same bitboards
+      this->evaluationBitboards = Attacks::Bitboards(this->testBoard);
+      whiteScore = cheapScore + evaluateSide(true, false) - evaluateSide(false, false);
+
+      if (searchOptions.useEvaluationCache)
+        evaluationCache.store(key, whiteScore);
+    }
+
+    return white ? whiteScore : -whiteScore;
+  }
+
+  void Brain::setNeurons(const std::vector<EvaluationNode> &neurons)
+  {
+    this->neurons = neurons;
+
+    this->neuronWeights.clear();
+    for (const auto &node : neurons)
+      this->neuronWeights.push_back(Score::toWeight(node.value));
+
+    // Scores cached under other weights no longer match any key
+    std::uint64_t key = 0;
+    for (const auto &node : neurons)
+    {
+      std::uint64_t valueBits;
+      std::memcpy(&valueBits, &node.value, sizeof(valueBits));
+      key = mixBits(key ^ static_cast<std::uint64_t>(node.type));
+      key = mixBits(key ^ valueBits);
+    }
+    this->neuronsKey = key;
+
+#ifdef CHESSBOT_COMPILED_NEURONS
+    this->usesCompiledNeurons = std::equal(neurons.begin(), neurons.end(), std::begin(CompiledNeurons::nodes), std::end(CompiledNeurons::nodes),
+                                           [](const EvaluationNode &first, const EvaluationNode &second)
+                                           { return first.type == second.type && first.value == second.value; });
+#endif
+  }
+
+  const std::vector<EvaluationNode> &Brain::getNeurons() const
+  {
+    return this->neurons;
+  }
+
+  bool Brain::reloadNeuronsIfChanged()
+  {
+    std::error_code error;
+    const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(neuronsSource, error);
+    if (error || writeTime == this->neuronsWriteTime)
+      return false;
+
+    // Caught in the middle of being saved, the next write brings it back
+    try
+    {
+      const std::vector<EvaluationNode> neurons = readNeurons();
+      if (neurons.empty())
+        return false;
+
+      setNeurons(neurons);
+      return true;
+    }
+    catch (const std::exception &)
+    {
+      return false;
+    }
+  }
+
+  Score::Score Brain::evaluateSide(bool white, bool cheapTerms)
+  {
+#ifdef CHESSBOT_COMPILED_NEURONS
+    if (this->usesCompiledNeurons)
+    {
+      constexpr auto indices = std::make_index_sequence<std::size(CompiledNeurons::nodes)>();
+      return cheapTerms ? evaluateCompiledSide<true>(white, indices) : evaluateCompiledSide<false>(white, indices);
+    }
+#endif
+
+    Score::Score result = 0;
+
+    for (std::size_t i = 0; i < neurons.size(); i++)
+    {
+      if (isCheap(neurons[i].type) == cheapTerms)
+        result += evaluateNode(neurons[i].type, neuronWeights[i], white);
+    }
+
+    return result;
+  }
+
+  constexpr bool Brain::isCheap(EvaluationTypes type)
+  {
+    // Material and piece-square sums are kept up to date by the board and the pawn terms almost always come from the
+    // pawn table, king safety and piece activity build attack sets from scratch
+    return type == EvaluationTypes::MATERIAL || type == EvaluationTypes::SPACE || type == EvaluationTypes::PAWN_STRUCTURE;
+  }
+
+  template <EvaluationTypes type>
+  Score::Score Brain::evaluateTerm(bool white)
+  {
+    if constexpr (type == EvaluationTypes::MATERIAL)
+      return calculateMaterialDifference(white);
+    else if constexpr (type == EvaluationTypes::SPACE)
+      return evaluateSpace(white);
+    else if constexpr (type == EvaluationTypes::KING_SAFETY)
+      return evaluateKingSafety(white);
+    else if constexpr (type == EvaluationTypes::PIECE_ACTIVITY)
+      return evaluatePieceActivity(white);
+    else if constexpr (type == EvaluationTypes::PAWN_STRUCTURE)
+      return pawnStructure.probe(this->testBoard).score[white ? 0 : 1];
+    else
+      return 0;
+  }
+
+#ifdef CHESSBOT_COMPILED_NEURONS
+  template <bool cheapTerms, std::size_t... indices>
+  Score::Score Brain::evaluateCompiledSide(bool white, std::index_sequence<indices...>)
+  {
+    // Added up left to right like the runtime loop, so both give exactly the same score
+    Score::Score result = 0;
+    (addCompiledTerm<cheapTerms, indices>(white, result), ...);
     return result;
   }
 
+  template <bool cheapTerms, std::size_t index>
+  void Brain::addCompiledTerm(bool white, Score::Score &result)
+  {
+    constexpr EvaluationNode node = CompiledNeurons::nodes[index];
+    constexpr Score::Weight weight = Score::toWeight(node.value);
+    if constexpr (isCheap(node.type) == cheapTerms && weight != 0)
+      result += Score::applyWeight(evaluateTerm<node.type>(white), weight);
+  }
+#endif
+
   Move::Move Brain::findBestMove()
   {
-    // std::cout << "WG BOTA TURA: " << (this->testBoard.isWhiteTurn ? "BIALEGO" : "CZARNEGO") << "\n";
+    return findBestMove(TimeManager::TimeControl());
+  }
+
+  Move::Move Brain::findBestMove(const TimeManager::TimeControl &timeControl)
+  {
+    // Still pondering means the opponent played the expected move, the search goes on with the clock running
+    if (isPondering())
+    {
+      timeManager.ponderHit(timeControl, searchOptions.maxDepth);
+      this->ponderThread.join();
+      return this->ponderResult;
+    }
+
+    if (searchOptions.reloadNeurons)
+      reloadNeuronsIfChanged();
+
+    searchStatistics = SearchStatistics();
+    pawnStructure.resetStatistics();
+    evaluationCache.resetStatistics();
+    transpositionTable.newSearch();
+    timeManager.start(timeControl);
+
+    if (searchOptions.useOpeningBook && openingBook.isOpen())
+    {
+      Move::Move bookMove = openingBook.probe(this->testBoard, searchOptions.bookSelection);
+      if (bookMove.isValid)
+        return bookMove;
+    }
+
+    return iterativeDeepening();
+  }
+
+  Move::Move Brain::findMate(int maxPlies)
+  {
+    searchStatistics = SearchStatistics();
+    Move::Move mateMove(false);
+
+    // Mates end on a move of the attacker, trying the odd lengths in turn makes the first one found the shortest
+    for (int plies = 1; plies <= maxPlies; plies += 2)
+    {
+      const bool isMate = mateSearch.solve(this->testBoard, plies, mateMove);
+      searchStatistics.nodes += mateSearch.getNodes();
+
+      if (isMate)
+      {
+        searchStatistics.depth = plies;
+        searchStatistics.score = Score::mateIn(plies);
+        return mateMove;
+      }
+    }
+
+    return Move::Move(false);
+  }
+
+  Move::Move Brain::iterativeDeepening()
+  {
     auto moves = this->testBoard.getAllValidMoves();
 
-    // std::cout << "size: " << moves.size() << std::endl;
-    // for (auto &move : moves)
-    // {
-    //   std::cout << move.toString() << " " << move.to << std::endl;
-    // }
+    // A won or lost endgame is played straight from the tables, a drawn one is searched among the drawing moves only
+    Tablebase::ProbeResult rootResult;
+    Syzygy::Wdl rootWdl;
+    if (searchOptions.useTablebase && tablebase.isAvailable() && tablebase.probeRoot(this->testBoard, moves, rootResult))
+    {
+      searchStatistics.tablebaseHits++;
+
+      if (rootResult.wdl != Tablebase::Wdl::DRAW)
+      {
+        SearchLine line;
+        line.score = scoreFromTablebase(rootResult, 0);
+        line.principalVariation.push_back(moves[0]);
+        searchLines = {line};
+        searchStatistics.score = line.score;
+        return moves[0];
+      }
+    }
+    // The Syzygy tables know the result, the moves are kept and ordered by the distance to the next capture or pawn move
+    // and the fifty move counter. A win or a loss the rule cannot change is played straight from them
+    else if (searchOptions.useTablebase && syzygy.isAvailable() && syzygy.probeRoot(this->testBoard, moves, rootWdl))
+    {
+      searchStatistics.tablebaseHits++;
+
+      if (rootWdl == Syzygy::Wdl::WIN || rootWdl == Syzygy::Wdl::LOSS)
+      {
+        SearchLine line;
+        line.score = scoreFromSyzygy(rootWdl, 0);
+        line.principalVariation.push_back(moves[0]);
+        searchLines = {line};
+        searchStatistics.score = line.score;
+        return moves[0];
+      }
+    }
+
+    TranspositionTable::Entry entry;
+    Move::Move hashMove(false);
+    if (searchOptions.useTranspositionTable && transpositionTable.probe(this->testBoard.hashKey, entry) && entry.from >= 0)
+      hashMove = Move::Move(entry.from, entry.to, Move::PieceType::NONE, {}, static_cast<Move::PieceType>(entry.promotionTo));
+
+    orderMoves(moves, hashMove);
 
-    double bestScore = -1000000;
     Move::Move bestMove(true);
 
-    for (auto &move : moves)
+    if (moves.size() > 0)
+      bestMove = moves[0];
+
+    searchLines.clear();
+
+    const int lineCount = std::min(std::max(searchOptions.multiPv, 1), static_cast<int>(moves.size()));
+
+    // On the clock the depth is limited by time alone, a ponder hit without one hands maxDepth to the time manager
+    const int depthLimit = timeManager.isActive() ? maxPly - 1 : searchOptions.maxDepth;
+
+    // Iterative deepening, each iteration searches the best moves of the previous one first
+    for (int depth = 1; depth <= depthLimit && timeManager.canStartIteration(); depth++)
     {
-      // std::cout << "WG BOTA TURA: " << (this->testBoard.isWhiteTurn ? "BIALEGO" : "CZARNEGO") << "\n";
+      timeManager.startIteration(depth);
 
-      // auto xd = this->testBoard.getAllValidMoves();
+      const long long nodesBeforeIteration = searchStatistics.nodes;
+      const long long timeBeforeIteration = searchStatistics.getElapsedTime();
 
+      // Every line searches the root without the moves of the lines above it, all of them share the transposition table
+      std::vector<SearchLine> iterationLines;
+      std::vector<Move::Move> excludedMoves;
+      Move::Move iterationBestMove = bestMove;
 
+      for (int lineIndex = 0; lineIndex < lineCount; lineIndex++)
+      {
+        const Score::Score previousScore = lineIndex < static_cast<int>(searchLines.size()) ? searchLines[lineIndex].score : 0;
+        Move::Move lineBestMove(false);
 
-      // std::cout <<"KRUWAAA: " << move.toString() << "\n";
+        const Score::Score score = searchLine(moves, depth, previousScore, excludedMoves, lineBestMove);
 
-    //   for (auto &move : xd)
-    // {
-    //   std::cout << move.toString() << " " << move.to << std::endl;
-    // }
+        if (lineIndex == 0 && lineBestMove.isValid)
+          iterationBestMove = lineBestMove;
 
-      auto v = this->testBoard.makeMove(move);
-      // std::cout << "Valid? " << v << "\n";
-      double score = evaluatePosition();
-      this->testBoard.undoMove();
-      
-      
-      // std::cout <<"BOARD PO TESCIE " << "\n";
-      // Menu::printBoard(this->testBoard);
-      
-      // std::cout << "PO WSZYSTKIM WG BOTA TURA: " << (this->testBoard.isWhiteTurn ? "BIALEGO" : "CZARNEGO") << "\n\n\n\n";
-    // std::cout << "TESTUJE RUCH: " << move.toString() << std::endl;
+        if (timeManager.shouldStop(searchStatistics.nodes) || !lineBestMove.isValid)
+          break;
 
-      if (score > bestScore)
+        SearchLine line;
+        line.score = score;
+        line.principalVariation = getPrincipalVariation(lineBestMove, depth);
+        iterationLines.push_back(line);
+        excludedMoves.push_back(lineBestMove);
+      }
+
+      // An interrupted iteration has not looked at every move, only completed ones are trusted,
+      // except for the first one where any searched move beats the blind guess from move ordering
+      if (timeManager.shouldStop(searchStatistics.nodes) || iterationLines.empty())
       {
-        bestScore = score;
-        bestMove = move;
+        if (depth == 1)
+          bestMove = iterationBestMove;
+        break;
+      }
+
+      // A later line can come back above an earlier one when the shared table or the pruning shaped them differently,
+      // the best scoring line is the move to play
+      std::stable_sort(iterationLines.begin(), iterationLines.end(), [](const SearchLine &first, const SearchLine &second)
+                       { return first.score > second.score; });
+      iterationBestMove = iterationLines[0].principalVariation[0];
+
+      const Score::Score score = iterationLines[0].score;
+
+      if (depth > 1)
+        timeManager.updateIteration(!isSameMove(iterationBestMove, bestMove), Score::toPawns(searchStatistics.score - score));
+
+      bestMove = iterationBestMove;
+      searchLines = iterationLines;
+      searchStatistics.depth = depth;
+      searchStatistics.score = score;
+      searchStatistics.iterationNodes.push_back(searchStatistics.nodes - nodesBeforeIteration);
+      searchStatistics.iterationTimes.push_back(searchStatistics.getElapsedTime() - timeBeforeIteration);
+      searchStatistics.hashfull = transpositionTable.getHashfull();
+      searchStatistics.pawnHashProbes = pawnStructure.getProbes();
+      searchStatistics.pawnHashHits = pawnStructure.getHits();
+      searchStatistics.evaluationCacheProbes = evaluationCache.getProbes();
+      searchStatistics.evaluationCacheHits = evaluationCache.getHits();
+
+      if (searchOptions.useTranspositionTable)
+        transpositionTable.store(this->testBoard.hashKey, scoreToTranspositionTable(score, 0), depth, TranspositionTable::Bound::EXACT, bestMove);
+
+      // The next iteration searches the lines in the order they were found
+      std::stable_sort(moves.begin(), moves.end(), [&](const Move::Move &first, const Move::Move &second)
+                       { return getLineIndex(first) < getLineIndex(second); });
+
+      if (infoOutput != nullptr && !timeManager.isPondering())
+      {
+        for (size_t lineIndex = 0; lineIndex < searchLines.size(); lineIndex++)
+          printSearchInfo(searchLines[lineIndex], lineIndex + 1);
       }
+
+      // No point in searching deeper once a forced mate has been found, unless other lines still want their scores
+      if (std::abs(score) >= Score::mateBound && lineCount == 1)
+        break;
     }
 
     return bestMove;
   }
 
-  double Brain::evaluateNode(EvaluationNode node)
+  Score::Score Brain::searchLine(std::vector<Move::Move> &moves, int depth, Score::Score previousScore, const std::vector<Move::Move> &excludedMoves, Move::Move &bestMove)
   {
-    switch (node.type)
+    if (!searchOptions.useAspirationWindows || depth < aspirationDepth || std::abs(previousScore) >= Score::mateBound)
+      return searchRoot(moves, depth, -Score::infinite, Score::infinite, excludedMoves, bestMove);
+
+    Score::Score window = aspirationWindow;
+    Score::Score alpha = previousScore - window;
+    Score::Score beta = previousScore + window;
+
+    // Widen only the side that missed, the other bound is still trustworthy
+    while (true)
     {
-    case EvaluationTypes::MATERIAL:
-      return calculateMaterialDifference() * node.value;
-    case EvaluationTypes::SPACE:
-      return evaluateSpace() * node.value;
-    case EvaluationTypes::KING_SAFETY:
-      return evaluateKingSafety() * node.value;
-    case EvaluationTypes::PIECE_ACTIVITY:
-      return evaluatePieceActivity() * node.value;
-    default:
-      return 0;
+      const Score::Score score = searchRoot(moves, depth, alpha, beta, excludedMoves, bestMove);
+
+      if (timeManager.shouldStop(searchStatistics.nodes))
+        return score;
+
+      if (score <= alpha)
+      {
+        searchStatistics.failLows++;
+        window *= 2;
+        alpha = window > maxAspirationWindow ? -Score::infinite : std::max(score - window, -Score::infinite);
+      }
+      else if (score >= beta)
+      {
+        searchStatistics.failHighs++;
+        window *= 2;
+        beta = window > maxAspirationWindow ? Score::infinite : std::min(score + window, Score::infinite);
+      }
+      else
+      {
+        return score;
+      }
     }
   }
 
-  int Brain::calculateMaterialDifference()
+  std::vector<Move::Move> Brain::getPrincipalVariation(const Move::Move &firstMove, int maxLength)
   {
-    int result = 0;
+    std::vector<Move::Move> principalVariation = {firstMove};
+
+    if (!this->testBoard.makeMove(firstMove))
+      return principalVariation;
 
-    for (int i = 0; i < 64; i++)
+    // Follow the best moves stored in the transposition table, the length limit also breaks repetition cycles
+    TranspositionTable::Entry entry;
+    while (static_cast<int>(principalVariation.size()) < maxLength &&
+           transpositionTable.probe(this->testBoard.hashKey, entry) && entry.from >= 0)
     {
-      if (this->testBoard.board[i] == Board::Board::NONE)
-        continue;
+      const Move::Move move = this->testBoard.getValidMove(entry.from, entry.to, static_cast<Move::PieceType>(entry.promotionTo));
+
+      if (!move.isValid || !this->testBoard.makeMove(move))
+        break;
 
-      if (this->testBoard.getPiece(i) == (Board::Board::PAWN | !isWhite))
-        result += 1;
-      else if (this->testBoard.getPiece(i) == (Board::Board::KNIGHT | !isWhite))
-        result += 3;
-      else if (this->testBoard.getPiece(i) == (Board::Board::BISHOP | !isWhite))
-        result += 3;
-      else if (this->testBoard.getPiece(i) == (Board::Board::ROOK | !isWhite))
-        result += 5;
-      else if (this->testBoard.getPiece(i) == (Board::Board::QUEEN | !isWhite))
-        result += 9;
+      principalVariation.push_back(move);
     }
 
-    return result;
+    for (size_t i = 0; i < principalVariation.size(); i++)
+      this->testBoard.undoMove();
+
+    return principalVariation;
+  }
+
+  int Brain::getLineIndex(const Move::Move &move) const
+  {
+    for (size_t lineIndex = 0; lineIndex < searchLines.size(); lineIndex++)
+    {
+      if (isSameMove(searchLines[lineIndex].principalVariation[0], move))
+        return lineIndex;
+    }
+
+    return searchLines.size();
   }
 
-  double Brain::evaluatePieceActivity()
+  void Brain::printSearchInfo(const SearchLine &line, int lineNumber)
   {
-    double result = 0;
+    const SearchStatistics &statistics = this->searchStatistics;
 
-    // Space will be evaluated in the following manner:
-    // 1. The more space a piece controls, the better
-    // 2. The more space a piece controls, the better
-    // 3. A square controlled in the enemy's half is double the value of the player's half
-    // 4. A square controlled in the center is double the value of the player's half
+    *infoOutput << "info depth " << statistics.depth
+                << " seldepth " << statistics.selectiveDepth
+                << " multipv " << lineNumber;
 
-    for (int i = 0; i < 64; i++)
+    // Mates are given in moves, negative when the side to move is the one getting mated
+    if (Score::isMate(line.score))
+    {
+      const int plies = Score::mate - std::abs(line.score);
+      *infoOutput << " score mate " << (line.score > 0 ? (plies + 1) / 2 : -(plies / 2));
+    }
+    else
     {
-      if (this->testBoard.board[i] == Board::Board::NONE)
+      *infoOutput << " score cp " << line.score;
+    }
+
+    *infoOutput << " nodes " << statistics.nodes
+                << " nps " << statistics.getNodesPerSecond()
+                << " time " << statistics.getElapsedTime()
+                << " hashfull " << statistics.hashfull
+                << " tthits " << static_cast<int>(statistics.getHashHitRate() * 100) << "%"
+                << " pawnhits " << static_cast<int>(statistics.getPawnHashHitRate() * 100) << "%"
+                << " evalhits " << static_cast<int>(statistics.getEvaluationCacheHitRate() * 100) << "%"
+                << " lazy " << static_cast<int>(statistics.getLazyEvaluationRate() * 100) << "%"
+                << " ebf " << statistics.getEffectiveBranchingFactor()
+                << " firstcut " << static_cast<int>(statistics.getFirstMoveCutoffRate() * 100) << "%"
+                << " qnodes " << static_cast<int>(statistics.getQuiescenceShare() * 100) << "%"
+                << " pv";
+
+    for (const auto &move : line.principalVariation)
+      *infoOutput << " " << move.toString();
+
+    *infoOutput << "\n";
+  }
+
+  Score::Score Brain::searchRoot(std::vector<Move::Move> &moves, int depth, Score::Score alpha, Score::Score beta, const std::vector<Move::Move> &excludedMoves, Move::Move &bestMove)
+  {
+    Score::Score bestScore = -Score::infinite;
+    int movesSearched = 0;
+
+    for (auto &move : moves)
+    {
+      if (std::any_of(excludedMoves.begin(), excludedMoves.end(), [&](const Move::Move &excludedMove)
+                      { return isSameMove(move, excludedMove); }))
         continue;
 
-      if (this->testBoard.getPiece(i) == (Board::Board::KNIGHT | !isWhite))
-      {
-        std::vector<int> knightPositions = {};
+      if (!this->testBoard.makeMove(move))
+        continue;
 
-        for (int i = 0; i < 64; i++)
-        {
-          if (this->testBoard.getPiece(i) == (Board::Board::KNIGHT | !isWhite))
-          {
-            knightPositions.push_back(i);
-          }
-        }
+      Score::Score score;
 
-        constexpr int knightOffsets[] = {Board::Board::UP + Board::Board::UP + Board::Board::LEFT,
-                                         Board::Board::UP + Board::Board::UP + Board::Board::RIGHT,
-                                         Board::Board::UP + Board::Board::LEFT + Board::Board::LEFT,
-                                         Board::Board::UP + Board::Board::RIGHT + Board::Board::RIGHT,
-                                         Board::Board::DOWN + Board::Board::DOWN + Board::Board::LEFT,
-                                         Board::Board::DOWN + Board::Board::DOWN + Board::Board::RIGHT,
-                                         Board::Board::DOWN + Board::Board::LEFT + Board::Board::LEFT,
-                                         Board::Board::DOWN + Board::Board::RIGHT + Board::Board::RIGHT};
+      // The first move is the expected principal variation, the others only have to prove they are worse
+      if (searchOptions.usePrincipalVariationSearch && movesSearched > 0)
+      {
+        score = -search(depth - 1, -alpha - nullWindow, -alpha, 1, true);
 
-        for (auto &position : knightPositions)
+        if (score > alpha && score < beta)
         {
-          for (auto &offset : knightOffsets)
-          {
-            if (Board::Board::checkIfFitsInBoard(position + offset))
-            {
-              if (this->testBoard.isOnEnemySide(position + offset, isWhite))
-                result += 2;
-              else
-                result += 1;
-            }
-          }
+          searchStatistics.reSearches++;
+          score = -search(depth - 1, -beta, -alpha, 1, true);
         }
       }
-      else if (this->testBoard.getPiece(i) == (Board::Board::BISHOP | !isWhite))
+      else
       {
-        std::vector<int> bishopPositions = {};
+        score = -search(depth - 1, -beta, -alpha, 1, true);
+      }
 
-        for (int i = 0; i < 64; i++)
-        {
-          if (this->testBoard.getPiece(i) == (Board::Board::BISHOP | !isWhite))
-          {
-            bishopPositions.push_back(i);
-          }
-        }
+      this->testBoard.undoMove();
+      movesSearched++;
 
-        std::vector<int> possibleSquares = {};
+      if (timeManager.shouldStop(searchStatistics.nodes))
+        break;
 
-        for (auto &position : bishopPositions)
-        {
-          auto squares = this->testBoard.getDiagonalMoves(position);
+      if (score > bestScore)
+        bestScore = score;
 
-          for (auto &square : squares)
-          {
-            possibleSquares.push_back(square.first);
-          }
-        }
+      // The first move always becomes the best one, so a line that fails low still has a move to show
+      if (score > alpha || !bestMove.isValid)
+        bestMove = move;
 
-        for (auto &square : possibleSquares)
-        {
-          if (this->testBoard.isOnEnemySide(square, isWhite))
-            result += 2;
-          else
-            result += 1;
-        }
+      if (score > alpha)
+        alpha = score;
+
+      if (alpha >= beta)
+        break;
+    }
+
+    return bestScore;
+  }
+
+  Score::Score Brain::search(int depth, Score::Score alpha, Score::Score beta, int ply, bool isNullMoveAllowed)
+  {
+    switch (this->testBoard.gameState)
+    {
+    case Board::GameState::CHECKMATE:
+      return Score::matedIn(ply);
+    case Board::GameState::STALEMATE:
+    case Board::GameState::FIFTY_MOVE_RULE:
+    case Board::GameState::INSUFFICIENT_MATERIAL:
+      return 0;
+    default:
+      break;
+    }
+
+    // The tables know the exact result, including at the horizon where the evaluation would only guess
+    Tablebase::ProbeResult tablebaseResult;
+    if (searchOptions.useTablebase && tablebase.isAvailable() && tablebase.probe(this->testBoard, tablebaseResult))
+    {
+      searchStatistics.tablebaseHits++;
+      return scoreFromTablebase(tablebaseResult, ply);
+    }
+
+    // The Syzygy tables only know the result for a fresh fifty move count, so they are probed right after a capture or a
+    // pawn move
+    Syzygy::Wdl syzygyResult;
+    if (searchOptions.useTablebase && this->testBoard.fiftyMoveRuleCounter == 0 && syzygy.isAvailable() &&
+        syzygy.probeWdl(this->testBoard, syzygyResult))
+    {
+      searchStatistics.tablebaseHits++;
+      return scoreFromSyzygy(syzygyResult, ply);
+    }
+
+    // King and pawn against king is known without tables, a drawn one needs no search. Wins are played out by the
+    // evaluation pushing the pawn
+    int kpkResult;
+    if (searchOptions.useEndgames && this->testBoard.probeKPK(kpkResult) && kpkResult == 0)
+    {
+      searchStatistics.bitbaseHits++;
+      return Score::draw;
+    }
+
+    if (depth <= 0)
+      return quiescence(alpha, beta, ply);
+
+    searchStatistics.nodes++;
+    searchStatistics.selectiveDepth = std::max(searchStatistics.selectiveDepth, ply);
+
+    // The result is thrown away by the root once time is up, any value will do
+    if (timeManager.shouldStop(searchStatistics.nodes))
+      return 0;
+
+    const bool isWhiteToMove = this->testBoard.isWhiteTurn;
+
+    if (ply >= maxPly)
+      return evaluateFor(isWhiteToMove, alpha, beta);
+
+    const bool isPvNode = beta - alpha > 2 * nullWindow;
+    const Score::Score originalAlpha = alpha;
+    const unsigned long long hashKey = this->testBoard.hashKey;
+
+    // Zero window nodes take the stored score when it was searched deep enough, PV nodes only take the move
+    TranspositionTable::Entry entry;
+    Move::Move hashMove(false);
+    if (searchOptions.useTranspositionTable)
+      searchStatistics.hashProbes++;
+
+    if (searchOptions.useTranspositionTable && transpositionTable.probe(hashKey, entry))
+    {
+      const Score::Score storedScore = scoreFromTranspositionTable(Score::unpack(entry.score), ply);
+      searchStatistics.hashHits++;
+
+      if (!isPvNode && entry.depth >= depth &&
+          (entry.bound == TranspositionTable::Bound::EXACT ||
+           (entry.bound == TranspositionTable::Bound::LOWER && storedScore >= beta) ||
+           (entry.bound == TranspositionTable::Bound::UPPER && storedScore <= alpha)))
+      {
+        searchStatistics.hashCutoffs++;
+        return storedScore;
       }
-      else if (this->testBoard.getPiece(i) == (Board::Board::ROOK | !isWhite))
+
+      if (entry.from >= 0)
+        hashMove = Move::Move(entry.from, entry.to, Move::PieceType::NONE, {}, static_cast<Move::PieceType>(entry.promotionTo));
+    }
+
+    const bool inCheck = this->testBoard.gameState == Board::GameState::CHECK;
+    const Score::Score staticEvaluation = inCheck ? -Score::infinite : evaluateFor(isWhiteToMove, alpha, beta);
+    const bool isSelective = !inCheck && std::abs(beta) < Score::mateBound;
+
+    // Reverse futility pruning: far enough above beta that a quiet move at this depth will not bring it back
+    if (searchOptions.useReverseFutilityPruning && isSelective && depth <= selectiveDepth &&
+        staticEvaluation - reverseFutilityMargin * depth >= beta)
+      return staticEvaluation;
+
+    // Razoring: hopelessly below alpha, only captures can help, so let the quiescence search decide
+    if (searchOptions.useRazoring && isSelective && depth <= 2 &&
+        staticEvaluation + razoringMargin * depth < alpha)
+    {
+      Score::Score score = quiescence(alpha, beta, ply);
+      if (score < alpha)
+        return score;
+    }
+
+    // Null move pruning, guarded against zugzwang by requiring pieces besides pawns and a verification search at higher depths
+    if (searchOptions.useNullMovePruning && isNullMoveAllowed && isSelective && depth >= 3 &&
+        staticEvaluation >= beta && hasNonPawnMaterial(isWhiteToMove))
+    {
+      const int reduction = 2 + depth / 4;
+
+      this->testBoard.makeNullMove();
+      Score::Score score = -search(depth - 1 - reduction, -beta, -beta + nullWindow, ply + 1, false);
+      this->testBoard.undoNullMove();
+
+      if (score >= beta)
       {
-        std::vector<int> rookPositions = {};
+        if (score >= Score::mateBound)
+          score = beta;
 
-        for (int i = 0; i < 64; i++)
-        {
-          if (this->testBoard.getPiece(i) == (Board::Board::ROOK | !isWhite))
-          {
-            rookPositions.push_back(i);
-          }
-        }
+        if (depth < nullMoveVerificationDepth)
+          return score;
 
-        std::vector<int> possibleSquares = {};
+        if (search(depth - 1 - reduction, beta - nullWindow, beta, ply, false) >= beta)
+          return score;
+      }
+    }
 
-        for (auto &position : rookPositions)
-        {
-          auto squares = this->testBoard.getVerticalAndHorizontalMoves(position);
+    auto moves = this->testBoard.getAllValidMoves();
 
-          for (auto &square : squares)
-          {
-            possibleSquares.push_back(square.first);
-          }
-        }
+    if (moves.size() == 0)
+      return inCheck ? Score::matedIn(ply) : 0;
 
-        for (auto &square : possibleSquares)
-        {
-          if (this->testBoard.isOnEnemySide(square, isWhite))
-            result += 2;
-          else
-            result += 1;
-        }
+    orderMoves(moves, hashMove);
+
+    const int lateMovePruningCount = 3 + depth * depth;
+    const bool canPruneQuietMoves = !inCheck && depth <= selectiveDepth;
+
+    Score::Score bestScore = -Score::infinite;
+    Move::Move bestMove(false);
+    int movesSearched = 0;
+    int quietMovesSearched = 0;
+
+    for (auto &move : moves)
+    {
+      const bool isQuiet = !isCapture(move) && !isPromotion(move);
+
+      if (isQuiet && canPruneQuietMoves && movesSearched > 0 && bestScore > -Score::mateBound)
+      {
+        // Late move pruning: the ordering puts the promising moves first, the tail is rarely worth a look
+        if (searchOptions.useLateMovePruning && quietMovesSearched >= lateMovePruningCount)
+          continue;
+
+        // Futility pruning: a quiet move will not gain enough to reach alpha
+        if (searchOptions.useFutilityPruning && staticEvaluation + futilityMargin * depth <= alpha)
+          continue;
+      }
+
+      if (!this->testBoard.makeMove(move))
+        continue;
+
+      const bool givesCheck = this->testBoard.gameState == Board::GameState::CHECK;
+      Score::Score score = -Score::infinite;
+
+      // Late move reductions: quiet moves late in the list are searched shallower first
+      int reduction = 0;
+      if (searchOptions.useLateMoveReductions && depth >= 3 && movesSearched >= 3 && isQuiet && !inCheck && !givesCheck)
+        reduction = std::min(getReduction(depth, movesSearched), depth - 2);
+
+      if (movesSearched == 0)
+      {
+        score = -search(depth - 1, -beta, -alpha, ply + 1, true);
       }
-      else if (this->testBoard.getPiece(i) == (Board::Board::QUEEN | !isWhite))
+      else if (searchOptions.usePrincipalVariationSearch)
       {
-        std::vector<int> queenPositions = {};
+        // Principal variation search: prove the move is no better than alpha with a zero window scout
+        score = -search(depth - 1 - reduction, -alpha - nullWindow, -alpha, ply + 1, true);
+
+        if (score > alpha && reduction > 0)
+          score = -search(depth - 1, -alpha - nullWindow, -alpha, ply + 1, true);
 
-        for (int i = 0; i < 64; i++)
+        // Only a scout that failed high inside a real window needs the full search
+        if (score > alpha && score < beta)
         {
-          if (this->testBoard.getPiece(i) == (Board::Board::QUEEN | !isWhite))
-          {
-            queenPositions.push_back(i);
-          }
+          searchStatistics.reSearches++;
+          score = -search(depth - 1, -beta, -alpha, ply + 1, true);
         }
+      }
+      else
+      {
+        if (reduction > 0)
+          score = -search(depth - 1 - reduction, -alpha - nullWindow, -alpha, ply + 1, true);
 
-        std::vector<int> possibleSquares = {};
+        if (reduction == 0 || score > alpha)
+          score = -search(depth - 1, -beta, -alpha, ply + 1, true);
+      }
 
-        for (auto &position : queenPositions)
-        {
-          auto squares = this->testBoard.getVerticalAndHorizontalMoves(position);
-          auto squares2 = this->testBoard.getDiagonalMoves(position);
-
-          for (auto &square : squares)
-          {
-            possibleSquares.push_back(square.first);
-          }
-          for (auto &square : squares2)
-          {
-            possibleSquares.push_back(square.first);
-          }
-        }
+      this->testBoard.undoMove();
 
-        for (auto &square : possibleSquares)
-        {
-          if (this->testBoard.isOnEnemySide(square, isWhite))
-            result += 2;
-          else
-            result += 1;
-        }
+      movesSearched++;
+      if (isQuiet)
+        quietMovesSearched++;
+
+      if (score > bestScore)
+      {
+        bestScore = score;
+        bestMove = move;
       }
+
+      if (score > alpha)
+        alpha = score;
+
+      if (alpha >= beta)
+      {
+        searchStatistics.betaCutoffs++;
+        if (movesSearched == 1)
+          searchStatistics.firstMoveBetaCutoffs++;
+        break;
+      }
+    }
+
+    // Everything was pruned, the static evaluation is the best guess we have
+    if (movesSearched == 0)
+      return inCheck ? Score::matedIn(ply) : staticEvaluation;
+
+    // Scores of an interrupted search are made up and must not outlive it
+    if (searchOptions.useTranspositionTable && !timeManager.shouldStop(searchStatistics.nodes))
+    {
+      const TranspositionTable::Bound bound = bestScore >= beta           ? TranspositionTable::Bound::LOWER
+                                              : bestScore > originalAlpha ? TranspositionTable::Bound::EXACT
+                                                                          : TranspositionTable::Bound::UPPER;
+
+      transpositionTable.store(hashKey, scoreToTranspositionTable(bestScore, ply), depth, bound, bestMove);
     }
 
-    return result / optimalPieceActivity;
+    return bestScore;
   }
 
-  double Brain::evaluateSpace()
+  Score::Score Brain::quiescence(Score::Score alpha, Score::Score beta, int ply)
   {
-    double result = 0;
+    searchStatistics.nodes++;
+    searchStatistics.quiescenceNodes++;
+    searchStatistics.selectiveDepth = std::max(searchStatistics.selectiveDepth, ply);
+
+    if (timeManager.shouldStop(searchStatistics.nodes))
+      return 0;
+
+    const bool isWhiteToMove = this->testBoard.isWhiteTurn;
+    const Score::Score standPat = evaluateFor(isWhiteToMove, alpha, beta);
+
+    if (standPat >= beta || ply >= maxPly)
+      return standPat;
+
+    if (standPat > alpha)
+      alpha = standPat;
 
-    for (int i = 0; i < 64; i++)
+    auto moves = this->testBoard.getAllValidMoves();
+    moves.erase(std::remove_if(moves.begin(), moves.end(), [&](const Move::Move &move)
+                               { return !isCapture(move) && !isPromotion(move); }),
+                moves.end());
+    orderMoves(moves);
+
+    for (auto &move : moves)
     {
-      if (this->testBoard.getPiece(i) == Board::Board::NONE)
+      if (!this->testBoard.makeMove(move))
         continue;
 
-      if (this->testBoard.getPiece(i) == (Board::Board::PAWN | !isWhite))
+      Score::Score score;
+      if (this->testBoard.gameState == Board::GameState::CHECKMATE)
+        score = Score::mateIn(ply + 1);
+      else
+        score = -quiescence(-beta, -alpha, ply + 1);
+
+      this->testBoard.undoMove();
+
+      if (score >= beta)
+        return score;
+
+      if (score > alpha)
+        alpha = score;
+    }
+
+    return alpha;
+  }
+
+  void Brain::orderMoves(std::vector<Move::Move> &moves, const Move::Move &hashMove)
+  {
+    // Promotions and captures first, most valuable victim / least valuable attacker
+    auto moveScore = [&](const Move::Move &move)
+    {
+      int score = 0;
+
+      if (isPromotion(move))
+        score += 10 * move.promotionTo;
+
+      if (isCapture(move))
       {
-        result += i / 8;
+        const int victim = std::max(2, static_cast<int>(this->testBoard.board[move.to] >> 1) << 1);
+        score += 10 * victim - move.pieceType;
       }
-    }
 
-    return result;
+      return score;
+    };
+
+    std::stable_sort(moves.begin(), moves.end(), [&](const Move::Move &first, const Move::Move &second)
+                     { return moveScore(first) > moveScore(second); });
+
+    // The best move found for this position in an earlier search goes before everything else
+    if (hashMove.isValid)
+      std::stable_partition(moves.begin(), moves.end(), [&](const Move::Move &move)
+                            { return isSameMove(move, hashMove); });
   }
 
-  double Brain::evaluateKingSafety()
+  bool Brain::isCapture(const Move::Move &move)
   {
-    double result = 0;
+    return this->testBoard.board[move.to] != Board::Board::NONE ||
+           std::find(move.moveTypes.begin(), move.moveTypes.end(), Move::MoveTypes::EN_PASSANT) != move.moveTypes.end();
+  }
 
-    int kingPosition = this->testBoard.currentWhiteKingPosition;
-    if (!isWhite)
-      kingPosition = this->testBoard.currentBlackKingPosition;
+  bool Brain::isPromotion(const Move::Move &move)
+  {
+    return std::find(move.moveTypes.begin(), move.moveTypes.end(), Move::MoveTypes::PROMOTION) != move.moveTypes.end();
+  }
 
-    int pawnsInFront = 0;
-    for (int i = 1; i <= 2; i++)
+  bool Brain::isSameMove(const Move::Move &first, const Move::Move &second)
+  {
+    return first.from == second.from && first.to == second.to && first.promotionTo == second.promotionTo;
+  }
+
+  bool Brain::hasNonPawnMaterial(bool white)
+  {
+    for (int type = 1; type < 5; type++)
     {
-      int currentlyCheckedPosition = kingPosition + Board::Board::UP * i;
-      if (Board::Board::checkIfFitsInBoard(currentlyCheckedPosition) && this->testBoard.getPiece(currentlyCheckedPosition) == (Board::Board::PAWN | isWhite))
-        pawnsInFront++;
-      currentlyCheckedPosition = kingPosition + Board::Board::UP * i + Board::Board::LEFT;
-      if (Board::Board::checkIfFitsInBoard(currentlyCheckedPosition) &&
-          Board::Board::checkIfCrossesBorder(currentlyCheckedPosition, currentlyCheckedPosition - Board::Board::LEFT) &&
-          this->testBoard.getPiece(currentlyCheckedPosition) == (Board::Board::PAWN | isWhite))
-        pawnsInFront++;
-      currentlyCheckedPosition = kingPosition + Board::Board::UP * i + Board::Board::RIGHT;
-      if (Board::Board::checkIfFitsInBoard(currentlyCheckedPosition) &&
-          Board::Board::checkIfCrossesBorder(currentlyCheckedPosition, currentlyCheckedPosition - Board::Board::RIGHT) &&
-          this->testBoard.getPiece(currentlyCheckedPosition) == (Board::Board::PAWN | isWhite))
-        pawnsInFront++;
+      if (this->testBoard.getPieceCount(white, type) != 0)
+        return true;
     }
 
-    int defenders = 0;
+    return false;
+  }
 
-    for (int i = kingPosition + 14; i >= kingPosition - 18; i--)
-    {
-      if (!Board::Board::checkIfFitsInBoard(i) || this->testBoard.getPiece(i) <= (Board::Board::PAWN | Board::Board::BLACK))
-        continue;
+  int Brain::getReduction(int depth, int moveNumber)
+  {
+    static const auto reductionTable = buildReductionTable();
 
-      // It is often said that a knight is king's best defender therefore the value is higher
-      if (this->testBoard.getPiece(i) == (Board::Board::KNIGHT | isWhite))
-        defenders += 5;
-      else
-      {
-        // Remove the color bit
-        defenders += (this->testBoard.getPiece(i) >> 1) << 1;
-      }
-    }
+    return reductionTable[std::min(depth, maxPly - 1)][std::min(moveNumber, maxPly - 1)];
+  }
 
-    int controledAdjacenedSquared = 0;
+  // Mate scores are stored relative to the node, not the root, so they stay right when the position is reached at another ply
+  Score::Score Brain::scoreToTranspositionTable(Score::Score score, int ply)
+  {
+    if (score >= Score::mateBound)
+      return score + ply;
+    if (score <= -Score::mateBound)
+      return score - ply;
+    return score;
+  }
 
-    for (int i = kingPosition + 8; i >= kingPosition - 9; i--)
+  Score::Score Brain::scoreFromTranspositionTable(Score::Score score, int ply)
+  {
+    if (score >= Score::mateBound)
+      return score - ply;
+    if (score <= -Score::mateBound)
+      return score + ply;
+    return score;
+  }
+
+  // Same scale as the mates found by the search, so the shortest win is preferred
+  Score::Score Brain::scoreFromTablebase(const Tablebase::ProbeResult &result, int ply)
+  {
+    switch (result.wdl)
     {
-      if (!Board::Board::checkIfFitsInBoard(i))
-        continue;
+    case Tablebase::Wdl::WIN:
+      return Score::mateIn(ply + result.distance);
+    case Tablebase::Wdl::LOSS:
+      return Score::matedIn(ply + result.distance);
+    default:
+      return 0;
+    }
+  }
 
-      if (this->testBoard.isSquareControled(i) != -1)
-        controledAdjacenedSquared++;
+  // Wins the fifty move rule takes away are draws
+  Score::Score Brain::scoreFromSyzygy(Syzygy::Wdl wdl, int ply)
+  {
+    switch (wdl)
+    {
+    case Syzygy::Wdl::WIN:
+      return Score::tablebaseWin - ply;
+    case Syzygy::Wdl::LOSS:
+      return -Score::tablebaseWin + ply;
+    default:
+      return Score::draw;
     }
+  }
 
-    const int centerSquare = isWhite ? 28 : 35;
-    int howCloseToCenter = 0;
+  Score::Score Brain::evaluateNode(EvaluationTypes type, Score::Weight weight, bool white)
+  {
+    switch (type)
+    {
+    case EvaluationTypes::MATERIAL:
+      return Score::applyWeight(evaluateTerm<EvaluationTypes::MATERIAL>(white), weight);
+    case EvaluationTypes::SPACE:
+      return Score::applyWeight(evaluateTerm<EvaluationTypes::SPACE>(white), weight);
+    case EvaluationTypes::KING_SAFETY:
+      return Score::applyWeight(evaluateTerm<EvaluationTypes::KING_SAFETY>(white), weight);
+    case EvaluationTypes::PIECE_ACTIVITY:
+      return Score::applyWeight(evaluateTerm<EvaluationTypes::PIECE_ACTIVITY>(white), weight);
+    case EvaluationTypes::PAWN_STRUCTURE:
+      return Score::applyWeight(evaluateTerm<EvaluationTypes::PAWN_STRUCTURE>(white), weight);
+    default:
+      return 0;
+    }
+  }
 
-    int dx = abs(kingPosition % 8 - centerSquare % 8);
-    int dy = abs(kingPosition / 8 - centerSquare / 8);
+  Score::Score Brain::calculateMaterialDifference(bool white)
+  {
+    // Kept up to date by the board on every move, already in centipawns
+    return this->testBoard.getTaperedScore(white);
+  }
 
-    // Avoiding using sqrt, dividing by 2 gives a rought estimate without the performance hit
-    howCloseToCenter = (dx * dx + dy * dy) >> 1;
+  Score::Score Brain::evaluatePieceActivity(bool white)
+  {
+    return Evaluation::getPieceActivity(this->evaluationBitboards, white ? 0 : 1);
+  }
 
-    result = pawnsInFront + defenders - controledAdjacenedSquared - howCloseToCenter;
+  Score::Score Brain::evaluateSpace(bool white)
+  {
+    // How far the pawns have advanced, counted from their own side of the board, a pawn for every rank
+    return pawnStructure.probe(this->testBoard).advancement[white ? 0 : 1] * 100;
+  }
 
-    if (result < 0)
-      return 0;
+  Score::Score Brain::evaluateKingSafety(bool white)
+  {
+    return Evaluation::getKingSafety(this->evaluationBitboards, white ? 0 : 1, this->testBoard.phase);
+  }
 
-    return result / optimalKingSafety;
+  std::vector<EvaluationNode> Brain::getStartingNeurons()
+  {
+#ifdef CHESSBOT_COMPILED_NEURONS
+    return std::vector<EvaluationNode>(std::begin(CompiledNeurons::nodes), std::end(CompiledNeurons::nodes));
+#else
+    return readNeurons();
+#endif
   }
 
   std::vector<EvaluationNode> Brain::readNeurons()
   {
+    std::error_code error;
+    this->neuronsWriteTime = std::filesystem::last_write_time(neuronsSource, error);
+
     std::ifstream source(neuronsSource);
 
     std::vector<EvaluationNode> neurons;
@@ -436,6 +1188,10 @@ namespace Brain
       {
         node.type = EvaluationTypes::PIECE_ACTIVITY;
       }
+      else if (type == "PAWN_STRUCTURE")
+      {
+        node.type = EvaluationTypes::PAWN_STRUCTURE;
+      }
 
       node.value = std::stod(value);
 
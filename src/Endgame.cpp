@@ -0,0 +1,209 @@
+#include "Endgame.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <unordered_map>
+
+#include "Attacks.hpp"
+#include "BoardScan.hpp"
+
+namespace {
+  using Endgame::Entry;
+
+  // Pawn, knight, bishop, rook and queen in the order of the material key
+  const std::string pieceLetters = "PNBRQ";
+
+  int getDistance(int first, int second) {
+    return std::max(std::abs(first % 8 - second % 8), std::abs(first / 8 - second / 8));
+  }
+
+  // 0 in a corner, 6 on the four centre squares
+  int getEdgeDistance(int square) {
+    const int file = square % 8;
+    const int rank = square / 8;
+    return std::min(file, 7 - file) + std::min(rank, 7 - rank);
+  }
+
+  bool isDarkSquare(int square) {
+    return (square % 8 + square / 8) % 2 == 0;
+  }
+
+  int getKingSquare(const Board::Board &board, int side) {
+    return side == 0 ? board.currentWhiteKingPosition : board.currentBlackKingPosition;
+  }
+
+  int getFirstPieceSquare(const Board::Board &board, int piece) {
+    return Attacks::getFirstSquare(BoardScan::getPieceMask(board.packedBoard, static_cast<std::uint8_t>(piece)));
+  }
+
+  Score::Score getMaterial(const Board::Board &board, int strongSide) {
+    return board.getTaperedScore(strongSide == 0) - board.getTaperedScore(strongSide != 0);
+  }
+
+  Score::Score evaluateDraw(const Board::Board &, int) {
+    return Score::draw;
+  }
+
+  // A lone king is mated on the edge, the strong king has to come close to help
+  Score::Score evaluateKXK(const Board::Board &board, int strongSide) {
+    const int strongKing = getKingSquare(board, strongSide);
+    const int weakKing = getKingSquare(board, 1 - strongSide);
+
+    return Endgame::knownWin + getMaterial(board, strongSide) + 20 * (6 - getEdgeDistance(weakKing)) +
+           10 * (7 - getDistance(strongKing, weakKing));
+  }
+
+  // Bishop and knight only mate in a corner of the bishop's colour
+  Score::Score evaluateKBNK(const Board::Board &board, int strongSide) {
+    const int strongKing = getKingSquare(board, strongSide);
+    const int weakKing = getKingSquare(board, 1 - strongSide);
+    const int bishop = getFirstPieceSquare(board, Board::Board::BISHOP | strongSide);
+
+    const int cornerDistance = isDarkSquare(bishop) ? std::min(getDistance(weakKing, 0), getDistance(weakKing, 63))
+                                                    : std::min(getDistance(weakKing, 7), getDistance(weakKing, 56));
+
+    return Endgame::knownWin + getMaterial(board, strongSide) + 20 * (7 - cornerDistance) +
+           10 * (7 - getDistance(strongKing, weakKing));
+  }
+
+  // Exact from the bitbase, a won pawn is pushed on towards promotion
+  Score::Score evaluateKPK(const Board::Board &board, int strongSide) {
+    int result;
+    if (!board.probeKPK(result) || result == 0)
+      return Score::draw;
+
+    const int pawn = getFirstPieceSquare(board, Board::Board::PAWN | strongSide);
+    const int relativeRank = strongSide == 0 ? pawn / 8 : 7 - pawn / 8;
+    return Endgame::knownWin + getMaterial(board, strongSide) + 20 * relativeRank;
+  }
+
+  int scaleDraw(const Board::Board &) {
+    return 0;
+  }
+
+  // Each bishop can only guard its own colour, even a pawn or two more is often no win
+  int scaleOppositeBishops(const Board::Board &board) {
+    const int whiteBishop = getFirstPieceSquare(board, Board::Board::BISHOP);
+    const int blackBishop = getFirstPieceSquare(board, Board::Board::BISHOP | Board::Board::BLACK);
+
+    return isDarkSquare(whiteBishop) != isDarkSquare(blackBishop) ? Endgame::fullScale / 2 : Endgame::fullScale;
+  }
+
+  int getCount(std::uint64_t materialKey, int side, int type) {
+    return static_cast<int>((materialKey >> (4 * (5 * side + type))) & 15);
+  }
+
+  // The same material with the colours swapped
+  std::uint64_t swapSides(std::uint64_t materialKey) {
+    return (materialKey >> 20) | ((materialKey & 0xFFFFF) << 20);
+  }
+
+  std::unordered_map<std::uint64_t, Entry> buildTable() {
+    std::unordered_map<std::uint64_t, Entry> table;
+
+    // Written for a strong white side, black gets the same entries on the swapped key
+    const auto add = [&table](const std::string &signature, Entry entry) {
+      const std::uint64_t key = Endgame::getMaterialKey(signature);
+      table[key] = entry;
+
+      entry.strongSide = 1;
+      table[swapSides(key)] = entry;
+    };
+
+    add("KvK", {evaluateDraw, nullptr, 0, true});
+    add("KNvK", {evaluateDraw, nullptr, 0, true});
+    add("KBvK", {evaluateDraw, nullptr, 0, true});
+
+    add("KBNvK", {evaluateKBNK, nullptr, 0, false});
+    add("KPvK", {evaluateKPK, nullptr, 0, false});
+
+    // Mates exist, but none that can be forced
+    add("KNNvK", {nullptr, scaleDraw, 0, false});
+    add("KNvKN", {nullptr, scaleDraw, 0, false});
+    add("KBvKN", {nullptr, scaleDraw, 0, false});
+    add("KBvKB", {nullptr, scaleDraw, 0, false});
+
+    return table;
+  }
+
+  const std::unordered_map<std::uint64_t, Entry> &getTable() {
+    static const std::unordered_map<std::uint64_t, Entry> table = buildTable();
+    return table;
+  }
+
+  const Entry kxkEntries[2] = {{evaluateKXK, nullptr, 0, false}, {evaluateKXK, nullptr, 1, false}};
+  const Entry oppositeBishopsEntry = {nullptr, scaleOppositeBishops, 0, false};
+}
+
+namespace Endgame
+{
+  std::uint64_t getMaterialKey(const std::string &signature)
+  {
+    const std::size_t separator = signature.find('v');
+    if (separator == std::string::npos || signature.find('v', separator + 1) != std::string::npos)
+      throw "Invalid material signature";
+
+    std::uint64_t key = 0;
+    const std::string sides[2] = {signature.substr(0, separator), signature.substr(separator + 1)};
+
+    for (int side = 0; side < 2; side++)
+    {
+      if (sides[side].empty() || sides[side][0] != 'K')
+        throw "Invalid material signature";
+
+      for (std::size_t i = 1; i < sides[side].size(); i++)
+      {
+        const std::size_t type = pieceLetters.find(sides[side][i]);
+        if (type == std::string::npos)
+          throw "Invalid material signature";
+
+        key += Board::Board::getMaterialKeyStep(side, static_cast<int>(type));
+      }
+    }
+
+    return key;
+  }
+
+  const Entry *probe(std::uint64_t materialKey)
+  {
+    int counts[2][5];
+    int pieces[2] = {0, 0};
+    for (int side = 0; side < 2; side++)
+    {
+      for (int type = 0; type < 5; type++)
+      {
+        counts[side][type] = getCount(materialKey, side, type);
+        pieces[side] += counts[side][type];
+      }
+    }
+
+    // Every signature of the table has at most two pieces besides the kings
+    if (pieces[0] + pieces[1] <= 2)
+    {
+      const auto &table = getTable();
+      const auto entry = table.find(materialKey);
+      if (entry != table.end())
+        return &entry->second;
+    }
+
+    for (int side = 0; side < 2; side++)
+    {
+      const int *strong = counts[side];
+      const bool canMate = strong[3] > 0 || strong[4] > 0 || strong[2] >= 2 || (strong[2] > 0 && strong[1] > 0);
+      if (pieces[1 - side] == 0 && canMate)
+        return &kxkEntries[side];
+    }
+
+    const bool onlyBishops = counts[0][1] + counts[0][3] + counts[0][4] + counts[1][1] + counts[1][3] + counts[1][4] == 0;
+    if (onlyBishops && counts[0][2] == 1 && counts[1][2] == 1)
+      return &oppositeBishopsEntry;
+
+    return nullptr;
+  }
+
+  bool isInsufficientMaterial(std::uint64_t materialKey)
+  {
+    const Entry *entry = probe(materialKey);
+    return entry != nullptr && entry->isInsufficientMaterial;
+  }
+} // namespace Endgame
@@ -0,0 +1,90 @@
+#include "Evaluation.hpp"
+
+#include <algorithm>
+
+#include "PieceSquareTables.hpp"
+
+namespace Evaluation
+{
+  Score::Score getPieceActivity(const Attacks::Bitboards &bitboards, int side)
+  {
+    // Every square a piece attacks counts once, twice in the enemy's half, squares of its own pieces not at all
+    const std::uint64_t targets = ~bitboards.sides[side];
+    const std::uint64_t enemyHalf = side == 0 ? Attacks::blackHalf : Attacks::whiteHalf;
+    int result = 0;
+
+    auto addActivity = [&](std::uint64_t attacks)
+    {
+      attacks &= targets;
+      result += Attacks::countBits(attacks) + Attacks::countBits(attacks & enemyHalf);
+    };
+
+    for (std::uint64_t knights = bitboards.pieces[side][1]; knights != 0; knights &= knights - 1)
+      addActivity(Attacks::getKnightAttacks(Attacks::getFirstSquare(knights)));
+
+    for (std::uint64_t bishops = bitboards.pieces[side][2]; bishops != 0; bishops &= bishops - 1)
+      addActivity(Attacks::getBishopAttacks(Attacks::getFirstSquare(bishops), bitboards.occupancy));
+
+    for (std::uint64_t rooks = bitboards.pieces[side][3]; rooks != 0; rooks &= rooks - 1)
+      addActivity(Attacks::getRookAttacks(Attacks::getFirstSquare(rooks), bitboards.occupancy));
+
+    for (std::uint64_t queens = bitboards.pieces[side][4]; queens != 0; queens &= queens - 1)
+    {
+      const int square = Attacks::getFirstSquare(queens);
+      addActivity(Attacks::getBishopAttacks(square, bitboards.occupancy) | Attacks::getRookAttacks(square, bitboards.occupancy));
+    }
+
+    return (result * 100 + optimalPieceActivity / 2) / optimalPieceActivity;
+  }
+
+  Score::Score getKingSafety(const Attacks::Bitboards &bitboards, int side, int phase)
+  {
+    const int enemy = 1 - side;
+    const int king = bitboards.kings[side];
+    const std::uint64_t zone = Attacks::getKingZone(king, side);
+
+    // Every enemy piece hitting the zone is an attacker, weighted by what it is and how many squares of the zone it hits
+    int attackers = 0;
+    int attackUnits = 0;
+
+    auto addAttacker = [&](std::uint64_t attacks, int type)
+    {
+      const std::uint64_t zoneAttacks = attacks & zone;
+      if (zoneAttacks == 0)
+        return;
+
+      attackers++;
+      attackUnits += kingAttackWeights[type] * Attacks::countBits(zoneAttacks);
+    };
+
+    for (std::uint64_t knights = bitboards.pieces[enemy][1]; knights != 0; knights &= knights - 1)
+      addAttacker(Attacks::getKnightAttacks(Attacks::getFirstSquare(knights)), 1);
+
+    for (std::uint64_t bishops = bitboards.pieces[enemy][2]; bishops != 0; bishops &= bishops - 1)
+      addAttacker(Attacks::getBishopAttacks(Attacks::getFirstSquare(bishops), bitboards.occupancy), 2);
+
+    for (std::uint64_t rooks = bitboards.pieces[enemy][3]; rooks != 0; rooks &= rooks - 1)
+      addAttacker(Attacks::getRookAttacks(Attacks::getFirstSquare(rooks), bitboards.occupancy), 3);
+
+    for (std::uint64_t queens = bitboards.pieces[enemy][4]; queens != 0; queens &= queens - 1)
+    {
+      const int square = Attacks::getFirstSquare(queens);
+      addAttacker(Attacks::getBishopAttacks(square, bitboards.occupancy) | Attacks::getRookAttacks(square, bitboards.occupancy), 4);
+    }
+
+    // A lone piece does not mate, the danger grows with the square of the units once a second one joins
+    int danger = 0;
+    if (attackers >= 2)
+      danger = std::min(attackUnits * attackUnits * kingDangerPerUnit / 10, maxKingDanger);
+
+    // Pawns right next to the king shelter it twice as well as the ones a rank further
+    const std::uint64_t shield = bitboards.pieces[side][0] & Attacks::getPawnShield(king, side);
+    const int shelter = Attacks::countBits(shield) + Attacks::countBits(shield & Attacks::getKingAttacks(king));
+    const int storm = Attacks::countBits(bitboards.pieces[enemy][0] & Attacks::getPawnStorm(king, side));
+
+    const int result = shelter * pawnShieldBonus - storm * pawnStormPenalty - danger;
+
+    // Only matters while there are pieces left to attack the king with
+    return result * std::min(phase, PieceSquareTables::maxPhase) / PieceSquareTables::maxPhase;
+  }
+} // namespace Evaluation
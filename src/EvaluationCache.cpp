@@ -0,0 +1,78 @@
+#include "EvaluationCache.hpp"
+
+namespace {
+  // The lower half of the key picks the entry, the upper half is what is left to tell keys apart
+  constexpr std::uint64_t checkMask = 0xFFFFFFFF00000000ULL;
+
+  std::uint64_t pack(std::uint64_t key, Score::Score score) {
+    return (key & checkMask) | static_cast<std::uint32_t>(score);
+  }
+
+  Score::Score unpackScore(std::uint64_t data) {
+    return static_cast<Score::Score>(static_cast<std::uint32_t>(data));
+  }
+}
+
+namespace EvaluationCache
+{
+  EvaluationCache::EvaluationCache(std::size_t sizeInKilobytes)
+  {
+    resize(sizeInKilobytes);
+  }
+
+  void EvaluationCache::resize(std::size_t sizeInKilobytes)
+  {
+    const std::size_t maxEntries = sizeInKilobytes * 1024 / sizeof(Entry);
+
+    std::size_t size = 1;
+    while (size * 2 <= maxEntries)
+      size *= 2;
+
+    this->entries.reset(new Entry[size]);
+    this->mask = size - 1;
+    resetStatistics();
+  }
+
+  void EvaluationCache::clear()
+  {
+    for (std::size_t i = 0; i <= this->mask; i++)
+      this->entries[i].data.store(0, std::memory_order_relaxed);
+    resetStatistics();
+  }
+
+  bool EvaluationCache::probe(std::uint64_t key, Score::Score &score)
+  {
+    const Entry &entry = this->entries[key & this->mask];
+    this->probes.fetch_add(1, std::memory_order_relaxed);
+
+    // Empty entries are zero, a score of zero under a key with a zero upper half is never found but costs only a miss
+    const std::uint64_t data = entry.data.load(std::memory_order_relaxed);
+    if (data == 0 || ((data ^ key) & checkMask) != 0)
+      return false;
+
+    this->hits.fetch_add(1, std::memory_order_relaxed);
+    score = unpackScore(data);
+    return true;
+  }
+
+  void EvaluationCache::store(std::uint64_t key, Score::Score score)
+  {
+    this->entries[key & this->mask].data.store(pack(key, score), std::memory_order_relaxed);
+  }
+
+  long long EvaluationCache::getProbes() const
+  {
+    return this->probes.load(std::memory_order_relaxed);
+  }
+
+  long long EvaluationCache::getHits() const
+  {
+    return this->hits.load(std::memory_order_relaxed);
+  }
+
+  void EvaluationCache::resetStatistics()
+  {
+    this->probes.store(0, std::memory_order_relaxed);
+    this->hits.store(0, std::memory_order_relaxed);
+  }
+} // namespace EvaluationCache
@@ -0,0 +1,151 @@
+#include "MappedFile.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace MappedFile
+{
+  MappedFile::MappedFile(const std::string &path)
+  {
+    open(path);
+  }
+
+  MappedFile::~MappedFile()
+  {
+    close();
+  }
+
+  MappedFile::MappedFile(MappedFile &&other) noexcept
+  {
+    *this = std::move(other);
+  }
+
+  MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+  {
+    if (this != &other)
+    {
+      close();
+      this->data = std::exchange(other.data, nullptr);
+      this->size = std::exchange(other.size, 0);
+#ifdef _WIN32
+      this->fileHandle = std::exchange(other.fileHandle, nullptr);
+      this->mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+    }
+    return *this;
+  }
+
+#ifdef _WIN32
+  bool MappedFile::open(const std::string &path)
+  {
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+      return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+      CloseHandle(file);
+      return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+      CloseHandle(file);
+      return false;
+    }
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr)
+    {
+      CloseHandle(mapping);
+      CloseHandle(file);
+      return false;
+    }
+
+    this->fileHandle = file;
+    this->mappingHandle = mapping;
+    this->data = static_cast<const unsigned char *>(view);
+    this->size = static_cast<std::size_t>(fileSize.QuadPart);
+    return true;
+  }
+
+  void MappedFile::close()
+  {
+    if (this->data != nullptr)
+      UnmapViewOfFile(this->data);
+    if (this->mappingHandle != nullptr)
+      CloseHandle(this->mappingHandle);
+    if (this->fileHandle != nullptr)
+      CloseHandle(this->fileHandle);
+
+    this->data = nullptr;
+    this->size = 0;
+    this->fileHandle = nullptr;
+    this->mappingHandle = nullptr;
+  }
+#else
+  bool MappedFile::open(const std::string &path)
+  {
+    close();
+
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file == -1)
+      return false;
+
+    struct stat fileStatus;
+    if (fstat(file, &fileStatus) == -1 || fileStatus.st_size == 0)
+    {
+      ::close(file);
+      return false;
+    }
+
+    void *view = mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_SHARED, file, 0);
+
+    // The mapping keeps its own reference to the file
+    ::close(file);
+
+    if (view == MAP_FAILED)
+      return false;
+
+    this->data = static_cast<const unsigned char *>(view);
+    this->size = static_cast<std::size_t>(fileStatus.st_size);
+    return true;
+  }
+
+  void MappedFile::close()
+  {
+    if (this->data != nullptr)
+      munmap(const_cast<unsigned char *>(this->data), this->size);
+
+    this->data = nullptr;
+    this->size = 0;
+  }
+#endif
+
+  bool MappedFile::isOpen() const
+  {
+    return this->data != nullptr;
+  }
+
+  const unsigned char *MappedFile::getData() const
+  {
+    return this->data;
+  }
+
+  std::size_t MappedFile::getSize() const
+  {
+    return this->size;
+  }
+} // namespace MappedFile
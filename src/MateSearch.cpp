@@ -0,0 +1,210 @@
+#include "MateSearch.hpp"
+
+#include <algorithm>
+
+namespace {
+  struct Child {
+    Move::Move move;
+    unsigned long long key;
+  };
+
+  std::uint32_t addCapped(std::uint64_t first, std::uint64_t second) {
+    return static_cast<std::uint32_t>(std::min<std::uint64_t>(first + second, MateSearch::MateSearch::infinity));
+  }
+}
+
+namespace MateSearch
+{
+  MateSearch::MateSearch(std::size_t sizeInMegabytes)
+  {
+    resize(sizeInMegabytes);
+  }
+
+  void MateSearch::resize(std::size_t sizeInMegabytes)
+  {
+    const std::size_t maxEntries = sizeInMegabytes * 1024 * 1024 / sizeof(Entry);
+
+    std::size_t size = 1;
+    while (size * 2 <= maxEntries)
+      size *= 2;
+
+    this->entries.assign(size, Entry());
+    this->mask = size - 1;
+  }
+
+  void MateSearch::clear()
+  {
+    std::fill(this->entries.begin(), this->entries.end(), Entry());
+  }
+
+  long long MateSearch::getNodes() const
+  {
+    return this->nodes;
+  }
+
+  bool MateSearch::solve(Board::Board &board, int maxPlies, Move::Move &mateMove)
+  {
+    this->nodes = 0;
+    this->rootDepth = maxPlies;
+    this->rootMove = Move::Move(false);
+
+    searchNode(board, infinity, infinity, maxPlies, true);
+
+    const Entry root = lookup(board.hashKey, maxPlies, true);
+    if (root.proof != 0 || !this->rootMove.isValid)
+      return false;
+
+    mateMove = this->rootMove;
+    return true;
+  }
+
+  unsigned long long MateSearch::getTableKey(unsigned long long key, int depth, bool isAttacker)
+  {
+    // The same position is a different question with fewer plies left or the other side attacking
+    return key ^ (static_cast<unsigned long long>(depth) * 0x9E3779B97F4A7C15ULL) ^ (isAttacker ? 0xD1B54A32D192ED03ULL : 0);
+  }
+
+  Entry MateSearch::lookup(unsigned long long key, int depth, bool isAttacker) const
+  {
+    const unsigned long long tableKey = getTableKey(key, depth, isAttacker);
+    const Entry &stored = this->entries[tableKey & this->mask];
+
+    if (stored.depth != depth || stored.key != tableKey)
+      return Entry();
+
+    return stored;
+  }
+
+  void MateSearch::store(unsigned long long key, int depth, bool isAttacker, std::uint32_t proof, std::uint32_t disproof)
+  {
+    const unsigned long long tableKey = getTableKey(key, depth, isAttacker);
+    Entry &stored = this->entries[tableKey & this->mask];
+
+    stored.key = tableKey;
+    stored.depth = static_cast<std::int16_t>(depth);
+    stored.proof = proof;
+    stored.disproof = disproof;
+  }
+
+  bool MateSearch::getTerminal(const Board::Board &board, int depth, bool isAttacker, Entry &entry) const
+  {
+    bool isAttackerLost = false;
+
+    switch (board.gameState)
+    {
+    case Board::GameState::CHECKMATE:
+      // Whoever is mated has lost, the defender can only be mated here because it only answers checks
+      entry.proof = infinity;
+      entry.disproof = 0;
+      return true;
+    case Board::GameState::STALEMATE:
+    case Board::GameState::FIFTY_MOVE_RULE:
+    case Board::GameState::INSUFFICIENT_MATERIAL:
+    case Board::GameState::THREEFOLD_REPETITION:
+      isAttackerLost = true;
+      break;
+    default:
+      // Out of plies without a mate on the board
+      isAttackerLost = depth <= 0;
+      break;
+    }
+
+    if (!isAttackerLost)
+      return false;
+
+    entry.proof = isAttacker ? infinity : 0;
+    entry.disproof = isAttacker ? 0 : infinity;
+    return true;
+  }
+
+  void MateSearch::searchNode(Board::Board &board, std::uint32_t proofThreshold, std::uint32_t disproofThreshold, int depth, bool isAttacker)
+  {
+    this->nodes++;
+
+    Entry terminal;
+    if (getTerminal(board, depth, isAttacker, terminal))
+    {
+      store(board.hashKey, depth, isAttacker, terminal.proof, terminal.disproof);
+      return;
+    }
+
+    // The attacker only looks at checks, the defender has to answer them with everything it has
+    std::vector<Child> children;
+    for (const auto &move : board.getAllValidMoves())
+    {
+      if (!board.makeMove(move))
+        continue;
+
+      const bool givesCheck = board.gameState == Board::GameState::CHECK || board.gameState == Board::GameState::CHECKMATE;
+      if (isAttacker && !givesCheck)
+      {
+        board.undoMove();
+        continue;
+      }
+
+      // Solve the leaves right away, a check with few replies is the most promising one to look at
+      Entry child = lookup(board.hashKey, depth - 1, !isAttacker);
+      if (child.depth < 0)
+      {
+        if (!getTerminal(board, depth - 1, !isAttacker, child) && isAttacker)
+          child.disproof = static_cast<std::uint32_t>(std::max(board.possibleMoves, 1));
+        store(board.hashKey, depth - 1, !isAttacker, child.proof, child.disproof);
+      }
+
+      children.push_back({move, board.hashKey});
+      board.undoMove();
+    }
+
+    if (children.empty())
+    {
+      store(board.hashKey, depth, isAttacker, infinity, 0);
+      return;
+    }
+
+    while (true)
+    {
+      // A node is proven by its best child and disproven only by all of them
+      std::uint32_t proof = infinity;
+      std::uint32_t disproof = 0;
+      std::uint32_t secondBestProof = infinity;
+      std::uint32_t bestChildProof = infinity;
+      size_t bestChild = 0;
+
+      for (size_t i = 0; i < children.size(); i++)
+      {
+        const Entry child = lookup(children[i].key, depth - 1, !isAttacker);
+
+        if (child.disproof < proof)
+        {
+          secondBestProof = proof;
+          proof = child.disproof;
+          bestChildProof = child.proof;
+          bestChild = i;
+        }
+        else if (child.disproof < secondBestProof)
+        {
+          secondBestProof = child.disproof;
+        }
+
+        disproof = addCapped(disproof, child.proof);
+      }
+
+      if (proof == 0 && depth == this->rootDepth && isAttacker)
+        this->rootMove = children[bestChild].move;
+
+      if (proof >= proofThreshold || disproof >= disproofThreshold || this->nodes >= this->nodeLimit)
+      {
+        store(board.hashKey, depth, isAttacker, proof, disproof);
+        return;
+      }
+
+      // The best child is searched until it stops being the best one or the node crosses one of its thresholds
+      const std::uint32_t childProofThreshold = addCapped(disproofThreshold - disproof, bestChildProof);
+      const std::uint32_t childDisproofThreshold = std::min(proofThreshold, addCapped(secondBestProof, 1));
+
+      board.makeMove(children[bestChild].move);
+      searchNode(board, childProofThreshold, childDisproofThreshold, depth - 1, !isAttacker);
+      board.undoMove();
+    }
+  }
+} // namespace MateSearch
@@ -46,7 +46,7 @@ namespace Menu
       std::cout << 8 - i << "| ";
       for (int j = 0; j < 8; j++)
       {
-        auto tileIndex = i * 8 + j;
+        auto tileIndex = (7 - i) * 8 + j;
         auto tile = board.board[tileIndex];
 
         if (tile == 0)
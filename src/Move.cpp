@@ -114,10 +114,15 @@ namespace Move
   }
 
   Move::Move(const std::string& moveFrom, const std::string& moveTo) {
-    int from = Move::getSquareIndex(moveFrom);
-    int to = Move::getSquareIndex(moveTo);
-
-    std::cout << from << " " << to << "\n";
+    // Only the squares are known, the board fills in the piece when the move is made
+    try {
+      this->from = Move::getSquareIndex(moveFrom);
+      this->to = Move::getSquareIndex(moveTo);
+    } catch (const std::invalid_argument &e) {
+      this->from = -1;
+      this->to = -1;
+      this->isValid = false;
+    }
   }
 
   Move::Move(int from, int to, PieceType pieceType, std::vector<MoveTypes> moveTypes)
@@ -0,0 +1,385 @@
+#include "Network.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "BoardScan.hpp"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CHESSBOT_NETWORK_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+  // Every kernel works on multiples of 16 values, the loader rejects networks with other layer sizes
+  struct Kernels {
+    BoardScan::Kernel kernel;
+    void (*addRow)(std::int16_t *values, const std::int16_t *row, int count);
+    void (*subtractRow)(std::int16_t *values, const std::int16_t *row, int count);
+    void (*clip)(const std::int16_t *values, std::int16_t *output, int count);
+    std::int32_t (*dot)(const std::int16_t *first, const std::int16_t *second, int count);
+  };
+
+  void addRowScalar(std::int16_t *values, const std::int16_t *row, int count) {
+    for (int i = 0; i < count; i++)
+      values[i] = static_cast<std::int16_t>(values[i] + row[i]);
+  }
+
+  void subtractRowScalar(std::int16_t *values, const std::int16_t *row, int count) {
+    for (int i = 0; i < count; i++)
+      values[i] = static_cast<std::int16_t>(values[i] - row[i]);
+  }
+
+  // Clipped ReLU, everything is brought into 0 to 127
+  void clipScalar(const std::int16_t *values, std::int16_t *output, int count) {
+    for (int i = 0; i < count; i++)
+      output[i] = std::min<std::int16_t>(std::max<std::int16_t>(values[i], 0), 127);
+  }
+
+  // Inputs are at most 127 and weights fit in int8, so the pairwise sums of the multiply-add never overflow
+  std::int32_t dotScalar(const std::int16_t *first, const std::int16_t *second, int count) {
+    std::int32_t sum = 0;
+    for (int i = 0; i < count; i++)
+      sum += first[i] * second[i];
+    return sum;
+  }
+
+#ifdef CHESSBOT_NETWORK_X86
+  // SSE2: eight values per register
+
+  __attribute__((target("sse2"))) void addRowSse2(std::int16_t *values, const std::int16_t *row, int count) {
+    for (int i = 0; i < count; i += 8) {
+      const __m128i sum = _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i)),
+                                        _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i)));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(values + i), sum);
+    }
+  }
+
+  __attribute__((target("sse2"))) void subtractRowSse2(std::int16_t *values, const std::int16_t *row, int count) {
+    for (int i = 0; i < count; i += 8) {
+      const __m128i difference = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i)),
+                                               _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i)));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(values + i), difference);
+    }
+  }
+
+  __attribute__((target("sse2"))) void clipSse2(const std::int16_t *values, std::int16_t *output, int count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i top = _mm_set1_epi16(127);
+    for (int i = 0; i < count; i += 8) {
+      const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), _mm_max_epi16(_mm_min_epi16(value, top), zero));
+    }
+  }
+
+  __attribute__((target("sse2"))) std::int32_t dotSse2(const std::int16_t *first, const std::int16_t *second, int count) {
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < count; i += 8) {
+      sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(first + i)),
+                                              _mm_loadu_si128(reinterpret_cast<const __m128i *>(second + i))));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+  }
+
+  // AVX2: sixteen values per register
+
+  __attribute__((target("avx2"))) void addRowAvx2(std::int16_t *values, const std::int16_t *row, int count) {
+    for (int i = 0; i < count; i += 16) {
+      const __m256i sum = _mm256_add_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i)),
+                                           _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + i)));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(values + i), sum);
+    }
+  }
+
+  __attribute__((target("avx2"))) void subtractRowAvx2(std::int16_t *values, const std::int16_t *row, int count) {
+    for (int i = 0; i < count; i += 16) {
+      const __m256i difference = _mm256_sub_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i)),
+                                                  _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + i)));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(values + i), difference);
+    }
+  }
+
+  __attribute__((target("avx2"))) void clipAvx2(const std::int16_t *values, std::int16_t *output, int count) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i top = _mm256_set1_epi16(127);
+    for (int i = 0; i < count; i += 16) {
+      const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i), _mm256_max_epi16(_mm256_min_epi16(value, top), zero));
+    }
+  }
+
+  __attribute__((target("avx2"))) std::int32_t dotAvx2(const std::int16_t *first, const std::int16_t *second, int count) {
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < count; i += 16) {
+      sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(first + i)),
+                                                    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(second + i))));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    return _mm_cvtsi128_si32(half);
+  }
+#endif
+
+  Kernels getKernels(BoardScan::Kernel kernel) {
+    switch (kernel) {
+#ifdef CHESSBOT_NETWORK_X86
+    case BoardScan::Kernel::AVX2:
+      return {kernel, addRowAvx2, subtractRowAvx2, clipAvx2, dotAvx2};
+    case BoardScan::Kernel::SSE2:
+      return {kernel, addRowSse2, subtractRowSse2, clipSse2, dotSse2};
+#endif
+    default:
+      return {BoardScan::Kernel::SCALAR, addRowScalar, subtractRowScalar, clipScalar, dotScalar};
+    }
+  }
+
+  // Picked once from what the processor running the bot supports, the same way as the board scans
+  Kernels &getCurrentKernels() {
+    static Kernels kernels = getKernels(BoardScan::isSupported(BoardScan::Kernel::AVX2)   ? BoardScan::Kernel::AVX2
+                                        : BoardScan::isSupported(BoardScan::Kernel::SSE2) ? BoardScan::Kernel::SSE2
+                                                                                          : BoardScan::Kernel::SCALAR);
+    return kernels;
+  }
+
+  int readUnsigned16(const unsigned char *data) {
+    return data[0] | (data[1] << 8);
+  }
+
+  // Copies count little endian values out of the file and moves the cursor past them
+  template <typename Stored, typename Value>
+  void readValues(const unsigned char *&cursor, std::vector<Value> &values, std::size_t count) {
+    values.resize(count);
+    for (std::size_t i = 0; i < count; i++) {
+      Stored value;
+      std::memcpy(&value, cursor, sizeof(Stored));
+      values[i] = static_cast<Value>(value);
+      cursor += sizeof(Stored);
+    }
+  }
+}
+
+namespace Network
+{
+  bool Network::load(const std::string &path)
+  {
+    close();
+
+    if (!this->file.open(path) || this->file.getSize() < headerSize)
+    {
+      close();
+      return false;
+    }
+
+    const unsigned char *data = this->file.getData();
+    const int half = readUnsigned16(data + 8);
+    const int first = readUnsigned16(data + 10);
+    const int second = readUnsigned16(data + 12);
+
+    const std::size_t expectedSize = headerSize + 2 * static_cast<std::size_t>(half) +
+                                     2 * static_cast<std::size_t>(featureCount) * half +
+                                     static_cast<std::size_t>(first) * 2 * half + 4 * static_cast<std::size_t>(first) +
+                                     static_cast<std::size_t>(second) * first + 4 * static_cast<std::size_t>(second) +
+                                     second + 4;
+
+    const bool isValid = std::memcmp(data, magic, 4) == 0 && data[4] == version &&
+                         half > 0 && first > 0 && second > 0 && half % 16 == 0 && first % 16 == 0 && second % 16 == 0 &&
+                         this->file.getSize() == expectedSize;
+    if (!isValid)
+    {
+      close();
+      return false;
+    }
+
+    this->halfDimensions = half;
+    this->firstHidden = first;
+    this->secondHidden = second;
+
+    const unsigned char *cursor = data + headerSize;
+    readValues<std::int16_t>(cursor, this->featureBiases, half);
+
+    // The biggest part by far is read straight from the mapping, the header and the biases keep it two byte aligned
+    this->featureWeights = reinterpret_cast<const std::int16_t *>(cursor);
+    cursor += 2 * static_cast<std::size_t>(featureCount) * half;
+
+    readValues<std::int8_t>(cursor, this->firstWeights, static_cast<std::size_t>(first) * 2 * half);
+    readValues<std::int32_t>(cursor, this->firstBiases, first);
+    readValues<std::int8_t>(cursor, this->secondWeights, static_cast<std::size_t>(second) * first);
+    readValues<std::int32_t>(cursor, this->secondBiases, second);
+    readValues<std::int8_t>(cursor, this->outputWeights, second);
+    std::memcpy(&this->outputBias, cursor, sizeof(this->outputBias));
+
+    this->inputBuffer.assign(2 * half, 0);
+    this->firstOutputBuffer.assign(first, 0);
+    this->secondOutputBuffer.assign(second, 0);
+
+    this->isLoadedFlag = true;
+    return true;
+  }
+
+  void Network::close()
+  {
+    this->file.close();
+    this->isLoadedFlag = false;
+    this->featureWeights = nullptr;
+    this->accumulators.clear();
+  }
+
+  bool Network::isLoaded() const
+  {
+    return this->isLoadedFlag;
+  }
+
+  int Network::getHalfDimensions() const
+  {
+    return this->halfDimensions;
+  }
+
+  int Network::getFeatureIndex(int perspective, int kingSquare, unsigned long long piece, int square)
+  {
+    const int orientation = perspective == 0 ? 0 : 56;
+
+    // PAWN = 2 ... QUEEN = 32 become 0 ... 4, the perspective's own pieces come first
+    const int type = __builtin_ctzll(piece & ~Board::Board::BLACK) - 1;
+    const int isEnemy = static_cast<int>(piece & Board::Board::BLACK) != perspective ? 1 : 0;
+
+    return ((kingSquare ^ orientation) * 10 + type * 2 + isEnemy) * 64 + (square ^ orientation);
+  }
+
+  BoardScan::Kernel Network::getKernel()
+  {
+    return getCurrentKernels().kernel;
+  }
+
+  bool Network::setKernel(BoardScan::Kernel kernel)
+  {
+    if (!BoardScan::isSupported(kernel))
+      return false;
+
+    getCurrentKernels() = getKernels(kernel);
+    return true;
+  }
+
+  void Network::addFeature(std::int16_t *values, int feature) const
+  {
+    getCurrentKernels().addRow(values, this->featureWeights + static_cast<std::size_t>(feature) * this->halfDimensions, this->halfDimensions);
+  }
+
+  void Network::removeFeature(std::int16_t *values, int feature) const
+  {
+    getCurrentKernels().subtractRow(values, this->featureWeights + static_cast<std::size_t>(feature) * this->halfDimensions, this->halfDimensions);
+  }
+
+  void Network::refresh(const Board::Board &board, int perspective, std::int16_t *values) const
+  {
+    std::copy(this->featureBiases.begin(), this->featureBiases.end(), values);
+
+    const int kingSquare = perspective == 0 ? board.currentWhiteKingPosition : board.currentBlackKingPosition;
+    for (std::uint64_t occupied = BoardScan::getOccupiedMask(board.packedBoard); occupied != 0; occupied &= occupied - 1)
+    {
+      const int square = __builtin_ctzll(occupied);
+      const unsigned long long piece = board.board[square];
+      if ((piece & ~Board::Board::BLACK) != Board::Board::KING)
+        addFeature(values, getFeatureIndex(perspective, kingSquare, piece, square));
+    }
+  }
+
+  const Accumulator &Network::update(const Board::Board &board)
+  {
+    const std::size_t ply = board.moveHistory.size();
+    if (this->accumulators.size() <= ply)
+    {
+      Accumulator empty;
+      empty.values[0].resize(this->halfDimensions);
+      empty.values[1].resize(this->halfDimensions);
+      this->accumulators.resize(ply + 1, empty);
+    }
+
+    Accumulator &target = this->accumulators[ply];
+    if (target.isValid && target.key == board.hashKey)
+      return target;
+
+    // The closest position before this one that still has its accumulator, usually the one a move ago
+    int source = -1;
+    for (int previous = static_cast<int>(ply) - 1; previous >= 0 && static_cast<int>(ply) - previous <= maxReplayedMoves; previous--)
+    {
+      const Accumulator &candidate = this->accumulators[previous];
+      if (candidate.isValid && candidate.key == board.stateHistory[previous].hashKey)
+      {
+        source = previous;
+        break;
+      }
+    }
+
+    const std::size_t firstChange = source >= 0 ? board.stateHistory[source].pieceChangeCount : board.pieceChanges.size();
+
+    for (int perspective = 0; perspective < 2; perspective++)
+    {
+      // Every input is seen from the king, once it moves nothing of the old sums can be kept
+      const unsigned long long king = Board::Board::KING | (perspective == 0 ? 0 : Board::Board::BLACK);
+      bool canReplay = source >= 0;
+      for (std::size_t i = firstChange; canReplay && i < board.pieceChanges.size(); i++)
+        canReplay = board.pieceChanges[i].piece != king;
+
+      std::int16_t *values = target.values[perspective].data();
+      if (!canReplay)
+      {
+        refresh(board, perspective, values);
+        continue;
+      }
+
+      const std::vector<std::int16_t> &sourceValues = this->accumulators[source].values[perspective];
+      std::copy(sourceValues.begin(), sourceValues.end(), values);
+
+      const int kingSquare = perspective == 0 ? board.currentWhiteKingPosition : board.currentBlackKingPosition;
+      for (std::size_t i = firstChange; i < board.pieceChanges.size(); i++)
+      {
+        const Board::PieceChange &change = board.pieceChanges[i];
+        if ((change.piece & ~Board::Board::BLACK) == Board::Board::KING)
+          continue;
+
+        const int feature = getFeatureIndex(perspective, kingSquare, change.piece, change.square);
+        if (change.sign > 0)
+          addFeature(values, feature);
+        else
+          removeFeature(values, feature);
+      }
+    }
+
+    target.key = board.hashKey;
+    target.isValid = true;
+    return target;
+  }
+
+  int Network::evaluate(const Board::Board &board)
+  {
+    const Accumulator &accumulator = update(board);
+    const int us = board.isWhiteTurn ? 0 : 1;
+    const int half = this->halfDimensions;
+
+    // The side to move's half always comes first, so one set of weights serves both colours
+    const Kernels &kernels = getCurrentKernels();
+    std::vector<std::int16_t> &input = this->inputBuffer;
+    kernels.clip(accumulator.values[us].data(), input.data(), half);
+    kernels.clip(accumulator.values[1 - us].data(), input.data() + half, half);
+
+    std::vector<std::int16_t> &firstOutput = this->firstOutputBuffer;
+    for (int i = 0; i < this->firstHidden; i++)
+    {
+      const std::int32_t sum = this->firstBiases[i] + kernels.dot(input.data(), this->firstWeights.data() + static_cast<std::size_t>(i) * 2 * half, 2 * half);
+      firstOutput[i] = static_cast<std::int16_t>(std::min(std::max(sum >> weightShift, 0), 127));
+    }
+
+    std::vector<std::int16_t> &secondOutput = this->secondOutputBuffer;
+    for (int i = 0; i < this->secondHidden; i++)
+    {
+      const std::int32_t sum = this->secondBiases[i] + kernels.dot(firstOutput.data(), this->secondWeights.data() + static_cast<std::size_t>(i) * this->firstHidden, this->firstHidden);
+      secondOutput[i] = static_cast<std::int16_t>(std::min(std::max(sum >> weightShift, 0), 127));
+    }
+
+    const std::int32_t output = this->outputBias + kernels.dot(secondOutput.data(), this->outputWeights.data(), this->secondHidden);
+    return output / outputScale;
+  }
+} // namespace Network
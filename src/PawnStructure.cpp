@@ -0,0 +1,167 @@
+#include "PawnStructure.hpp"
+
+#include <algorithm>
+
+#include "BoardScan.hpp"
+
+namespace {
+  constexpr std::uint64_t fileA = 0x0101010101010101ULL;
+  constexpr std::uint64_t fileH = fileA << 7;
+  constexpr std::uint64_t rank1 = 0xFFULL;
+
+  std::uint64_t north(std::uint64_t bits) { return bits << 8; }
+  std::uint64_t south(std::uint64_t bits) { return bits >> 8; }
+  std::uint64_t east(std::uint64_t bits) { return (bits & ~fileH) << 1; }
+  std::uint64_t west(std::uint64_t bits) { return (bits & ~fileA) >> 1; }
+
+  std::uint64_t northFill(std::uint64_t bits) {
+    bits |= bits << 8;
+    bits |= bits << 16;
+    bits |= bits << 32;
+    return bits;
+  }
+
+  std::uint64_t southFill(std::uint64_t bits) {
+    bits |= bits >> 8;
+    bits |= bits >> 16;
+    bits |= bits >> 32;
+    return bits;
+  }
+
+  // Squares in front of the pawns, seen from the side they belong to
+  std::uint64_t frontSpan(std::uint64_t pawns, int side) {
+    return side == 0 ? north(northFill(pawns)) : south(southFill(pawns));
+  }
+
+  std::uint64_t rearSpan(std::uint64_t pawns, int side) {
+    return frontSpan(pawns, 1 - side);
+  }
+
+  int countBits(std::uint64_t bits) {
+    return __builtin_popcountll(bits);
+  }
+}
+
+namespace PawnStructure
+{
+  PawnStructure::PawnStructure(std::size_t sizeInKilobytes)
+  {
+    resize(sizeInKilobytes);
+  }
+
+  void PawnStructure::resize(std::size_t sizeInKilobytes)
+  {
+    const std::size_t maxEntries = sizeInKilobytes * 1024 / sizeof(Entry);
+
+    std::size_t size = 1;
+    while (size * 2 <= maxEntries)
+      size *= 2;
+
+    this->entries.assign(size, Entry());
+    this->mask = size - 1;
+  }
+
+  void PawnStructure::clear()
+  {
+    std::fill(this->entries.begin(), this->entries.end(), Entry());
+    resetStatistics();
+  }
+
+  long long PawnStructure::getProbes() const
+  {
+    return this->probes;
+  }
+
+  long long PawnStructure::getHits() const
+  {
+    return this->hits;
+  }
+
+  void PawnStructure::resetStatistics()
+  {
+    this->probes = 0;
+    this->hits = 0;
+  }
+
+  const Entry &PawnStructure::probe(const Board::Board &board)
+  {
+    Entry &entry = this->entries[board.pawnKey & this->mask];
+    this->probes++;
+
+    if (entry.isValid && entry.key == board.pawnKey)
+    {
+      this->hits++;
+      return entry;
+    }
+
+    entry = evaluate(board);
+    return entry;
+  }
+
+  Entry PawnStructure::evaluate(const Board::Board &board)
+  {
+    Entry entry = evaluate(BoardScan::getPieceMask(board.packedBoard, Board::Board::PAWN),
+                           BoardScan::getPieceMask(board.packedBoard, Board::Board::PAWN | Board::Board::BLACK));
+    entry.key = board.pawnKey;
+    return entry;
+  }
+
+  Entry PawnStructure::evaluate(std::uint64_t whitePawns, std::uint64_t blackPawns)
+  {
+    Entry entry;
+    entry.isValid = true;
+    entry.pawns[0] = whitePawns;
+    entry.pawns[1] = blackPawns;
+
+    for (int side = 0; side < 2; side++)
+    {
+      const std::uint64_t pawns = entry.pawns[side];
+      const std::uint64_t forward = side == 0 ? north(pawns) : south(pawns);
+      entry.attacks[side] = east(forward) | west(forward);
+
+      const std::uint64_t span = frontSpan(pawns, side);
+      entry.attackSpans[side] = east(span) | west(span);
+    }
+
+    for (int side = 0; side < 2; side++)
+    {
+      const int enemy = 1 - side;
+      const std::uint64_t pawns = entry.pawns[side];
+      const std::uint64_t enemyPawns = entry.pawns[enemy];
+
+      // Nothing in front of it or next to it on the way, only the front pawn of a doubled pair counts
+      const std::uint64_t enemyFront = frontSpan(enemyPawns, enemy);
+      const std::uint64_t blockers = enemyFront | east(enemyFront) | west(enemyFront);
+      entry.passedPawns[side] = pawns & ~blockers & ~rearSpan(pawns, side);
+
+      const std::uint64_t files = northFill(southFill(pawns));
+      const std::uint64_t isolated = pawns & ~(east(files) | west(files));
+      const std::uint64_t doubled = pawns & rearSpan(pawns, side);
+
+      // The square in front is taken by an enemy pawn and no neighbour can ever come up to cover it
+      const std::uint64_t stops = side == 0 ? north(pawns) : south(pawns);
+      const std::uint64_t uncoveredStops = stops & entry.attacks[enemy] & ~entry.attackSpans[side];
+      const std::uint64_t backward = (side == 0 ? south(uncoveredStops) : north(uncoveredStops)) & ~isolated;
+
+      Score::Score score = 0;
+      int advancement = 0;
+      for (int rank = 0; rank < 8; rank++)
+      {
+        const std::uint64_t rankPawns = pawns & (rank1 << (8 * rank));
+        const int relativeRank = side == 0 ? rank : 7 - rank;
+
+        score += countBits(rankPawns & entry.passedPawns[side]) * passedPawnBonus[relativeRank];
+        advancement += countBits(rankPawns) * relativeRank;
+      }
+
+      score -= countBits(isolated) * isolatedPawnPenalty;
+      score -= countBits(doubled) * doubledPawnPenalty;
+      score -= countBits(backward) * backwardPawnPenalty;
+
+      entry.score[side] = score;
+      entry.advancement[side] = advancement;
+    }
+
+    return entry;
+  }
+} // namespace PawnStructure
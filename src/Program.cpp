@@ -5,15 +5,28 @@
 #include "Menu.hpp"
 #include "Move.hpp"
 #include "Brain.hpp"
+#include "TimeManager.hpp"
 
 namespace Program
 {
   void run()
   {
     Brain::Brain bot;
+    bot.infoOutput = &std::cout;
+
+    // Optional, without a book every move is searched
+    bot.openingBook.open("book.bin");
+    bot.tablebase.setPath("tablebases");
+    bot.syzygy.setPath("syzygy");
+    bot.network.load("network.cbnn");
 
     bot.realBoard.setFromFEN("8/1p2bppk/4p2p/3pP3/1P1P4/5N1P/r5q1/1R2R1K1 w - - 0 30");
 
+    // The bot plays on a clock, five minutes with a three second increment
+    TimeManager::TimeControl timeControl;
+    timeControl.remainingTime = 5 * 60 * 1000;
+    timeControl.increment = 3 * 1000;
+
     Menu::init();
 
     Menu::printBoard(bot.realBoard);
@@ -27,13 +40,18 @@ namespace Program
       
 
       if(isValidMove) {
-        Move::Move botsMove = bot.findBestMove();
+        Move::Move botsMove = bot.findBestMove(timeControl);
+        timeControl.remainingTime += timeControl.increment - bot.timeManager.getElapsedTime();
 
         std::cout
-            << "Evaluation: " << bot.evaluatePosition() << "\n"
-            << "Bot's move: " << botsMove.toString() << "\n";
+            << "Evaluation: " << Score::toPawns(bot.evaluatePosition()) << "\n"
+            << "Bot's move: " << botsMove.toString() << "\n"
+            << "Bot's clock: " << timeControl.remainingTime / 1000.0 << "s\n";
 
         bot.makeRealMove(botsMove);
+
+        // Keep thinking on the user's time, the search is picked up by findBestMove if the guess is right
+        bot.startPondering();
       }
 
 
@@ -0,0 +1,1158 @@
+#include "Syzygy.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+#include "Attacks.hpp"
+#include "BoardScan.hpp"
+
+namespace {
+  // File codes are the letter's position plus one, black pieces add 8
+  constexpr char pieceLetters[] = "PNBRQK";
+  constexpr char signatureOrder[] = "KQRBNP";
+  constexpr int blackCode = 8;
+  constexpr int pawnCode = 1;
+  constexpr int kingCode = 6;
+
+  // Indices of the three leading pieces of a table without pawns but with a piece that is there once
+  constexpr std::uint64_t uniquePiecesSize = 31332;
+  // Ways to place both kings with the first one in the a1-d1-d4 triangle
+  constexpr std::uint64_t kingsSize = 462;
+
+  // Ranks of a root move, every win the fifty move rule cannot take away ranks the same
+  constexpr int maxDtz = 1 << 18;
+
+  // Which of the four DTZ maps holds the values of each result, from a loss to a win
+  constexpr int wdlMaps[] = {1, 3, 0, 2, 0};
+
+  int getFile(int square) {
+    return square % 8;
+  }
+
+  int getRank(int square) {
+    return square / 8;
+  }
+
+  // Above the a1-h8 diagonal when positive, below it when negative
+  int getDiagonalOffset(int square) {
+    return getRank(square) - getFile(square);
+  }
+
+  int getEdgeDistance(int file) {
+    return std::min(file, 7 - file);
+  }
+
+  int getSign(int value) {
+    return (value > 0) - (value < 0);
+  }
+
+  std::uint16_t readLittleEndian16(const unsigned char *data) {
+    return static_cast<std::uint16_t>(data[0] | (data[1] << 8));
+  }
+
+  std::uint32_t readLittleEndian32(const unsigned char *data) {
+    return static_cast<std::uint32_t>(data[0]) | (static_cast<std::uint32_t>(data[1]) << 8) |
+           (static_cast<std::uint32_t>(data[2]) << 16) | (static_cast<std::uint32_t>(data[3]) << 24);
+  }
+
+  // The compressed blocks are read as big endian words, past the end of the file they read as zeros
+  std::uint32_t readBigEndian32(const unsigned char *data, const unsigned char *end) {
+    std::uint32_t value = 0;
+    for (int i = 0; i < 4; i++)
+      value = (value << 8) | (data + i < end ? data[i] : 0);
+    return value;
+  }
+
+  // Left and right child of a symbol of the pair tree, 12 bits each
+  int getLeftSymbol(const unsigned char *tree, int symbol) {
+    return tree[3 * symbol] | ((tree[3 * symbol + 1] & 0xF) << 8);
+  }
+
+  int getRightSymbol(const unsigned char *tree, int symbol) {
+    return (tree[3 * symbol + 2] << 4) | (tree[3 * symbol + 1] >> 4);
+  }
+
+  // A symbol without a right child stands for a single value
+  constexpr int leafSymbol = 0xFFF;
+
+  // The tables of the index, the same for every table
+  struct Encoding {
+    int mapA1D1D4[64] = {0};
+    int mapB1H1H7[64] = {0};
+    int mapKK[10][64] = {{0}};
+    int mapPawns[64] = {0};
+    std::uint64_t binomial[6][64] = {{0}};
+    std::uint64_t leadPawnIndex[6][64] = {{0}};
+    std::uint64_t leadPawnsSize[6][4] = {{0}};
+
+    Encoding() {
+      int code = 0;
+      for (int square = 0; square < 64; square++)
+        if (getDiagonalOffset(square) < 0)
+          this->mapB1H1H7[square] = code++;
+
+      // The triangle below the diagonal first, the diagonal squares last
+      std::vector<int> diagonal;
+      code = 0;
+      for (int square = 0; square <= 27; square++) {
+        if (getDiagonalOffset(square) < 0 && getFile(square) <= 3)
+          this->mapA1D1D4[square] = code++;
+        else if (getDiagonalOffset(square) == 0 && getFile(square) <= 3)
+          diagonal.push_back(square);
+      }
+      for (int square : diagonal)
+        this->mapA1D1D4[square] = code++;
+
+      // With the first king on the diagonal the second one stays on or below it, positions with both kings on the
+      // diagonal come last
+      std::vector<std::pair<int, int>> bothOnDiagonal;
+      code = 0;
+      for (int index = 0; index < 10; index++)
+        for (int first = 0; first <= 27; first++) {
+          if (this->mapA1D1D4[first] != index || (index == 0 && first != 1))
+            continue;
+
+          for (int second = 0; second < 64; second++) {
+            if (std::abs(getFile(first) - getFile(second)) <= 1 && std::abs(getRank(first) - getRank(second)) <= 1)
+              continue;
+            if (getDiagonalOffset(first) == 0 && getDiagonalOffset(second) > 0)
+              continue;
+
+            if (getDiagonalOffset(first) == 0 && getDiagonalOffset(second) == 0)
+              bothOnDiagonal.emplace_back(index, second);
+            else
+              this->mapKK[index][second] = code++;
+          }
+        }
+      for (const auto &kings : bothOnDiagonal)
+        this->mapKK[kings.first][kings.second] = code++;
+
+      this->binomial[0][0] = 1;
+      for (int n = 1; n < 64; n++)
+        for (int k = 0; k < 6 && k <= n; k++)
+          this->binomial[k][n] = (k > 0 ? this->binomial[k - 1][n - 1] : 0) + (k < n ? this->binomial[k][n - 1] : 0);
+
+      // The leading pawn is the one nearest the edge and then the lowest, mapPawns counts the squares left for the
+      // other pawns when it stands on a square
+      int availableSquares = 47;
+      for (int leadPawnCount = 1; leadPawnCount <= 5; leadPawnCount++)
+        for (int file = 0; file < 4; file++) {
+          std::uint64_t index = 0;
+          for (int rank = 1; rank <= 6; rank++) {
+            const int square = 8 * rank + file;
+            if (leadPawnCount == 1) {
+              this->mapPawns[square] = availableSquares--;
+              this->mapPawns[square ^ 7] = availableSquares--;
+            }
+            this->leadPawnIndex[leadPawnCount][square] = index;
+            index += this->binomial[leadPawnCount - 1][this->mapPawns[square]];
+          }
+          this->leadPawnsSize[leadPawnCount][file] = index;
+        }
+    }
+  };
+
+  const Encoding &getEncoding() {
+    static const Encoding encoding;
+    return encoding;
+  }
+
+  int getPieceCode(const Tablebase::TablePiece &piece) {
+    return static_cast<int>(std::strchr(pieceLetters, piece.letter) - pieceLetters) + 1 + (piece.isWhite ? 0 : blackCode);
+  }
+
+  char getLetter(unsigned long long piece) {
+    switch (piece & ~Board::Board::BLACK) {
+      case Board::Board::KING:
+        return 'K';
+      case Board::Board::QUEEN:
+        return 'Q';
+      case Board::Board::ROOK:
+        return 'R';
+      case Board::Board::BISHOP:
+        return 'B';
+      case Board::Board::KNIGHT:
+        return 'N';
+      default:
+        return 'P';
+    }
+  }
+
+  std::vector<Tablebase::TablePiece> getPieces(const Board::Board &board) {
+    std::vector<Tablebase::TablePiece> pieces;
+    for (std::uint64_t occupied = BoardScan::getOccupiedMask(board.packedBoard); occupied != 0; occupied &= occupied - 1) {
+      const int square = Attacks::getFirstSquare(occupied);
+      pieces.push_back({getLetter(board.board[square]), (board.board[square] & Board::Board::BLACK) == 0, square});
+    }
+    return pieces;
+  }
+
+  int getPieceCount(const Board::Board &board) {
+    return Attacks::countBits(BoardScan::getOccupiedMask(board.packedBoard));
+  }
+
+  // Each side from the king down, e.g. KRPvKR
+  std::string getSignature(const std::vector<Tablebase::TablePiece> &pieces) {
+    std::string sides[2];
+    for (const char *letter = signatureOrder; *letter != '\0'; letter++)
+      for (const auto &piece : pieces)
+        if (piece.letter == *letter)
+          sides[piece.isWhite ? 0 : 1] += *letter;
+    return sides[0] + "v" + sides[1];
+  }
+
+  std::string getSwappedSignature(const std::string &signature) {
+    const std::size_t separator = signature.find('v');
+    return signature.substr(separator + 1) + "v" + signature.substr(0, separator);
+  }
+
+  bool isValidSignature(const std::string &signature) {
+    const std::size_t separator = signature.find('v');
+    if (separator == std::string::npos || signature.find('v', separator + 1) != std::string::npos ||
+        signature.size() - 1 > static_cast<std::size_t>(Syzygy::Syzygy::maxPieces))
+      return false;
+
+    for (const std::string &side : {signature.substr(0, separator), signature.substr(separator + 1)})
+      if (side.empty() || side[0] != 'K' || side.find('K', 1) != std::string::npos ||
+          side.find_first_not_of(signatureOrder) != std::string::npos)
+        return false;
+
+    return true;
+  }
+
+  bool hasCastlingRights(const Board::Board &board) {
+    return (!board.hasWhiteKingMoved && (!board.hasWhiteRookAMoved || !board.hasWhiteRookHMoved)) ||
+           (!board.hasBlackKingMoved && (!board.hasBlackRookAMoved || !board.hasBlackRookHMoved));
+  }
+
+  bool isCapture(const Board::Board &board, const Move::Move &move) {
+    return board.board[move.to] != Board::Board::NONE ||
+           std::find(move.moveTypes.begin(), move.moveTypes.end(), Move::MoveTypes::EN_PASSANT) != move.moveTypes.end();
+  }
+
+  // Keys of the positions since the last capture or pawn move, the current one last
+  std::vector<unsigned long long> getReversibleKeys(const Board::Board &board) {
+    const std::size_t plies = std::min(static_cast<std::size_t>(board.fiftyMoveRuleCounter), board.stateHistory.size());
+    std::vector<unsigned long long> keys;
+    for (std::size_t i = board.stateHistory.size() - plies; i < board.stateHistory.size(); i++)
+      keys.push_back(board.stateHistory[i].hashKey);
+    keys.push_back(board.hashKey);
+    return keys;
+  }
+
+  bool hasRepeated(const Board::Board &board) {
+    std::vector<unsigned long long> keys = getReversibleKeys(board);
+    std::sort(keys.begin(), keys.end());
+    return std::adjacent_find(keys.begin(), keys.end()) != keys.end();
+  }
+
+  bool isThreefoldRepetition(const Board::Board &board) {
+    const std::vector<unsigned long long> keys = getReversibleKeys(board);
+    return std::count(keys.begin(), keys.end(), board.hashKey) >= 3;
+  }
+
+  // DTZ of a position whose best move captures or moves a pawn, counted from before that move
+  int getDtzBeforeZeroing(int wdl) {
+    switch (wdl) {
+      case 2:
+        return 1;
+      case 1:
+        return 101;
+      case -1:
+        return -101;
+      case -2:
+        return -1;
+      default:
+        return 0;
+    }
+  }
+}
+
+namespace Syzygy
+{
+  bool Syzygy::setPath(const std::string &directory)
+  {
+    close();
+
+    std::error_code error;
+    for (const auto &file : std::filesystem::directory_iterator(directory, error))
+    {
+      const std::string extension = file.path().extension().string();
+      if (!file.is_regular_file() || (extension != wdlExtension && extension != dtzExtension))
+        continue;
+
+      const std::string signature = file.path().stem().string();
+      if (!isValidSignature(signature))
+        continue;
+
+      const bool isDtz = extension == dtzExtension;
+      Table &table = (isDtz ? this->dtzTables : this->wdlTables)[signature];
+      table.path = file.path().string();
+      table.pieceCount = static_cast<int>(signature.size()) - 1;
+      table.hasPawns = signature.find('P') != std::string::npos;
+      table.isSymmetric = signature == getSwappedSignature(signature);
+
+      const std::size_t separator = signature.find('v');
+      const std::string first = signature.substr(0, separator);
+      const std::string second = signature.substr(separator + 1);
+      for (const std::string &side : {first, second})
+        for (char letter : std::string("QRBNP"))
+          table.hasUniquePieces |= std::count(side.begin(), side.end(), letter) == 1;
+
+      // The pawns of the side with fewer of them lead the index, they compress better
+      const int firstPawns = static_cast<int>(std::count(first.begin(), first.end(), 'P'));
+      const int secondPawns = static_cast<int>(std::count(second.begin(), second.end(), 'P'));
+      const bool isFirstLeading = secondPawns == 0 || (firstPawns > 0 && secondPawns >= firstPawns);
+      table.pawnCount[0] = isFirstLeading ? firstPawns : secondPawns;
+      table.pawnCount[1] = isFirstLeading ? secondPawns : firstPawns;
+
+      if (!isDtz)
+        this->largestTable = std::max(this->largestTable, table.pieceCount);
+    }
+
+    return isAvailable();
+  }
+
+  void Syzygy::close()
+  {
+    this->wdlTables.clear();
+    this->dtzTables.clear();
+    this->largestTable = 0;
+  }
+
+  bool Syzygy::isAvailable() const
+  {
+    return !this->wdlTables.empty();
+  }
+
+  int Syzygy::getMaxPieces() const
+  {
+    return this->largestTable;
+  }
+
+  Syzygy::Table *Syzygy::getTable(const std::string &signature, bool isDtz, bool &isSwapped)
+  {
+    auto &tables = isDtz ? this->dtzTables : this->wdlTables;
+
+    // Files are named with the stronger side first, a position with the stronger side on black finds it swapped
+    isSwapped = false;
+    auto found = tables.find(signature);
+    if (found == tables.end())
+    {
+      isSwapped = true;
+      found = tables.find(getSwappedSignature(signature));
+    }
+    if (found == tables.end())
+      return nullptr;
+
+    Table &table = found->second;
+    if (!table.isLoaded && !table.isBroken)
+    {
+      table.isLoaded = table.file.open(table.path) && load(table, isDtz);
+      table.isBroken = !table.isLoaded;
+
+      if (table.isBroken)
+        table.file.close();
+    }
+
+    return table.isLoaded ? &table : nullptr;
+  }
+
+  bool Syzygy::load(Table &table, bool isDtz)
+  {
+    const unsigned char *data = table.file.getData();
+    const std::size_t size = table.file.getSize();
+    const std::uint8_t *magic = isDtz ? dtzMagic : wdlMagic;
+
+    if (size < 6 || std::memcmp(data, magic, 4) != 0)
+      return false;
+
+    // Split: both sides to move are stored, HasPawns: the table is stored once for each file of the leading pawn
+    constexpr std::uint8_t splitFlag = 1;
+    constexpr std::uint8_t hasPawnsFlag = 2;
+    if (((data[4] & hasPawnsFlag) != 0) != table.hasPawns || ((data[4] & splitFlag) != 0) == table.isSymmetric)
+      return false;
+
+    std::size_t offset = 5;
+    const int sides = !isDtz && !table.isSymmetric ? 2 : 1;
+    const int fileCount = table.hasPawns ? 4 : 1;
+    const bool hasPawnsOnBothSides = table.hasPawns && table.pawnCount[1] > 0;
+
+    for (int file = 0; file < fileCount; file++)
+    {
+      if (offset + 1 + hasPawnsOnBothSides + table.pieceCount > size)
+        return false;
+
+      // The order in which the groups of pieces multiply into the index, 0xF for no group
+      const int order[2][2] = {{data[offset] & 0xF, hasPawnsOnBothSides ? data[offset + 1] & 0xF : 0xF},
+                               {data[offset] >> 4, hasPawnsOnBothSides ? data[offset + 1] >> 4 : 0xF}};
+      offset += 1 + hasPawnsOnBothSides;
+
+      for (int k = 0; k < table.pieceCount; k++, offset++)
+        for (int side = 0; side < sides; side++)
+        {
+          const int code = side ? data[offset] >> 4 : data[offset] & 0xF;
+          if ((code & 7) < pawnCode || (code & 7) > kingCode)
+            return false;
+          table.sides[side][file].pieces[k] = code;
+        }
+
+      for (int side = 0; side < sides; side++)
+        if (!setGroups(table, table.sides[side][file], order[side], file))
+          return false;
+    }
+
+    offset += offset & 1;
+
+    for (int file = 0; file < fileCount; file++)
+      for (int side = 0; side < sides; side++)
+        if (!setSizes(table.sides[side][file], data, size, offset))
+          return false;
+
+    if (isDtz)
+    {
+      const std::size_t mapOffset = offset;
+      table.map = data + mapOffset;
+
+      for (int file = 0; file < fileCount; file++)
+      {
+        PairsData &pairs = table.sides[0][file];
+        if ((pairs.flags & mappedFlag) == 0)
+          continue;
+
+        // Four maps, one for each result, each starts with its length
+        if (pairs.flags & wideFlag)
+        {
+          offset += offset & 1;
+          for (int i = 0; i < 4; i++)
+          {
+            if (offset + 2 > size)
+              return false;
+            pairs.mapIndex[i] = static_cast<std::uint16_t>((offset - mapOffset) / 2 + 1);
+            offset += 2 * readLittleEndian16(data + offset) + 2;
+          }
+        }
+        else
+        {
+          for (int i = 0; i < 4; i++)
+          {
+            if (offset + 1 > size)
+              return false;
+            pairs.mapIndex[i] = static_cast<std::uint16_t>(offset - mapOffset + 1);
+            offset += data[offset] + 1;
+          }
+        }
+      }
+
+      offset += offset & 1;
+    }
+
+    for (int file = 0; file < fileCount; file++)
+      for (int side = 0; side < sides; side++)
+      {
+        PairsData &pairs = table.sides[side][file];
+        pairs.sparseIndex = data + offset;
+        offset += pairs.sparseIndexSize * 6;
+      }
+
+    for (int file = 0; file < fileCount; file++)
+      for (int side = 0; side < sides; side++)
+      {
+        PairsData &pairs = table.sides[side][file];
+        pairs.blockLengths = data + offset;
+        offset += pairs.blockLengthCount * 2;
+      }
+
+    for (int file = 0; file < fileCount; file++)
+      for (int side = 0; side < sides; side++)
+      {
+        PairsData &pairs = table.sides[side][file];
+        offset = (offset + 0x3F) & ~static_cast<std::size_t>(0x3F);
+        pairs.data = data + offset;
+        offset += pairs.blockCount * pairs.blockSize;
+      }
+
+    return offset <= size;
+  }
+
+  bool Syzygy::setGroups(const Table &table, PairsData &pairs, const int order[2], int file)
+  {
+    const Encoding &encoding = getEncoding();
+
+    // Without pawns the leading group is both kings, or with a piece that is there once the first three pieces. Other
+    // groups are runs of the same piece
+    int firstLength = table.hasPawns ? 0 : table.hasUniquePieces ? 3 : 2;
+    int groupCount = 0;
+    pairs.groupLengths[0] = 1;
+    for (int i = 1; i < table.pieceCount; i++)
+    {
+      if (--firstLength > 0 || pairs.pieces[i] == pairs.pieces[i - 1])
+        pairs.groupLengths[groupCount]++;
+      else
+        pairs.groupLengths[++groupCount] = 1;
+    }
+    pairs.groupLengths[++groupCount] = 0;
+
+    for (int group = table.hasPawns ? 0 : 1; group < groupCount; group++)
+      if (pairs.groupLengths[group] > 5)
+        return false;
+
+    // The index is g1 * N(g2) * N(g3) + g2 * N(g3) + g3 with N(g) the ways to place group g, the order of the groups is
+    // up to the table. The leading group goes where order[0] says and the other side's pawns where order[1] says
+    const bool hasPawnsOnBothSides = table.hasPawns && table.pawnCount[1] > 0;
+    int next = hasPawnsOnBothSides ? 2 : 1;
+    int freeSquares = 64 - pairs.groupLengths[0] - (hasPawnsOnBothSides ? pairs.groupLengths[1] : 0);
+    std::uint64_t factor = 1;
+
+    for (int k = 0; next < groupCount || k == order[0] || k == order[1]; k++)
+    {
+      if (k == order[0])
+      {
+        pairs.groupFactors[0] = factor;
+        factor *= table.hasPawns ? encoding.leadPawnsSize[pairs.groupLengths[0]][file]
+                  : table.hasUniquePieces ? uniquePiecesSize
+                                          : kingsSize;
+      }
+      else if (k == order[1])
+      {
+        pairs.groupFactors[1] = factor;
+        factor *= encoding.binomial[pairs.groupLengths[1]][48 - pairs.groupLengths[0]];
+      }
+      else
+      {
+        pairs.groupFactors[next] = factor;
+        factor *= encoding.binomial[pairs.groupLengths[next]][freeSquares];
+        freeSquares -= pairs.groupLengths[next++];
+      }
+    }
+    pairs.groupFactors[groupCount] = factor;
+
+    return true;
+  }
+
+  bool Syzygy::setSizes(PairsData &pairs, const unsigned char *data, std::size_t size, std::size_t &offset)
+  {
+    if (offset + 2 > size)
+      return false;
+
+    pairs.flags = data[offset++];
+
+    // Every position of the side has the same value
+    if (pairs.flags & singleValueFlag)
+    {
+      pairs.blockCount = 0;
+      pairs.blockLengthCount = 0;
+      pairs.span = 0;
+      pairs.sparseIndexSize = 0;
+      pairs.minSymbolLength = data[offset++];
+      return true;
+    }
+
+    if (offset + 9 > size || data[offset] > 30 || data[offset + 1] > 30)
+      return false;
+
+    const int groupCount = static_cast<int>(std::find(pairs.groupLengths, pairs.groupLengths + maxPieces, 0) - pairs.groupLengths);
+    const std::uint64_t tableSize = pairs.groupFactors[groupCount];
+
+    pairs.blockSize = std::size_t(1) << data[offset++];
+    pairs.span = std::size_t(1) << data[offset++];
+    pairs.sparseIndexSize = static_cast<std::size_t>((tableSize + pairs.span - 1) / pairs.span);
+
+    // Extra block lengths so the sparse index near the end does not point past them
+    const int padding = data[offset++];
+    pairs.blockCount = readLittleEndian32(data + offset);
+    offset += 4;
+    pairs.blockLengthCount = pairs.blockCount + padding;
+
+    pairs.maxSymbolLength = data[offset++];
+    pairs.minSymbolLength = data[offset++];
+    if (pairs.minSymbolLength < 1 || pairs.maxSymbolLength < pairs.minSymbolLength || pairs.maxSymbolLength > 32)
+      return false;
+
+    // Canonical Huffman codes: the longer a code, the lower its value, and the codes of one length are consecutive.
+    // base[i] is the lowest code of length minSymbolLength + i padded to 64 bits, so the length of the code at the top of
+    // a 64 bit buffer is the first i whose base is not above it
+    pairs.lowestSymbols = data + offset;
+    pairs.base.assign(pairs.maxSymbolLength - pairs.minSymbolLength + 1, 0);
+    if (offset + 2 * pairs.base.size() + 2 > size)
+      return false;
+
+    for (int i = static_cast<int>(pairs.base.size()) - 2; i >= 0; i--)
+      pairs.base[i] = (pairs.base[i + 1] + readLittleEndian16(pairs.lowestSymbols + 2 * i) -
+                       readLittleEndian16(pairs.lowestSymbols + 2 * (i + 1))) / 2;
+
+    for (std::size_t i = 0; i < pairs.base.size(); i++)
+      pairs.base[i] <<= 64 - i - pairs.minSymbolLength;
+
+    offset += 2 * pairs.base.size();
+    const std::size_t symbolCount = readLittleEndian16(data + offset);
+    offset += 2;
+
+    // Recursive pairing: a symbol is either a value or a pair of two earlier symbols, symbolLengths holds how many values
+    // a symbol stands for minus one
+    pairs.tree = data + offset;
+    if (offset + 3 * symbolCount > size)
+      return false;
+
+    pairs.symbolLengths.assign(symbolCount, 0);
+    std::vector<bool> isVisited(symbolCount, false);
+    std::vector<int> stack;
+    for (std::size_t first = 0; first < symbolCount; first++)
+    {
+      if (isVisited[first])
+        continue;
+
+      // Children first, without recursing as deep as the tree
+      stack.push_back(static_cast<int>(first));
+      while (!stack.empty())
+      {
+        const int symbol = stack.back();
+        isVisited[symbol] = true;
+
+        const int right = getRightSymbol(pairs.tree, symbol);
+        if (right == leafSymbol)
+        {
+          stack.pop_back();
+          continue;
+        }
+
+        const int left = getLeftSymbol(pairs.tree, symbol);
+        if (static_cast<std::size_t>(left) >= symbolCount || static_cast<std::size_t>(right) >= symbolCount)
+          return false;
+
+        if (!isVisited[left])
+          stack.push_back(left);
+        else if (!isVisited[right])
+          stack.push_back(right);
+        else
+        {
+          pairs.symbolLengths[symbol] = static_cast<std::uint8_t>(pairs.symbolLengths[left] + pairs.symbolLengths[right] + 1);
+          stack.pop_back();
+        }
+      }
+    }
+
+    offset += 3 * symbolCount + (symbolCount & 1);
+    return true;
+  }
+
+  int Syzygy::decompress(const PairsData &pairs, std::uint64_t index, const unsigned char *end)
+  {
+    if (pairs.flags & singleValueFlag)
+      return pairs.minSymbolLength;
+
+    // Block k of the sparse index knows the block and the offset in it of value k * span + span / 2, the block of the
+    // index is found by walking the block lengths from there
+    const std::size_t k = static_cast<std::size_t>(index / pairs.span);
+    if (k >= pairs.sparseIndexSize)
+      return -1;
+
+    std::int64_t block = readLittleEndian32(pairs.sparseIndex + 6 * k);
+    std::int64_t offset = readLittleEndian16(pairs.sparseIndex + 6 * k + 4);
+    offset += static_cast<std::int64_t>(index % pairs.span) - static_cast<std::int64_t>(pairs.span / 2);
+
+    const auto getBlockLength = [&pairs](std::int64_t block) { return readLittleEndian16(pairs.blockLengths + 2 * block); };
+    while (offset < 0 && block > 0)
+      offset += getBlockLength(--block) + 1;
+    while (block < static_cast<std::int64_t>(pairs.blockLengthCount) && offset > getBlockLength(block))
+      offset -= getBlockLength(block++) + 1;
+    if (offset < 0 || block >= static_cast<std::int64_t>(pairs.blockCount))
+      return -1;
+
+    // Symbols are read from the top of a 64 bit buffer, refilled 32 bits at a time
+    const unsigned char *pointer = pairs.data + block * pairs.blockSize;
+    std::uint64_t buffer = (static_cast<std::uint64_t>(readBigEndian32(pointer, end)) << 32) | readBigEndian32(pointer + 4, end);
+    pointer += 8;
+    int bufferSize = 64;
+    int symbol;
+
+    while (true)
+    {
+      int length = 0;
+      while (buffer < pairs.base[length])
+        length++;
+
+      symbol = static_cast<int>((buffer - pairs.base[length]) >> (64 - length - pairs.minSymbolLength));
+      symbol += readLittleEndian16(pairs.lowestSymbols + 2 * length);
+      if (static_cast<std::size_t>(symbol) >= pairs.symbolLengths.size())
+        return -1;
+
+      if (offset < pairs.symbolLengths[symbol] + 1)
+        break;
+
+      offset -= pairs.symbolLengths[symbol] + 1;
+      length += pairs.minSymbolLength;
+      buffer <<= length;
+      bufferSize -= length;
+
+      if (bufferSize <= 32)
+      {
+        bufferSize += 32;
+        buffer |= static_cast<std::uint64_t>(readBigEndian32(pointer, end)) << (64 - bufferSize);
+        pointer += 4;
+      }
+    }
+
+    // The symbol stands for symbolLengths + 1 values, the pairs are split until the value at the offset is left
+    while (pairs.symbolLengths[symbol] != 0)
+    {
+      const int left = getLeftSymbol(pairs.tree, symbol);
+      if (offset < pairs.symbolLengths[left] + 1)
+        symbol = left;
+      else
+      {
+        offset -= pairs.symbolLengths[left] + 1;
+        symbol = getRightSymbol(pairs.tree, symbol);
+      }
+    }
+
+    return getLeftSymbol(pairs.tree, symbol);
+  }
+
+  int Syzygy::mapScore(const Table &table, int file, int value, int wdl)
+  {
+    const PairsData &pairs = table.sides[0][file];
+
+    if (pairs.flags & mappedFlag)
+    {
+      const int mapIndex = pairs.mapIndex[wdlMaps[wdl + 2]];
+      value = pairs.flags & wideFlag ? readLittleEndian16(table.map + 2 * (mapIndex + value)) : table.map[mapIndex + value];
+    }
+
+    // Stored in full moves unless the flags say half moves, results the fifty move rule changes always in full moves
+    if ((wdl == 2 && (pairs.flags & winPliesFlag) == 0) || (wdl == -2 && (pairs.flags & lossPliesFlag) == 0) ||
+        wdl == 1 || wdl == -1)
+      value *= 2;
+
+    return value + 1;
+  }
+
+  Syzygy::ProbeState Syzygy::findIndex(const std::vector<Tablebase::TablePiece> &pieces, bool isWhiteToMove, bool isDtz,
+                                       Table *&table, int &side, int &file, std::uint64_t &index)
+  {
+    const Encoding &encoding = getEncoding();
+
+    bool isSwapped;
+    table = getTable(getSignature(pieces), isDtz, isSwapped);
+    if (table == nullptr)
+      return ProbeState::FAIL;
+
+    // Tables store white as the stronger side, and a symmetric one only white to move. Otherwise the colours are
+    // swapped and the board turned upside down
+    const bool isFlipped = isSwapped || (table->isSymmetric && !isWhiteToMove);
+    const int flipColour = isFlipped ? blackCode : 0;
+    const int flipSquares = isFlipped ? 56 : 0;
+    side = isFlipped == isWhiteToMove ? 1 : 0;
+    file = 0;
+
+    int squares[maxPieces];
+    int codes[maxPieces];
+    int size = 0;
+    int leadPawnCount = 0;
+    int leadPawnCode = -1;
+
+    // With pawns the table is split by the file of the leading pawn, the one nearest the edge and then the lowest
+    if (table->hasPawns)
+    {
+      leadPawnCode = table->sides[0][0].pieces[0] ^ flipColour;
+      for (const auto &piece : pieces)
+        if (getPieceCode(piece) == leadPawnCode)
+          squares[size++] = piece.square ^ flipSquares;
+
+      leadPawnCount = size;
+      std::swap(squares[0], *std::max_element(squares, squares + leadPawnCount, [&encoding](int first, int second)
+                                              { return encoding.mapPawns[first] < encoding.mapPawns[second]; }));
+      file = getEdgeDistance(getFile(squares[0]));
+    }
+
+    // A DTZ table stores one side to move, the other one is probed one move deeper
+    if (isDtz && (table->sides[0][file].flags & sideToMoveFlag) != side && !(table->isSymmetric && !table->hasPawns))
+      return ProbeState::CHANGE_SIDE;
+
+    for (const auto &piece : pieces)
+    {
+      if (getPieceCode(piece) == leadPawnCode)
+        continue;
+      squares[size] = piece.square ^ flipSquares;
+      codes[size++] = getPieceCode(piece) ^ flipColour;
+    }
+
+    const PairsData &pairs = table->sides[isDtz ? 0 : side][file];
+
+    // The pieces in the order of the table
+    for (int i = leadPawnCount; i < size - 1; i++)
+      for (int j = i; j < size; j++)
+        if (codes[j] == pairs.pieces[i])
+        {
+          std::swap(codes[i], codes[j]);
+          std::swap(squares[i], squares[j]);
+          break;
+        }
+
+    // The leading piece goes to files a to d
+    if (getFile(squares[0]) > 3)
+      for (int i = 0; i < size; i++)
+        squares[i] ^= 7;
+
+    if (table->hasPawns)
+    {
+      index = encoding.leadPawnIndex[leadPawnCount][squares[0]];
+
+      std::stable_sort(squares + 1, squares + leadPawnCount, [&encoding](int first, int second)
+                       { return encoding.mapPawns[first] < encoding.mapPawns[second]; });
+      for (int i = 1; i < leadPawnCount; i++)
+        index += encoding.binomial[i][encoding.mapPawns[squares[i]]];
+    }
+    else
+    {
+      // Without pawns also to ranks 1 to 4, and the first leading piece off the a1-h8 diagonal below it
+      if (getRank(squares[0]) > 3)
+        for (int i = 0; i < size; i++)
+          squares[i] ^= 56;
+
+      for (int i = 0; i < pairs.groupLengths[0]; i++)
+      {
+        if (getDiagonalOffset(squares[i]) == 0)
+          continue;
+
+        if (getDiagonalOffset(squares[i]) > 0)
+          for (int j = i; j < size; j++)
+            squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+        break;
+      }
+
+      if (table->hasUniquePieces)
+      {
+        const int adjust1 = squares[1] > squares[0];
+        const int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+
+        // First piece below the diagonal in the b1-d1-d3 triangle, then first on the diagonal and second below, then the
+        // first two on it and the third below, then all three on it
+        if (getDiagonalOffset(squares[0]) != 0)
+          index = (encoding.mapA1D1D4[squares[0]] * 63 + (squares[1] - adjust1)) * 62 + squares[2] - adjust2;
+        else if (getDiagonalOffset(squares[1]) != 0)
+          index = (6 * 63 + getRank(squares[0]) * 28 + encoding.mapB1H1H7[squares[1]]) * 62 + squares[2] - adjust2;
+        else if (getDiagonalOffset(squares[2]) != 0)
+          index = 6 * 63 * 62 + 4 * 28 * 62 + getRank(squares[0]) * 7 * 28 + (getRank(squares[1]) - adjust1) * 28 +
+                  encoding.mapB1H1H7[squares[2]];
+        else
+          index = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + getRank(squares[0]) * 7 * 6 + (getRank(squares[1]) - adjust1) * 6 +
+                  (getRank(squares[2]) - adjust2);
+      }
+      else
+        index = encoding.mapKK[encoding.mapA1D1D4[squares[0]]][squares[1]];
+    }
+
+    index *= pairs.groupFactors[0];
+
+    // The other groups, each square counted without the squares of the groups before it
+    bool isRemainingPawns = table->hasPawns && table->pawnCount[1] > 0;
+    int groupStart = pairs.groupLengths[0];
+    for (int group = 1; pairs.groupLengths[group] != 0; group++)
+    {
+      const int groupEnd = groupStart + pairs.groupLengths[group];
+      std::sort(squares + groupStart, squares + groupEnd);
+
+      std::uint64_t groupIndex = 0;
+      for (int i = groupStart; i < groupEnd; i++)
+      {
+        const int adjust = static_cast<int>(std::count_if(squares, squares + groupStart, [&squares, i](int square)
+                                                          { return squares[i] > square; }));
+        groupIndex += encoding.binomial[i - groupStart + 1][squares[i] - adjust - 8 * isRemainingPawns];
+      }
+
+      isRemainingPawns = false;
+      index += groupIndex * pairs.groupFactors[group];
+      groupStart = groupEnd;
+    }
+
+    return ProbeState::OK;
+  }
+
+  bool Syzygy::getIndex(const std::vector<Tablebase::TablePiece> &pieces, bool isWhiteToMove, bool isDtz, int &side, int &file,
+                        std::uint64_t &index)
+  {
+    Table *table;
+    return findIndex(pieces, isWhiteToMove, isDtz, table, side, file, index) == ProbeState::OK;
+  }
+
+  Syzygy::ProbeState Syzygy::probeTable(const std::vector<Tablebase::TablePiece> &pieces, bool isWhiteToMove, bool isDtz, int wdl, int &value)
+  {
+    // Bare kings have no table
+    if (pieces.size() == 2)
+    {
+      value = 0;
+      return ProbeState::OK;
+    }
+
+    Table *table;
+    int side;
+    int file;
+    std::uint64_t index;
+    const ProbeState state = findIndex(pieces, isWhiteToMove, isDtz, table, side, file, index);
+    if (state != ProbeState::OK)
+      return state;
+
+    const int stored = decompress(table->sides[isDtz ? 0 : side][file], index, table->file.getData() + table->file.getSize());
+    if (stored < 0)
+      return ProbeState::FAIL;
+
+    value = isDtz ? mapScore(*table, file, stored, wdl) : stored - 2;
+    return ProbeState::OK;
+  }
+
+  int Syzygy::search(Board::Board &board, bool isZeroingChecked, ProbeState &state)
+  {
+    switch (board.gameState)
+    {
+    case Board::GameState::CHECKMATE:
+      state = ProbeState::OK;
+      return -2;
+    case Board::GameState::STALEMATE:
+    case Board::GameState::INSUFFICIENT_MATERIAL:
+      state = ProbeState::OK;
+      return 0;
+    case Board::GameState::FIFTY_MOVE_RULE:
+      // No move can be made on the board any more
+      state = ProbeState::FAIL;
+      return 0;
+    default:
+      break;
+    }
+
+    const std::vector<Move::Move> moves = board.getAllValidMoves();
+    std::size_t searchedCount = 0;
+    int bestValue = -2;
+
+    for (const auto &move : moves)
+    {
+      if (!isCapture(board, move) && (!isZeroingChecked || move.pieceType != Move::PieceType::PAWN))
+        continue;
+
+      searchedCount++;
+
+      if (!board.makeMove(move))
+      {
+        state = ProbeState::FAIL;
+        return 0;
+      }
+      const int value = -search(board, false, state);
+      board.undoMove();
+
+      if (state == ProbeState::FAIL)
+        return 0;
+
+      if (value > bestValue)
+      {
+        bestValue = value;
+        if (value == 2)
+        {
+          state = ProbeState::ZEROING_BEST_MOVE;
+          return value;
+        }
+      }
+    }
+
+    // With every move searched the table is not needed, it may even be wrong as it knows nothing of en passant
+    const bool isEveryMoveSearched = searchedCount != 0 && searchedCount == moves.size();
+
+    int value = bestValue;
+    if (!isEveryMoveSearched)
+    {
+      state = probeTable(getPieces(board), board.isWhiteTurn, false, 0, value);
+      if (state == ProbeState::FAIL)
+        return 0;
+    }
+
+    // The table may hold anything where the best capture is at least as good
+    if (bestValue >= value)
+    {
+      state = bestValue > 0 || isEveryMoveSearched ? ProbeState::ZEROING_BEST_MOVE : ProbeState::OK;
+      return bestValue;
+    }
+
+    state = ProbeState::OK;
+    return value;
+  }
+
+  bool Syzygy::probeWdl(Board::Board &board, Wdl &result)
+  {
+    if (this->largestTable == 0 || getPieceCount(board) > this->largestTable || hasCastlingRights(board))
+      return false;
+
+    ProbeState state = ProbeState::OK;
+    const int value = search(board, false, state);
+    if (state == ProbeState::FAIL)
+      return false;
+
+    result = static_cast<Wdl>(value);
+    return true;
+  }
+
+  bool Syzygy::probeDtz(Board::Board &board, int &result)
+  {
+    if (this->largestTable == 0 || getPieceCount(board) > this->largestTable || hasCastlingRights(board))
+      return false;
+
+    ProbeState state = ProbeState::OK;
+    const int wdl = search(board, true, state);
+    if (state == ProbeState::FAIL)
+      return false;
+
+    if (wdl == 0)
+    {
+      result = 0;
+      return true;
+    }
+
+    if (board.gameState == Board::GameState::CHECKMATE)
+    {
+      result = -1;
+      return true;
+    }
+
+    if (state == ProbeState::ZEROING_BEST_MOVE)
+    {
+      result = getDtzBeforeZeroing(wdl);
+      return true;
+    }
+
+    int dtz = 0;
+    state = probeTable(getPieces(board), board.isWhiteTurn, true, wdl, dtz);
+    if (state == ProbeState::FAIL)
+      return false;
+
+    if (state == ProbeState::OK)
+    {
+      result = (dtz + (wdl == 1 || wdl == -1 ? 100 : 0)) * getSign(wdl);
+      return true;
+    }
+
+    // The table stores the other side to move, the best move is the one with the best DTZ one move deeper
+    int bestDtz = 0xFFFF;
+    for (const auto &move : board.getAllValidMoves())
+    {
+      const bool isZeroing = isCapture(board, move) || move.pieceType == Move::PieceType::PAWN;
+
+      if (!board.makeMove(move))
+        return false;
+
+      // After a zeroing move only the result counts, the DTZ is the one of the move itself
+      bool isFound = true;
+      if (isZeroing)
+      {
+        ProbeState childState = ProbeState::OK;
+        dtz = -getDtzBeforeZeroing(search(board, false, childState));
+        isFound = childState != ProbeState::FAIL;
+      }
+      else
+      {
+        int childDtz = 0;
+        isFound = probeDtz(board, childDtz);
+        dtz = -childDtz;
+      }
+
+      if (dtz == 1 && board.gameState == Board::GameState::CHECKMATE)
+        bestDtz = 1;
+
+      if (!isZeroing)
+        dtz += getSign(dtz);
+
+      if (dtz < bestDtz && getSign(dtz) == getSign(wdl))
+        bestDtz = dtz;
+
+      board.undoMove();
+
+      if (!isFound)
+        return false;
+    }
+
+    // Without a legal move the side to move is mated
+    result = bestDtz == 0xFFFF ? -1 : bestDtz;
+    return true;
+  }
+
+  bool Syzygy::probeRoot(Board::Board &board, std::vector<Move::Move> &moves, Wdl &result)
+  {
+    if (moves.empty() || this->largestTable == 0 || getPieceCount(board) > this->largestTable || hasCastlingRights(board))
+      return false;
+
+    const int fiftyMoveCount = board.fiftyMoveRuleCounter;
+    const bool isRepeated = hasRepeated(board);
+
+    struct RankedMove
+    {
+      Move::Move move;
+      int rank;
+      int dtz;
+    };
+    std::vector<RankedMove> rankedMoves;
+
+    for (const auto &move : moves)
+    {
+      if (!board.makeMove(move))
+        return false;
+
+      // DTZ counted from the root
+      bool isFound = true;
+      int dtz = 0;
+      if (board.fiftyMoveRuleCounter == 0)
+      {
+        Wdl wdl;
+        isFound = probeWdl(board, wdl);
+        dtz = getDtzBeforeZeroing(-static_cast<int>(wdl));
+      }
+      else if (board.gameState != Board::GameState::FIFTY_MOVE_RULE && !isThreefoldRepetition(board))
+      {
+        int childDtz = 0;
+        isFound = probeDtz(board, childDtz);
+        dtz = -childDtz;
+        dtz += getSign(dtz);
+      }
+
+      if (board.gameState == Board::GameState::CHECKMATE && dtz == 2)
+        dtz = 1;
+
+      board.undoMove();
+
+      if (!isFound)
+        return false;
+
+      // Every win that comes before the fifty move rule ranks the same, later ones and losses the fifty move rule might
+      // still save rank by how far the rule is
+      int rank = 0;
+      if (dtz > 0)
+        rank = dtz + fiftyMoveCount <= 99 && !isRepeated ? maxDtz : maxDtz - (dtz + fiftyMoveCount);
+      else if (dtz < 0)
+        rank = -dtz * 2 + fiftyMoveCount < 100 ? -maxDtz : -maxDtz + (-dtz + fiftyMoveCount);
+
+      rankedMoves.push_back({move, rank, dtz});
+    }
+
+    const int bestRank = std::max_element(rankedMoves.begin(), rankedMoves.end(), [](const RankedMove &first, const RankedMove &second)
+                                          { return first.rank < second.rank; })->rank;
+
+    rankedMoves.erase(std::remove_if(rankedMoves.begin(), rankedMoves.end(), [bestRank](const RankedMove &rankedMove)
+                                     { return rankedMove.rank != bestRank; }),
+                      rankedMoves.end());
+
+    // The shortest way to the next capture, pawn move or mate wins, the longest one loses slowest
+    std::stable_sort(rankedMoves.begin(), rankedMoves.end(), [](const RankedMove &first, const RankedMove &second)
+                     { return first.dtz < second.dtz; });
+
+    moves.clear();
+    for (const auto &rankedMove : rankedMoves)
+      moves.push_back(rankedMove.move);
+
+    const int bound = maxDtz - 100;
+    result = bestRank >= bound ? Wdl::WIN
+             : bestRank > 0    ? Wdl::CURSED_WIN
+             : bestRank == 0   ? Wdl::DRAW
+             : bestRank > -bound ? Wdl::BLESSED_LOSS
+                                 : Wdl::LOSS;
+    return true;
+  }
+} // namespace Syzygy
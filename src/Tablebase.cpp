@@ -0,0 +1,315 @@
+#include "Tablebase.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+#include "BoardScan.hpp"
+
+namespace {
+  // Order of the pieces inside a signature, also the order of their squares in the index
+  constexpr char pieceLetters[] = "KQRBNP";
+  constexpr int pieceValues[] = {0, 9, 5, 3, 3, 1};
+
+  int getPieceOrder(unsigned long long piece) {
+    switch (piece & ~Board::Board::BLACK) {
+      case Board::Board::KING:
+        return 0;
+      case Board::Board::QUEEN:
+        return 1;
+      case Board::Board::ROOK:
+        return 2;
+      case Board::Board::BISHOP:
+        return 3;
+      case Board::Board::KNIGHT:
+        return 4;
+      default:
+        return 5;
+    }
+  }
+
+  struct Side {
+    std::string letters;
+    std::vector<int> squares;
+    int value = 0;
+  };
+
+  bool hasCastlingRights(const Board::Board &board) {
+    return (!board.hasWhiteKingMoved && (!board.hasWhiteRookAMoved || !board.hasWhiteRookHMoved)) ||
+           (!board.hasBlackKingMoved && (!board.hasBlackRookAMoved || !board.hasBlackRookHMoved));
+  }
+
+  // The tables know nothing about en passant, a pawn that just moved two squares next to an enemy pawn makes the position unknown
+  bool hasEnPassant(const Board::Board &board) {
+    if (board.moveHistory.empty())
+      return false;
+
+    const Move::Move &lastMove = board.moveHistory.back();
+    if (lastMove.pieceType != Move::PieceType::PAWN || std::abs(lastMove.to - lastMove.from) != 16)
+      return false;
+
+    const int file = lastMove.to % 8;
+    const unsigned long long ownPawn = Board::Board::PAWN | (board.isWhiteTurn ? 0 : Board::Board::BLACK);
+    return (file > 0 && board.board[lastMove.to - 1] == ownPawn) || (file < 7 && board.board[lastMove.to + 1] == ownPawn);
+  }
+}
+
+namespace Tablebase
+{
+  bool Tablebase::setPath(const std::string &directory)
+  {
+    close();
+
+    std::error_code error;
+    for (const auto &file : std::filesystem::directory_iterator(directory, error))
+    {
+      if (!file.is_regular_file() || file.path().extension() != extension)
+        continue;
+
+      const std::string signature = file.path().stem().string();
+      const int pieceCount = static_cast<int>(signature.size()) - 1;
+      if (signature.find('v') == std::string::npos || pieceCount > maxPieces)
+        continue;
+
+      this->tables[signature].path = file.path().string();
+      this->largestTable = std::max(this->largestTable, pieceCount);
+    }
+
+    return isAvailable();
+  }
+
+  void Tablebase::close()
+  {
+    this->tables.clear();
+    this->largestTable = 0;
+  }
+
+  bool Tablebase::isAvailable() const
+  {
+    return !this->tables.empty();
+  }
+
+  int Tablebase::getMaxPieces() const
+  {
+    return this->largestTable;
+  }
+
+  const Tablebase::Table *Tablebase::getTable(const std::string &signature)
+  {
+    auto found = this->tables.find(signature);
+    if (found == this->tables.end())
+      return nullptr;
+
+    Table &table = found->second;
+    if (!table.isLoaded && !table.isBroken)
+    {
+      const int pieceCount = static_cast<int>(signature.size()) - 1;
+      const unsigned char *data = nullptr;
+
+      if (table.file.open(table.path))
+        data = table.file.getData();
+
+      table.isBroken = data == nullptr ||
+                       table.file.getSize() != headerSize + 2 * getEntryCount(pieceCount) ||
+                       std::memcmp(data, magic, 4) != 0 || data[4] != version || data[5] != pieceCount;
+      table.isLoaded = !table.isBroken;
+
+      if (table.isBroken)
+        table.file.close();
+    }
+
+    return table.isLoaded ? &table : nullptr;
+  }
+
+  bool Tablebase::probe(const Board::Board &board, ProbeResult &result)
+  {
+    if (this->largestTable == 0 || hasCastlingRights(board) || hasEnPassant(board))
+      return false;
+
+    TablePosition position;
+    if (!getTablePosition(board, position) || static_cast<int>(position.squares.size()) > this->largestTable)
+      return false;
+
+    const Table *table = getTable(position.signature);
+    if (table == nullptr)
+      return false;
+
+    const unsigned char *bytes = table->file.getData() + headerSize + 2 * getIndex(position);
+    const std::int16_t value = static_cast<std::int16_t>(bytes[0] | (bytes[1] << 8));
+    if (value == illegalValue)
+      return false;
+
+    result = decodeValue(value);
+
+    // A mate the fifty move rule would stop is not a win any more, the search has to find out what it is
+    if (result.wdl != Wdl::DRAW && board.fiftyMoveRuleCounter + result.distance > fiftyMoveLimit)
+      return false;
+
+    return true;
+  }
+
+  bool Tablebase::probeRoot(Board::Board &board, std::vector<Move::Move> &moves, ProbeResult &result)
+  {
+    if (moves.empty())
+      return false;
+
+    std::vector<std::pair<Move::Move, ProbeResult>> results;
+    for (const auto &move : moves)
+    {
+      ProbeResult childResult;
+      if (!board.makeMove(move))
+        return false;
+      const bool isFound = probe(board, childResult);
+      board.undoMove();
+
+      if (!isFound)
+        return false;
+
+      // The child result is for the opponent
+      ProbeResult moveResult;
+      moveResult.wdl = static_cast<Wdl>(-static_cast<int>(childResult.wdl));
+      moveResult.distance = childResult.wdl == Wdl::DRAW ? 0 : childResult.distance + 1;
+      results.emplace_back(move, moveResult);
+    }
+
+    Wdl best = Wdl::LOSS;
+    for (const auto &moveResult : results)
+      best = std::max(best, moveResult.second.wdl);
+
+    results.erase(std::remove_if(results.begin(), results.end(), [best](const std::pair<Move::Move, ProbeResult> &moveResult)
+                                 { return moveResult.second.wdl != best; }),
+                  results.end());
+
+    // Win as fast as possible, lose as slowly as possible
+    std::stable_sort(results.begin(), results.end(), [best](const std::pair<Move::Move, ProbeResult> &first, const std::pair<Move::Move, ProbeResult> &second)
+                     { return best == Wdl::LOSS ? first.second.distance > second.second.distance : first.second.distance < second.second.distance; });
+
+    moves.clear();
+    for (const auto &moveResult : results)
+      moves.push_back(moveResult.first);
+
+    result = results[0].second;
+    return true;
+  }
+
+  bool Tablebase::getTablePosition(const Board::Board &board, TablePosition &position)
+  {
+    std::vector<TablePiece> pieces;
+
+    for (std::uint64_t occupied = BoardScan::getOccupiedMask(board.packedBoard); occupied != 0; occupied &= occupied - 1)
+    {
+      if (pieces.size() == static_cast<size_t>(maxPieces))
+        return false;
+
+      const int square = __builtin_ctzll(occupied);
+      const unsigned long long piece = board.board[square];
+      pieces.push_back({pieceLetters[getPieceOrder(piece)], (piece & Board::Board::BLACK) == 0, square});
+    }
+
+    return getTablePosition(pieces, board.isWhiteTurn, position);
+  }
+
+  bool Tablebase::getTablePosition(const std::vector<TablePiece> &pieces, bool isWhiteToMove, TablePosition &position)
+  {
+    Side white;
+    Side black;
+    std::vector<std::pair<int, int>> whitePieces;
+    std::vector<std::pair<int, int>> blackPieces;
+
+    for (const TablePiece &piece : pieces)
+    {
+      const int order = static_cast<int>(std::strchr(pieceLetters, piece.letter) - pieceLetters);
+      (piece.isWhite ? whitePieces : blackPieces).emplace_back(order, piece.square);
+    }
+
+    std::sort(whitePieces.begin(), whitePieces.end());
+    std::sort(blackPieces.begin(), blackPieces.end());
+
+    for (const auto &piece : whitePieces)
+    {
+      white.letters += pieceLetters[piece.first];
+      white.squares.push_back(piece.second);
+      white.value += pieceValues[piece.first];
+    }
+    for (const auto &piece : blackPieces)
+    {
+      black.letters += pieceLetters[piece.first];
+      black.squares.push_back(piece.second);
+      black.value += pieceValues[piece.first];
+    }
+
+    if (white.letters.empty() || white.letters[0] != 'K' || black.letters.empty() || black.letters[0] != 'K' ||
+        white.letters.find('K', 1) != std::string::npos || black.letters.find('K', 1) != std::string::npos)
+      return false;
+
+    // Black as the stronger side is stored with the colours swapped and the board turned upside down
+    const bool isBlackStrong = std::make_pair(black.value, black.letters) > std::make_pair(white.value, white.letters);
+    const Side &strong = isBlackStrong ? black : white;
+    const Side &weak = isBlackStrong ? white : black;
+    const int flip = isBlackStrong ? 56 : 0;
+
+    // Without castling rights the board can be mirrored left to right, so the strong king only needs half of it
+    const int mirror = strong.squares[0] % 8 > 3 ? 7 : 0;
+
+    position.signature = strong.letters + "v" + weak.letters;
+    position.squares.clear();
+    for (int square : strong.squares)
+      position.squares.push_back(square ^ flip ^ mirror);
+    for (int square : weak.squares)
+      position.squares.push_back(square ^ flip ^ mirror);
+    position.isStrongSideToMove = isWhiteToMove != isBlackStrong;
+
+    return true;
+  }
+
+  std::size_t Tablebase::getIndex(const TablePosition &position)
+  {
+    const int strongKing = position.squares[0];
+    std::size_t index = position.isStrongSideToMove ? 0 : 1;
+    index = index * 32 + (strongKing / 8) * 4 + strongKing % 8;
+
+    for (size_t i = 1; i < position.squares.size(); i++)
+      index = index * 64 + position.squares[i];
+
+    return index;
+  }
+
+  std::size_t Tablebase::getEntryCount(int pieceCount)
+  {
+    std::size_t count = 2 * 32;
+    for (int i = 1; i < pieceCount; i++)
+      count *= 64;
+    return count;
+  }
+
+  std::int16_t Tablebase::encodeValue(const ProbeResult &result)
+  {
+    switch (result.wdl)
+    {
+    case Wdl::WIN:
+      return static_cast<std::int16_t>(result.distance);
+    case Wdl::LOSS:
+      return static_cast<std::int16_t>(-result.distance - 1);
+    default:
+      return 0;
+    }
+  }
+
+  ProbeResult Tablebase::decodeValue(std::int16_t value)
+  {
+    ProbeResult result;
+    if (value > 0)
+    {
+      result.wdl = Wdl::WIN;
+      result.distance = value;
+    }
+    else if (value < 0)
+    {
+      result.wdl = Wdl::LOSS;
+      result.distance = -value - 1;
+    }
+    return result;
+  }
+} // namespace Tablebase
@@ -0,0 +1,667 @@
+#include "TablebaseGenerator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <set>
+#include <unordered_map>
+
+#include "Attacks.hpp"
+#include "MappedFile.hpp"
+
+namespace {
+  using Table = Tablebase::Tablebase;
+
+  constexpr int maxPieces = Table::maxPieces;
+
+  // Not decided yet in the values, no capture or promotion in the exits
+  constexpr std::int16_t unknownValue = std::numeric_limits<std::int16_t>::max();
+  constexpr std::int16_t noExit = std::numeric_limits<std::int16_t>::max();
+
+  // Positions per task, small enough that every thread gets many of them
+  constexpr std::size_t chunkSize = 1 << 14;
+
+  const std::string pieceLetters = "KQRBNP";
+  const std::string promotionLetters = "QRBN";
+
+  // The pieces of a signature, the strong side plays white like in the tables
+  struct Layout
+  {
+    int pieceCount = 0;
+    char letters[maxPieces] = {};
+    bool isWhite[maxPieces] = {};
+    int kings[2] = {0, 0};
+  };
+
+  // Piece i of the layout stands on squares[i]
+  struct Position
+  {
+    int squares[maxPieces] = {};
+    bool isWhiteToMove = true;
+  };
+
+  Layout getLayout(const std::string &signature) {
+    Layout layout;
+    bool isWhite = true;
+
+    for (char letter : signature) {
+      if (letter == 'v') {
+        isWhite = false;
+        layout.kings[1] = layout.pieceCount;
+        continue;
+      }
+
+      layout.letters[layout.pieceCount] = letter;
+      layout.isWhite[layout.pieceCount] = isWhite;
+      layout.pieceCount++;
+    }
+    return layout;
+  }
+
+  std::int16_t encode(Tablebase::Wdl wdl, int distance) {
+    Tablebase::ProbeResult result;
+    result.wdl = wdl;
+    result.distance = distance;
+    return Table::encodeValue(result);
+  }
+
+  bool isWin(std::int16_t value) {
+    return value > 0 && value != unknownValue;
+  }
+
+  bool isLoss(std::int16_t value) {
+    return value < 0 && value != Table::illegalValue;
+  }
+
+  int getDistance(std::int16_t value) {
+    return Table::decodeValue(value).distance;
+  }
+
+  // Higher is better for the side to move, quick wins first and slow losses last
+  int getPreference(std::int16_t value) {
+    if (value == noExit)
+      return std::numeric_limits<int>::min();
+    if (isWin(value))
+      return 100000 - getDistance(value);
+    if (isLoss(value))
+      return -100000 + getDistance(value);
+    return 0;
+  }
+
+  // The same layout as Tablebase::getIndex, mirrored so the strong king is on files a to d
+  std::size_t getIndex(const Layout &layout, const Position &position) {
+    const int mirror = position.squares[0] % 8 > 3 ? 7 : 0;
+    const int king = position.squares[0] ^ mirror;
+
+    std::size_t index = (position.isWhiteToMove ? 0 : 1) * 32 + (king / 8) * 4 + king % 8;
+    for (int i = 1; i < layout.pieceCount; i++)
+      index = index * 64 + (position.squares[i] ^ mirror);
+    return index;
+  }
+
+  Position getPosition(const Layout &layout, std::size_t index) {
+    Position position;
+    for (int i = layout.pieceCount - 1; i > 0; i--) {
+      position.squares[i] = static_cast<int>(index % 64);
+      index /= 64;
+    }
+
+    const int king = static_cast<int>(index % 32);
+    position.squares[0] = (king / 4) * 8 + king % 4;
+    position.isWhiteToMove = index / 32 == 0;
+    return position;
+  }
+
+  std::uint64_t getOccupancy(const Layout &layout, const Position &position, int captured) {
+    std::uint64_t occupancy = 0;
+    for (int i = 0; i < layout.pieceCount; i++) {
+      if (i != captured)
+        occupancy |= 1ULL << position.squares[i];
+    }
+    return occupancy;
+  }
+
+  std::uint64_t getAttacks(char letter, bool isWhite, int square, std::uint64_t occupancy) {
+    switch (letter) {
+      case 'K':
+        return Attacks::getKingAttacks(square);
+      case 'Q':
+        return Attacks::getBishopAttacks(square, occupancy) | Attacks::getRookAttacks(square, occupancy);
+      case 'R':
+        return Attacks::getRookAttacks(square, occupancy);
+      case 'B':
+        return Attacks::getBishopAttacks(square, occupancy);
+      case 'N':
+        return Attacks::getKnightAttacks(square);
+      default:
+        return Attacks::getPawnAttacks(1ULL << square, isWhite ? 0 : 1);
+    }
+  }
+
+  // The captured piece is still in the position but attacks nothing any more
+  bool isInCheck(const Layout &layout, const Position &position, bool white, int captured = -1) {
+    const std::uint64_t occupancy = getOccupancy(layout, position, captured);
+    const std::uint64_t king = 1ULL << position.squares[layout.kings[white ? 0 : 1]];
+
+    for (int i = 0; i < layout.pieceCount; i++) {
+      if (i != captured && layout.isWhite[i] != white &&
+          (getAttacks(layout.letters[i], layout.isWhite[i], position.squares[i], occupancy) & king))
+        return true;
+    }
+    return false;
+  }
+
+  bool isLegal(const Layout &layout, const Position &position) {
+    for (int i = 0; i < layout.pieceCount; i++) {
+      if (layout.letters[i] == 'P' && (position.squares[i] < 8 || position.squares[i] >= 56))
+        return false;
+
+      for (int j = 0; j < i; j++) {
+        if (position.squares[i] == position.squares[j])
+          return false;
+      }
+    }
+
+    return !isInCheck(layout, position, !position.isWhiteToMove);
+  }
+
+  // Every pseudo legal move, visit gets the position after it, the index of a captured piece or -1 and the letter of
+  // a promotion or 0
+  template <typename Visit>
+  void forEachMove(const Layout &layout, const Position &position, Visit visit) {
+    const std::uint64_t occupancy = getOccupancy(layout, position, -1);
+    std::uint64_t own = 0;
+    for (int i = 0; i < layout.pieceCount; i++) {
+      if (layout.isWhite[i] == position.isWhiteToMove)
+        own |= 1ULL << position.squares[i];
+    }
+
+    const auto getPieceOn = [&](int square) {
+      for (int i = 0; i < layout.pieceCount; i++) {
+        if (position.squares[i] == square)
+          return i;
+      }
+      return -1;
+    };
+
+    for (int i = 0; i < layout.pieceCount; i++) {
+      if (layout.isWhite[i] != position.isWhiteToMove)
+        continue;
+
+      const int from = position.squares[i];
+      Position child = position;
+      child.isWhiteToMove = !position.isWhiteToMove;
+
+      const auto moveTo = [&](int to, int captured) {
+        child.squares[i] = to;
+        if (layout.letters[i] == 'P' && (to < 8 || to >= 56)) {
+          for (char promotion : promotionLetters)
+            visit(i, child, captured, promotion);
+        } else {
+          visit(i, child, captured, '\0');
+        }
+      };
+
+      if (layout.letters[i] == 'P') {
+        const int forward = layout.isWhite[i] ? 8 : -8;
+        const int startRank = layout.isWhite[i] ? 1 : 6;
+
+        if (!(occupancy & (1ULL << (from + forward)))) {
+          moveTo(from + forward, -1);
+          if (from / 8 == startRank && !(occupancy & (1ULL << (from + 2 * forward))))
+            moveTo(from + 2 * forward, -1);
+        }
+
+        for (std::uint64_t targets = getAttacks('P', layout.isWhite[i], from, occupancy) & occupancy & ~own; targets != 0; targets &= targets - 1) {
+          const int to = Attacks::getFirstSquare(targets);
+          moveTo(to, getPieceOn(to));
+        }
+        continue;
+      }
+
+      for (std::uint64_t targets = getAttacks(layout.letters[i], layout.isWhite[i], from, occupancy) & ~own; targets != 0; targets &= targets - 1) {
+        const int to = Attacks::getFirstSquare(targets);
+        moveTo(to, (occupancy & (1ULL << to)) ? getPieceOn(to) : -1);
+      }
+    }
+  }
+
+  // Every move that could have led to the position and stays in the table, no captures and no promotions, visit gets
+  // the position before it
+  template <typename Visit>
+  void forEachUnmove(const Layout &layout, const Position &position, Visit visit) {
+    const std::uint64_t occupancy = getOccupancy(layout, position, -1);
+    const bool isWhiteMover = !position.isWhiteToMove;
+
+    for (int i = 0; i < layout.pieceCount; i++) {
+      if (layout.isWhite[i] != isWhiteMover)
+        continue;
+
+      const int to = position.squares[i];
+      Position parent = position;
+      parent.isWhiteToMove = isWhiteMover;
+
+      if (layout.letters[i] == 'P') {
+        // Pushes backwards, a pawn on its fourth rank may also come from its second
+        const int backward = isWhiteMover ? -8 : 8;
+        const int from = to + backward;
+        const int fromRank = isWhiteMover ? from / 8 : 7 - from / 8;
+        if (fromRank < 1 || (occupancy & (1ULL << from)))
+          continue;
+
+        parent.squares[i] = from;
+        visit(parent);
+
+        if (fromRank == 2 && !(occupancy & (1ULL << (from + backward)))) {
+          parent.squares[i] = from + backward;
+          visit(parent);
+        }
+        continue;
+      }
+
+      // Sliding back over empty squares is the same as sliding forward
+      for (std::uint64_t sources = getAttacks(layout.letters[i], isWhiteMover, to, occupancy) & ~occupancy; sources != 0; sources &= sources - 1) {
+        parent.squares[i] = Attacks::getFirstSquare(sources);
+        visit(parent);
+      }
+    }
+  }
+
+  template <typename Function>
+  void forEachChunk(WorkStealingPool::WorkStealingPool &pool, std::size_t count, Function function) {
+    for (std::size_t begin = 0; begin < count; begin += chunkSize) {
+      const std::size_t end = std::min(begin + chunkSize, count);
+      pool.submit([=]() { function(begin, end); });
+    }
+    pool.wait();
+  }
+
+  // The tables of captures and promotions, mapped while a table is built
+  class ChildTables
+  {
+  public:
+    void open(const std::string &signature, const std::string &path) {
+      MappedFile::MappedFile &file = this->files[signature];
+      const int pieceCount = static_cast<int>(signature.size()) - 1;
+
+      if (!file.open(path) || file.getSize() != Table::headerSize + 2 * Table::getEntryCount(pieceCount) ||
+          std::memcmp(file.getData(), Table::magic, 4) != 0)
+        throw "A table the generator depends on is missing or broken";
+    }
+
+    // The value for the side to move after a capture or a promotion
+    std::int16_t probe(const Layout &layout, const Position &position, int moved, int captured, char promotion) const {
+      std::vector<Tablebase::TablePiece> pieces;
+      for (int i = 0; i < layout.pieceCount; i++) {
+        if (i != captured)
+          pieces.push_back({i == moved && promotion != '\0' ? promotion : layout.letters[i], layout.isWhite[i], position.squares[i]});
+      }
+
+      // Bare kings
+      if (pieces.size() == 2)
+        return 0;
+
+      Tablebase::TablePosition tablePosition;
+      Table::getTablePosition(pieces, position.isWhiteToMove, tablePosition);
+
+      const unsigned char *bytes = this->files.at(tablePosition.signature).getData() + Table::headerSize + 2 * Table::getIndex(tablePosition);
+      return static_cast<std::int16_t>(bytes[0] | (bytes[1] << 8));
+    }
+
+  private:
+    std::unordered_map<std::string, MappedFile::MappedFile> files;
+  };
+
+  std::string getCanonicalSignature(const std::string &white, const std::string &black) {
+    std::vector<Tablebase::TablePiece> pieces;
+    for (char letter : white)
+      pieces.push_back({letter, true, static_cast<int>(pieces.size())});
+    for (char letter : black)
+      pieces.push_back({letter, false, static_cast<int>(pieces.size())});
+
+    // The tables decide which side is the strong one, the squares do not matter for that
+    Tablebase::TablePosition position;
+    if (!Table::getTablePosition(pieces, true, position))
+      throw "Invalid material signature";
+    return position.signature;
+  }
+
+  int countPawns(const std::string &signature) {
+    return static_cast<int>(std::count(signature.begin(), signature.end(), 'P'));
+  }
+}
+
+namespace TablebaseGenerator
+{
+  TablebaseGenerator::TablebaseGenerator(const GeneratorOptions &options) : options(options), pool(options.threadCount)
+  {
+  }
+
+  std::string TablebaseGenerator::generate(const std::string &signature)
+  {
+    const std::string path = getPath(signature);
+    if (!this->options.overwrite && std::filesystem::exists(path))
+      return path;
+
+    for (const std::string &child : getChildSignatures(signature))
+    {
+      if (!std::filesystem::exists(getPath(child)))
+        generate(child);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<std::int16_t> values = generateTable(signature);
+
+    std::filesystem::create_directories(this->options.directory);
+    writeTable(path, static_cast<int>(signature.size()) - 1, values);
+
+    if (this->options.progressOutput != nullptr)
+    {
+      int longestMate = 0;
+      for (std::int16_t value : values)
+      {
+        if (value != Table::illegalValue && value != 0)
+          longestMate = std::max(longestMate, getDistance(value));
+      }
+
+      const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+      *this->options.progressOutput << signature << ": " << values.size() << " positions, longest mate " << longestMate
+                                    << " half moves, " << time.count() << "s" << std::endl;
+    }
+
+    return path;
+  }
+
+  std::size_t TablebaseGenerator::generateAll(int maxPieces)
+  {
+    std::size_t generated = 0;
+    for (int pieceCount = 3; pieceCount <= std::min(maxPieces, Table::maxPieces); pieceCount++)
+    {
+      for (const std::string &signature : getSignatures(pieceCount))
+      {
+        if (this->options.overwrite || !std::filesystem::exists(getPath(signature)))
+          generated++;
+        generate(signature);
+      }
+    }
+    return generated;
+  }
+
+  std::vector<std::int16_t> TablebaseGenerator::generateTable(const std::string &signature)
+  {
+    if (getCanonicalSignature(signature.substr(0, signature.find('v')), signature.substr(signature.find('v') + 1)) != signature)
+      throw "Not a signature of the tables, the strong side comes first";
+
+    const Layout layout = getLayout(signature);
+    if (layout.pieceCount > Table::maxPieces)
+      throw "The tables have at most four pieces";
+
+    ChildTables children;
+    for (const std::string &child : getChildSignatures(signature))
+      children.open(child, getPath(child));
+
+    const std::size_t count = Table::getEntryCount(layout.pieceCount);
+    std::unique_ptr<std::atomic<std::int16_t>[]> values(new std::atomic<std::int16_t>[count]);
+    std::unique_ptr<std::atomic<std::uint8_t>[]> remaining(new std::atomic<std::uint8_t>[count]);
+    std::vector<std::int16_t> exits(count, noExit);
+    std::atomic<int> longestExit{0};
+
+    // Illegal positions, mates and stalemates, the moves that stay in the table and the best capture or promotion
+    forEachChunk(this->pool, count, [&](std::size_t begin, std::size_t end)
+                 {
+      int chunkLongestExit = 0;
+      for (std::size_t index = begin; index < end; index++) {
+        const Position position = getPosition(layout, index);
+        remaining[index].store(0, std::memory_order_relaxed);
+
+        if (!isLegal(layout, position)) {
+          values[index].store(Table::illegalValue, std::memory_order_relaxed);
+          continue;
+        }
+
+        int moves = 0;
+        int legalMoves = 0;
+        std::int16_t bestExit = noExit;
+        forEachMove(layout, position, [&](int moved, const Position &child, int captured, char promotion) {
+          if (isInCheck(layout, child, position.isWhiteToMove, captured))
+            return;
+
+          legalMoves++;
+          if (captured < 0 && promotion == '\0') {
+            moves++;
+            return;
+          }
+
+          // The child value is for the opponent
+          const std::int16_t childValue = children.probe(layout, child, moved, captured, promotion);
+          const std::int16_t exit = isLoss(childValue) ? encode(Tablebase::Wdl::WIN, getDistance(childValue) + 1)
+                                    : isWin(childValue) ? encode(Tablebase::Wdl::LOSS, getDistance(childValue) + 1)
+                                                        : std::int16_t(0);
+          if (getPreference(exit) > getPreference(bestExit))
+            bestExit = exit;
+        });
+
+        exits[index] = bestExit;
+        remaining[index].store(static_cast<std::uint8_t>(moves), std::memory_order_relaxed);
+        if (bestExit != noExit && bestExit != 0)
+          chunkLongestExit = std::max(chunkLongestExit, getDistance(bestExit));
+
+        if (legalMoves == 0)
+          values[index].store(isInCheck(layout, position, position.isWhiteToMove) ? encode(Tablebase::Wdl::LOSS, 0) : std::int16_t(0), std::memory_order_relaxed);
+        else
+          values[index].store(unknownValue, std::memory_order_relaxed);
+      }
+
+      int longest = longestExit.load();
+      while (chunkLongestExit > longest && !longestExit.compare_exchange_weak(longest, chunkLongestExit)) {
+      } });
+
+    const auto decide = [&](std::size_t index, std::int16_t value)
+    {
+      std::int16_t expected = unknownValue;
+      return values[index].compare_exchange_strong(expected, value, std::memory_order_relaxed);
+    };
+
+    for (int distance = 0;; distance++)
+    {
+      std::atomic<long long> decided{0};
+
+      // Every position one move before a loss is a win, one before a win loses once all its moves do
+      forEachChunk(this->pool, count, [&](std::size_t begin, std::size_t end)
+                   {
+        long long chunkDecided = 0;
+        for (std::size_t index = begin; index < end; index++) {
+          const std::int16_t value = values[index].load(std::memory_order_relaxed);
+          if (value == 0 || value == unknownValue || value == Table::illegalValue || getDistance(value) != distance)
+            continue;
+
+          const bool isLost = isLoss(value);
+          forEachUnmove(layout, getPosition(layout, index), [&](const Position &parent) {
+            const std::size_t parentIndex = getIndex(layout, parent);
+            if (values[parentIndex].load(std::memory_order_relaxed) == Table::illegalValue)
+              return;
+
+            if (isLost) {
+              chunkDecided += decide(parentIndex, encode(Tablebase::Wdl::WIN, distance + 1));
+              return;
+            }
+
+            if (remaining[parentIndex].fetch_sub(1, std::memory_order_relaxed) != 1)
+              return;
+
+            // The last move that stayed in the table loses, a capture or a promotion may still hold out longer
+            const std::int16_t exit = exits[parentIndex];
+            if (exit == noExit || (isLoss(exit) && getDistance(exit) <= distance + 1))
+              chunkDecided += decide(parentIndex, encode(Tablebase::Wdl::LOSS, distance + 1));
+          });
+        }
+        decided += chunkDecided; });
+
+      // Captures and promotions that decide the game at this distance
+      forEachChunk(this->pool, count, [&](std::size_t begin, std::size_t end)
+                   {
+        long long chunkDecided = 0;
+        for (std::size_t index = begin; index < end; index++) {
+          const std::int16_t exit = exits[index];
+          if (exit == noExit || exit == 0 || getDistance(exit) != distance + 1 || values[index].load(std::memory_order_relaxed) != unknownValue)
+            continue;
+
+          if (isWin(exit) || remaining[index].load(std::memory_order_relaxed) == 0)
+            chunkDecided += decide(index, exit);
+        }
+        decided += chunkDecided; });
+
+      if (decided == 0 && distance + 1 >= longestExit)
+        break;
+    }
+
+    // Whatever neither side could force is a draw
+    std::vector<std::int16_t> result(count);
+    for (std::size_t index = 0; index < count; index++)
+    {
+      const std::int16_t value = values[index].load(std::memory_order_relaxed);
+      result[index] = value == unknownValue ? 0 : value;
+    }
+    return result;
+  }
+
+  std::vector<std::string> TablebaseGenerator::getSignatures(int pieceCount)
+  {
+    std::set<std::string> signatures;
+
+    // Every split of the pieces besides the kings between the two sides
+    const std::string pieces = pieceLetters.substr(1);
+    std::vector<std::string> sets = {""};
+    for (int i = 0; i < pieceCount - 2; i++)
+    {
+      std::vector<std::string> longer;
+      for (const std::string &set : sets)
+      {
+        for (char letter : pieces)
+        {
+          if (set.empty() || pieces.find(letter) >= pieces.find(set.back()))
+            longer.push_back(set + letter);
+        }
+      }
+      sets = longer;
+    }
+
+    for (const std::string &set : sets)
+    {
+      for (std::size_t split = 0; split <= set.size(); split++)
+        signatures.insert(getCanonicalSignature("K" + set.substr(0, split), "K" + set.substr(split)));
+    }
+
+    std::vector<std::string> ordered(signatures.begin(), signatures.end());
+    std::stable_sort(ordered.begin(), ordered.end(), [](const std::string &first, const std::string &second)
+                     { return countPawns(first) < countPawns(second); });
+    return ordered;
+  }
+
+  std::vector<std::string> TablebaseGenerator::getChildSignatures(const std::string &signature)
+  {
+    const std::size_t separator = signature.find('v');
+    if (separator == std::string::npos)
+      throw "Invalid material signature";
+
+    const std::string sides[2] = {signature.substr(0, separator), signature.substr(separator + 1)};
+    std::set<std::string> children;
+
+    for (int side = 0; side < 2; side++)
+    {
+      for (std::size_t i = 1; i < sides[side].size(); i++)
+      {
+        std::string changed[2] = {sides[0], sides[1]};
+
+        // Captured
+        changed[side].erase(i, 1);
+        if (changed[0].size() + changed[1].size() > 2)
+          children.insert(getCanonicalSignature(changed[0], changed[1]));
+
+        if (sides[side][i] != 'P')
+          continue;
+
+        for (char promotion : promotionLetters)
+        {
+          std::string promoted[2] = {sides[0], sides[1]};
+          promoted[side][i] = promotion;
+          children.insert(getCanonicalSignature(promoted[0], promoted[1]));
+        }
+      }
+    }
+
+    return std::vector<std::string>(children.begin(), children.end());
+  }
+
+  void TablebaseGenerator::writeTable(const std::string &path, int pieceCount, const std::vector<std::int16_t> &values)
+  {
+    std::ofstream output(path, std::ios::binary);
+    if (!output)
+      throw "Could not write the table";
+
+    output.write(Table::magic, 4);
+    output.put(static_cast<char>(Table::version));
+    output.put(static_cast<char>(pieceCount));
+    output.put(0);
+    output.put(0);
+
+    // Little endian whatever the machine
+    std::vector<char> bytes(2 * values.size());
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+      const std::uint16_t value = static_cast<std::uint16_t>(values[i]);
+      bytes[2 * i] = static_cast<char>(value & 0xFF);
+      bytes[2 * i + 1] = static_cast<char>(value >> 8);
+    }
+    output.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  }
+
+  std::string TablebaseGenerator::getPath(const std::string &signature) const
+  {
+    return (std::filesystem::path(this->options.directory) / (signature + Table::extension)).string();
+  }
+
+  void run(const std::vector<std::string> &arguments)
+  {
+    if (arguments.empty())
+      throw "Usage: ChessbotTablebases <directory> [--pieces 3|4] [--threads N] [--overwrite] [signatures]";
+
+    GeneratorOptions options;
+    options.directory = arguments[0];
+    options.progressOutput = &std::cout;
+    int maxPieces = Table::maxPieces;
+    std::vector<std::string> signatures;
+
+    for (std::size_t i = 1; i < arguments.size(); i++)
+    {
+      const std::string &name = arguments[i];
+
+      if (name == "--overwrite")
+        options.overwrite = true;
+      else if ((name == "--pieces" || name == "--threads") && i + 1 == arguments.size())
+        throw "Every generator option needs a value";
+      else if (name == "--pieces")
+        maxPieces = std::stoi(arguments[++i]);
+      else if (name == "--threads")
+        options.threadCount = std::stoul(arguments[++i]);
+      else if (name.find('v') != std::string::npos)
+        signatures.push_back(name);
+      else
+        throw "Unknown generator option";
+    }
+
+    TablebaseGenerator generator(options);
+    std::cout << "Generating into " << options.directory << " on " << options.threadCount << " threads" << std::endl;
+
+    if (signatures.empty())
+      generator.generateAll(maxPieces);
+    for (const std::string &signature : signatures)
+      generator.generate(signature);
+  }
+} // namespace TablebaseGenerator
@@ -0,0 +1,305 @@
+#include "TexelTuner.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include "Attacks.hpp"
+
+namespace {
+  // Positions evaluated per batch while loading, the packed positions of one batch are all that is kept of the file
+  constexpr std::size_t loadBatchSize = 1 << 16;
+
+  bool parsePlacement(const std::string &placement, BatchEvaluation::PackedPosition &position) {
+    const std::string pieces = "pnbrqk";
+    position = BatchEvaluation::PackedPosition();
+
+    int rank = 7;
+    int file = 0;
+    for (char symbol : placement) {
+      if (symbol == '/') {
+        if (file != 8 || rank == 0)
+          return false;
+        rank--;
+        file = 0;
+      } else if (symbol >= '1' && symbol <= '8') {
+        file += symbol - '0';
+      } else {
+        const std::size_t type = pieces.find(static_cast<char>(std::tolower(static_cast<unsigned char>(symbol))));
+        if (type == std::string::npos || file > 7)
+          return false;
+
+        const int side = std::islower(static_cast<unsigned char>(symbol)) ? 1 : 0;
+        position.pieces[side][type] |= 1ULL << (rank * 8 + file);
+        file++;
+      }
+
+      if (file > 8)
+        return false;
+    }
+
+    // The evaluation needs both kings
+    return rank == 0 && file == 8 && Attacks::countBits(position.pieces[0][5]) == 1 &&
+           Attacks::countBits(position.pieces[1][5]) == 1;
+  }
+
+  bool parseResult(const std::string &text, double &result) {
+    if (text.find("1/2-1/2") != std::string::npos) {
+      result = 0.5;
+      return true;
+    }
+    if (text.find("1-0") != std::string::npos) {
+      result = 1.0;
+      return true;
+    }
+    if (text.find("0-1") != std::string::npos) {
+      result = 0.0;
+      return true;
+    }
+
+    const std::size_t open = text.find('[');
+    if (open == std::string::npos)
+      return false;
+
+    std::istringstream label(text.substr(open + 1));
+    return static_cast<bool>(label >> result) && result >= 0 && result <= 1;
+  }
+
+  // Adds up partial sums of the chunks in chunk order, the totals do not depend on which thread ran what
+  template <typename Function>
+  void forEachChunk(WorkStealingPool::WorkStealingPool &pool, std::size_t count, std::size_t chunkSize, Function function) {
+    for (std::size_t begin = 0; begin < count; begin += chunkSize) {
+      const std::size_t end = std::min(begin + chunkSize, count);
+      pool.submit([=]() { function(begin / chunkSize, begin, end); });
+    }
+    pool.wait();
+  }
+}
+
+namespace TexelTuner
+{
+  TexelTuner::TexelTuner(const TexelOptions &options)
+      : options(options), pool(options.threadCount), batchEvaluator(options.threadCount)
+  {
+  }
+
+  std::size_t TexelTuner::loadEpd(const std::string &path)
+  {
+    std::ifstream input(path);
+    if (!input)
+      throw "Could not open the EPD file";
+
+    std::vector<BatchEvaluation::PackedPosition> positions;
+    std::vector<double> results;
+    std::size_t added = 0;
+
+    std::string line;
+    while (std::getline(input, line))
+    {
+      BatchEvaluation::PackedPosition position;
+      double result;
+      if (!parseEpdLine(line, position, result))
+        continue;
+
+      positions.push_back(position);
+      results.push_back(result);
+
+      if (positions.size() == loadBatchSize)
+      {
+        addPositions(positions, results);
+        added += positions.size();
+        positions.clear();
+        results.clear();
+      }
+    }
+
+    addPositions(positions, results);
+    return added + positions.size();
+  }
+
+  bool TexelTuner::parseEpdLine(const std::string &line, BatchEvaluation::PackedPosition &position, double &result)
+  {
+    std::istringstream fields(line);
+    std::string placement, side, castling, enPassant;
+    if (!(fields >> placement >> side >> castling >> enPassant) || (side != "w" && side != "b"))
+      return false;
+
+    std::string rest;
+    std::getline(fields, rest);
+
+    if (!parsePlacement(placement, position) || !parseResult(rest, result))
+      return false;
+
+    position.isWhiteToMove = side == "w";
+    return true;
+  }
+
+  void TexelTuner::addPositions(const std::vector<BatchEvaluation::PackedPosition> &positions, const std::vector<double> &results)
+  {
+    if (positions.empty())
+      return;
+
+    const std::size_t first = this->results.size();
+    this->features.resize((first + positions.size()) * termCount);
+    this->results.insert(this->results.end(), results.begin(), results.end());
+
+    // One pass per term with only that term weighted, the batch scores are for the side to move
+    const BatchEvaluation::PositionBatch batch(positions);
+    const Brain::EvaluationTypes types[termCount] = {Brain::EvaluationTypes::MATERIAL, Brain::EvaluationTypes::SPACE,
+                                                     Brain::EvaluationTypes::KING_SAFETY, Brain::EvaluationTypes::PIECE_ACTIVITY,
+                                                     Brain::EvaluationTypes::PAWN_STRUCTURE};
+    for (Brain::EvaluationTypes type : types)
+    {
+      const std::vector<Score::Score> scores = this->batchEvaluator.evaluate(batch, {{type, 1.0}});
+      const int term = getTermIndex(type);
+
+      // Kept in pawns, the weights stay around 1 and the curve below reads pawns
+      for (std::size_t i = 0; i < positions.size(); i++)
+        this->features[(first + i) * termCount + term] = static_cast<float>(Score::toPawns(positions[i].isWhiteToMove ? scores[i] : -scores[i]));
+    }
+  }
+
+  std::size_t TexelTuner::getPositionCount() const
+  {
+    return this->results.size();
+  }
+
+  double TexelTuner::getFeature(std::size_t position, Brain::EvaluationTypes type) const
+  {
+    return this->features[position * termCount + getTermIndex(type)];
+  }
+
+  int TexelTuner::getTermIndex(Brain::EvaluationTypes type)
+  {
+    // The enum starts at 1
+    return static_cast<int>(type) - 1;
+  }
+
+  double TexelTuner::getWinProbability(double score, double scaling)
+  {
+    // The usual Texel curve, a score of 4 / scaling pawns wins 10 out of 11 games
+    return 1.0 / (1.0 + std::pow(10.0, -scaling * score / 4.0));
+  }
+
+  double TexelTuner::computeError(const std::vector<Brain::EvaluationNode> &neurons, double scaling) const
+  {
+    double error;
+    computeGradient(neurons, scaling, error);
+    return error;
+  }
+
+  std::vector<double> TexelTuner::computeGradient(const std::vector<Brain::EvaluationNode> &neurons, double scaling, double &error) const
+  {
+    const std::size_t count = getPositionCount();
+    const std::size_t nodeCount = neurons.size();
+    const std::size_t chunkCount = (count + this->options.chunkSize - 1) / this->options.chunkSize;
+
+    // The weights laid out like the features, a term weighted twice counts twice
+    double weights[termCount] = {};
+    for (const auto &node : neurons)
+      weights[getTermIndex(node.type)] += node.value;
+
+    std::vector<double> chunkErrors(chunkCount, 0);
+    std::vector<double> chunkGradients(chunkCount * termCount, 0);
+
+    forEachChunk(this->pool, count, this->options.chunkSize, [&](std::size_t chunk, std::size_t begin, std::size_t end)
+                 {
+      double chunkError = 0;
+      double gradient[termCount] = {};
+
+      for (std::size_t i = begin; i < end; i++) {
+        const float *feature = &this->features[i * termCount];
+
+        double score = 0;
+        for (int term = 0; term < termCount; term++)
+          score += weights[term] * feature[term];
+
+        const double probability = getWinProbability(score, scaling);
+        const double difference = probability - this->results[i];
+        chunkError += difference * difference;
+
+        // d(difference^2)/d(score), the derivative of the curve is its value times one minus it times its slope
+        const double slope = 2 * difference * probability * (1 - probability) * std::log(10.0) * scaling / 4.0;
+        for (int term = 0; term < termCount; term++)
+          gradient[term] += slope * feature[term];
+      }
+
+      chunkErrors[chunk] = chunkError;
+      for (int term = 0; term < termCount; term++)
+        chunkGradients[chunk * termCount + term] = gradient[term]; });
+
+    error = 0;
+    double termGradients[termCount] = {};
+    for (std::size_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+      error += chunkErrors[chunk];
+      for (int term = 0; term < termCount; term++)
+        termGradients[term] += chunkGradients[chunk * termCount + term];
+    }
+
+    std::vector<double> gradient(nodeCount, 0);
+    if (count == 0)
+      return gradient;
+
+    error /= count;
+    for (std::size_t i = 0; i < nodeCount; i++)
+      gradient[i] = termGradients[getTermIndex(neurons[i].type)] / count;
+
+    return gradient;
+  }
+
+  double TexelTuner::findScaling(const std::vector<Brain::EvaluationNode> &neurons) const
+  {
+    // The error has a single minimum in the scaling, narrowed down by a golden section search
+    const double ratio = (std::sqrt(5.0) - 1) / 2;
+    double low = 0.05;
+    double high = 10.0;
+
+    for (int step = 0; step < 40; step++)
+    {
+      const double left = high - ratio * (high - low);
+      const double right = low + ratio * (high - low);
+
+      if (computeError(neurons, left) < computeError(neurons, right))
+        high = right;
+      else
+        low = left;
+    }
+
+    return (low + high) / 2;
+  }
+
+  std::vector<Brain::EvaluationNode> TexelTuner::tune(const std::vector<Brain::EvaluationNode> &neurons, double scaling)
+  {
+    constexpr double firstDecay = 0.9;
+    constexpr double secondDecay = 0.999;
+    constexpr double epsilon = 1e-8;
+
+    std::vector<Brain::EvaluationNode> tuned = neurons;
+    std::vector<double> firstMoment(neurons.size(), 0);
+    std::vector<double> secondMoment(neurons.size(), 0);
+
+    for (int epoch = 1; epoch <= this->options.epochs; epoch++)
+    {
+      double error;
+      const std::vector<double> gradient = computeGradient(tuned, scaling, error);
+
+      for (std::size_t i = 0; i < tuned.size(); i++)
+      {
+        firstMoment[i] = firstDecay * firstMoment[i] + (1 - firstDecay) * gradient[i];
+        secondMoment[i] = secondDecay * secondMoment[i] + (1 - secondDecay) * gradient[i] * gradient[i];
+
+        const double firstEstimate = firstMoment[i] / (1 - std::pow(firstDecay, epoch));
+        const double secondEstimate = secondMoment[i] / (1 - std::pow(secondDecay, epoch));
+        tuned[i].value -= this->options.learningRate * firstEstimate / (std::sqrt(secondEstimate) + epsilon);
+      }
+
+      if (this->options.progressOutput != nullptr)
+        *this->options.progressOutput << "Epoch " << epoch << " error " << error << std::endl;
+    }
+
+    return tuned;
+  }
+} // namespace TexelTuner
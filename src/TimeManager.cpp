@@ -0,0 +1,167 @@
+#include "TimeManager.hpp"
+#include <algorithm>
+
+namespace TimeManager
+{
+  void TimeManager::start(const TimeControl &timeControl)
+  {
+    this->nextPoll = pollInterval;
+    this->softScale = 1.0;
+    this->bestMoveStability = 0;
+    this->isStopped = false;
+    this->isPonderSearch = false;
+    this->maxDepth = 0;
+    this->iterationDepth = 0;
+    this->hitNodes = 0;
+
+    computeDeadlines(timeControl);
+  }
+
+  void TimeManager::startPondering()
+  {
+    start(TimeControl());
+    this->isPonderSearch = true;
+  }
+
+  void TimeManager::ponderHit(const TimeControl &timeControl, int maxDepth)
+  {
+    computeDeadlines(timeControl);
+
+    // Without a clock or a node budget the search ends at the depth it would have stopped at without pondering, the
+    // nodes searched while pondering are not counted against the budget
+    this->maxDepth = this->isTimed || this->maxNodes > 0 ? 0 : maxDepth;
+    this->hitNodes = -1;
+
+    // Publishes the deadlines to the searching thread
+    this->isPonderSearch.store(false, std::memory_order_release);
+  }
+
+  void TimeManager::computeDeadlines(const TimeControl &timeControl)
+  {
+    this->startTime = std::chrono::steady_clock::now();
+    this->isTimed = timeControl.isTimed();
+    this->maxNodes = timeControl.nodes;
+
+    if (!this->isTimed)
+      return;
+
+    if (timeControl.moveTime > 0)
+    {
+      // Fixed time per move, nothing to save up for later
+      this->hardDeadline = std::max(1LL, timeControl.moveTime - moveOverhead);
+      this->softDeadline = this->hardDeadline;
+      return;
+    }
+
+    const int movesToGo = timeControl.movesToGo > 0 ? std::min(timeControl.movesToGo, maxMovesToGo) : defaultMovesToGo;
+    const long long available = std::max(1LL, timeControl.remainingTime - moveOverhead);
+    const long long optimum = available / movesToGo + timeControl.increment * 3 / 4;
+
+    // The hard deadline is never more than a share of the clock, so one bad move cannot flag the game
+    const long long maxTime = movesToGo == 1 ? available : static_cast<long long>(available * maxRemainingShare);
+
+    this->hardDeadline = std::max(1LL, std::min(static_cast<long long>(optimum * maxOptimumMultiplier), maxTime));
+    this->softDeadline = std::max(1LL, std::min(optimum, this->hardDeadline));
+  }
+
+  void TimeManager::stop()
+  {
+    this->isStopped = true;
+  }
+
+  bool TimeManager::shouldStop(long long nodes)
+  {
+    if (this->isStopped.load(std::memory_order_relaxed))
+      return true;
+
+    // ponderHit may be writing the limits until it clears the flag, none of them is read before that
+    if (this->isPonderSearch.load(std::memory_order_acquire))
+      return false;
+
+    if (this->hitNodes < 0)
+      this->hitNodes = nodes;
+
+    if ((this->maxNodes > 0 && nodes - this->hitNodes >= this->maxNodes) || (this->maxDepth > 0 && this->iterationDepth > this->maxDepth))
+    {
+      this->isStopped = true;
+      return true;
+    }
+
+    if (!this->isTimed || nodes < this->nextPoll)
+      return false;
+
+    this->nextPoll = nodes + pollInterval;
+
+    if (getElapsedTime() >= this->hardDeadline)
+      this->isStopped = true;
+
+    return this->isStopped;
+  }
+
+  void TimeManager::startIteration(int depth)
+  {
+    this->iterationDepth = depth;
+  }
+
+  void TimeManager::updateIteration(bool hasBestMoveChanged, double scoreDrop)
+  {
+    this->bestMoveStability = hasBestMoveChanged ? 0 : this->bestMoveStability + 1;
+
+    double scale = 1.0;
+
+    if (hasBestMoveChanged)
+      scale *= unstableBestMoveScale;
+    else if (this->bestMoveStability >= stableIterations)
+      scale *= stableBestMoveScale;
+
+    if (scoreDrop > scoreDropMargin)
+      scale *= scoreDropScale;
+
+    this->softScale = std::min(scale, maxSoftScale);
+  }
+
+  bool TimeManager::canStartIteration() const
+  {
+    if (this->isStopped)
+      return false;
+
+    if (this->isPonderSearch.load(std::memory_order_acquire))
+      return true;
+
+    if (this->maxDepth > 0 && this->iterationDepth >= this->maxDepth)
+      return false;
+
+    if (!this->isTimed)
+      return true;
+
+    // Every iteration costs more than all the previous ones together, starting one past half the budget rarely pays off
+    const double budget = std::min(this->softDeadline * this->softScale, static_cast<double>(this->hardDeadline));
+
+    return getElapsedTime() < budget / 2;
+  }
+
+  long long TimeManager::getElapsedTime() const
+  {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - this->startTime).count();
+  }
+
+  long long TimeManager::getSoftDeadline() const
+  {
+    return this->softDeadline;
+  }
+
+  long long TimeManager::getHardDeadline() const
+  {
+    return this->hardDeadline;
+  }
+
+  bool TimeManager::isActive() const
+  {
+    return this->isPonderSearch.load(std::memory_order_acquire) || this->isTimed || this->maxNodes > 0;
+  }
+
+  bool TimeManager::isPondering() const
+  {
+    return this->isPonderSearch.load(std::memory_order_acquire);
+  }
+} // namespace TimeManager
@@ -0,0 +1,95 @@
+#include "TranspositionTable.hpp"
+
+#include <algorithm>
+
+namespace TranspositionTable
+{
+  TranspositionTable::TranspositionTable(std::size_t sizeInMegabytes)
+  {
+    resize(sizeInMegabytes);
+  }
+
+  void TranspositionTable::resize(std::size_t sizeInMegabytes)
+  {
+    const std::size_t maxEntries = sizeInMegabytes * 1024 * 1024 / sizeof(Entry);
+
+    std::size_t size = 1;
+    while (size * 2 <= maxEntries)
+      size *= 2;
+
+    this->entries.assign(size, Entry());
+    this->mask = size - 1;
+    this->generation = 0;
+  }
+
+  void TranspositionTable::clear()
+  {
+    std::fill(this->entries.begin(), this->entries.end(), Entry());
+    this->generation = 0;
+  }
+
+  void TranspositionTable::newSearch()
+  {
+    this->generation++;
+  }
+
+  bool TranspositionTable::probe(unsigned long long key, Entry &entry) const
+  {
+    const Entry &stored = this->entries[key & this->mask];
+
+    if (stored.bound == Bound::NONE || stored.key != key)
+      return false;
+
+    entry = stored;
+    return true;
+  }
+
+  void TranspositionTable::store(unsigned long long key, Score::Score score, int depth, Bound bound, const Move::Move &bestMove)
+  {
+    Entry &stored = this->entries[key & this->mask];
+
+    // Deeper results of the current search are worth more than whatever is about to replace them
+    if (stored.bound != Bound::NONE && stored.generation == this->generation && stored.depth > depth &&
+        !(stored.key == key && bound == Bound::EXACT))
+      return;
+
+    // Keep the old best move when the new result has none, it is still the best guess for move ordering
+    if (bestMove.isValid && bestMove.from >= 0)
+    {
+      stored.from = static_cast<std::int8_t>(bestMove.from);
+      stored.to = static_cast<std::int8_t>(bestMove.to);
+      stored.promotionTo = static_cast<std::uint8_t>(bestMove.promotionTo);
+    }
+    else if (stored.key != key)
+    {
+      stored.from = -1;
+      stored.to = -1;
+      stored.promotionTo = Move::PieceType::NONE;
+    }
+
+    stored.key = key;
+    stored.score = Score::pack(score);
+    stored.depth = static_cast<std::int8_t>(std::min(depth, 127));
+    stored.bound = bound;
+    stored.generation = this->generation;
+  }
+
+  std::size_t TranspositionTable::getSize() const
+  {
+    return this->entries.size();
+  }
+
+  int TranspositionTable::getHashfull() const
+  {
+    const std::size_t sampleSize = std::min<std::size_t>(1000, this->entries.size());
+    int used = 0;
+
+    for (std::size_t i = 0; i < sampleSize; i++)
+    {
+      if (this->entries[i].bound != Bound::NONE && this->entries[i].generation == this->generation)
+        used++;
+    }
+
+    return static_cast<int>(used * 1000 / sampleSize);
+  }
+} // namespace TranspositionTable
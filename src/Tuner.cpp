@@ -0,0 +1,479 @@
+#include "Tuner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
+
+#include "TexelTuner.hpp"
+
+namespace {
+  // The names neurons.txt uses, not the shorter ones of EvaluationNode::toString
+  const char *getNeuronName(Brain::EvaluationTypes type) {
+    switch (type) {
+    case Brain::EvaluationTypes::MATERIAL:
+      return "MATERIAL";
+    case Brain::EvaluationTypes::SPACE:
+      return "SPACE";
+    case Brain::EvaluationTypes::KING_SAFETY:
+      return "KING_SAFETY";
+    case Brain::EvaluationTypes::PIECE_ACTIVITY:
+      return "PIECE_ACTIVITY";
+    case Brain::EvaluationTypes::PAWN_STRUCTURE:
+      return "PAWN_STRUCTURE";
+    default:
+      return "UNKNOWN";
+    }
+  }
+
+  bool parseNeuron(const std::string &line, Brain::EvaluationNode &node) {
+    const std::size_t separator = line.find('=');
+    if (separator == std::string::npos)
+      return false;
+
+    const std::string name = line.substr(0, separator);
+    const Brain::EvaluationTypes types[] = {Brain::EvaluationTypes::MATERIAL, Brain::EvaluationTypes::SPACE,
+                                            Brain::EvaluationTypes::KING_SAFETY, Brain::EvaluationTypes::PIECE_ACTIVITY,
+                                            Brain::EvaluationTypes::PAWN_STRUCTURE};
+    const auto type = std::find_if(std::begin(types), std::end(types), [&](Brain::EvaluationTypes candidate)
+                                   { return name == getNeuronName(candidate); });
+    if (type == std::end(types))
+      return false;
+
+    std::istringstream value(line.substr(separator + 1));
+    node.type = *type;
+    return static_cast<bool>(value >> node.value);
+  }
+
+  void writeNeurons(std::ostream &output, const std::vector<Brain::EvaluationNode> &neurons) {
+    for (std::size_t i = 0; i < neurons.size(); i++) {
+      // neurons.txt has no newline after its last line
+      output << getNeuronName(neurons[i].type) << "=" << neurons[i].value;
+      if (i + 1 < neurons.size())
+        output << "\n";
+    }
+  }
+
+  // Written next to the target and renamed over it, an interrupted run never leaves half a file behind
+  bool writeAtomically(const std::string &path, const std::string &contents) {
+    const std::string temporaryPath = path + ".tmp";
+    {
+      std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+      if (!(output << contents))
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    return !error;
+  }
+
+  double getPoints(Tuner::GameResult result, bool isWhite) {
+    if (result == Tuner::GameResult::DRAW)
+      return 0.5;
+    return (result == Tuner::GameResult::WHITE_WINS) == isWhite ? 1.0 : 0.0;
+  }
+
+  // Fits the weights to the results of the positions in an EPD file instead of playing games
+  void runTexel(const std::string &path, const TexelTuner::TexelOptions &options, const std::vector<Brain::EvaluationNode> &neurons,
+                const std::string &outputPath) {
+    TexelTuner::TexelTuner tuner(options);
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::size_t count = tuner.loadEpd(path);
+    const std::chrono::duration<double> loadTime = std::chrono::steady_clock::now() - start;
+    std::cout << "Loaded " << count << " positions in " << loadTime.count() << "s" << std::endl;
+    if (count == 0)
+      throw "The EPD file has no positions with a result";
+
+    const double scaling = tuner.findScaling(neurons);
+    std::cout << "Scaling " << scaling << " error " << tuner.computeError(neurons, scaling) << std::endl;
+
+    const std::vector<Brain::EvaluationNode> tuned = tuner.tune(neurons, scaling);
+    Tuner::Tuner::saveNeurons(outputPath, tuned);
+
+    std::cout << "Tuned weights, error " << tuner.computeError(tuned, scaling) << ":\n";
+    writeNeurons(std::cout, tuned);
+    std::cout << std::endl;
+  }
+}
+
+namespace Tuner
+{
+  const std::vector<std::string> Tuner::openings = {
+      "r1bqkbnr/pppp1ppp/2n5/1B2p3/4P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 3 3",
+      "rnbqkbnr/ppp2ppp/4p3/3p4/2PP4/8/PP2PPPP/RNBQKBNR w KQkq - 0 3",
+      "rnbqkbnr/pp2pppp/3p4/2p5/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 0 3",
+      "rnbqkb1r/pppppp1p/5np1/8/2PP4/8/PP2PPPP/RNBQKBNR w KQkq - 0 3",
+      "rnbqkbnr/ppp2ppp/4p3/3p4/3PP3/8/PPP2PPP/RNBQKBNR w KQkq - 0 3",
+      "rnbqkbnr/pppp1ppp/8/4p3/2P5/8/PP1PPPPP/RNBQKBNR w KQkq - 0 2",
+      "rnbqkbnr/pp2pppp/2p5/3p4/3PP3/8/PPP2PPP/RNBQKBNR w KQkq - 0 3",
+      "r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 3 3",
+  };
+
+  Tuner::Tuner(const TunerOptions &options) : options(options), pool(options.threadCount)
+  {
+  }
+
+  const TunerOptions &Tuner::getOptions() const
+  {
+    return this->options;
+  }
+
+  long long Tuner::getGamesPlayed() const
+  {
+    return this->gamesPlayed;
+  }
+
+  Individual Tuner::run(const std::vector<Brain::EvaluationNode> &startingNeurons)
+  {
+    Population population;
+    if (loadCheckpoint(this->options.checkpointPath, population))
+      std::cout << "Resuming at generation " << population.generation << "\n";
+    else
+      population = createPopulation(startingNeurons);
+
+    while (population.generation < this->options.generations)
+    {
+      runGeneration(population);
+
+      if (!saveCheckpoint(this->options.checkpointPath, population))
+        throw "Could not write the tuner checkpoint";
+      saveNeurons(this->options.outputPath, population.reference);
+
+      std::cout << "Generation " << population.generation << " best " << population.bestFitness
+                << " games " << this->gamesPlayed << " stolen " << this->pool.getStolenTaskCount() << std::endl;
+    }
+
+    Individual best;
+    best.neurons = population.reference;
+    best.fitness = population.bestFitness;
+    return best;
+  }
+
+  Population Tuner::createPopulation(const std::vector<Brain::EvaluationNode> &startingNeurons)
+  {
+    this->random.seed(this->options.seed);
+
+    Population population;
+    population.reference = startingNeurons;
+
+    // The starting weights take part themselves, a generation can only get better than them
+    population.individuals.push_back({startingNeurons, 0});
+    while (static_cast<int>(population.individuals.size()) < this->options.populationSize)
+      population.individuals.push_back({mutate(startingNeurons), 0});
+
+    return population;
+  }
+
+  void Tuner::runGeneration(Population &population)
+  {
+    this->random.seed(this->options.seed + population.generation);
+
+    evaluatePopulation(population);
+
+    std::stable_sort(population.individuals.begin(), population.individuals.end(), [](const Individual &first, const Individual &second)
+                     { return first.fitness > second.fitness; });
+    population.bestFitness = population.individuals.front().fitness;
+
+    // Only a winning score replaces the reference, drawn matches are noise
+    if (population.bestFitness > 0.5)
+      population.reference = population.individuals.front().neurons;
+
+    const int size = static_cast<int>(population.individuals.size());
+    const int eliteCount = std::min(std::max(this->options.eliteCount, 1), size);
+    const int parentCount = std::max(eliteCount, size / 2);
+    std::uniform_int_distribution<int> parent(0, parentCount - 1);
+
+    std::vector<Individual> children(population.individuals.begin(), population.individuals.begin() + eliteCount);
+    while (static_cast<int>(children.size()) < size)
+    {
+      const auto &first = population.individuals[parent(this->random)].neurons;
+      const auto &second = population.individuals[parent(this->random)].neurons;
+      children.push_back({mutate(crossover(first, second)), 0});
+    }
+
+    population.individuals = children;
+    population.generation++;
+  }
+
+  void Tuner::evaluatePopulation(Population &population)
+  {
+    const int openingCount = std::min(std::max(this->options.openingCount, 1), static_cast<int>(openings.size()));
+    const int gamesPerIndividual = 2 * openingCount;
+
+    // One task per game, the pool moves the games of a slow match to the threads that are already done
+    std::vector<double> points(population.individuals.size() * gamesPerIndividual, 0);
+    for (std::size_t i = 0; i < population.individuals.size(); i++)
+    {
+      for (int game = 0; game < gamesPerIndividual; game++)
+      {
+        const std::vector<Brain::EvaluationNode> *individual = &population.individuals[i].neurons;
+        const std::vector<Brain::EvaluationNode> *reference = &population.reference;
+        double *result = &points[i * gamesPerIndividual + game];
+        const std::string &fen = openings[game / 2];
+        const bool isWhite = game % 2 == 0;
+
+        this->pool.submit([this, individual, reference, result, &fen, isWhite]()
+                          {
+          const GameResult gameResult = isWhite ? playGame(*individual, *reference, fen) : playGame(*reference, *individual, fen);
+          *result = getPoints(gameResult, isWhite); });
+      }
+    }
+    this->pool.wait();
+    this->gamesPlayed += static_cast<long long>(points.size());
+
+    for (std::size_t i = 0; i < population.individuals.size(); i++)
+    {
+      double total = 0;
+      for (int game = 0; game < gamesPerIndividual; game++)
+        total += points[i * gamesPerIndividual + game];
+      population.individuals[i].fitness = total / gamesPerIndividual;
+    }
+  }
+
+  GameResult Tuner::playGame(const std::vector<Brain::EvaluationNode> &white, const std::vector<Brain::EvaluationNode> &black, const std::string &fen) const
+  {
+    std::unique_ptr<Brain::Brain> players[2] = {std::make_unique<Brain::Brain>(fen), std::make_unique<Brain::Brain>(fen)};
+    players[0]->setNeurons(white);
+    players[1]->setNeurons(black);
+
+    for (int side = 0; side < 2; side++)
+    {
+      // A few thousand nodes never fill more than a megabyte, the weights under test must not change underneath
+      players[side]->transpositionTable.resize(1);
+      players[side]->searchOptions.reloadNeurons = false;
+      players[side]->searchOptions.useOpeningBook = false;
+      players[side]->isWhite = side == 0;
+    }
+
+    TimeManager::TimeControl timeControl;
+    timeControl.nodes = this->options.nodesPerMove;
+
+    // The board does not count repetitions itself
+    std::unordered_map<unsigned long long, int> repetitions;
+    repetitions[players[0]->realBoard.hashKey]++;
+
+    for (int ply = 0; ply < this->options.maxPlies; ply++)
+    {
+      Brain::Brain &mover = *players[players[0]->realBoard.isWhiteTurn ? 0 : 1];
+      const bool isWhiteMoving = mover.isWhite;
+
+      const Move::Move move = mover.findBestMove(timeControl);
+      if (!move.isValid || !players[0]->makeRealMove(move) || !players[1]->makeRealMove(move))
+        return GameResult::DRAW;
+
+      const Board::Board &board = players[0]->realBoard;
+      switch (board.gameState)
+      {
+      case Board::GameState::CHECKMATE:
+        return isWhiteMoving ? GameResult::WHITE_WINS : GameResult::BLACK_WINS;
+      case Board::GameState::STALEMATE:
+      case Board::GameState::FIFTY_MOVE_RULE:
+      case Board::GameState::INSUFFICIENT_MATERIAL:
+        return GameResult::DRAW;
+      default:
+        break;
+      }
+
+      if (++repetitions[board.hashKey] >= 3)
+        return GameResult::DRAW;
+    }
+
+    return GameResult::DRAW;
+  }
+
+  std::vector<Brain::EvaluationNode> Tuner::mutate(const std::vector<Brain::EvaluationNode> &neurons)
+  {
+    std::vector<Brain::EvaluationNode> mutated = neurons;
+
+    for (auto &node : mutated)
+    {
+      std::normal_distribution<double> step(0, std::max(std::abs(node.value) * this->options.mutationScale, this->options.minimumMutation));
+
+      // A negative weight would reward the opposite of what the term measures
+      node.value = std::max(0.0, node.value + step(this->random));
+    }
+
+    return mutated;
+  }
+
+  std::vector<Brain::EvaluationNode> Tuner::crossover(const std::vector<Brain::EvaluationNode> &first, const std::vector<Brain::EvaluationNode> &second)
+  {
+    std::vector<Brain::EvaluationNode> child = first;
+    std::bernoulli_distribution fromSecond(0.5);
+
+    // Parents always share the terms and their order, only the weights are picked from one or the other
+    for (std::size_t i = 0; i < child.size() && i < second.size(); i++)
+    {
+      if (fromSecond(this->random))
+        child[i].value = second[i].value;
+    }
+
+    return child;
+  }
+
+  bool Tuner::saveCheckpoint(const std::string &path, const Population &population)
+  {
+    std::ostringstream output;
+    output.precision(std::numeric_limits<double>::max_digits10);
+
+    output << "generation " << population.generation << "\n";
+    output << "best " << population.bestFitness << "\n";
+    output << "reference\n";
+    writeNeurons(output, population.reference);
+    output << "\n";
+
+    for (const auto &individual : population.individuals)
+    {
+      output << "individual " << individual.fitness << "\n";
+      writeNeurons(output, individual.neurons);
+      output << "\n";
+    }
+
+    return writeAtomically(path, output.str());
+  }
+
+  bool Tuner::loadCheckpoint(const std::string &path, Population &population)
+  {
+    std::ifstream input(path);
+    if (!input)
+      return false;
+
+    Population loaded;
+    std::vector<Brain::EvaluationNode> *neurons = nullptr;
+
+    std::string line;
+    while (std::getline(input, line))
+    {
+      std::istringstream fields(line);
+      std::string keyword;
+      fields >> keyword;
+
+      Brain::EvaluationNode node;
+      if (keyword == "generation")
+        fields >> loaded.generation;
+      else if (keyword == "best")
+        fields >> loaded.bestFitness;
+      else if (keyword == "reference")
+        neurons = &loaded.reference;
+      else if (keyword == "individual")
+      {
+        loaded.individuals.emplace_back();
+        fields >> loaded.individuals.back().fitness;
+        neurons = &loaded.individuals.back().neurons;
+      }
+      else if (neurons != nullptr && parseNeuron(line, node))
+        neurons->push_back(node);
+      else if (!line.empty())
+        return false;
+    }
+
+    if (loaded.reference.empty() || loaded.individuals.empty())
+      return false;
+
+    population = loaded;
+    return true;
+  }
+
+  bool Tuner::saveNeurons(const std::string &path, const std::vector<Brain::EvaluationNode> &neurons)
+  {
+    std::ostringstream output;
+    writeNeurons(output, neurons);
+    return writeAtomically(path, output.str());
+  }
+
+  bool Tuner::loadNeurons(const std::string &path, std::vector<Brain::EvaluationNode> &neurons)
+  {
+    std::ifstream input(path);
+    if (!input)
+      return false;
+
+    std::vector<Brain::EvaluationNode> loaded;
+    std::string line;
+    while (std::getline(input, line))
+    {
+      Brain::EvaluationNode node;
+      if (!parseNeuron(line, node))
+        return false;
+      loaded.push_back(node);
+    }
+
+    neurons = loaded;
+    return !neurons.empty();
+  }
+
+  void run(const std::vector<std::string> &arguments)
+  {
+    TunerOptions options;
+    TexelTuner::TexelOptions texelOptions;
+    std::string neuronsPath = "neurons.txt";
+    std::string texelPath;
+
+    for (std::size_t i = 0; i + 1 < arguments.size(); i += 2)
+    {
+      const std::string &name = arguments[i];
+      const std::string &value = arguments[i + 1];
+
+      if (name == "--population")
+        options.populationSize = std::stoi(value);
+      else if (name == "--generations")
+        options.generations = std::stoi(value);
+      else if (name == "--elite")
+        options.eliteCount = std::stoi(value);
+      else if (name == "--openings")
+        options.openingCount = std::stoi(value);
+      else if (name == "--nodes")
+        options.nodesPerMove = std::stoll(value);
+      else if (name == "--plies")
+        options.maxPlies = std::stoi(value);
+      else if (name == "--threads")
+        options.threadCount = std::stoul(value);
+      else if (name == "--seed")
+        options.seed = static_cast<unsigned int>(std::stoul(value));
+      else if (name == "--checkpoint")
+        options.checkpointPath = value;
+      else if (name == "--output")
+        options.outputPath = value;
+      else if (name == "--neurons")
+        neuronsPath = value;
+      else if (name == "--texel")
+        texelPath = value;
+      else if (name == "--epochs")
+        texelOptions.epochs = std::stoi(value);
+      else if (name == "--learning-rate")
+        texelOptions.learningRate = std::stod(value);
+      else
+        throw "Unknown tuner option";
+    }
+
+    if (arguments.size() % 2 != 0)
+      throw "Every tuner option needs a value";
+
+    std::vector<Brain::EvaluationNode> neurons;
+    if (!Tuner::loadNeurons(neuronsPath, neurons))
+      throw "Could not read the starting neurons";
+
+    if (!texelPath.empty())
+    {
+      texelOptions.threadCount = options.threadCount;
+      texelOptions.progressOutput = &std::cout;
+      runTexel(texelPath, texelOptions, neurons, options.outputPath);
+      return;
+    }
+
+    Tuner tuner(options);
+    std::cout << "Tuning on " << options.threadCount << " threads" << std::endl;
+
+    const Individual best = tuner.run(neurons);
+    std::cout << "Best weights, scoring " << best.fitness << " against the previous best:\n";
+    writeNeurons(std::cout, best.neurons);
+    std::cout << std::endl;
+  }
+} // namespace Tuner
@@ -0,0 +1,154 @@
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+
+namespace WorkStealingPool
+{
+  WorkStealingPool::WorkStealingPool(std::size_t threadCount)
+  {
+    threadCount = std::max<std::size_t>(threadCount, 1);
+    for (std::size_t i = 0; i < threadCount; i++)
+      this->queues.push_back(std::make_unique<Queue>());
+
+    for (std::size_t i = 1; i < threadCount; i++)
+      this->workers.emplace_back([this, i]()
+                                 { runWorker(i); });
+  }
+
+  WorkStealingPool::~WorkStealingPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->isStopping = true;
+    }
+    this->workReady.notify_all();
+
+    for (auto &worker : this->workers)
+      worker.join();
+  }
+
+  void WorkStealingPool::submit(std::function<void()> task)
+  {
+    Queue &queue = *this->queues[this->nextQueue.fetch_add(1) % this->queues.size()];
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks.push_back(std::move(task));
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->queuedTasks++;
+      this->unfinishedTasks++;
+    }
+    this->workReady.notify_one();
+  }
+
+  void WorkStealingPool::wait()
+  {
+    while (runTask(0))
+    {
+    }
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->workDone.wait(lock, [this]()
+                        { return this->unfinishedTasks == 0; });
+
+    if (this->firstError)
+    {
+      std::exception_ptr error = this->firstError;
+      this->firstError = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+  std::size_t WorkStealingPool::getThreadCount() const
+  {
+    return this->queues.size();
+  }
+
+  long long WorkStealingPool::getStolenTaskCount() const
+  {
+    return this->stolenTasks;
+  }
+
+  std::size_t WorkStealingPool::getDefaultThreadCount()
+  {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  bool WorkStealingPool::takeTask(std::size_t queueIndex, bool isOwnQueue, std::function<void()> &task)
+  {
+    Queue &queue = *this->queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+      return false;
+
+    // The owner works from the back where its newest tasks are, thieves take the oldest ones from the front
+    if (isOwnQueue)
+    {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    }
+    else
+    {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    return true;
+  }
+
+  bool WorkStealingPool::runTask(std::size_t queueIndex)
+  {
+    std::function<void()> task;
+    bool hasTask = takeTask(queueIndex, true, task);
+
+    for (std::size_t offset = 1; !hasTask && offset < this->queues.size(); offset++)
+    {
+      hasTask = takeTask((queueIndex + offset) % this->queues.size(), false, task);
+      if (hasTask)
+        this->stolenTasks++;
+    }
+
+    if (!hasTask)
+      return false;
+
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->queuedTasks--;
+    }
+
+    std::exception_ptr error;
+    try
+    {
+      task();
+    }
+    catch (...)
+    {
+      error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (error && !this->firstError)
+      this->firstError = error;
+
+    if (--this->unfinishedTasks == 0)
+      this->workDone.notify_all();
+
+    return true;
+  }
+
+  void WorkStealingPool::runWorker(std::size_t queueIndex)
+  {
+    while (true)
+    {
+      if (runTask(queueIndex))
+        continue;
+
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->workReady.wait(lock, [this]()
+                           { return this->isStopping || this->queuedTasks > 0; });
+      if (this->isStopping)
+        return;
+    }
+  }
+} // namespace WorkStealingPool
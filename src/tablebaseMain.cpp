@@ -0,0 +1,19 @@
+#include "TablebaseGenerator.hpp"
+#include <iostream>
+
+int main(int argc, char *argv[])
+{
+  try {
+    TablebaseGenerator::run(std::vector<std::string>(argv + 1, argv + argc));
+  } catch (const char *message) {
+    std::cerr << "Error: " << message << std::endl;
+    return 1;
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cerr << "Unknown error" << std::endl;
+    return 1;
+  }
+  return 0;
+}
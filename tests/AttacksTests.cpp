@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "Attacks.hpp"
+
+namespace {
+    // Walks every ray square by square, the slow way the bitboard attacks have to agree with
+    std::uint64_t walkRays(int square, std::uint64_t occupancy, const int (&directions)[4][2]) {
+        std::uint64_t attacks = 0;
+        for (const auto &direction : directions) {
+            int rank = square / 8 + direction[0];
+            int file = square % 8 + direction[1];
+            while (rank >= 0 && rank < 8 && file >= 0 && file < 8) {
+                attacks |= 1ULL << (rank * 8 + file);
+                if (occupancy & (1ULL << (rank * 8 + file))) {
+                    break;
+                }
+                rank += direction[0];
+                file += direction[1];
+            }
+        }
+        return attacks;
+    }
+}
+
+TEST(AttacksTest, LeapersDoNotWrapAroundTheBoard) {
+    // a1 knight reaches b3 and c2 only, h4 knight stays on the g and f files
+    EXPECT_EQ(Attacks::getKnightAttacks(0), (1ULL << 17) | (1ULL << 10));
+    EXPECT_EQ(Attacks::countBits(Attacks::getKnightAttacks(31)), 4);
+    EXPECT_EQ(Attacks::countBits(Attacks::getKingAttacks(7)), 3);
+    EXPECT_EQ(Attacks::countBits(Attacks::getKingAttacks(36)), 8);
+
+    // White pawns on a2 and h2
+    EXPECT_EQ(Attacks::getPawnAttacks((1ULL << 8) | (1ULL << 15), 0), (1ULL << 17) | (1ULL << 22));
+}
+
+TEST(AttacksTest, KingMasksLookTowardsTheEnemy) {
+    // White king on g1: f1 to h2 around it and f3 to h3 in front of those
+    EXPECT_EQ(Attacks::getKingZone(6, 0), 0xE0E0E0ULL);
+    EXPECT_EQ(Attacks::getPawnShield(6, 0), 0xE0E000ULL);
+    EXPECT_EQ(Attacks::getPawnStorm(6, 0), 0xE0E0E0E000ULL);
+
+    // Black king on g8 looks down, a king on the h file does not wrap to the a file
+    EXPECT_EQ(Attacks::getPawnShield(62, 1), 0xE0E0ULL << 40);
+    EXPECT_EQ(Attacks::getPawnShield(7, 0), 0xC0C000ULL);
+    EXPECT_EQ(Attacks::getKingZone(63, 1), 0xC0C0C0ULL << 40);
+}
+
+TEST(AttacksTest, SlidersStopAtTheFirstPiece) {
+    const int rookDirections[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    const int bishopDirections[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    std::uint64_t state = 0x2545F4914F6CDD1DULL;
+
+    for (int i = 0; i < 200; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        const std::uint64_t occupancy = state & (state >> 3);
+
+        for (int square = 0; square < 64; square++) {
+            ASSERT_EQ(Attacks::getRookAttacks(square, occupancy), walkRays(square, occupancy, rookDirections));
+            ASSERT_EQ(Attacks::getBishopAttacks(square, occupancy), walkRays(square, occupancy, bishopDirections));
+        }
+    }
+}
+
+TEST(AttacksTest, BitboardsFollowTheBoard) {
+    Board::Board board;
+    Attacks::Bitboards bitboards(board);
+
+    EXPECT_EQ(bitboards.pieces[0][0], 0xFF00ULL);
+    EXPECT_EQ(bitboards.pieces[1][0], 0xFFULL << 48);
+    EXPECT_EQ(bitboards.pieces[0][1], (1ULL << 1) | (1ULL << 6));
+    EXPECT_EQ(bitboards.pieces[1][5], 1ULL << 60);
+    EXPECT_EQ(bitboards.occupancy, 0xFFFF00000000FFFFULL);
+    EXPECT_EQ(bitboards.kings[0], 4);
+}
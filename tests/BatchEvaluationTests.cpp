@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "BatchEvaluation.hpp"
+#include "Brain.hpp"
+
+#include <random>
+
+namespace {
+    // Positions along random games, many different structures without having to write them all down
+    std::vector<Board::Board> playRandomGames(int games, int plies) {
+        std::mt19937 random(7);
+        std::vector<Board::Board> boards;
+
+        for (int game = 0; game < games; game++) {
+            Board::Board board;
+            for (int ply = 0; ply < plies; ply++) {
+                auto moves = board.getAllValidMoves();
+                if (moves.empty() || !board.makeMove(moves[random() % moves.size()])) {
+                    break;
+                }
+                boards.push_back(board);
+            }
+        }
+
+        return boards;
+    }
+}
+
+TEST(BatchEvaluationTest, PackedPositionsKeepThePieces) {
+    Board::Board board;
+    board.setFromFEN("4k3/8/8/8/8/8/4P3/4K2R b K - 0 1");
+
+    const BatchEvaluation::PackedPosition position(board);
+    EXPECT_EQ(position.pieces[0][0], 1ULL << 12);
+    EXPECT_EQ(position.pieces[0][3], 1ULL << 7);
+    EXPECT_EQ(position.pieces[0][5], 1ULL << 4);
+    EXPECT_EQ(position.pieces[1][5], 1ULL << 60);
+    EXPECT_FALSE(position.isWhiteToMove);
+
+    const BatchEvaluation::PositionBatch batch({position, BatchEvaluation::PackedPosition(Board::Board())});
+    ASSERT_EQ(batch.size(), 2);
+    EXPECT_EQ(batch.pieces[0][3][0], 1ULL << 7);
+    EXPECT_EQ(batch.pieces[0][3][1], (1ULL << 0) | (1ULL << 7));
+    EXPECT_EQ(batch.isWhiteToMove[1], 1);
+}
+
+TEST(BatchEvaluationTest, MatchesEvaluatePosition) {
+    Brain::Brain brain;
+    brain.searchOptions.useEvaluationCache = false;
+
+    std::vector<Board::Board> boards = playRandomGames(20, 40);
+    std::vector<BatchEvaluation::PackedPosition> positions;
+    for (const auto &board : boards) {
+        positions.emplace_back(board);
+    }
+
+    const std::vector<Score::Score> scores = brain.evaluateBatch(positions);
+    ASSERT_EQ(scores.size(), boards.size());
+
+    for (size_t i = 0; i < boards.size(); i++) {
+        brain.testBoard = boards[i];
+        brain.isWhite = boards[i].isWhiteTurn;
+        EXPECT_EQ(scores[i], brain.evaluatePosition()) << i;
+    }
+}
+
+TEST(BatchEvaluationTest, ThreadCountDoesNotChangeTheScores) {
+    const Brain::Brain brain;
+    std::vector<BatchEvaluation::PackedPosition> positions;
+    for (const auto &board : playRandomGames(30, 60)) {
+        positions.emplace_back(board);
+    }
+    ASSERT_GT(positions.size(), 4 * BatchEvaluation::BatchEvaluator::chunkSize);
+
+    const BatchEvaluation::PositionBatch batch(positions);
+    BatchEvaluation::BatchEvaluator single(1);
+    BatchEvaluation::BatchEvaluator pool(4);
+    EXPECT_EQ(single.getThreadCount(), 1);
+    EXPECT_EQ(pool.getThreadCount(), 4);
+
+    const std::vector<Score::Score> expected = single.evaluate(batch, brain.getNeurons());
+
+    // The pool is reused between batches
+    for (int round = 0; round < 3; round++) {
+        EXPECT_EQ(pool.evaluate(batch, brain.getNeurons()), expected);
+    }
+}
+
+TEST(BatchEvaluationTest, EmptyBatchGivesNoScores) {
+    Brain::Brain brain;
+    EXPECT_TRUE(brain.evaluateBatch({}).empty());
+}
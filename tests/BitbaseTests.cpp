@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include "Bitbase.hpp"
+#include "Brain.hpp"
+
+namespace {
+    int probe(const std::string &fen) {
+        Board::Board board;
+        board.setFromFEN(fen);
+
+        int result = 2;
+        EXPECT_TRUE(board.probeKPK(result)) << fen;
+        return result;
+    }
+}
+
+TEST(BitbaseTest, OneBitPerPosition) {
+    EXPECT_EQ(Bitbase::getKPKSize(), 24 * 1024u);
+}
+
+TEST(BitbaseTest, SideToMoveDecides) {
+    // Pushing at once wins, with the other side to move the king in front holds the draw by stalemate
+    EXPECT_EQ(probe("4k3/8/3KP3/8/8/8/8/8 w - - 0 1"), 1);
+    EXPECT_EQ(probe("4k3/8/3KP3/8/8/8/8/8 b - - 0 1"), 0);
+
+    // The same with the colours swapped
+    EXPECT_EQ(probe("8/8/8/8/8/3kp3/8/4K3 b - - 0 1"), -1);
+    EXPECT_EQ(probe("8/8/8/8/8/3kp3/8/4K3 w - - 0 1"), 0);
+}
+
+TEST(BitbaseTest, KnowsTheClassicPositions) {
+    // Rook pawns are drawn once the defending king reaches the corner
+    EXPECT_EQ(probe("k7/8/8/8/8/8/P7/K7 w - - 0 1"), 0);
+    EXPECT_EQ(probe("7k/8/8/8/8/8/7P/7K w - - 0 1"), 0);
+
+    // A pawn the king cannot catch, on both wings
+    EXPECT_EQ(probe("k7/8/8/8/8/8/6P1/4K3 b - - 0 1"), 1);
+    EXPECT_EQ(probe("7k/8/8/8/8/8/1P6/3K4 b - - 0 1"), 1);
+
+    // Other material is not answered
+    Board::Board board;
+    int result;
+    board.setFromFEN("4k3/8/8/8/8/8/4PP2/4K3 w - - 0 1");
+    EXPECT_FALSE(board.probeKPK(result));
+}
+
+TEST(BitbaseTest, SearchStopsAtDrawnPawnEndings) {
+    Brain::Brain bot("k7/8/8/8/8/8/P7/K7 w - - 0 1");
+    bot.searchOptions.maxDepth = 3;
+    bot.findBestMove();
+
+    EXPECT_GT(bot.searchStatistics.bitbaseHits, 0);
+    EXPECT_EQ(bot.searchStatistics.score, Score::draw);
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "BoardScan.hpp"
+#include "Board.hpp"
+
+#include <random>
+
+namespace {
+    // Walks random games forward and takes them back, calling check on every position on the way
+    template <typename Check>
+    void walkRandomGames(int games, int plies, Check check) {
+        std::mt19937 random(11);
+
+        for (int game = 0; game < games; game++) {
+            Board::Board board;
+            int played = 0;
+            for (; played < plies; played++) {
+                auto moves = board.getAllValidMoves();
+                if (moves.empty() || !board.makeMove(moves[random() % moves.size()])) {
+                    break;
+                }
+                check(board);
+            }
+
+            for (; played > 0; played--) {
+                board.undoMove();
+                check(board);
+            }
+        }
+    }
+
+    struct KernelGuard {
+        BoardScan::Kernel kernel = BoardScan::getKernel();
+        ~KernelGuard() { BoardScan::setKernel(kernel); }
+    };
+}
+
+TEST(BoardScanTest, PackedBoardFollowsMakeAndUndo) {
+    walkRandomGames(10, 80, [](const Board::Board &board) {
+        for (int square = 0; square < 64; square++) {
+            ASSERT_EQ(board.packedBoard[square], board.board[square]) << square;
+        }
+    });
+}
+
+TEST(BoardScanTest, EveryKernelAgreesWithTheScalarOne) {
+    KernelGuard guard;
+    std::int16_t table[64];
+    for (int square = 0; square < 64; square++) {
+        table[square] = static_cast<std::int16_t>(square * 37 % 101 - 50);
+    }
+
+    const BoardScan::Kernel kernels[] = {BoardScan::Kernel::SSE2, BoardScan::Kernel::AVX2};
+    walkRandomGames(4, 60, [&](const Board::Board &board) {
+        ASSERT_TRUE(BoardScan::setKernel(BoardScan::Kernel::SCALAR));
+        const BoardScan::PieceMasks expected = BoardScan::getPieceMasks(board.packedBoard);
+        const std::uint64_t occupied = BoardScan::getOccupiedMask(board.packedBoard);
+        const int sum = BoardScan::sumPieceSquares(board.packedBoard, Board::Board::PAWN | Board::Board::BLACK, table);
+
+        for (BoardScan::Kernel kernel : kernels) {
+            if (!BoardScan::setKernel(kernel)) {
+                continue;
+            }
+
+            const BoardScan::PieceMasks masks = BoardScan::getPieceMasks(board.packedBoard);
+            for (int side = 0; side < 2; side++) {
+                for (int type = 0; type < 6; type++) {
+                    const std::uint8_t piece = static_cast<std::uint8_t>((Board::Board::PAWN << type) | side);
+                    EXPECT_EQ(masks.pieces[side][type], expected.pieces[side][type]);
+                    EXPECT_EQ(BoardScan::getPieceMask(board.packedBoard, piece), expected.pieces[side][type]);
+                }
+            }
+            EXPECT_EQ(BoardScan::getOccupiedMask(board.packedBoard), occupied);
+            EXPECT_EQ(BoardScan::sumPieceSquares(board.packedBoard, Board::Board::PAWN | Board::Board::BLACK, table), sum);
+        }
+    });
+}
+
+TEST(BoardScanTest, ScannedPieceScoresMatchTheIncrementalOnes) {
+    walkRandomGames(6, 60, [](const Board::Board &board) {
+        Board::Board scanned = board;
+        scanned.computePieceScores();
+
+        EXPECT_EQ(scanned.middlegameScore[0], board.middlegameScore[0]);
+        EXPECT_EQ(scanned.middlegameScore[1], board.middlegameScore[1]);
+        EXPECT_EQ(scanned.endgameScore[0], board.endgameScore[0]);
+        EXPECT_EQ(scanned.endgameScore[1], board.endgameScore[1]);
+        EXPECT_EQ(scanned.phase, board.phase);
+        EXPECT_EQ(scanned.computeHashKey(), board.hashKey);
+    });
+}
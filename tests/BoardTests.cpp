@@ -3,6 +3,27 @@
 #include "Move.hpp"
 #include <Menu.hpp>
 
+#include <cstring>
+
+namespace {
+    // Counts the leaf nodes of the legal move tree, every make is undone so the position must survive unchanged
+    long long perft(Board::Board &board, int depth) {
+        if (depth == 0) {
+            return 1;
+        }
+
+        long long nodes = 0;
+        for (const auto &move : board.getAllValidMoves()) {
+            if (!board.makeMove(move)) {
+                continue;
+            }
+            nodes += perft(board, depth - 1);
+            board.undoMove();
+        }
+        return nodes;
+    }
+}
+
 class BoardTest : public ::testing::Test {
 protected:
     Board::Board board;
@@ -93,10 +114,120 @@ TEST_F(BoardTest, PossibleMoves) {
     startingFEN = "8/3k4/8/8/8/8/3K4/8 w";
     board.setFromFEN(startingFEN);
     moves = board.getAllValidMoves();
-    // List valid moves
-    for(auto move : moves) {
-        std::cout << move.toString() << std::endl;
+    // Every square around the king is free, none of them is next to the other king
+    EXPECT_EQ(moves.size(), 8);
+}
+
+
+TEST_F(BoardTest, PerftStartingPosition) {
+    board.setFromFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+
+    EXPECT_EQ(perft(board, 1), 20);
+    EXPECT_EQ(perft(board, 2), 400);
+    EXPECT_EQ(perft(board, 3), 8902);
+}
+
+TEST_F(BoardTest, PerftCastlingPromotionsAndEnPassant) {
+    // Well known perft positions exercising castling, en passant and promotions
+    board.setFromFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    EXPECT_EQ(perft(board, 2), 2039);
+
+    board.setFromFEN("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+    EXPECT_EQ(perft(board, 2), 264);
+
+    board.setFromFEN("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8");
+    EXPECT_EQ(perft(board, 2), 1486);
+}
+
+TEST_F(BoardTest, UndoMoveRestoresPosition) {
+    board.setFromFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+    unsigned long long before[64];
+    std::memcpy(before, board.board, sizeof(before));
+
+    for (const auto &move : board.getAllValidMoves()) {
+        ASSERT_TRUE(board.makeMove(move)) << move.toString();
+        board.undoMove();
+
+        EXPECT_EQ(std::memcmp(before, board.board, sizeof(before)), 0) << move.toString();
+        EXPECT_TRUE(board.isWhiteTurn);
+        EXPECT_EQ(board.currentWhiteKingPosition, 4);
+        EXPECT_FALSE(board.hasWhiteKingMoved);
+        EXPECT_FALSE(board.hasWhiteRookAMoved);
+        EXPECT_FALSE(board.hasWhiteRookHMoved);
     }
-    EXPECT_EQ(moves.size(), 6);
 }
 
+TEST_F(BoardTest, NullMovePassesTheTurn) {
+    board.setFromFEN("4k3/8/8/8/8/8/4P3/4K3 w - - 0 1");
+
+    board.makeNullMove();
+    EXPECT_FALSE(board.isWhiteTurn);
+    EXPECT_EQ(board.getAllValidMoves().size(), 5);
+
+    board.undoNullMove();
+    EXPECT_TRUE(board.isWhiteTurn);
+    EXPECT_TRUE(board.moveHistory.empty());
+}
+
+TEST_F(BoardTest, FiftyMoveRuleCountsHalfMovesSinceCaptureOrPawnMove) {
+    board.setFromFEN("4k3/8/8/8/8/8/4P3/R3K3 w - - 98 60");
+    EXPECT_EQ(board.fiftyMoveRuleCounter, 98);
+
+    ASSERT_TRUE(board.makeMove(Move::Move("a1", "a2")));
+    EXPECT_EQ(board.fiftyMoveRuleCounter, 99);
+    EXPECT_FALSE(board.isFiftyMoveRule());
+
+    ASSERT_TRUE(board.makeMove(Move::Move("e8", "d7")));
+    EXPECT_EQ(board.fiftyMoveRuleCounter, 100);
+    EXPECT_TRUE(board.isFiftyMoveRule());
+
+    board.undoMove();
+    board.undoMove();
+    ASSERT_TRUE(board.makeMove(Move::Move("e2", "e3")));
+    EXPECT_EQ(board.fiftyMoveRuleCounter, 0);
+}
+
+namespace {
+    // Every position of the tree has to have the same sums as a board that added them up from scratch
+    void checkPieceScores(Board::Board &board, int depth) {
+        Board::Board fresh = board;
+        fresh.computePieceScores();
+        ASSERT_EQ(board.middlegameScore[0], fresh.middlegameScore[0]);
+        ASSERT_EQ(board.middlegameScore[1], fresh.middlegameScore[1]);
+        ASSERT_EQ(board.endgameScore[0], fresh.endgameScore[0]);
+        ASSERT_EQ(board.endgameScore[1], fresh.endgameScore[1]);
+        ASSERT_EQ(board.phase, fresh.phase);
+
+        if (depth == 0) {
+            return;
+        }
+
+        for (const auto &move : board.getAllValidMoves()) {
+            if (!board.makeMove(move)) {
+                continue;
+            }
+            checkPieceScores(board, depth - 1);
+            board.undoMove();
+        }
+    }
+}
+
+TEST_F(BoardTest, IncrementalPieceScoresMatchAFreshCount) {
+    // Castling, en passant, promotions and captures in the tree
+    board.setFromFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    checkPieceScores(board, 2);
+
+    board.setFromFEN("n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1");
+    checkPieceScores(board, 2);
+}
+
+TEST_F(BoardTest, TaperedScoreMovesToTheEndgameTables) {
+    EXPECT_EQ(board.phase, 24);
+    EXPECT_EQ(board.getTaperedScore(true), board.middlegameScore[0]);
+    EXPECT_EQ(board.getTaperedScore(true), board.getTaperedScore(false));
+
+    board.setFromFEN("4k3/8/8/8/8/8/4P3/4K3 w - - 0 1");
+    EXPECT_EQ(board.phase, 0);
+    EXPECT_EQ(board.getTaperedScore(true), board.endgameScore[0]);
+}
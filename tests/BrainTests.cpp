@@ -0,0 +1,357 @@
+#include <gtest/gtest.h>
+#include "Brain.hpp"
+#include "Move.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+class BrainTest : public ::testing::Test {
+protected:
+    void disableSelectiveSearch(Brain::Brain &bot) {
+        bot.searchOptions.useNullMovePruning = false;
+        bot.searchOptions.useLateMoveReductions = false;
+        bot.searchOptions.useFutilityPruning = false;
+        bot.searchOptions.useReverseFutilityPruning = false;
+        bot.searchOptions.useLateMovePruning = false;
+        bot.searchOptions.useRazoring = false;
+    }
+};
+
+TEST_F(BrainTest, FindsMateInOne) {
+    // Back rank mate with Ra8
+    Brain::Brain bot("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+    bot.searchOptions.maxDepth = 2;
+
+    Move::Move move = bot.findBestMove();
+
+    EXPECT_EQ(move.from, 0);
+    EXPECT_EQ(move.to, 56);
+}
+
+TEST_F(BrainTest, CapturesHangingQueen) {
+    Brain::Brain bot("4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1");
+    bot.searchOptions.maxDepth = 2;
+
+    Move::Move move = bot.findBestMove();
+
+    EXPECT_EQ(move.from, 11);
+    EXPECT_EQ(move.to, 35);
+}
+
+TEST_F(BrainTest, SelectiveSearchCanBeSwitchedOff) {
+    Brain::Brain plain("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+    plain.searchOptions.maxDepth = 2;
+    disableSelectiveSearch(plain);
+
+    Move::Move move = plain.findBestMove();
+
+    EXPECT_EQ(move.to, 56);
+}
+
+TEST_F(BrainTest, SelectiveSearchVisitsFewerNodes) {
+    const std::string fen = "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3";
+
+    Brain::Brain plain(fen);
+    plain.searchOptions.maxDepth = 3;
+    disableSelectiveSearch(plain);
+    plain.findBestMove();
+
+    Brain::Brain selective(fen);
+    selective.searchOptions.maxDepth = 3;
+    selective.findBestMove();
+
+    EXPECT_EQ(plain.searchStatistics.depth, 3);
+    EXPECT_EQ(selective.searchStatistics.depth, 3);
+    EXPECT_LT(selective.searchStatistics.nodes, plain.searchStatistics.nodes);
+}
+
+TEST_F(BrainTest, PrincipalVariationSearchKeepsTheScore) {
+    // Without the selective search the windows only change how fast the minimax score is found, never the score itself
+    const std::string fen = "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3";
+
+    Brain::Brain fullWindow(fen);
+    fullWindow.searchOptions.maxDepth = 3;
+    fullWindow.searchOptions.usePrincipalVariationSearch = false;
+    fullWindow.searchOptions.useAspirationWindows = false;
+    disableSelectiveSearch(fullWindow);
+    fullWindow.findBestMove();
+
+    Brain::Brain windowed(fen);
+    windowed.searchOptions.maxDepth = 3;
+    disableSelectiveSearch(windowed);
+    windowed.findBestMove();
+
+    EXPECT_EQ(windowed.searchStatistics.score, fullWindow.searchStatistics.score);
+    EXPECT_EQ(fullWindow.searchStatistics.failHighs + fullWindow.searchStatistics.failLows, 0);
+}
+
+TEST_F(BrainTest, SearchRespectsMoveTime) {
+    Brain::Brain bot("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    TimeManager::TimeControl timeControl;
+    timeControl.moveTime = 300;
+
+    Move::Move move = bot.findBestMove(timeControl);
+
+    EXPECT_LT(bot.timeManager.getElapsedTime(), 600);
+    EXPECT_TRUE(bot.testBoard.makeMove(move));
+}
+
+TEST_F(BrainTest, PonderHitContinuesTheSearch) {
+    Brain::Brain bot("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+    bot.searchOptions.maxDepth = 3;
+
+    ASSERT_TRUE(bot.makeRealMove(bot.findBestMove()));
+
+    bot.startPondering();
+    ASSERT_TRUE(bot.isPondering());
+
+    Move::Move expectedReply = bot.getPonderMove();
+    ASSERT_TRUE(bot.makeRealMove(Move::Move(expectedReply.from, expectedReply.to, Move::PieceType::NONE, {})));
+    EXPECT_TRUE(bot.isPondering());
+
+    TimeManager::TimeControl timeControl;
+    timeControl.moveTime = 300;
+    Move::Move move = bot.findBestMove(timeControl);
+
+    EXPECT_FALSE(bot.isPondering());
+    EXPECT_EQ(bot.testBoard.hashKey, bot.realBoard.hashKey);
+    EXPECT_TRUE(bot.makeRealMove(move));
+}
+
+TEST_F(BrainTest, UntimedPonderHitSearchesToTheMaximumDepth) {
+    Brain::Brain bot("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+    bot.searchOptions.maxDepth = 4;
+
+    ASSERT_TRUE(bot.makeRealMove(bot.findBestMove()));
+
+    bot.startPondering();
+    Move::Move expectedReply = bot.getPonderMove();
+    ASSERT_TRUE(bot.makeRealMove(Move::Move(expectedReply.from, expectedReply.to, Move::PieceType::NONE, {})));
+    ASSERT_TRUE(bot.isPondering());
+
+    Move::Move move = bot.findBestMove();
+
+    EXPECT_FALSE(bot.isPondering());
+    EXPECT_EQ(bot.searchStatistics.depth, 4);
+    EXPECT_TRUE(bot.makeRealMove(move));
+}
+
+TEST_F(BrainTest, PonderHitKeepsTheNodeLimit) {
+    Brain::Brain bot("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+    bot.searchOptions.maxDepth = 3;
+
+    ASSERT_TRUE(bot.makeRealMove(bot.findBestMove()));
+
+    bot.startPondering();
+    Move::Move expectedReply = bot.getPonderMove();
+    ASSERT_TRUE(bot.makeRealMove(Move::Move(expectedReply.from, expectedReply.to, Move::PieceType::NONE, {})));
+    ASSERT_TRUE(bot.isPondering());
+
+    // The budget counts from the hit, the nodes searched while pondering come on top of it
+    TimeManager::TimeControl timeControl;
+    timeControl.nodes = 5000;
+    Move::Move move = bot.findBestMove(timeControl);
+
+    EXPECT_FALSE(bot.isPondering());
+    EXPECT_GE(bot.searchStatistics.nodes, timeControl.nodes);
+    EXPECT_GE(bot.searchStatistics.depth, 1);
+    EXPECT_TRUE(bot.makeRealMove(move));
+}
+
+TEST_F(BrainTest, PonderMissStopsTheSearch) {
+    Brain::Brain bot("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+    bot.searchOptions.maxDepth = 3;
+
+    ASSERT_TRUE(bot.makeRealMove(bot.findBestMove()));
+
+    bot.startPondering();
+    ASSERT_TRUE(bot.isPondering());
+
+    Move::Move expectedReply = bot.getPonderMove();
+    for (const auto &reply : bot.realBoard.getAllValidMoves()) {
+        if (reply.from == expectedReply.from && reply.to == expectedReply.to)
+            continue;
+
+        ASSERT_TRUE(bot.makeRealMove(reply));
+        break;
+    }
+
+    EXPECT_FALSE(bot.isPondering());
+    EXPECT_EQ(bot.testBoard.hashKey, bot.realBoard.hashKey);
+}
+
+TEST_F(BrainTest, SearchReportsStatistics) {
+    Brain::Brain bot("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+    bot.searchOptions.maxDepth = 3;
+
+    std::ostringstream info;
+    bot.infoOutput = &info;
+    bot.findBestMove();
+
+    const Brain::SearchStatistics &statistics = bot.searchStatistics;
+    EXPECT_EQ(statistics.depth, 3);
+    EXPECT_GE(statistics.selectiveDepth, 3);
+    EXPECT_EQ(statistics.iterationNodes.size(), 3);
+    EXPECT_EQ(statistics.iterationTimes.size(), 3);
+    EXPECT_GT(statistics.getEffectiveBranchingFactor(), 1.0);
+    EXPECT_GT(statistics.hashProbes, 0);
+    EXPECT_LE(statistics.hashfull, 1000);
+    EXPECT_GT(statistics.betaCutoffs, 0);
+    EXPECT_LE(statistics.firstMoveBetaCutoffs, statistics.betaCutoffs);
+    EXPECT_GT(statistics.getQuiescenceShare(), 0.0);
+    EXPECT_LT(statistics.getQuiescenceShare(), 1.0);
+
+    EXPECT_NE(info.str().find("info depth 1 "), std::string::npos);
+    EXPECT_NE(info.str().find("info depth 3 "), std::string::npos);
+}
+
+TEST_F(BrainTest, MultiPvReportsDistinctLines) {
+    const std::string fen = "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3";
+
+    Brain::Brain single(fen);
+    single.searchOptions.maxDepth = 3;
+    single.findBestMove();
+
+    Brain::Brain bot(fen);
+    bot.searchOptions.maxDepth = 3;
+    bot.searchOptions.multiPv = 3;
+    Move::Move move = bot.findBestMove();
+
+    ASSERT_EQ(bot.searchLines.size(), 3);
+    EXPECT_EQ(bot.searchLines[0].principalVariation[0].from, move.from);
+    EXPECT_EQ(bot.searchLines[0].principalVariation[0].to, move.to);
+
+    for (size_t i = 0; i < bot.searchLines.size(); i++) {
+        ASSERT_FALSE(bot.searchLines[i].principalVariation.empty());
+        EXPECT_LE(bot.searchLines[i].principalVariation.size(), 3);
+
+        if (i > 0) {
+            EXPECT_LE(bot.searchLines[i].score, bot.searchLines[i - 1].score);
+        }
+        for (size_t j = 0; j < i; j++) {
+            const Move::Move &first = bot.searchLines[i].principalVariation[0];
+            const Move::Move &second = bot.searchLines[j].principalVariation[0];
+            EXPECT_FALSE(first.from == second.from && first.to == second.to);
+        }
+    }
+
+    // The lines share one search, three separate searches would cost at least three times as much
+    EXPECT_LT(bot.searchStatistics.nodes, 3 * single.searchStatistics.nodes);
+}
+
+TEST_F(BrainTest, KingSafetyRewardsThePawnShield) {
+    const std::vector<Brain::EvaluationNode> kingSafetyOnly = {{Brain::EvaluationTypes::KING_SAFETY, 1.0}};
+
+    Brain::Brain sheltered("r5k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1");
+    sheltered.isWhite = true;
+    sheltered.setNeurons(kingSafetyOnly);
+    EXPECT_EQ(sheltered.evaluatePosition(), 0);
+
+    // The same pawns pushed three ranks up no longer cover the king
+    Brain::Brain exposed("r5k1/5ppp/8/8/5PPP/8/8/R5K1 w - - 0 1");
+    exposed.isWhite = true;
+    exposed.setNeurons(kingSafetyOnly);
+    EXPECT_LT(exposed.evaluatePosition(), 0);
+}
+
+TEST_F(BrainTest, KingSafetyCountsAttackersOfTheKingZone) {
+    const std::vector<Brain::EvaluationNode> kingSafetyOnly = {{Brain::EvaluationTypes::KING_SAFETY, 1.0}};
+
+    // A queen alone is no danger yet, the knight joining it on g4 is
+    Brain::Brain queenAlone("n5k1/5ppp/8/8/7q/8/5PPP/6K1 w - - 0 1");
+    queenAlone.isWhite = true;
+    queenAlone.setNeurons(kingSafetyOnly);
+
+    Brain::Brain queenAndKnight("6k1/5ppp/8/8/6nq/8/5PPP/6K1 w - - 0 1");
+    queenAndKnight.isWhite = true;
+    queenAndKnight.setNeurons(kingSafetyOnly);
+
+    EXPECT_LT(queenAndKnight.evaluatePosition(), queenAlone.evaluatePosition());
+}
+
+TEST_F(BrainTest, LazyEvaluationSkipsLopsidedPositions) {
+    // White is a rook up, most leaves are far outside any window around the real score
+    const std::string fen = "r3k3/pppq1ppp/2n5/8/8/2N5/PPPQ1PPP/R3K2R w KQq - 0 1";
+
+    Brain::Brain lazy(fen);
+    lazy.searchOptions.maxDepth = 4;
+    lazy.findBestMove();
+
+    EXPECT_GT(lazy.searchStatistics.lazyEvaluationExits, 0);
+    EXPECT_LE(lazy.searchStatistics.lazyEvaluationExits, lazy.searchStatistics.lazyEvaluationProbes);
+    EXPECT_GT(lazy.searchStatistics.getLazyEvaluationRate(), 0);
+
+    Brain::Brain full(fen);
+    full.searchOptions.maxDepth = 4;
+    full.searchOptions.useLazyEvaluation = false;
+    full.findBestMove();
+
+    EXPECT_EQ(full.searchStatistics.lazyEvaluationProbes, 0);
+    EXPECT_EQ(full.searchStatistics.lazyEvaluationExits, 0);
+}
+
+TEST_F(BrainTest, LazyEvaluationNeverExitsWithAWideMargin) {
+    Brain::Brain bot("r3k3/pppq1ppp/2n5/8/8/2N5/PPPQ1PPP/R3K2R w KQq - 0 1");
+    bot.searchOptions.maxDepth = 3;
+    bot.searchOptions.lazyEvaluationMargin = Score::infinite;
+    bot.findBestMove();
+
+    EXPECT_GT(bot.searchStatistics.lazyEvaluationProbes, 0);
+    EXPECT_EQ(bot.searchStatistics.lazyEvaluationExits, 0);
+}
+
+#ifndef CHESSBOT_COMPILED_NEURONS
+TEST_F(BrainTest, NeuronsAreReloadedWhenTheFileChanges) {
+    const std::string path = "neurons.txt";
+
+    // Puts the real weights back however the test ends, a failed assertion returns early
+    struct RestoreFile {
+        std::string path;
+        std::string contents;
+        std::filesystem::file_time_type time;
+
+        ~RestoreFile() {
+            std::ofstream(path) << contents;
+            std::filesystem::last_write_time(path, time);
+        }
+    };
+    std::ifstream original(path);
+    const RestoreFile restore{path, std::string((std::istreambuf_iterator<char>(original)), std::istreambuf_iterator<char>()),
+                              std::filesystem::last_write_time(path)};
+    original.close();
+    const auto originalTime = restore.time;
+
+    Brain::Brain bot;
+    EXPECT_FALSE(bot.reloadNeuronsIfChanged());
+
+    // The clock of the file system may be coarse, the edits are dated well after the first read
+    std::ofstream(path) << "MATERIAL=2.0\nKING_SAFETY=0.5";
+    std::filesystem::last_write_time(path, originalTime + std::chrono::hours(1));
+    EXPECT_TRUE(bot.reloadNeuronsIfChanged());
+    ASSERT_EQ(bot.getNeurons().size(), 2);
+    EXPECT_EQ(bot.getNeurons()[0].type, Brain::EvaluationTypes::MATERIAL);
+    EXPECT_DOUBLE_EQ(bot.getNeurons()[0].value, 2.0);
+    EXPECT_FALSE(bot.reloadNeuronsIfChanged());
+
+    // Half saved, the weights in use are kept
+    std::ofstream(path) << "MATERIAL=";
+    std::filesystem::last_write_time(path, originalTime + std::chrono::hours(2));
+    EXPECT_FALSE(bot.reloadNeuronsIfChanged());
+    EXPECT_EQ(bot.getNeurons().size(), 2);
+}
+#else
+TEST_F(BrainTest, CompiledNeuronsScoreLikeTheRuntimeWeights) {
+    Brain::Brain bot("r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP3PPP/R2QKB1R w KQ - 0 1");
+    bot.isWhite = true;
+    bot.searchOptions.useEvaluationCache = false;
+    const Score::Score compiled = bot.evaluatePosition();
+
+    // One more term with no weight takes the runtime loop without changing the sum
+    std::vector<Brain::EvaluationNode> neurons = bot.getNeurons();
+    neurons.push_back({Brain::EvaluationTypes::MATERIAL, 0.0});
+    bot.setNeurons(neurons);
+    EXPECT_EQ(bot.evaluatePosition(), compiled);
+}
+#endif
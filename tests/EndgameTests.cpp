@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "Endgame.hpp"
+#include "Brain.hpp"
+
+#include <random>
+
+namespace {
+    Score::Score evaluate(const std::string &fen) {
+        Board::Board board;
+        board.setFromFEN(fen);
+
+        const Endgame::Entry *entry = Endgame::probe(board.materialKey);
+        EXPECT_NE(entry, nullptr) << fen;
+        EXPECT_NE(entry->evaluate, nullptr) << fen;
+        return entry->evaluate(board, entry->strongSide);
+    }
+}
+
+TEST(EndgameTest, MaterialKeyFollowsMakeAndUndo) {
+    std::mt19937 random(5);
+
+    for (int game = 0; game < 10; game++) {
+        Board::Board board;
+        int played = 0;
+        for (; played < 80; played++) {
+            auto moves = board.getAllValidMoves();
+            if (moves.empty() || !board.makeMove(moves[random() % moves.size()])) {
+                break;
+            }
+
+            Board::Board scanned = board;
+            scanned.computePieceScores();
+            ASSERT_EQ(board.materialKey, scanned.materialKey) << game << " " << played;
+        }
+
+        for (; played > 0; played--) {
+            board.undoMove();
+        }
+        EXPECT_EQ(board.materialKey, Board::Board().materialKey);
+    }
+}
+
+TEST(EndgameTest, MaterialKeyMatchesTheSignature) {
+    Board::Board board;
+    board.setFromFEN("4k3/8/8/8/8/8/2P5/2B1KN2 w - - 0 1");
+
+    EXPECT_EQ(board.materialKey, Endgame::getMaterialKey("KBNPvK"));
+    EXPECT_EQ(board.getPieceCount(true, 1), 1);
+    EXPECT_EQ(board.getPieceCount(false, 0), 0);
+    EXPECT_THROW(Endgame::getMaterialKey("KQK"), const char *);
+}
+
+TEST(EndgameTest, InsufficientMaterialIsReadFromTheKey) {
+    EXPECT_TRUE(Endgame::isInsufficientMaterial(Endgame::getMaterialKey("KvK")));
+    EXPECT_TRUE(Endgame::isInsufficientMaterial(Endgame::getMaterialKey("KvKN")));
+    EXPECT_TRUE(Endgame::isInsufficientMaterial(Endgame::getMaterialKey("KBvK")));
+
+    // Bishop and knight mate by force, the others could still be mated
+    EXPECT_FALSE(Endgame::isInsufficientMaterial(Endgame::getMaterialKey("KBNvK")));
+    EXPECT_FALSE(Endgame::isInsufficientMaterial(Endgame::getMaterialKey("KNvKN")));
+    EXPECT_FALSE(Endgame::isInsufficientMaterial(Endgame::getMaterialKey("KPvK")));
+
+    Board::Board board;
+    board.setFromFEN("4k3/8/8/8/8/8/8/2B1KN2 w - - 0 1");
+    EXPECT_FALSE(board.isInsufficientMaterial());
+    board.setFromFEN("4k3/8/8/8/8/8/8/2B1K3 w - - 0 1");
+    EXPECT_TRUE(board.isInsufficientMaterial());
+}
+
+TEST(EndgameTest, LoneKingIsDrivenToTheEdge) {
+    const Score::Score centre = evaluate("8/8/8/4k3/8/8/8/R3K3 w - - 0 1");
+    const Score::Score edge = evaluate("4k3/8/8/8/8/8/8/R3K3 w - - 0 1");
+
+    EXPECT_GT(centre, Endgame::knownWin);
+    EXPECT_GT(edge, centre);
+
+    // Black with the rook gets the same entry on the swapped key
+    EXPECT_EQ(evaluate("r3k3/8/8/8/8/8/8/4K3 b - - 0 1"), edge);
+}
+
+TEST(EndgameTest, BishopAndKnightMateInTheBishopsCorner) {
+    // The bishop on c1 is on a dark square, a1 and h8 are the corners it covers
+    const Score::Score rightCorner = evaluate("8/8/8/8/8/8/8/k1B1KN2 w - - 0 1");
+    const Score::Score wrongCorner = evaluate("k7/8/8/8/8/8/8/2B1KN2 w - - 0 1");
+
+    EXPECT_GT(rightCorner, wrongCorner);
+}
+
+TEST(EndgameTest, KingAndPawnIsScoredFromTheBitbase) {
+    EXPECT_GT(evaluate("k7/8/8/8/8/8/6P1/4K3 w - - 0 1"), Endgame::knownWin);
+    EXPECT_EQ(evaluate("k7/8/8/8/8/8/P7/K7 w - - 0 1"), Score::draw);
+}
+
+TEST(EndgameTest, BrainUsesTheEndgameEntries) {
+    Brain::Brain rook("4k3/8/8/8/8/8/8/R3K3 w - - 0 1");
+    rook.isWhite = true;
+    EXPECT_GT(rook.evaluatePosition(), Endgame::knownWin);
+    rook.isWhite = false;
+    EXPECT_LT(rook.evaluatePosition(), -Endgame::knownWin);
+
+    Brain::Brain knights("4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1");
+    knights.isWhite = true;
+    EXPECT_EQ(knights.evaluatePosition(), Score::draw);
+
+    // Two pawns up with opposite coloured bishops count half of what the general evaluation gives
+    Brain::Brain opposite("2b1k3/8/8/8/8/8/PP6/2B1K3 w - - 0 1");
+    opposite.isWhite = true;
+    Brain::Brain unscaled("2b1k3/8/8/8/8/8/PP6/2B1K3 w - - 0 1");
+    unscaled.isWhite = true;
+    unscaled.searchOptions.useEndgames = false;
+
+    EXPECT_EQ(opposite.evaluatePosition(), unscaled.evaluatePosition() * Endgame::fullScale / 2 / Endgame::fullScale);
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "EvaluationCache.hpp"
+#include "Brain.hpp"
+
+#include <thread>
+#include <vector>
+
+TEST(EvaluationCacheTest, StoredScoreIsFound) {
+    EvaluationCache::EvaluationCache cache(64);
+    cache.store(0x1234, 150);
+
+    Score::Score score = 0;
+    ASSERT_TRUE(cache.probe(0x1234, score));
+    EXPECT_EQ(score, 150);
+    EXPECT_FALSE(cache.probe(0x1235, score));
+
+    EXPECT_EQ(cache.getProbes(), 2);
+    EXPECT_EQ(cache.getHits(), 1);
+
+    cache.clear();
+    EXPECT_FALSE(cache.probe(0x1234, score));
+}
+
+TEST(EvaluationCacheTest, ConcurrentWritersNeverHandOutAnotherKeysScore) {
+    EvaluationCache::EvaluationCache cache(1);
+    std::vector<std::thread> threads;
+    std::atomic<int> wrongScores{0};
+
+    // Few entries and many keys, so the threads keep overwriting each other's entries
+    for (int thread = 0; thread < 4; thread++) {
+        threads.emplace_back([&cache, &wrongScores, thread]() {
+            for (std::uint64_t i = 0; i < 200000; i++) {
+                const std::uint64_t key = (i * 4 + thread) * 0x9E3779B97F4A7C15ULL;
+                cache.store(key, static_cast<Score::Score>(key >> 44));
+
+                Score::Score score;
+                const std::uint64_t otherKey = ((i + 7) * 4 + (thread + 1) % 4) * 0x9E3779B97F4A7C15ULL;
+                if (cache.probe(otherKey, score) && score != static_cast<Score::Score>(otherKey >> 44))
+                    wrongScores++;
+            }
+        });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(wrongScores.load(), 0);
+}
+
+TEST(EvaluationCacheTest, CachedEvaluationMatchesTheFullOne) {
+    Brain::Brain cached("r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4");
+    Brain::Brain uncached("r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4");
+    uncached.searchOptions.useEvaluationCache = false;
+
+    const Score::Score first = cached.evaluatePosition();
+    EXPECT_EQ(cached.evaluatePosition(), first);
+    EXPECT_EQ(uncached.evaluatePosition(), first);
+    EXPECT_EQ(cached.evaluationCache.getHits(), 1);
+}
+
+TEST(EvaluationCacheTest, NewWeightsAreNotAnsweredFromTheCache) {
+    Brain::Brain brain("r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4");
+    const Score::Score before = brain.evaluatePosition();
+
+    auto neurons = brain.getNeurons();
+    for (auto &node : neurons) {
+        node.value *= 2;
+    }
+    brain.setNeurons(neurons);
+
+    EXPECT_EQ(brain.evaluatePosition(), before * 2);
+}
+
+TEST(EvaluationCacheTest, SearchReportsCacheHits) {
+    Brain::Brain brain;
+    brain.searchOptions.maxDepth = 3;
+    brain.findBestMove();
+
+    EXPECT_GT(brain.searchStatistics.evaluationCacheProbes, 0);
+    EXPECT_GT(brain.searchStatistics.evaluationCacheHits, 0);
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include "MateSearch.hpp"
+#include "Brain.hpp"
+
+TEST(MateSearchTest, FindsMateInOne) {
+    Brain::Brain brain("r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4");
+
+    Move::Move move = brain.findMate(5);
+
+    ASSERT_TRUE(move.isValid);
+    EXPECT_EQ(move.from, 39);
+    EXPECT_EQ(move.to, 53);
+    EXPECT_EQ(brain.searchStatistics.depth, 1);
+}
+
+TEST(MateSearchTest, FindsSmotheredMateThroughAQueenSacrifice) {
+    // Nf7+ Kg8 Nh6+ Kh8 Qg8+ Rxg8 Nf7#
+    Brain::Brain brain("3r3k/6pp/8/6N1/2Q5/8/5PPP/6K1 w - - 0 1");
+
+    Move::Move move = brain.findMate(9);
+
+    ASSERT_TRUE(move.isValid);
+    EXPECT_EQ(move.from, 38);
+    EXPECT_EQ(move.to, 53);
+    EXPECT_EQ(brain.searchStatistics.depth, 7);
+    EXPECT_GE(brain.searchStatistics.score, Score::mateBound);
+}
+
+TEST(MateSearchTest, MateLongerThanTheLimitIsNotFound) {
+    Brain::Brain brain("3r3k/6pp/8/6N1/2Q5/8/5PPP/6K1 w - - 0 1");
+
+    EXPECT_FALSE(brain.findMate(5).isValid);
+}
+
+TEST(MateSearchTest, BlackCanBeTheAttacker) {
+    Brain::Brain brain("r1b1kb1r/pppp1ppp/5q2/4n3/3KP3/2N3PN/PPP4P/R1BQ1B1R b kq - 0 1");
+
+    Move::Move move = brain.findMate(9);
+
+    ASSERT_TRUE(move.isValid);
+    EXPECT_EQ(brain.searchStatistics.depth, 5);
+}
+
+TEST(MateSearchTest, NoChecksMeansNoMate) {
+    Board::Board board;
+    MateSearch::MateSearch mateSearch(1);
+    Move::Move move(false);
+
+    EXPECT_FALSE(mateSearch.solve(board, 5, move));
+    EXPECT_FALSE(move.isValid);
+}
+
+TEST(MateSearchTest, GivesUpAtTheNodeLimit) {
+    Board::Board board;
+    board.setFromFEN("3r3k/6pp/8/6N1/2Q5/8/5PPP/6K1 w - - 0 1");
+
+    MateSearch::MateSearch mateSearch(1);
+    mateSearch.nodeLimit = 5;
+    Move::Move move(false);
+
+    EXPECT_FALSE(mateSearch.solve(board, 7, move));
+    EXPECT_LE(mateSearch.getNodes(), 10);
+}
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include "Network.hpp"
+#include "Brain.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+namespace {
+    template <typename Value>
+    void writeValue(std::ofstream &output, Value value) {
+        for (std::size_t i = 0; i < sizeof(Value); i++) {
+            output.put(static_cast<char>((static_cast<long long>(value) >> (8 * i)) & 0xFF));
+        }
+    }
+
+    template <typename Value>
+    void writeRandomValues(std::ofstream &output, std::mt19937 &random, std::size_t count, int low, int high) {
+        std::uniform_int_distribution<int> distribution(low, high);
+        for (std::size_t i = 0; i < count; i++) {
+            writeValue(output, static_cast<Value>(distribution(random)));
+        }
+    }
+
+    // Small random network, the tests only need the evaluation to depend on every piece
+    void writeNetwork(const std::string &path, int half = 16, int first = 16, int second = 16) {
+        std::mt19937 random(11);
+        std::ofstream output(path, std::ios::binary);
+
+        output.write(Network::Network::magic, 4);
+        output.put(static_cast<char>(Network::Network::version));
+        output.put(0);
+        output.put(0);
+        output.put(0);
+        writeValue(output, static_cast<std::uint16_t>(half));
+        writeValue(output, static_cast<std::uint16_t>(first));
+        writeValue(output, static_cast<std::uint16_t>(second));
+        writeValue(output, static_cast<std::uint16_t>(0));
+
+        writeRandomValues<std::int16_t>(output, random, half, 0, 64);
+        writeRandomValues<std::int16_t>(output, random, static_cast<std::size_t>(Network::Network::featureCount) * half, -12, 12);
+        writeRandomValues<std::int8_t>(output, random, static_cast<std::size_t>(first) * 2 * half, -30, 30);
+        writeRandomValues<std::int32_t>(output, random, first, -500, 500);
+        writeRandomValues<std::int8_t>(output, random, static_cast<std::size_t>(second) * first, -30, 30);
+        writeRandomValues<std::int32_t>(output, random, second, -500, 500);
+        writeRandomValues<std::int8_t>(output, random, second, -127, 127);
+        writeValue(output, static_cast<std::int32_t>(100));
+    }
+
+    int evaluateFromScratch(const std::string &path, const Board::Board &board) {
+        Network::Network network;
+        EXPECT_TRUE(network.load(path));
+        return network.evaluate(board);
+    }
+}
+
+class NetworkTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        writeNetwork(path);
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+
+    const std::string path = "test_network.cbnn";
+};
+
+TEST_F(NetworkTest, RejectsMissingAndDamagedFiles) {
+    Network::Network network;
+    EXPECT_FALSE(network.load("missing.cbnn"));
+    EXPECT_FALSE(network.isLoaded());
+
+    EXPECT_TRUE(network.load(path));
+    EXPECT_TRUE(network.isLoaded());
+    EXPECT_EQ(network.getHalfDimensions(), 16);
+
+    // A file cut short loses the network that was loaded before
+    std::ofstream("test_network_short.cbnn", std::ios::binary) << "CBNN";
+    EXPECT_FALSE(network.load("test_network_short.cbnn"));
+    EXPECT_FALSE(network.isLoaded());
+    std::remove("test_network_short.cbnn");
+
+    writeNetwork("test_network_odd.cbnn", 12);
+    EXPECT_FALSE(network.load("test_network_odd.cbnn"));
+    std::remove("test_network_odd.cbnn");
+}
+
+TEST_F(NetworkTest, FeaturesAreSeenFromEachKing) {
+    using Board::Board;
+
+    // The white pawn on e2 seen by the white king on e1 is the black pawn on e7 seen by the black king on e8
+    EXPECT_EQ(Network::Network::getFeatureIndex(0, 4, Board::PAWN, 12),
+              Network::Network::getFeatureIndex(1, 60, Board::PAWN | Board::BLACK, 52));
+    EXPECT_NE(Network::Network::getFeatureIndex(0, 4, Board::PAWN, 12),
+              Network::Network::getFeatureIndex(1, 60, Board::PAWN, 52));
+    EXPECT_LT(Network::Network::getFeatureIndex(1, 0, Board::QUEEN, 63), Network::Network::featureCount);
+}
+
+TEST_F(NetworkTest, IncrementalUpdatesMatchAFreshEvaluation) {
+    Network::Network network;
+    ASSERT_TRUE(network.load(path));
+
+    std::mt19937 random(3);
+    Board::Board board;
+
+    for (int step = 0; step < 120; step++) {
+        const int action = random() % 6;
+
+        if (action == 0 && !board.moveHistory.empty()) {
+            if (board.moveHistory.back().pieceType == Move::PieceType::NONE) {
+                board.undoNullMove();
+            } else {
+                board.undoMove();
+            }
+        } else if (action == 1) {
+            board.makeNullMove();
+        } else {
+            auto moves = board.getAllValidMoves();
+            if (moves.empty()) {
+                board.undoMove();
+            } else {
+                ASSERT_TRUE(board.makeMove(moves[random() % moves.size()]));
+            }
+        }
+
+        ASSERT_EQ(network.evaluate(board), evaluateFromScratch(path, board)) << step;
+    }
+}
+
+TEST_F(NetworkTest, MirroredPositionsScoreTheSame) {
+    Network::Network network;
+    ASSERT_TRUE(network.load(path));
+
+    Board::Board board;
+    board.setFromFEN("r3k2r/pp3ppp/2n1bn2/3p4/3P4/2NB1N2/PP3PPP/R3K2R w KQkq - 0 1");
+    Board::Board mirrored;
+    mirrored.setFromFEN("r3k2r/pp3ppp/2nb1n2/3p4/3P4/2N1BN2/PP3PPP/R3K2R b KQkq - 0 1");
+
+    EXPECT_EQ(network.evaluate(board), network.evaluate(mirrored));
+}
+
+TEST_F(NetworkTest, EveryKernelScoresLikeTheScalarOne) {
+    const BoardScan::Kernel original = Network::Network::getKernel();
+    writeNetwork("test_network_wide.cbnn", 48, 32, 16);
+
+    const std::vector<std::string> fens = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/pp3ppp/2n1bn2/3p4/3P4/2NB1N2/PP3PPP/R3K2R w KQkq - 0 1",
+        "4k3/8/8/3q4/8/8/3P4/4K3 b - - 0 1",
+    };
+    const BoardScan::Kernel kernels[] = {BoardScan::Kernel::SSE2, BoardScan::Kernel::AVX2};
+
+    for (const std::string &fen : fens) {
+        Board::Board board;
+        board.setFromFEN(fen);
+
+        ASSERT_TRUE(Network::Network::setKernel(BoardScan::Kernel::SCALAR));
+        const int expected = evaluateFromScratch("test_network_wide.cbnn", board);
+
+        for (BoardScan::Kernel kernel : kernels) {
+            if (Network::Network::setKernel(kernel)) {
+                EXPECT_EQ(evaluateFromScratch("test_network_wide.cbnn", board), expected) << fen;
+            }
+        }
+    }
+
+    Network::Network::setKernel(original);
+    std::remove("test_network_wide.cbnn");
+}
+
+TEST_F(NetworkTest, BoardUndoForgetsThePieceChanges) {
+    Board::Board board;
+    EXPECT_TRUE(board.pieceChanges.empty());
+
+    ASSERT_TRUE(board.makeMove(board.getValidMove(12, 28)));
+    ASSERT_TRUE(board.makeMove(board.getValidMove(51, 35)));
+    ASSERT_TRUE(board.makeMove(board.getValidMove(28, 35)));
+    const std::size_t beforeCapture = board.stateHistory.back().pieceChangeCount;
+    EXPECT_EQ(board.pieceChanges.size() - beforeCapture, 3);
+
+    board.undoMove();
+    EXPECT_EQ(board.pieceChanges.size(), beforeCapture);
+}
+
+TEST_F(NetworkTest, BrainUsesTheNetworkOnlyWhenLoaded) {
+    Brain::Brain brain;
+    brain.isWhite = true;
+    brain.searchOptions.useEvaluationCache = false;
+    brain.testBoard.setFromFEN("4k3/8/8/3q4/8/8/3P4/4K3 b - - 0 1");
+
+    const Score::Score handCrafted = brain.evaluatePosition();
+
+    ASSERT_TRUE(brain.network.load(path));
+    const Score::Score expected = -brain.network.evaluate(brain.testBoard);
+    EXPECT_EQ(brain.evaluatePosition(), expected);
+
+    brain.searchOptions.useNetwork = false;
+    EXPECT_EQ(brain.evaluatePosition(), handCrafted);
+}
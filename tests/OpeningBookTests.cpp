@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include "OpeningBook.hpp"
+#include "Brain.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+    std::uint16_t encodeMove(int from, int to, int promotion = 0) {
+        return static_cast<std::uint16_t>(to | (from << 6) | (promotion << 12));
+    }
+
+    void writeBigEndian(std::ofstream &output, std::uint64_t value, int length) {
+        for (int i = length - 1; i >= 0; --i) {
+            output.put(static_cast<char>((value >> (i * 8)) & 0xFF));
+        }
+    }
+
+    // Writes a book sorted by key the way Polyglot tools do
+    void writeBook(const std::string &path, std::vector<OpeningBook::BookEntry> entries) {
+        std::stable_sort(entries.begin(), entries.end(), [](const OpeningBook::BookEntry &first, const OpeningBook::BookEntry &second) {
+            return first.key < second.key;
+        });
+
+        std::ofstream output(path, std::ios::binary);
+        for (const auto &entry : entries) {
+            writeBigEndian(output, entry.key, 8);
+            writeBigEndian(output, entry.move, 2);
+            writeBigEndian(output, entry.weight, 2);
+            writeBigEndian(output, entry.learn, 4);
+        }
+    }
+}
+
+class OpeningBookTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Board::Board start;
+        Board::Board afterE4;
+        ASSERT_TRUE(afterE4.makeMove(Move::Move("e2", "e4")));
+
+        Board::Board castling;
+        castling.setFromFEN("r3k2r/pppppppp/8/8/8/8/PPPPPPPP/R3K2R w KQkq - 0 1");
+
+        std::vector<OpeningBook::BookEntry> entries = {
+            {OpeningBook::OpeningBook::getKey(start), encodeMove(12, 28), 10, 0},
+            {OpeningBook::OpeningBook::getKey(start), encodeMove(11, 27), 5, 0},
+            {OpeningBook::OpeningBook::getKey(afterE4), encodeMove(50, 34), 1, 0},
+            {OpeningBook::OpeningBook::getKey(castling), encodeMove(4, 7), 1, 0},
+        };
+
+        // Unrelated positions around the real ones, so the binary search has something to skip
+        for (std::uint64_t key = 1; key < 200; key++) {
+            entries.push_back({key * 0x0101010101010101ULL, encodeMove(0, 1), 1, 0});
+        }
+
+        writeBook(path, entries);
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+
+    const std::string path = "test_book.bin";
+};
+
+TEST(OpeningBookKeyTest, KeysMatchThePublishedPolyglotValues) {
+    Board::Board board;
+    EXPECT_EQ(OpeningBook::OpeningBook::getKey(board), 0x463b96181691fc9cULL);
+
+    // The test games of the Polyglot book format, f7-f5 can be taken en passant and the king walks lose castling
+    const std::vector<std::pair<Move::Move, std::uint64_t>> moves = {
+        {Move::Move("e2", "e4"), 0x823c9b50fd114196ULL},
+        {Move::Move("d7", "d5"), 0x0756b94461c50fb0ULL},
+        {Move::Move("e4", "e5"), 0x662fafb965db29d4ULL},
+        {Move::Move("f7", "f5"), 0x22a48b5a8e47ff78ULL},
+        {Move::Move("e1", "e2"), 0x652a607ca3f242c1ULL},
+        {Move::Move("e8", "f7"), 0x00fdd303c946bdd9ULL},
+    };
+    for (const auto &move : moves) {
+        ASSERT_TRUE(board.makeMove(move.first));
+        EXPECT_EQ(OpeningBook::OpeningBook::getKey(board), move.second);
+    }
+
+    Board::Board other;
+    for (const char *squares : {"a2a4", "b7b5", "h2h4", "b5b4", "c2c4"}) {
+        const std::string move(squares);
+        ASSERT_TRUE(other.makeMove(Move::Move(move.substr(0, 2), move.substr(2, 2))));
+    }
+    EXPECT_EQ(OpeningBook::OpeningBook::getKey(other), 0x3c8123ea7b067637ULL);
+
+    ASSERT_TRUE(other.makeMove(Move::Move("b4", "c3")));
+    ASSERT_TRUE(other.makeMove(Move::Move("a1", "a3")));
+    EXPECT_EQ(OpeningBook::OpeningBook::getKey(other), 0x5c3f9b829b279560ULL);
+}
+
+TEST_F(OpeningBookTest, FindsEveryEntryOfThePosition) {
+    OpeningBook::OpeningBook book;
+    ASSERT_TRUE(book.open(path));
+
+    Board::Board board;
+    auto entries = book.getEntries(OpeningBook::OpeningBook::getKey(board));
+
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[0].weight, 10);
+    EXPECT_EQ(entries[1].weight, 5);
+}
+
+TEST_F(OpeningBookTest, BestSelectionTakesTheHighestWeight) {
+    OpeningBook::OpeningBook book;
+    ASSERT_TRUE(book.open(path));
+
+    Board::Board board;
+    Move::Move move = book.probe(board, OpeningBook::Selection::BEST);
+
+    ASSERT_TRUE(move.isValid);
+    EXPECT_EQ(move.from, 12);
+    EXPECT_EQ(move.to, 28);
+}
+
+TEST_F(OpeningBookTest, WeightedSelectionOnlyPicksBookMoves) {
+    OpeningBook::OpeningBook book;
+    ASSERT_TRUE(book.open(path));
+
+    Board::Board board;
+    for (int i = 0; i < 20; i++) {
+        Move::Move move = book.probe(board, OpeningBook::Selection::WEIGHTED);
+        ASSERT_TRUE(move.isValid);
+        EXPECT_TRUE((move.from == 12 && move.to == 28) || (move.from == 11 && move.to == 27));
+    }
+}
+
+TEST_F(OpeningBookTest, CastlingIsDecodedAsAKingMove) {
+    OpeningBook::OpeningBook book;
+    ASSERT_TRUE(book.open(path));
+
+    Board::Board board;
+    board.setFromFEN("r3k2r/pppppppp/8/8/8/8/PPPPPPPP/R3K2R w KQkq - 0 1");
+    Move::Move move = book.probe(board);
+
+    ASSERT_TRUE(move.isValid);
+    EXPECT_EQ(move.from, 4);
+    EXPECT_EQ(move.to, 6);
+}
+
+TEST_F(OpeningBookTest, UnknownPositionHasNoMove) {
+    OpeningBook::OpeningBook book;
+    ASSERT_TRUE(book.open(path));
+
+    Board::Board board;
+    board.setFromFEN("4k3/8/8/8/8/8/4P3/4K3 w - - 0 1");
+
+    EXPECT_FALSE(book.probe(board).isValid);
+    EXPECT_FALSE(OpeningBook::OpeningBook().open("missing_book.bin"));
+}
+
+TEST_F(OpeningBookTest, BrainPlaysBookMovesWithoutSearching) {
+    Brain::Brain bot("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1");
+    ASSERT_TRUE(bot.openingBook.open(path));
+
+    // The key of a position set from FEN has no en passant file, like the one after e4 with no pawn to take it
+    Move::Move move = bot.findBestMove();
+
+    ASSERT_TRUE(move.isValid);
+    EXPECT_EQ(move.from, 50);
+    EXPECT_EQ(move.to, 34);
+    EXPECT_EQ(bot.searchStatistics.nodes, 0);
+}
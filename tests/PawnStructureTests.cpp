@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include "PawnStructure.hpp"
+#include "Brain.hpp"
+
+TEST(PawnStructureTest, PawnKeyOnlyFollowsThePawns) {
+    Board::Board board;
+    const unsigned long long startKey = board.pawnKey;
+
+    ASSERT_TRUE(board.makeMove(Move::Move("g1", "f3")));
+    EXPECT_EQ(board.pawnKey, startKey);
+
+    ASSERT_TRUE(board.makeMove(Move::Move("e7", "e5")));
+    EXPECT_NE(board.pawnKey, startKey);
+    EXPECT_EQ(board.pawnKey, board.computePawnKey());
+
+    board.undoMove();
+    EXPECT_EQ(board.pawnKey, startKey);
+}
+
+TEST(PawnStructureTest, FindsPassedIsolatedAndBackwardPawns) {
+    Board::Board board;
+    board.setFromFEN("4k3/8/8/4p3/2P5/3P4/8/4K3 w - - 0 1");
+
+    const PawnStructure::Entry entry = PawnStructure::PawnStructure::evaluate(board);
+
+    // c4 is passed, d3 can not advance past e5 and has no neighbour behind it, e5 stands alone
+    EXPECT_EQ(entry.passedPawns[0], 1ULL << 26);
+    EXPECT_EQ(entry.passedPawns[1], 0ULL);
+    EXPECT_EQ(entry.score[0], PawnStructure::PawnStructure::passedPawnBonus[3] - PawnStructure::PawnStructure::backwardPawnPenalty);
+    EXPECT_EQ(entry.score[1], -PawnStructure::PawnStructure::isolatedPawnPenalty);
+    EXPECT_EQ(entry.advancement[0], 5);
+    EXPECT_EQ(entry.advancement[1], 3);
+}
+
+TEST(PawnStructureTest, DoubledPawnsCountOnce) {
+    Board::Board board;
+    board.setFromFEN("4k3/8/8/8/3P4/3P4/2P5/4K3 w - - 0 1");
+
+    const PawnStructure::Entry entry = PawnStructure::PawnStructure::evaluate(board);
+
+    // Only the front pawn of the pair is passed, the rear one pays for the doubling
+    EXPECT_EQ(entry.passedPawns[0], (1ULL << 27) | (1ULL << 10));
+    EXPECT_EQ(entry.score[0], PawnStructure::PawnStructure::passedPawnBonus[3] + PawnStructure::PawnStructure::passedPawnBonus[1] -
+                                         PawnStructure::PawnStructure::doubledPawnPenalty);
+}
+
+TEST(PawnStructureTest, SecondProbeIsAHit) {
+    Board::Board board;
+    PawnStructure::PawnStructure pawnStructure(64);
+
+    pawnStructure.probe(board);
+    ASSERT_TRUE(board.makeMove(Move::Move("g1", "f3")));
+    const PawnStructure::Entry &entry = pawnStructure.probe(board);
+
+    EXPECT_EQ(pawnStructure.getProbes(), 2);
+    EXPECT_EQ(pawnStructure.getHits(), 1);
+    EXPECT_EQ(entry.advancement[0], 8);
+}
+
+TEST(PawnStructureTest, SearchMostlyHitsThePawnTable) {
+    Brain::Brain brain;
+    brain.searchOptions.maxDepth = 3;
+
+    // Every evaluation goes to the pawn table, not only the ones the evaluation cache misses
+    brain.searchOptions.useEvaluationCache = false;
+    brain.findBestMove();
+
+    EXPECT_GT(brain.searchStatistics.pawnHashProbes, 0);
+    EXPECT_GT(brain.searchStatistics.getPawnHashHitRate(), 0.8);
+}
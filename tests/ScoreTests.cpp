@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+#include "Score.hpp"
+#include "Brain.hpp"
+#include "TranspositionTable.hpp"
+
+TEST(ScoreTest, WeightsRoundBothSignsTheSameWay) {
+    const Score::Weight weight = Score::toWeight(0.85);
+
+    for (Score::Score term = 0; term < 2000; term += 7) {
+        EXPECT_EQ(Score::applyWeight(-term, weight), -Score::applyWeight(term, weight)) << term;
+        EXPECT_NEAR(Score::applyWeight(term, weight), term * 0.85, 0.5 + 1e-9) << term;
+    }
+
+    EXPECT_EQ(Score::applyWeight(1234, Score::weightOne), 1234);
+    EXPECT_EQ(Score::fromPawns(-0.355), -Score::fromPawns(0.355));
+}
+
+TEST(ScoreTest, MatesSurviveTheSixteenBitPacking) {
+    EXPECT_TRUE(Score::isMate(Score::mateIn(5)));
+    EXPECT_TRUE(Score::isMate(Score::matedIn(8)));
+    EXPECT_FALSE(Score::isMate(3000));
+
+    for (Score::Score score : {Score::mateIn(1), Score::matedIn(2), -Score::infinite, Score::infinite, 0, -125})
+        EXPECT_EQ(Score::unpack(Score::pack(score)), score);
+
+    EXPECT_EQ(Score::unpack(Score::pack(100000)), 32767);
+    EXPECT_EQ(sizeof(TranspositionTable::Entry), 16u);
+}
+
+TEST(ScoreTest, MirroredPositionsScoreTheSame) {
+    Brain::Brain white("r1bqk2r/ppp2ppp/2np1n2/2b1p3/2B1P3/3P1N2/PPP2PPP/RNBQK2R w KQkq - 0 5");
+    Brain::Brain black("rnbqk2r/ppp2ppp/3p1n2/2b1p3/2B1P3/2NP1N2/PPP2PPP/R1BQK2R b KQkq - 0 5");
+    white.isWhite = true;
+    black.isWhite = false;
+
+    EXPECT_EQ(white.evaluatePosition(), black.evaluatePosition());
+}
@@ -0,0 +1,587 @@
+#include <gtest/gtest.h>
+#include "Syzygy.hpp"
+#include "TablebaseGenerator.hpp"
+#include "Brain.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <queue>
+
+namespace {
+    const std::string directory = "test_syzygy";
+
+    // The index sizes of the real tables, a table without pawns places its three pieces in one group, KPvK places the
+    // pawn on one of the six ranks of the file and the kings on the squares left
+    constexpr std::uint64_t uniquePiecesSize = 31332;
+    constexpr std::uint64_t pawnFileSize = 6 * 63 * 62;
+
+    constexpr int blockBits = 6;
+    constexpr int spanBits = 7;
+
+    void putLittleEndian(std::vector<unsigned char> &bytes, std::uint64_t value, int length) {
+        for (int i = 0; i < length; ++i) {
+            bytes.push_back(static_cast<unsigned char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    struct Symbol {
+        int left;
+        int right;
+        std::uint64_t frequency;
+        int length;
+    };
+
+    // The sizes, sparse index, block lengths and blocks of one side of a table
+    struct CompressedSide {
+        std::vector<unsigned char> sizes;
+        std::vector<unsigned char> sparseIndex;
+        std::vector<unsigned char> blockLengths;
+        std::vector<unsigned char> blocks;
+    };
+
+    CompressedSide getSingleValue(std::uint8_t flags, int value) {
+        CompressedSide side;
+        side.sizes = {static_cast<unsigned char>(flags | Syzygy::Syzygy::singleValueFlag), static_cast<unsigned char>(value)};
+        return side;
+    }
+
+    // Canonical Huffman codes over every value and one pair of the most frequent value, the way the Syzygy generator
+    // writes them with fewer pairs
+    CompressedSide compress(const std::vector<int> &values, std::uint8_t flags) {
+        std::map<int, int> leaves;
+        std::map<int, std::uint64_t> counts;
+        std::vector<Symbol> symbols;
+        for (int value : values) {
+            counts[value]++;
+            if (leaves.count(value) == 0) {
+                leaves[value] = static_cast<int>(symbols.size());
+                symbols.push_back({value, 0xFFF, 0, 0});
+            }
+        }
+
+        const int common = std::max_element(counts.begin(), counts.end(), [](const auto &first, const auto &second) {
+            return first.second < second.second;
+        })->first;
+        const int pair = static_cast<int>(symbols.size());
+        symbols.push_back({leaves[common], leaves[common], 0, 0});
+
+        std::vector<int> tokens;
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (i + 1 < values.size() && values[i] == common && values[i + 1] == common) {
+                tokens.push_back(pair);
+                ++i;
+            } else {
+                tokens.push_back(leaves[values[i]]);
+            }
+        }
+        for (int token : tokens) {
+            symbols[token].frequency++;
+        }
+
+        // Code lengths from the Huffman tree, every symbol gets a code even if only a pair uses it
+        std::vector<int> parents(symbols.size(), -1);
+        std::priority_queue<std::pair<std::uint64_t, int>, std::vector<std::pair<std::uint64_t, int>>, std::greater<>> queue;
+        for (std::size_t i = 0; i < symbols.size(); ++i) {
+            queue.push({std::max<std::uint64_t>(symbols[i].frequency, 1), static_cast<int>(i)});
+        }
+        while (queue.size() > 1) {
+            const auto first = queue.top();
+            queue.pop();
+            const auto second = queue.top();
+            queue.pop();
+            parents.push_back(-1);
+            parents[first.second] = static_cast<int>(parents.size()) - 1;
+            parents[second.second] = static_cast<int>(parents.size()) - 1;
+            queue.push({first.first + second.first, static_cast<int>(parents.size()) - 1});
+        }
+        for (std::size_t i = 0; i < symbols.size(); ++i) {
+            for (int node = parents[i]; node != -1; node = parents[node]) {
+                symbols[i].length++;
+            }
+        }
+
+        // Longer codes get the lower symbols
+        std::vector<int> order(symbols.size());
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            order[i] = static_cast<int>(i);
+        }
+        std::stable_sort(order.begin(), order.end(), [&symbols](int first, int second) {
+            return symbols[first].length > symbols[second].length;
+        });
+        std::vector<int> ids(symbols.size());
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            ids[order[i]] = static_cast<int>(i);
+        }
+
+        const int minLength = symbols[order.back()].length;
+        const int maxLength = symbols[order.front()].length;
+        std::vector<int> lowest(maxLength - minLength + 1, 0);
+        std::vector<std::uint64_t> base(lowest.size(), 0);
+        for (int i = 0; i < static_cast<int>(lowest.size()); ++i) {
+            lowest[i] = static_cast<int>(std::count_if(symbols.begin(), symbols.end(), [&](const Symbol &symbol) {
+                return symbol.length > minLength + i;
+            }));
+        }
+        for (int i = static_cast<int>(base.size()) - 2; i >= 0; --i) {
+            const std::uint64_t next = base[i + 1] + lowest[i] - lowest[i + 1];
+            EXPECT_EQ(next % 2, 0u);
+            base[i] = next / 2;
+        }
+        const auto getCode = [&](int symbol) {
+            const int i = symbols[symbol].length - minLength;
+            return base[i] + (ids[symbol] - lowest[i]);
+        };
+
+        CompressedSide side;
+        const std::size_t blockSize = std::size_t(1) << blockBits;
+        std::vector<int> blockValueCounts;
+        std::size_t bit = 0;
+        for (int token : tokens) {
+            if (blockValueCounts.empty() || bit + symbols[token].length > (blockSize - 8) * 8) {
+                side.blocks.resize(side.blocks.size() + blockSize, 0);
+                blockValueCounts.push_back(0);
+                bit = 0;
+            }
+
+            const std::uint64_t code = getCode(token);
+            for (int i = symbols[token].length - 1; i >= 0; --i, ++bit) {
+                if ((code >> i) & 1) {
+                    side.blocks[side.blocks.size() - blockSize + bit / 8] |= static_cast<unsigned char>(0x80 >> (bit % 8));
+                }
+            }
+            blockValueCounts.back() += token == pair ? 2 : 1;
+        }
+
+        std::vector<std::uint64_t> blockStarts = {0};
+        for (int count : blockValueCounts) {
+            putLittleEndian(side.blockLengths, count - 1, 2);
+            blockStarts.push_back(blockStarts.back() + count);
+        }
+
+        // The sparse index points at the middle of every span, past the last value it goes on counting in the last block
+        const std::uint64_t span = std::uint64_t(1) << spanBits;
+        for (std::uint64_t k = 0; k * span < values.size(); ++k) {
+            const std::uint64_t middle = k * span + span / 2;
+            std::size_t block = std::upper_bound(blockStarts.begin(), blockStarts.end(), middle) - blockStarts.begin() - 1;
+            block = std::min(block, blockValueCounts.size() - 1);
+            putLittleEndian(side.sparseIndex, block, 4);
+            putLittleEndian(side.sparseIndex, middle - blockStarts[block], 2);
+        }
+
+        side.sizes = {flags, blockBits, spanBits, 0};
+        putLittleEndian(side.sizes, blockValueCounts.size(), 4);
+        side.sizes.push_back(static_cast<unsigned char>(maxLength));
+        side.sizes.push_back(static_cast<unsigned char>(minLength));
+        for (int value : lowest) {
+            putLittleEndian(side.sizes, value, 2);
+        }
+        putLittleEndian(side.sizes, symbols.size(), 2);
+        for (int symbol : order) {
+            const int left = symbols[symbol].right == 0xFFF ? symbols[symbol].left : ids[symbols[symbol].left];
+            const int right = symbols[symbol].right == 0xFFF ? 0xFFF : ids[symbols[symbol].right];
+            side.sizes.push_back(static_cast<unsigned char>(left & 0xFF));
+            side.sizes.push_back(static_cast<unsigned char>((left >> 8) | ((right & 0xF) << 4)));
+            side.sizes.push_back(static_cast<unsigned char>(right >> 4));
+        }
+        if (symbols.size() % 2 == 1) {
+            side.sizes.push_back(0);
+        }
+        return side;
+    }
+
+    // header holds the order byte and the piece bytes of every file of the leading pawn, sides the compressed sides of
+    // every file
+    void writeTable(const std::string &path, bool isDtz, std::uint8_t flags, const std::vector<std::vector<unsigned char>> &header,
+                    const std::vector<std::vector<CompressedSide>> &sides) {
+        const std::uint8_t *magic = isDtz ? Syzygy::Syzygy::dtzMagic : Syzygy::Syzygy::wdlMagic;
+        std::vector<unsigned char> bytes(magic, magic + 4);
+        bytes.push_back(flags);
+        for (const auto &fileHeader : header) {
+            bytes.insert(bytes.end(), fileHeader.begin(), fileHeader.end());
+        }
+        bytes.resize(bytes.size() + bytes.size() % 2, 0);
+
+        for (const auto &fileSides : sides) {
+            for (const auto &side : fileSides) {
+                bytes.insert(bytes.end(), side.sizes.begin(), side.sizes.end());
+            }
+        }
+        bytes.resize(bytes.size() + bytes.size() % 2, 0);
+
+        for (const auto &fileSides : sides) {
+            for (const auto &side : fileSides) {
+                bytes.insert(bytes.end(), side.sparseIndex.begin(), side.sparseIndex.end());
+            }
+        }
+        for (const auto &fileSides : sides) {
+            for (const auto &side : fileSides) {
+                bytes.insert(bytes.end(), side.blockLengths.begin(), side.blockLengths.end());
+            }
+        }
+        for (const auto &fileSides : sides) {
+            for (const auto &side : fileSides) {
+                bytes.resize((bytes.size() + 63) / 64 * 64, 0);
+                bytes.insert(bytes.end(), side.blocks.begin(), side.blocks.end());
+            }
+        }
+
+        std::ofstream output(path, std::ios::binary);
+        output.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    std::vector<std::int16_t> readDistanceToMate(const std::string &signature) {
+        std::ifstream input(directory + "/" + signature + Tablebase::Tablebase::extension, std::ios::binary);
+        std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+        std::vector<std::int16_t> values;
+        for (std::size_t i = Tablebase::Tablebase::headerSize; i + 1 < bytes.size(); i += 2) {
+            values.push_back(static_cast<std::int16_t>(bytes[i] | (bytes[i + 1] << 8)));
+        }
+        return values;
+    }
+
+    std::string getFen(const std::vector<Tablebase::TablePiece> &pieces, bool isWhiteToMove, int fiftyMoveCount = 0) {
+        char squares[64] = {0};
+        for (const auto &piece : pieces) {
+            squares[piece.square] = piece.isWhite ? piece.letter : static_cast<char>(std::tolower(piece.letter));
+        }
+
+        std::string fen;
+        for (int rank = 7; rank >= 0; --rank) {
+            int empty = 0;
+            for (int file = 0; file < 8; ++file) {
+                const char square = squares[8 * rank + file];
+                if (square == 0) {
+                    ++empty;
+                    continue;
+                }
+                if (empty > 0) {
+                    fen += std::to_string(empty);
+                    empty = 0;
+                }
+                fen += square;
+            }
+            if (empty > 0) {
+                fen += std::to_string(empty);
+            }
+            if (rank > 0) {
+                fen += '/';
+            }
+        }
+        return fen + (isWhiteToMove ? " w" : " b") + " - - " + std::to_string(fiftyMoveCount) + " 1";
+    }
+
+    // The same position with the colours swapped and the board turned upside down
+    std::vector<Tablebase::TablePiece> getFlipped(std::vector<Tablebase::TablePiece> pieces) {
+        for (auto &piece : pieces) {
+            piece.isWhite = !piece.isWhite;
+            piece.square ^= 56;
+        }
+        return pieces;
+    }
+
+    struct Position {
+        std::vector<Tablebase::TablePiece> pieces;
+        bool isWhiteToMove;
+        Tablebase::ProbeResult result;
+    };
+
+    // Every legal position of the strong king, the piece and the weak king with its distance to mate
+    std::vector<Position> getPositions(char letter) {
+        const std::string signature = std::string("K") + letter + "vK";
+        const std::vector<std::int16_t> values = readDistanceToMate(signature);
+
+        std::vector<Position> positions;
+        for (int strongKing = 0; strongKing < 64; ++strongKing) {
+            for (int piece = 0; piece < 64; ++piece) {
+                if (letter == 'P' && (piece < 8 || piece >= 56)) {
+                    continue;
+                }
+                for (int weakKing = 0; weakKing < 64; ++weakKing) {
+                    if (strongKing == piece || strongKing == weakKing || piece == weakKing) {
+                        continue;
+                    }
+                    for (bool isWhiteToMove : {true, false}) {
+                        const std::vector<Tablebase::TablePiece> pieces = {{'K', true, strongKing}, {letter, true, piece}, {'K', false, weakKing}};
+
+                        Tablebase::TablePosition position;
+                        EXPECT_TRUE(Tablebase::Tablebase::getTablePosition(pieces, isWhiteToMove, position));
+                        const std::int16_t value = values[Tablebase::Tablebase::getIndex(position)];
+                        if (value != Tablebase::Tablebase::illegalValue) {
+                            positions.push_back({pieces, isWhiteToMove, Tablebase::Tablebase::decodeValue(value)});
+                        }
+                    }
+                }
+            }
+        }
+        return positions;
+    }
+
+    int getWdl(const Tablebase::ProbeResult &result) {
+        return 2 * static_cast<int>(result.wdl);
+    }
+}
+
+class SyzygyTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        std::filesystem::create_directory(directory);
+
+        // KPvK needs the tables of the promotions, so KQvK comes with it
+        TablebaseGenerator::GeneratorOptions options;
+        options.directory = directory;
+        options.threadCount = 2;
+        TablebaseGenerator::TablebaseGenerator generator(options);
+        generator.generate("KPvK");
+
+        queenPositions = getPositions('Q');
+        pawnPositions = getPositions('P');
+
+        // Both sides list the king, the piece and the other king, with the pawn first since it leads the index
+        const std::vector<unsigned char> queenHeader = {0x00, 0x66, 0x55, 0xEE};
+        const std::vector<unsigned char> pawnHeader = {0x00, 0x11, 0x66, 0xEE};
+        const std::vector<std::vector<unsigned char>> pawnHeaders(4, pawnHeader);
+
+        // Only the layout is read to find the indices, the values come after
+        writeTable(directory + "/KQvK.rtbw", false, 0x01, {queenHeader}, {{getSingleValue(0, 2), getSingleValue(0, 2)}});
+        writeTable(directory + "/KQvK.rtbz", true, 0x01, {queenHeader}, {{getSingleValue(0, 0)}});
+        writeTable(directory + "/KPvK.rtbw", false, 0x03, pawnHeaders,
+                   std::vector<std::vector<CompressedSide>>(4, {getSingleValue(0, 2), getSingleValue(0, 2)}));
+
+        // Unset entries are draws, the positions the search never asks for
+        std::vector<std::vector<int>> queenWdl(2, std::vector<int>(uniquePiecesSize, -1));
+        std::vector<int> queenDtz(uniquePiecesSize, -1);
+        std::vector<std::vector<std::vector<int>>> pawnWdl(4, std::vector<std::vector<int>>(2, std::vector<int>(pawnFileSize, -1)));
+        {
+            Syzygy::Syzygy syzygy;
+            ASSERT_TRUE(syzygy.setPath(directory));
+
+            const auto setValue = [](std::vector<int> &values, std::uint64_t index, int value) {
+                ASSERT_LT(index, values.size());
+                if (values[index] != -1 && values[index] != value) {
+                    collisionCount++;
+                }
+                values[index] = value;
+            };
+
+            for (const Position &position : queenPositions) {
+                int side;
+                int file;
+                std::uint64_t index;
+                ASSERT_TRUE(syzygy.getIndex(position.pieces, position.isWhiteToMove, false, side, file, index));
+                setValue(queenWdl[side], index, getWdl(position.result) + 2);
+
+                // Only white to move is stored, white has no capture or pawn move so the DTZ is the distance to mate
+                if (syzygy.getIndex(position.pieces, position.isWhiteToMove, true, side, file, index)) {
+                    EXPECT_TRUE(position.isWhiteToMove);
+                    setValue(queenDtz, index, position.result.wdl == Tablebase::Wdl::WIN ? (position.result.distance - 1) / 2 : 0);
+                }
+            }
+
+            for (const Position &position : pawnPositions) {
+                int side;
+                int file;
+                std::uint64_t index;
+                ASSERT_TRUE(syzygy.getIndex(position.pieces, position.isWhiteToMove, false, side, file, index));
+                setValue(pawnWdl[file][side], index, getWdl(position.result) + 2);
+            }
+
+            // Black can take the queen, the table stores a loss there as the generator may
+            int side;
+            int file;
+            std::uint64_t index;
+            ASSERT_TRUE(syzygy.getIndex(getPieces(capturedQueen), false, false, side, file, index));
+            queenWdl[side][index] = 0;
+        }
+
+        const auto fillDraws = [](std::vector<int> &values, int draw) {
+            std::replace(values.begin(), values.end(), -1, draw);
+        };
+        fillDraws(queenWdl[0], 2);
+        fillDraws(queenWdl[1], 2);
+        fillDraws(queenDtz, 0);
+
+        writeTable(directory + "/KQvK.rtbw", false, 0x01, {queenHeader}, {{compress(queenWdl[0], 0), compress(queenWdl[1], 0)}});
+        writeTable(directory + "/KQvK.rtbz", true, 0x01, {queenHeader}, {{compress(queenDtz, 0)}});
+
+        std::vector<std::vector<CompressedSide>> pawnSides;
+        for (auto &fileValues : pawnWdl) {
+            fillDraws(fileValues[0], 2);
+            fillDraws(fileValues[1], 2);
+            pawnSides.push_back({compress(fileValues[0], 0), compress(fileValues[1], 0)});
+        }
+        writeTable(directory + "/KPvK.rtbw", false, 0x03, pawnHeaders, pawnSides);
+    }
+
+    static void TearDownTestSuite() {
+        std::filesystem::remove_all(directory);
+    }
+
+    static std::vector<Tablebase::TablePiece> getPieces(const std::string &fen) {
+        Board::Board board;
+        board.setFromFEN(fen);
+
+        std::vector<Tablebase::TablePiece> pieces;
+        for (int square = 0; square < 64; ++square) {
+            const unsigned long long piece = board.board[square];
+            if (piece == Board::Board::NONE) {
+                continue;
+            }
+            const char letter = (piece & Board::Board::KING) ? 'K' : (piece & Board::Board::QUEEN) ? 'Q' : 'P';
+            pieces.push_back({letter, (piece & Board::Board::BLACK) == 0, square});
+        }
+        return pieces;
+    }
+
+    static inline std::vector<Position> queenPositions;
+    static inline std::vector<Position> pawnPositions;
+    static inline int collisionCount = 0;
+    static inline const std::string capturedQueen = "8/8/8/4Q3/3k4/8/8/K7 b - - 0 1";
+};
+
+TEST_F(SyzygyTest, OnlyMirroredPositionsShareAnIndex) {
+    EXPECT_EQ(collisionCount, 0);
+}
+
+TEST_F(SyzygyTest, ProbesTheResultOfEitherColour) {
+    Syzygy::Syzygy syzygy;
+    ASSERT_TRUE(syzygy.setPath(directory));
+    EXPECT_EQ(syzygy.getMaxPieces(), 3);
+
+    for (const auto *positions : {&queenPositions, &pawnPositions}) {
+        for (std::size_t i = 0; i < positions->size(); i += 97) {
+            const Position &position = (*positions)[i];
+            const int expected = getWdl(position.result);
+
+            Board::Board board;
+            board.setFromFEN(getFen(position.pieces, position.isWhiteToMove));
+            Syzygy::Wdl result;
+            ASSERT_TRUE(syzygy.probeWdl(board, result)) << getFen(position.pieces, position.isWhiteToMove);
+            EXPECT_EQ(static_cast<int>(result), expected) << getFen(position.pieces, position.isWhiteToMove);
+
+            Board::Board flipped;
+            flipped.setFromFEN(getFen(getFlipped(position.pieces), !position.isWhiteToMove));
+            ASSERT_TRUE(syzygy.probeWdl(flipped, result));
+            EXPECT_EQ(static_cast<int>(result), expected) << getFen(getFlipped(position.pieces), !position.isWhiteToMove);
+        }
+    }
+}
+
+TEST_F(SyzygyTest, CapturesOverrideTheStoredValue) {
+    Syzygy::Syzygy syzygy;
+    ASSERT_TRUE(syzygy.setPath(directory));
+
+    Board::Board board;
+    board.setFromFEN(capturedQueen);
+    Syzygy::Wdl result;
+    ASSERT_TRUE(syzygy.probeWdl(board, result));
+    EXPECT_EQ(result, Syzygy::Wdl::DRAW);
+}
+
+TEST_F(SyzygyTest, DtzCountsHalfMovesToTheMate) {
+    Syzygy::Syzygy syzygy;
+    ASSERT_TRUE(syzygy.setPath(directory));
+
+    for (std::size_t i = 0; i < queenPositions.size(); i += 211) {
+        const Position &position = queenPositions[i];
+
+        // Black to move is not stored, it is probed one move deeper. A mated side has a DTZ of -1
+        int expected = 0;
+        if (position.result.wdl == Tablebase::Wdl::WIN) {
+            expected = position.result.distance;
+        } else if (position.result.wdl == Tablebase::Wdl::LOSS) {
+            expected = -std::max(position.result.distance, 1);
+        }
+
+        Board::Board board;
+        board.setFromFEN(getFen(position.pieces, position.isWhiteToMove));
+        int dtz;
+        ASSERT_TRUE(syzygy.probeDtz(board, dtz));
+        EXPECT_EQ(dtz, expected) << getFen(position.pieces, position.isWhiteToMove);
+    }
+}
+
+TEST_F(SyzygyTest, RootKeepsTheFastestWinsUnlessTheFiftyMoveRuleIsNear) {
+    Syzygy::Syzygy syzygy;
+    ASSERT_TRUE(syzygy.setPath(directory));
+
+    const Position &longest = *std::max_element(queenPositions.begin(), queenPositions.end(), [](const Position &first, const Position &second) {
+        const int firstDistance = first.isWhiteToMove && first.result.wdl == Tablebase::Wdl::WIN ? first.result.distance : 0;
+        const int secondDistance = second.isWhiteToMove && second.result.wdl == Tablebase::Wdl::WIN ? second.result.distance : 0;
+        return firstDistance < secondDistance;
+    });
+    ASSERT_EQ(longest.result.distance, 19);
+
+    Tablebase::Tablebase tablebase;
+    ASSERT_TRUE(tablebase.setPath(directory));
+
+    // The mate comes right at the fifty move limit, every kept move still mates in the fewest moves
+    Board::Board board;
+    board.setFromFEN(getFen(longest.pieces, true, 100 - longest.result.distance));
+    std::vector<Move::Move> moves = board.getAllValidMoves();
+    Syzygy::Wdl result;
+    ASSERT_TRUE(syzygy.probeRoot(board, moves, result));
+    EXPECT_EQ(result, Syzygy::Wdl::WIN);
+    ASSERT_FALSE(moves.empty());
+    for (const auto &move : moves) {
+        ASSERT_TRUE(board.makeMove(move));
+        Tablebase::ProbeResult child;
+        ASSERT_TRUE(tablebase.probe(board, child));
+        EXPECT_EQ(child.wdl, Tablebase::Wdl::LOSS);
+        EXPECT_EQ(child.distance, longest.result.distance - 1);
+        board.undoMove();
+    }
+
+    // One half move later the fifty move rule comes first
+    Board::Board late;
+    late.setFromFEN(getFen(longest.pieces, true, 101 - longest.result.distance));
+    moves = late.getAllValidMoves();
+    ASSERT_TRUE(syzygy.probeRoot(late, moves, result));
+    EXPECT_EQ(result, Syzygy::Wdl::CURSED_WIN);
+}
+
+TEST_F(SyzygyTest, BrainPlaysWonEndgamesFromTheTables) {
+    Brain::Brain bot("7k/8/5K2/8/8/8/8/Q7 w - - 0 1");
+    ASSERT_TRUE(bot.syzygy.setPath(directory));
+
+    Tablebase::Tablebase tablebase;
+    ASSERT_TRUE(tablebase.setPath(directory));
+    Board::Board board;
+    board.setFromFEN("7k/8/5K2/8/8/8/8/Q7 w - - 0 1");
+    Tablebase::ProbeResult root;
+    ASSERT_TRUE(tablebase.probe(board, root));
+
+    Move::Move move = bot.findBestMove();
+    ASSERT_TRUE(move.isValid);
+    EXPECT_EQ(bot.searchStatistics.score, Score::tablebaseWin);
+    EXPECT_GT(bot.searchStatistics.tablebaseHits, 0);
+    EXPECT_EQ(bot.searchStatistics.nodes, 0);
+
+    ASSERT_TRUE(board.makeMove(move));
+    Tablebase::ProbeResult child;
+    ASSERT_TRUE(tablebase.probe(board, child));
+    EXPECT_EQ(child.distance, root.distance - 1);
+}
+
+TEST_F(SyzygyTest, MissingAndBrokenTablesAreNotProbed) {
+    Syzygy::Syzygy syzygy;
+    EXPECT_FALSE(syzygy.setPath("missing_syzygy"));
+
+    Board::Board board;
+    board.setFromFEN("8/8/8/8/8/2k5/8/KR6 w - - 0 1");
+    Syzygy::Wdl result;
+    EXPECT_FALSE(syzygy.probeWdl(board, result));
+
+    // A table under the right name but with the wrong magic
+    const std::string brokenDirectory = "test_syzygy_broken";
+    std::filesystem::create_directory(brokenDirectory);
+    std::ofstream(brokenDirectory + "/KRvK.rtbw") << "not a table at all";
+    ASSERT_TRUE(syzygy.setPath(brokenDirectory));
+    EXPECT_FALSE(syzygy.probeWdl(board, result));
+    syzygy.close();
+    std::filesystem::remove_all(brokenDirectory);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include "TablebaseGenerator.hpp"
+#include "Bitbase.hpp"
+
+#include <algorithm>
+#include <filesystem>
+
+class TablebaseGeneratorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        options.directory = directory;
+        options.threadCount = 2;
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory);
+    }
+
+    int getLongestWin(const std::vector<std::int16_t> &values) {
+        int longest = 0;
+        for (std::int16_t value : values) {
+            if (value > 0) {
+                longest = std::max<int>(longest, value);
+            }
+        }
+        return longest;
+    }
+
+    const std::string directory = "test_generated_tablebases";
+    TablebaseGenerator::GeneratorOptions options;
+};
+
+TEST_F(TablebaseGeneratorTest, ListsEveryEnding) {
+    const std::vector<std::string> threePieces = {"KBvK", "KNvK", "KQvK", "KRvK", "KPvK"};
+    EXPECT_EQ(TablebaseGenerator::TablebaseGenerator::getSignatures(3), threePieces);
+
+    // Two pieces on one side or one on each
+    EXPECT_EQ(TablebaseGenerator::TablebaseGenerator::getSignatures(4).size(), 30u);
+
+    const std::vector<std::string> children = TablebaseGenerator::TablebaseGenerator::getChildSignatures("KRvKP");
+    const std::vector<std::string> expected = {"KPvK", "KQvKR", "KRvK", "KRvKB", "KRvKN", "KRvKR"};
+    EXPECT_EQ(children, expected);
+}
+
+TEST_F(TablebaseGeneratorTest, FindsTheLongestMates) {
+    TablebaseGenerator::TablebaseGenerator generator(options);
+
+    // Ten moves with the queen and sixteen with the rook, counted in half moves from the winning side
+    EXPECT_EQ(getLongestWin(generator.generateTable("KQvK")), 19);
+    EXPECT_EQ(getLongestWin(generator.generateTable("KRvK")), 31);
+    EXPECT_EQ(getLongestWin(generator.generateTable("KNvK")), 0);
+}
+
+TEST_F(TablebaseGeneratorTest, TablebaseProbesTheGeneratedTables) {
+    TablebaseGenerator::TablebaseGenerator generator(options);
+    generator.generate("KQvK");
+
+    Tablebase::Tablebase tablebase;
+    ASSERT_TRUE(tablebase.setPath(directory));
+
+    Board::Board board;
+    Tablebase::ProbeResult result;
+
+    // Black has to answer the check with Kg8 and Qa8 mates
+    board.setFromFEN("7k/8/6K1/8/8/8/8/Q7 b - - 0 1");
+    ASSERT_TRUE(tablebase.probe(board, result));
+    EXPECT_EQ(result.wdl, Tablebase::Wdl::LOSS);
+    EXPECT_EQ(result.distance, 2);
+
+    board.setFromFEN("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1");
+    ASSERT_TRUE(tablebase.probe(board, result));
+    EXPECT_EQ(result.wdl, Tablebase::Wdl::DRAW);
+}
+
+TEST_F(TablebaseGeneratorTest, PawnEndingsAgreeWithTheBitbase) {
+    TablebaseGenerator::TablebaseGenerator generator(options);
+    generator.generate("KPvK");
+
+    const std::vector<std::int16_t> values = generator.generateTable("KPvK");
+    int compared = 0;
+
+    for (int strongKing = 0; strongKing < 64; strongKing++) {
+        if (strongKing % 8 > 3) {
+            continue;
+        }
+        for (int pawn = 8; pawn < 56; pawn++) {
+            for (int weakKing = 0; weakKing < 64; weakKing++) {
+                for (bool isStrongSideToMove : {true, false}) {
+                    Tablebase::TablePosition position;
+                    position.signature = "KPvK";
+                    position.squares = {strongKing, pawn, weakKing};
+                    position.isStrongSideToMove = isStrongSideToMove;
+
+                    const std::int16_t value = values[Tablebase::Tablebase::getIndex(position)];
+                    if (value == Tablebase::Tablebase::illegalValue) {
+                        continue;
+                    }
+
+                    // Values are seen from the side to move
+                    const bool isStrongSideWinning = isStrongSideToMove ? value > 0 : value < 0;
+                    compared++;
+                    ASSERT_EQ(isStrongSideWinning, Bitbase::probeKPK(strongKing, pawn, weakKing, isStrongSideToMove))
+                        << strongKing << " " << pawn << " " << weakKing << " " << isStrongSideToMove;
+                }
+            }
+        }
+    }
+
+    EXPECT_GT(compared, 100000);
+}
+
+TEST_F(TablebaseGeneratorTest, ThreadCountDoesNotChangeTheTable) {
+    options.threadCount = 1;
+    TablebaseGenerator::TablebaseGenerator single(options);
+    options.threadCount = 3;
+    TablebaseGenerator::TablebaseGenerator several(options);
+
+    EXPECT_EQ(single.generateTable("KRvK"), several.generateTable("KRvK"));
+}
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include "Tablebase.hpp"
+#include "Brain.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    // Every position of the material is a draw except the ones given
+    void writeTable(const std::string &path, int pieceCount, const std::vector<std::pair<std::size_t, std::int16_t>> &values) {
+        std::vector<std::int16_t> entries(Tablebase::Tablebase::getEntryCount(pieceCount), 0);
+        for (const auto &value : values) {
+            entries[value.first] = value.second;
+        }
+
+        std::ofstream output(path, std::ios::binary);
+        output.write(Tablebase::Tablebase::magic, 4);
+        output.put(static_cast<char>(Tablebase::Tablebase::version));
+        output.put(static_cast<char>(pieceCount));
+        output.put(0);
+        output.put(0);
+        for (std::int16_t entry : entries) {
+            output.put(static_cast<char>(entry & 0xFF));
+            output.put(static_cast<char>((entry >> 8) & 0xFF));
+        }
+    }
+
+    std::size_t getIndex(const std::string &fen) {
+        Board::Board board;
+        board.setFromFEN(fen);
+
+        Tablebase::TablePosition position;
+        EXPECT_TRUE(Tablebase::Tablebase::getTablePosition(board, position));
+        return Tablebase::Tablebase::getIndex(position);
+    }
+}
+
+class TablebaseTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::filesystem::create_directory(directory);
+
+        // After Qa8+ black is made to lose in two half moves, any other queen move only draws
+        Tablebase::ProbeResult lost;
+        lost.wdl = Tablebase::Wdl::LOSS;
+        lost.distance = 2;
+        writeTable(directory + "/KQvK.cbtb", 3, {{getIndex(afterQa8), Tablebase::Tablebase::encodeValue(lost)}});
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory);
+    }
+
+    const std::string directory = "test_tablebases";
+    const std::string root = "7k/8/5K2/8/8/8/8/Q7 w - - 0 1";
+    const std::string afterQa8 = "Q6k/8/5K2/8/8/8/8/8 b - - 1 1";
+};
+
+TEST_F(TablebaseTest, ColourFlippedAndMirroredPositionsShareAnEntry) {
+    Board::Board board;
+    board.setFromFEN("q7/8/8/8/8/5k2/8/7K b - - 0 1");
+
+    Tablebase::TablePosition position;
+    ASSERT_TRUE(Tablebase::Tablebase::getTablePosition(board, position));
+    EXPECT_EQ(position.signature, "KQvK");
+    EXPECT_TRUE(position.isStrongSideToMove);
+
+    EXPECT_EQ(getIndex(root), getIndex("q7/8/8/8/8/5k2/8/7K b - - 0 1"));
+    EXPECT_EQ(getIndex(root), getIndex("k7/8/2K5/8/8/8/8/7Q w - - 0 1"));
+    EXPECT_NE(getIndex(root), getIndex("7k/8/5K2/8/8/8/8/Q7 b - - 0 1"));
+}
+
+TEST_F(TablebaseTest, ValuesRoundTrip) {
+    for (std::int16_t value : {std::int16_t(0), std::int16_t(1), std::int16_t(25), std::int16_t(-1), std::int16_t(-40)}) {
+        EXPECT_EQ(Tablebase::Tablebase::encodeValue(Tablebase::Tablebase::decodeValue(value)), value);
+    }
+}
+
+TEST_F(TablebaseTest, ProbesTheTableOfTheMaterial) {
+    Tablebase::Tablebase tablebase;
+    ASSERT_TRUE(tablebase.setPath(directory));
+    EXPECT_EQ(tablebase.getMaxPieces(), 3);
+
+    Board::Board board;
+    board.setFromFEN(afterQa8);
+
+    Tablebase::ProbeResult result;
+    ASSERT_TRUE(tablebase.probe(board, result));
+    EXPECT_EQ(result.wdl, Tablebase::Wdl::LOSS);
+    EXPECT_EQ(result.distance, 2);
+
+    // Other material has no table
+    board.setFromFEN("R6k/8/5K2/8/8/8/8/8 b - - 0 1");
+    EXPECT_FALSE(tablebase.probe(board, result));
+}
+
+TEST_F(TablebaseTest, FiftyMoveRuleTakesAwayLateMates) {
+    Tablebase::Tablebase tablebase;
+    ASSERT_TRUE(tablebase.setPath(directory));
+
+    Board::Board board;
+    board.setFromFEN("Q6k/8/5K2/8/8/8/8/8 b - - 98 80");
+
+    Tablebase::ProbeResult result;
+    EXPECT_TRUE(tablebase.probe(board, result));
+
+    board.setFromFEN("Q6k/8/5K2/8/8/8/8/8 b - - 99 80");
+    EXPECT_FALSE(tablebase.probe(board, result));
+}
+
+TEST_F(TablebaseTest, BrokenTableIsIgnored) {
+    std::ofstream(directory + "/KQvK.cbtb", std::ios::binary) << "CBTB";
+
+    Tablebase::Tablebase tablebase;
+    ASSERT_TRUE(tablebase.setPath(directory));
+
+    Board::Board board;
+    board.setFromFEN(afterQa8);
+
+    Tablebase::ProbeResult result;
+    EXPECT_FALSE(tablebase.probe(board, result));
+}
+
+TEST_F(TablebaseTest, RootKeepsOnlyTheWinningMove) {
+    Tablebase::Tablebase tablebase;
+    ASSERT_TRUE(tablebase.setPath(directory));
+
+    Board::Board board;
+    board.setFromFEN(root);
+    auto moves = board.getAllValidMoves();
+
+    Tablebase::ProbeResult result;
+    ASSERT_TRUE(tablebase.probeRoot(board, moves, result));
+    ASSERT_EQ(moves.size(), 1);
+    EXPECT_EQ(moves[0].from, 0);
+    EXPECT_EQ(moves[0].to, 56);
+    EXPECT_EQ(result.wdl, Tablebase::Wdl::WIN);
+    EXPECT_EQ(result.distance, 3);
+}
+
+TEST_F(TablebaseTest, BrainPlaysTheTablebaseMoveWithoutSearching) {
+    Brain::Brain brain(root);
+    brain.searchOptions.maxDepth = 3;
+    ASSERT_TRUE(brain.tablebase.setPath(directory));
+
+    Move::Move move = brain.findBestMove();
+
+    EXPECT_EQ(move.from, 0);
+    EXPECT_EQ(move.to, 56);
+    EXPECT_EQ(brain.searchStatistics.nodes, 0);
+    EXPECT_GT(brain.searchStatistics.tablebaseHits, 0);
+    EXPECT_GE(brain.searchStatistics.score, Score::mateBound);
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "TexelTuner.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+namespace {
+    const std::vector<Brain::EvaluationNode> allTerms = {
+        {Brain::EvaluationTypes::MATERIAL, 1.0},
+        {Brain::EvaluationTypes::KING_SAFETY, 1.0},
+        {Brain::EvaluationTypes::SPACE, 1.0},
+        {Brain::EvaluationTypes::PIECE_ACTIVITY, 1.0},
+        {Brain::EvaluationTypes::PAWN_STRUCTURE, 1.0},
+    };
+
+    // Positions along random games, labelled by who is ahead in material so the weights have something to fit
+    void addRandomGames(TexelTuner::TexelTuner &tuner, std::vector<Board::Board> *boards = nullptr) {
+        std::mt19937 random(5);
+        std::vector<BatchEvaluation::PackedPosition> positions;
+        std::vector<double> results;
+
+        for (int game = 0; game < 20; game++) {
+            Board::Board board;
+            for (int ply = 0; ply < 60; ply++) {
+                auto moves = board.getAllValidMoves();
+                if (moves.empty() || !board.makeMove(moves[random() % moves.size()])) {
+                    break;
+                }
+
+                const int material = board.getTaperedScore(true) - board.getTaperedScore(false);
+                positions.emplace_back(board);
+                results.push_back(material > 100 ? 1.0 : material < -100 ? 0.0 : 0.5);
+                if (boards != nullptr) {
+                    boards->push_back(board);
+                }
+            }
+        }
+
+        tuner.addPositions(positions, results);
+    }
+}
+
+TEST(TexelTunerTest, ParsesTheUsualEpdResults) {
+    BatchEvaluation::PackedPosition position;
+    double result = -1;
+
+    ASSERT_TRUE(TexelTuner::TexelTuner::parseEpdLine("4k3/8/8/8/8/8/4P3/4K3 b - - c9 \"1-0\";", position, result));
+    EXPECT_EQ(result, 1.0);
+    EXPECT_FALSE(position.isWhiteToMove);
+    EXPECT_EQ(position.pieces[0][0], 1ULL << 12);
+    EXPECT_EQ(position.pieces[1][5], 1ULL << 60);
+
+    ASSERT_TRUE(TexelTuner::TexelTuner::parseEpdLine("4k3/8/8/8/8/8/4P3/4K3 w - - c9 \"1/2-1/2\";", position, result));
+    EXPECT_EQ(result, 0.5);
+    ASSERT_TRUE(TexelTuner::TexelTuner::parseEpdLine("4k3/8/8/8/8/8/4P3/4K3 w - - 0 1 [0.0]", position, result));
+    EXPECT_EQ(result, 0.0);
+
+    EXPECT_FALSE(TexelTuner::TexelTuner::parseEpdLine("4k3/8/8/8/8/8/4P3/4K3 w - -", position, result));
+    EXPECT_FALSE(TexelTuner::TexelTuner::parseEpdLine("4k3/8/8/8/8/8/4P3/8 w - - [1.0]", position, result));
+    EXPECT_FALSE(TexelTuner::TexelTuner::parseEpdLine("4k3/8/8/8/8/8/4P3/4K4 w - - [1.0]", position, result));
+}
+
+TEST(TexelTunerTest, LoadsEpdFiles) {
+    {
+        std::ofstream output("test_positions.epd");
+        output << "4k3/8/8/8/8/8/4P3/4K3 w - - c9 \"1-0\";\n";
+        output << "not a position\n";
+        output << "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 c9 \"1/2-1/2\";\n";
+    }
+
+    TexelTuner::TexelTuner tuner;
+    EXPECT_EQ(tuner.loadEpd("test_positions.epd"), 2);
+    EXPECT_EQ(tuner.getPositionCount(), 2);
+    EXPECT_GT(tuner.getFeature(0, Brain::EvaluationTypes::MATERIAL), 0.5);
+    std::remove("test_positions.epd");
+
+    EXPECT_ANY_THROW(tuner.loadEpd("missing.epd"));
+}
+
+TEST(TexelTunerTest, FeaturesAddUpToEvaluatePosition) {
+    TexelTuner::TexelTuner tuner;
+    std::vector<Board::Board> boards;
+    addRandomGames(tuner, &boards);
+    ASSERT_EQ(tuner.getPositionCount(), boards.size());
+
+    Brain::Brain brain;
+    brain.setNeurons(allTerms);
+    brain.isWhite = true;
+    brain.searchOptions.useEvaluationCache = false;
+
+    for (std::size_t i = 0; i < boards.size(); i += 7) {
+        brain.testBoard = boards[i];
+
+        double score = 0;
+        for (const auto &node : allTerms) {
+            score += node.value * tuner.getFeature(i, node.type);
+        }
+        EXPECT_NEAR(score, Score::toPawns(brain.evaluatePosition()), 1e-4) << i;
+    }
+}
+
+TEST(TexelTunerTest, GradientMatchesTheErrorItDescends) {
+    TexelTuner::TexelTuner tuner;
+    addRandomGames(tuner);
+
+    double error;
+    const std::vector<double> gradient = tuner.computeGradient(allTerms, 1.0, error);
+    EXPECT_DOUBLE_EQ(error, tuner.computeError(allTerms, 1.0));
+
+    for (std::size_t i = 0; i < allTerms.size(); i++) {
+        std::vector<Brain::EvaluationNode> higher = allTerms;
+        std::vector<Brain::EvaluationNode> lower = allTerms;
+        higher[i].value += 1e-5;
+        lower[i].value -= 1e-5;
+
+        const double difference = (tuner.computeError(higher, 1.0) - tuner.computeError(lower, 1.0)) / 2e-5;
+        EXPECT_NEAR(gradient[i], difference, 1e-6) << i;
+    }
+}
+
+TEST(TexelTunerTest, ChunksAndThreadsDoNotChangeTheError) {
+    TexelTuner::TexelOptions options;
+    options.threadCount = 1;
+    options.chunkSize = 1 << 20;
+    TexelTuner::TexelTuner single(options);
+    addRandomGames(single);
+
+    options.threadCount = 4;
+    options.chunkSize = 64;
+    TexelTuner::TexelTuner chunked(options);
+    addRandomGames(chunked);
+
+    EXPECT_NEAR(single.computeError(allTerms, 1.3), chunked.computeError(allTerms, 1.3), 1e-12);
+}
+
+TEST(TexelTunerTest, TuningLowersTheError) {
+    TexelTuner::TexelOptions options;
+    options.epochs = 100;
+    options.learningRate = 0.05;
+    TexelTuner::TexelTuner tuner(options);
+    addRandomGames(tuner);
+
+    const double scaling = tuner.findScaling(allTerms);
+    EXPECT_GT(scaling, 0.05);
+    EXPECT_LT(scaling, 10.0);
+
+    const double before = tuner.computeError(allTerms, scaling);
+    EXPECT_LE(before, tuner.computeError(allTerms, scaling * 1.5));
+    EXPECT_LE(before, tuner.computeError(allTerms, scaling / 1.5));
+
+    const std::vector<Brain::EvaluationNode> tuned = tuner.tune(allTerms, scaling);
+    ASSERT_EQ(tuned.size(), allTerms.size());
+    EXPECT_LT(tuner.computeError(tuned, scaling), before);
+}
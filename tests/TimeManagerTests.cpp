@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "TimeManager.hpp"
+
+TEST(TimeManagerTest, FixedMoveTimeUsesItAll) {
+    TimeManager::TimeManager timeManager;
+    TimeManager::TimeControl timeControl;
+    timeControl.moveTime = 1000;
+
+    timeManager.start(timeControl);
+
+    EXPECT_TRUE(timeManager.isActive());
+    EXPECT_EQ(timeManager.getSoftDeadline(), 950);
+    EXPECT_EQ(timeManager.getHardDeadline(), 950);
+}
+
+TEST(TimeManagerTest, ClockIsSplitOverTheRemainingMoves) {
+    TimeManager::TimeManager timeManager;
+    TimeManager::TimeControl timeControl;
+    timeControl.remainingTime = 60050;
+    timeControl.increment = 1000;
+    timeControl.movesToGo = 40;
+
+    timeManager.start(timeControl);
+
+    // 60000 / 40 + 3/4 of the increment
+    EXPECT_EQ(timeManager.getSoftDeadline(), 2250);
+    EXPECT_EQ(timeManager.getHardDeadline(), 6750);
+}
+
+TEST(TimeManagerTest, HardDeadlineNeverRisksTheClock) {
+    TimeManager::TimeManager timeManager;
+    TimeManager::TimeControl timeControl;
+    timeControl.remainingTime = 1050;
+    timeControl.increment = 5000;
+
+    timeManager.start(timeControl);
+
+    EXPECT_LE(timeManager.getHardDeadline(), 500);
+    EXPECT_LE(timeManager.getSoftDeadline(), timeManager.getHardDeadline());
+}
+
+TEST(TimeManagerTest, UntimedSearchNeverStops) {
+    TimeManager::TimeManager timeManager;
+    timeManager.start(TimeManager::TimeControl());
+
+    EXPECT_FALSE(timeManager.isActive());
+    EXPECT_TRUE(timeManager.canStartIteration());
+    EXPECT_FALSE(timeManager.shouldStop(1000000));
+
+    timeManager.stop();
+    EXPECT_TRUE(timeManager.shouldStop(0));
+    EXPECT_FALSE(timeManager.canStartIteration());
+}
+
+TEST(TimeManagerTest, NodeLimitStopsTheSearch) {
+    TimeManager::TimeManager timeManager;
+    TimeManager::TimeControl timeControl;
+    timeControl.nodes = 1000;
+
+    timeManager.start(timeControl);
+
+    // Without a clock the depth is left to the node limit
+    EXPECT_TRUE(timeManager.isActive());
+    EXPECT_TRUE(timeManager.canStartIteration());
+    EXPECT_FALSE(timeManager.shouldStop(999));
+    EXPECT_TRUE(timeManager.shouldStop(1000));
+    EXPECT_FALSE(timeManager.canStartIteration());
+}
+
+TEST(TimeManagerTest, PonderHitWithoutAClockKeepsSearching) {
+    TimeManager::TimeManager timeManager;
+    timeManager.startPondering();
+    timeManager.startIteration(1);
+    EXPECT_FALSE(timeManager.shouldStop(1000000));
+
+    // The node budget counts from the first poll after the hit
+    TimeManager::TimeControl timeControl;
+    timeControl.nodes = 1000;
+    timeManager.ponderHit(timeControl, 4);
+    EXPECT_FALSE(timeManager.isPondering());
+    EXPECT_TRUE(timeManager.canStartIteration());
+    EXPECT_FALSE(timeManager.shouldStop(1000000));
+    EXPECT_FALSE(timeManager.shouldStop(1000999));
+    EXPECT_TRUE(timeManager.shouldStop(1001000));
+}
+
+TEST(TimeManagerTest, UntimedPonderHitStopsPastTheMaximumDepth) {
+    TimeManager::TimeManager timeManager;
+    timeManager.startPondering();
+    timeManager.startIteration(3);
+    timeManager.ponderHit(TimeManager::TimeControl(), 3);
+
+    // The iteration at the maximum depth finishes, none is started after it
+    EXPECT_FALSE(timeManager.shouldStop(1000000));
+    EXPECT_FALSE(timeManager.canStartIteration());
+
+    // One already past it when the move came is stopped
+    timeManager.startPondering();
+    timeManager.startIteration(5);
+    timeManager.ponderHit(TimeManager::TimeControl(), 3);
+    EXPECT_TRUE(timeManager.shouldStop(0));
+}
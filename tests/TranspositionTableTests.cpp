@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "TranspositionTable.hpp"
+#include "Board.hpp"
+
+TEST(TranspositionTableTest, StoredEntryIsFound) {
+    TranspositionTable::TranspositionTable table(1);
+    Move::Move move(12, 28, Move::PieceType::PAWN, {});
+
+    table.store(0x1234, 50, 4, TranspositionTable::Bound::EXACT, move);
+
+    TranspositionTable::Entry entry;
+    ASSERT_TRUE(table.probe(0x1234, entry));
+    EXPECT_EQ(Score::unpack(entry.score), 50);
+    EXPECT_EQ(entry.depth, 4);
+    EXPECT_EQ(entry.bound, TranspositionTable::Bound::EXACT);
+    EXPECT_EQ(entry.from, 12);
+    EXPECT_EQ(entry.to, 28);
+
+    EXPECT_FALSE(table.probe(0x1234 + table.getSize(), entry));
+}
+
+TEST(TranspositionTableTest, DeeperEntriesSurviveUntilTheNextSearch) {
+    TranspositionTable::TranspositionTable table(1);
+    const unsigned long long key = 0x42;
+    const unsigned long long otherKey = key + table.getSize();
+
+    table.store(key, 100, 6, TranspositionTable::Bound::LOWER, Move::Move(false));
+    table.store(otherKey, 200, 2, TranspositionTable::Bound::LOWER, Move::Move(false));
+
+    TranspositionTable::Entry entry;
+    EXPECT_TRUE(table.probe(key, entry));
+
+    table.newSearch();
+    table.store(otherKey, 200, 2, TranspositionTable::Bound::LOWER, Move::Move(false));
+    EXPECT_TRUE(table.probe(otherKey, entry));
+    EXPECT_FALSE(table.probe(key, entry));
+}
+
+TEST(TranspositionTableTest, HashKeyFollowsMakeAndUndo) {
+    Board::Board board;
+    board.setFromFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    const unsigned long long initialKey = board.hashKey;
+
+    for (const auto &move : board.getAllValidMoves()) {
+        ASSERT_TRUE(board.makeMove(move));
+        EXPECT_NE(board.hashKey, initialKey);
+        EXPECT_EQ(board.hashKey, board.computeHashKey());
+        board.undoMove();
+        EXPECT_EQ(board.hashKey, initialKey);
+    }
+}
+
+TEST(TranspositionTableTest, IncrementalKeysMatchTheRecomputedOnes) {
+    // Castling both ways and en passant after a2-a4, then promotions with and without a capture
+    const std::vector<std::string> fens = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N w - - 0 1",
+    };
+
+    for (const std::string &fen : fens) {
+        Board::Board board;
+        board.setFromFEN(fen);
+
+        for (const auto &move : board.getAllValidMoves()) {
+            ASSERT_TRUE(board.makeMove(move));
+            ASSERT_EQ(board.hashKey, board.computeHashKey()) << fen;
+
+            for (const auto &reply : board.getAllValidMoves()) {
+                ASSERT_TRUE(board.makeMove(reply));
+                ASSERT_EQ(board.hashKey, board.computeHashKey()) << fen;
+                ASSERT_EQ(board.pawnKey, board.computePawnKey()) << fen;
+
+                board.makeNullMove();
+                ASSERT_EQ(board.hashKey, board.computeHashKey()) << fen;
+                board.undoNullMove();
+
+                board.undoMove();
+            }
+
+            board.undoMove();
+        }
+    }
+}
+
+TEST(TranspositionTableTest, TranspositionsShareTheKey) {
+    Board::Board first;
+    Board::Board second;
+
+    // 1. Nf3 Nf6 2. Nc3 and 1. Nc3 Nf6 2. Nf3
+    ASSERT_TRUE(first.makeMove(Move::Move("g1", "f3")));
+    ASSERT_TRUE(first.makeMove(Move::Move("g8", "f6")));
+    ASSERT_TRUE(first.makeMove(Move::Move("b1", "c3")));
+
+    ASSERT_TRUE(second.makeMove(Move::Move("b1", "c3")));
+    ASSERT_TRUE(second.makeMove(Move::Move("g8", "f6")));
+    ASSERT_TRUE(second.makeMove(Move::Move("g1", "f3")));
+
+    EXPECT_EQ(first.hashKey, second.hashKey);
+}
+
+TEST(TranspositionTableTest, HashfullCountsTheCurrentSearch) {
+    TranspositionTable::TranspositionTable table(1);
+    EXPECT_EQ(table.getHashfull(), 0);
+
+    for (unsigned long long key = 0; key < 500; key++) {
+        table.store(key, 0, 1, TranspositionTable::Bound::EXACT, Move::Move(false));
+    }
+    EXPECT_EQ(table.getHashfull(), 500);
+
+    table.newSearch();
+    EXPECT_EQ(table.getHashfull(), 0);
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include "Tuner.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+namespace {
+    const std::vector<Brain::EvaluationNode> startingNeurons = {
+        {Brain::EvaluationTypes::MATERIAL, 1.0},
+        {Brain::EvaluationTypes::KING_SAFETY, 1.0},
+        {Brain::EvaluationTypes::SPACE, 0.5},
+    };
+
+    // Just enough to play a couple of real games in a test
+    Tuner::TunerOptions getSmallOptions() {
+        Tuner::TunerOptions options;
+        options.populationSize = 2;
+        options.generations = 1;
+        options.eliteCount = 1;
+        options.openingCount = 1;
+        options.nodesPerMove = 50;
+        options.maxPlies = 8;
+        options.threadCount = 2;
+        options.checkpointPath = "test_tuner_checkpoint.txt";
+        options.outputPath = "test_tuned_neurons.txt";
+        return options;
+    }
+}
+
+class TunerTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        std::remove("test_tuner_checkpoint.txt");
+        std::remove("test_tuned_neurons.txt");
+        std::remove("test_neurons.txt");
+    }
+};
+
+TEST_F(TunerTest, CheckpointKeepsThePopulation) {
+    Tuner::Tuner tuner(getSmallOptions());
+    Tuner::Population population = tuner.createPopulation(startingNeurons);
+    population.generation = 7;
+    population.bestFitness = 0.625;
+    population.individuals[1].fitness = 1.0 / 3;
+
+    ASSERT_TRUE(Tuner::Tuner::saveCheckpoint("test_tuner_checkpoint.txt", population));
+
+    Tuner::Population loaded;
+    ASSERT_TRUE(Tuner::Tuner::loadCheckpoint("test_tuner_checkpoint.txt", loaded));
+    EXPECT_EQ(loaded.generation, 7);
+    EXPECT_EQ(loaded.bestFitness, 0.625);
+    ASSERT_EQ(loaded.reference.size(), startingNeurons.size());
+    ASSERT_EQ(loaded.individuals.size(), population.individuals.size());
+    EXPECT_EQ(loaded.individuals[1].fitness, 1.0 / 3);
+
+    for (std::size_t i = 0; i < population.individuals.size(); i++) {
+        ASSERT_EQ(loaded.individuals[i].neurons.size(), startingNeurons.size());
+        for (std::size_t j = 0; j < startingNeurons.size(); j++) {
+            EXPECT_EQ(loaded.individuals[i].neurons[j].type, population.individuals[i].neurons[j].type);
+            EXPECT_EQ(loaded.individuals[i].neurons[j].value, population.individuals[i].neurons[j].value);
+        }
+    }
+
+    EXPECT_FALSE(Tuner::Tuner::loadCheckpoint("missing_checkpoint.txt", loaded));
+}
+
+TEST_F(TunerTest, NeuronsFilesUseTheNeuronsTxtFormat) {
+    ASSERT_TRUE(Tuner::Tuner::saveNeurons("test_neurons.txt", startingNeurons));
+
+    std::ifstream input("test_neurons.txt");
+    const std::string contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(contents, "MATERIAL=1\nKING_SAFETY=1\nSPACE=0.5");
+
+    std::vector<Brain::EvaluationNode> loaded;
+    ASSERT_TRUE(Tuner::Tuner::loadNeurons("test_neurons.txt", loaded));
+    ASSERT_EQ(loaded.size(), 3);
+    EXPECT_EQ(loaded[2].type, Brain::EvaluationTypes::SPACE);
+    EXPECT_EQ(loaded[2].value, 0.5);
+
+    std::ofstream("test_neurons.txt") << "MATERIAL=1.0\nTEMPO=0.2";
+    EXPECT_FALSE(Tuner::Tuner::loadNeurons("test_neurons.txt", loaded));
+}
+
+TEST_F(TunerTest, ChildrenKeepTheTermsOfTheirParents) {
+    Tuner::Tuner tuner(getSmallOptions());
+
+    for (int i = 0; i < 50; i++) {
+        const std::vector<Brain::EvaluationNode> child = tuner.mutate(tuner.crossover(startingNeurons, tuner.mutate(startingNeurons)));
+        ASSERT_EQ(child.size(), startingNeurons.size());
+        for (std::size_t j = 0; j < child.size(); j++) {
+            EXPECT_EQ(child[j].type, startingNeurons[j].type);
+            EXPECT_GE(child[j].value, 0);
+        }
+    }
+}
+
+TEST_F(TunerTest, FixedNodeGamesAreRepeatable) {
+    Tuner::Tuner tuner(getSmallOptions());
+    const std::string fen = Tuner::Tuner::openings[0];
+
+    const Tuner::GameResult first = tuner.playGame(startingNeurons, startingNeurons, fen);
+    EXPECT_EQ(tuner.playGame(startingNeurons, startingNeurons, fen), first);
+
+    // A mate in one is played at once
+    EXPECT_EQ(tuner.playGame(startingNeurons, startingNeurons, "6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1"), Tuner::GameResult::WHITE_WINS);
+}
+
+TEST_F(TunerTest, ResumesFromTheCheckpoint) {
+    Tuner::TunerOptions options = getSmallOptions();
+    {
+        Tuner::Tuner tuner(options);
+        tuner.run(startingNeurons);
+        EXPECT_EQ(tuner.getGamesPlayed(), 4);
+    }
+
+    Tuner::Population population;
+    ASSERT_TRUE(Tuner::Tuner::loadCheckpoint(options.checkpointPath, population));
+    EXPECT_EQ(population.generation, 1);
+
+    std::vector<Brain::EvaluationNode> best;
+    EXPECT_TRUE(Tuner::Tuner::loadNeurons(options.outputPath, best));
+
+    // Only the generation that is missing is played
+    options.generations = 2;
+    Tuner::Tuner resumed(options);
+    resumed.run(startingNeurons);
+    EXPECT_EQ(resumed.getGamesPlayed(), 4);
+
+    ASSERT_TRUE(Tuner::Tuner::loadCheckpoint(options.checkpointPath, population));
+    EXPECT_EQ(population.generation, 2);
+}
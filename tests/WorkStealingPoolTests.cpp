@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include "WorkStealingPool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+TEST(WorkStealingPoolTest, RunsEveryTaskAndCanBeReused) {
+    WorkStealingPool::WorkStealingPool pool(4);
+    EXPECT_EQ(pool.getThreadCount(), 4);
+
+    std::atomic<int> sum{0};
+    for (int round = 1; round <= 3; round++) {
+        for (int i = 1; i <= 100; i++) {
+            pool.submit([&sum, i]() { sum += i; });
+        }
+        pool.wait();
+        EXPECT_EQ(sum, round * 5050);
+    }
+}
+
+TEST(WorkStealingPoolTest, IdleThreadsStealQueuedTasks) {
+    WorkStealingPool::WorkStealingPool pool(2);
+    std::atomic<int> finished{0};
+
+    // The queues are filled in turn, two tasks wait in the queue of the thread that has not called wait yet
+    for (int i = 0; i < 3; i++) {
+        pool.submit([&finished]() { finished++; });
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (finished < 3 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(finished, 3);
+    EXPECT_EQ(pool.getStolenTaskCount(), 2);
+    pool.wait();
+}
+
+TEST(WorkStealingPoolTest, WaitThrowsWhatATaskThrew) {
+    WorkStealingPool::WorkStealingPool pool(2);
+    std::atomic<int> finished{0};
+
+    pool.submit([]() { throw std::runtime_error("task failed"); });
+    for (int i = 0; i < 10; i++) {
+        pool.submit([&finished]() { finished++; });
+    }
+
+    EXPECT_THROW(pool.wait(), std::runtime_error);
+    EXPECT_EQ(finished, 10);
+
+    // The error is reported once
+    pool.submit([&finished]() { finished++; });
+    EXPECT_NO_THROW(pool.wait());
+}